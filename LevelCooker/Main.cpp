@@ -0,0 +1,77 @@
+#include "LevelCook.h"
+#include "LevelFormat.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// LevelCooker <level.json> <output.bdlevel> [--image <TilesetName>=<GameImagePath>]...
+int main(int argc, char ** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: LevelCooker <level.json> <output.bdlevel> [--image <TilesetName>=<GameImagePath>]..." << std::endl;
+        return 1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string outputPath = argv[2];
+
+    LevelCookOptions options;
+    for (int arg = 3; arg < argc; ++arg)
+    {
+        std::string option = argv[arg];
+        if (option == "--image" && arg + 1 < argc)
+        {
+            std::string mapping = argv[++arg];
+            size_t equals = mapping.find('=');
+            if (equals == std::string::npos)
+            {
+                std::cerr << "Expected <TilesetName>=<GameImagePath>, got " << mapping << std::endl;
+                return 1;
+            }
+            options.mImageOverrides[mapping.substr(0, equals)] = mapping.substr(equals + 1);
+        }
+        else
+        {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    std::string error;
+    if (!CookLevel(inputPath, options, bytes, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    // Write to a temporary file first so a failed cook never leaves a truncated level behind
+    std::string tempPath = outputPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(bytes.data()), std::streamsize(bytes.size()));
+        if (!file.good())
+        {
+            std::cerr << "Failed to write " << tempPath << std::endl;
+            return 1;
+        }
+    }
+    std::remove(outputPath.c_str());
+    if (std::rename(tempPath.c_str(), outputPath.c_str()) != 0)
+    {
+        std::cerr << "Failed to replace " << outputPath << std::endl;
+        return 1;
+    }
+
+    const auto * pHeader = reinterpret_cast<const LevelFormat::Header *>(bytes.data());
+    const auto * pTilesets = LevelFormat::GetSection<LevelFormat::TilesetDesc>(pHeader, pHeader->mTilesetsOffset);
+    std::cout << "Cooked " << inputPath << " -> " << outputPath << " (" << bytes.size() << " bytes, "
+        << pHeader->mWidth << "x" << pHeader->mHeight << ", " << pHeader->mLayerCount << " layers)" << std::endl;
+    for (uint32_t tileset = 0; tileset < pHeader->mTilesetCount; ++tileset)
+    {
+        std::cout << "  tileset " << pTilesets[tileset].mName << " firstgid " << pTilesets[tileset].mFirstGid
+            << " -> " << (pTilesets[tileset].mImagePath[0] ? pTilesets[tileset].mImagePath : "<unresolved>") << std::endl;
+    }
+    return 0;
+}
@@ -1,17 +1,18 @@
 #include "AstroidsPrivate.h"
-#include <queue>
-#include <unordered_map>
 #include "AIPathComponent.h"
 #include "PlayerManager.h"
 #include "imgui.h"
 #include "LevelManager.h"
 #include "CameraManager.h"
+#include "NavigationManager.h"
+#include "CrowdManager.h"
+#include "InfluenceMapManager.h"
+#include "AIScheduler.h"
 
 //------------------------------------------------------------------------------------------------------------------------
 
 namespace
 {
-    static const int skSearchRadius = 5;
     static const float skUpdateInterval = 1.f;
 }
 
@@ -19,29 +20,85 @@ namespace
 
 AIPathComponent::AIPathComponent(GameObject * pGameObject, GameManager & gameManager)
     : GameComponent(pGameObject, gameManager)
-    , mName("AIPathComponent")
-    , mPath()
-    , mPathIndex(0)
-    , mLastPlayerTile()
     , mStopDistance(150.f)
     , mMovementSpeed(200.f)
     , mTimeSinceLastPlayerMovement(2.f)
     , mPlayerPosition()
+    , mPathTicket(gsInvalidPathTicket)
+    , mPath()
+    , mPathIndex(0)
+    , mNeedsRepath(false)
+    , mDirection()
+    , mIsScheduled(false)
 {
-
+    if (auto * pCrowdManager = gameManager.GetManager<CrowdManager>())
+    {
+        pCrowdManager->AddAgent(mOwnerHandle, mMovementSpeed);
+    }
+    if (auto * pAIScheduler = gameManager.GetManager<AIScheduler>())
+    {
+        pAIScheduler->Register(this);
+        mIsScheduled = true;
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
 AIPathComponent::~AIPathComponent()
 {
-
+    if (auto * pPathfindingService = GetGameManager().GetManager<PathfindingService>())
+    {
+        pPathfindingService->CancelPath(mPathTicket);
+    }
+    if (auto * pCrowdManager = GetGameManager().GetManager<CrowdManager>())
+    {
+        pCrowdManager->RemoveAgent(mOwnerHandle);
+    }
+    if (auto * pAIScheduler = GetGameManager().GetManager<AIScheduler>())
+    {
+        pAIScheduler->Unregister(this);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
 void AIPathComponent::Update(float deltaTime)
 {
+    // Without a scheduler every frame is a think
+    if (!mIsScheduled)
+    {
+        Think(deltaTime);
+    }
+
+    // Crowd agents are moved together with their neighbors after every component has had its say
+    auto * pCrowdManager = GetGameManager().GetManager<CrowdManager>();
+    if (pCrowdManager && pCrowdManager->HasAgent(mOwnerHandle))
+    {
+        pCrowdManager->SetPreferredVelocity(mOwnerHandle, mDirection * mMovementSpeed);
+        return;
+    }
+
+    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
+    if (!pLevelManager || (mDirection.x == 0.f && mDirection.y == 0.f))
+    {
+        return;
+    }
+
+    // The heading can be a few frames old, so it is checked against the map rather than trusted
+    sf::Vector2f newPosition = GetGameObject().GetPosition() + mDirection * (mMovementSpeed * deltaTime);
+    sf::Vector2i newTile = NavigationManager::WorldToTile(newPosition);
+    if (pLevelManager->IsTileWalkableAI(newTile.x, newTile.y))
+    {
+        GetGameObject().SetPosition(newPosition);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AIPathComponent::Think(float elapsed)
+{
+    mDirection = sf::Vector2f();
+
     GameManager & gameManager = GetGameManager();
     auto playerHandle = gameManager.GetManager<PlayerManager>()->GetPlayers()[0];
     auto * pPlayer = gameManager.GetGameObject(playerHandle);
@@ -54,11 +111,12 @@ void AIPathComponent::Update(float deltaTime)
 
     auto myPosition = GetGameObject().GetPosition();
 
-    mTimeSinceLastPlayerMovement += deltaTime;
+    mTimeSinceLastPlayerMovement += elapsed;
     if (mTimeSinceLastPlayerMovement >= skUpdateInterval)
     {
         mPlayerPosition = pPlayer->GetPosition();
         mTimeSinceLastPlayerMovement = 0.f;
+        mNeedsRepath = true;
     }
 
     float distanceSquared = (mPlayerPosition.x - myPosition.x) * (mPlayerPosition.x - myPosition.x) +
@@ -69,158 +127,160 @@ void AIPathComponent::Update(float deltaTime)
         return;
     }
 
-    auto cellSize = BD::gsPixelCountCellSize;
-    sf::Vector2i myTile(static_cast<int>(myPosition.x / cellSize), static_cast<int>(myPosition.y / cellSize));
-    sf::Vector2i playerTile(static_cast<int>(mPlayerPosition.x / cellSize), static_cast<int>(mPlayerPosition.y / cellSize));
+    // Follow the shared flow field, then a searched path where the field does not reach, and as a last resort head
+    // straight for the player
+    sf::Vector2f direction;
+    auto * pNavigationManager = gameManager.GetManager<NavigationManager>();
+    if (pNavigationManager && pNavigationManager->GetFlowDirection(myPosition, direction))
+    {
+        mPath.clear();
+    }
+    else if (!FollowPath(myPosition, direction))
+    {
+        direction = mPlayerPosition - myPosition;
+        direction /= std::sqrt(distanceSquared);
+    }
+    mDirection = direction;
+}
 
-    sf::Vector2i goalTile = FindClosestWalkableTile(playerTile);
+//------------------------------------------------------------------------------------------------------------------------
 
-    if (playerTile != mLastPlayerTile || mPath.empty())
+bool AIPathComponent::FollowPath(const sf::Vector2f & position, sf::Vector2f & outDirection)
+{
+    GameManager & gameManager = GetGameManager();
+    auto * pPathfindingService = gameManager.GetManager<PathfindingService>();
+    if (!pPathfindingService)
     {
-        mPath = FindPath(myTile, goalTile);
-        mPathIndex = 0;
-        mLastPlayerTile = playerTile;
+        return false;
     }
 
-    if (!mPath.empty() && mPathIndex < mPath.size())
+    if (mPathTicket != gsInvalidPathTicket)
     {
-        sf::Vector2i nextTile = mPath[mPathIndex];
-        sf::Vector2f targetPosition(
-            nextTile.x * cellSize + cellSize / 2.0f,
-            nextTile.y * cellSize + cellSize / 2.0f
-        );
-
-        sf::Vector2f direction = targetPosition - myPosition;
-        float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-        if (distance > 0.01f)
+        std::vector<sf::Vector2i> path;
+        EPathStatus status = pPathfindingService->PollPath(mPathTicket, path);
+        if (status != EPathStatus::Pending)
         {
-            direction /= distance;
+            mPathTicket = gsInvalidPathTicket;
+            if (status == EPathStatus::Ready)
+            {
+                mPath = std::move(path);
+                mPathIndex = 0;
+            }
         }
+    }
 
-        float movementSpeed = mMovementSpeed * deltaTime;
-        sf::Vector2f newPosition = myPosition + (direction * movementSpeed);
+    auto * pNavigationManager = gameManager.GetManager<NavigationManager>();
+    sf::Vector2i goalTile = pNavigationManager && pNavigationManager->HasGoal() ?
+        pNavigationManager->GetGoalTile() : NavigationManager::WorldToTile(mPlayerPosition);
 
-        GetGameObject().SetPosition(newPosition);
+    // Long routes come back a stretch at a time, so running off the end short of the goal asks for the next one.
+    // Keep walking the old path while a new one is on its way.
+    bool reachedPathEnd = !mPath.empty() && mPathIndex >= mPath.size() && mPath.back() != goalTile;
+    if (mPathTicket == gsInvalidPathTicket && (mPath.empty() || mNeedsRepath || reachedPathEnd))
+    {
+        mPathTicket = pPathfindingService->RequestPath(NavigationManager::WorldToTile(position), goalTile);
+        mNeedsRepath = false;
+    }
 
-        float threshold = movementSpeed * 1.5f;
-        if (distance < threshold)
+    float cellSize = BD::gsPixelCountCellSize;
+    while (mPathIndex < mPath.size())
+    {
+        sf::Vector2f target((mPath[mPathIndex].x + 0.5f) * cellSize, (mPath[mPathIndex].y + 0.5f) * cellSize);
+        sf::Vector2f toTarget = target - position;
+        float distance = std::sqrt(toTarget.x * toTarget.x + toTarget.y * toTarget.y);
+        if (distance > cellSize * 0.5f)
         {
-            ++mPathIndex;
+            outDirection = toTarget / distance;
+            return true;
         }
+        ++mPathIndex;
     }
+    return false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void AIPathComponent::DebugImGuiComponentInfo()
+void AIPathComponent::SaveState(SnapshotFormat::AIPathRecord & outRecord, std::vector<SnapshotFormat::PathPoint> & outPoints) const
 {
-	auto gameObjPos = GetGameObject().GetPosition();
-	ImGui::Text("Position x,y: %.3f, %.3f", gameObjPos.x, gameObjPos.y);
+	outRecord.mStopDistance = mStopDistance;
+	outRecord.mMovementSpeed = mMovementSpeed;
+	outRecord.mTimeSinceLastPlayerMovement = mTimeSinceLastPlayerMovement;
+	outRecord.mPlayerPositionX = mPlayerPosition.x;
+	outRecord.mPlayerPositionY = mPlayerPosition.y;
+	outRecord.mDirectionX = mDirection.x;
+	outRecord.mDirectionY = mDirection.y;
+	outRecord.mPathIndex = uint32_t(mPathIndex);
+	outRecord.mFirstPoint = uint32_t(outPoints.size());
+	outRecord.mPointCount = uint32_t(mPath.size());
+	outRecord.mNeedsRepath = (mNeedsRepath || mPathTicket != gsInvalidPathTicket) ? 1 : 0;
+
+	for (const sf::Vector2i & point : mPath)
+	{
+		outPoints.push_back({ point.x, point.y });
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & AIPathComponent::GetClassName()
+void AIPathComponent::LoadState(const SnapshotFormat::AIPathRecord & record, const SnapshotFormat::PathPoint * pPoints)
 {
-	return mName;
+	if (mPathTicket != gsInvalidPathTicket)
+	{
+		if (auto * pPathfindingService = GetGameManager().GetManager<PathfindingService>())
+		{
+			pPathfindingService->CancelPath(mPathTicket);
+		}
+		mPathTicket = gsInvalidPathTicket;
+	}
+
+	mStopDistance = record.mStopDistance;
+	mMovementSpeed = record.mMovementSpeed;
+	mTimeSinceLastPlayerMovement = record.mTimeSinceLastPlayerMovement;
+	mPlayerPosition = sf::Vector2f(record.mPlayerPositionX, record.mPlayerPositionY);
+	mDirection = sf::Vector2f(record.mDirectionX, record.mDirectionY);
+	mPathIndex = record.mPathIndex;
+	mNeedsRepath = record.mNeedsRepath != 0;
+
+	mPath.resize(record.mPointCount);
+	for (uint32_t point = 0; point < record.mPointCount; ++point)
+	{
+		mPath[point] = sf::Vector2i(pPoints[point].mX, pPoints[point].mY);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::vector<sf::Vector2i> AIPathComponent::FindPath(sf::Vector2i start, sf::Vector2i goal)
+void AIPathComponent::DebugImGuiComponentInfo()
 {
-    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
-    std::vector<sf::Vector2i> path;
-    if (!pLevelManager || !pLevelManager->IsTileWalkableAI(goal.x, goal.y))
-    {
-        return path;
-    }
-
-    auto heuristic = [](sf::Vector2i a, sf::Vector2i b) {
-        return abs(a.x - b.x) + abs(a.y - b.y);
-        };
-
-    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> openList;
-    std::unordered_map<int, Node> allNodes;
-
-    auto getKey = [](sf::Vector2i pos) { return pos.y * 1000 + pos.x; };
-
-    Node startNode = { start, 0, heuristic(start, goal), nullptr };
-    openList.push(startNode);
-    allNodes[getKey(start)] = startNode;
-
-    std::vector<sf::Vector2i> directions = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
-
-    while (!openList.empty())
-    {
-        Node current = openList.top();
-        openList.pop();
-
-        if (current.position == goal)
-        {
-            Node * pathNode = &allNodes[getKey(goal)];
-            while (pathNode)
-            {
-                path.push_back(pathNode->position);
-                pathNode = pathNode->parent;
-            }
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
-
-        for (const auto & dir : directions)
-        {
-            sf::Vector2i neighborPos = { current.position.x + dir.x, current.position.y + dir.y };
-
-            if (!pLevelManager->IsTileWalkableAI(neighborPos.x, neighborPos.y)) continue;
-
-            int gCost = current.gCost + 1;
-            int hCost = heuristic(neighborPos, goal);
-            int key = getKey(neighborPos);
+	auto gameObjPos = GetGameObject().GetPosition();
+	ImGui::Text("Position x,y: %.3f, %.3f", gameObjPos.x, gameObjPos.y);
 
-            if (allNodes.find(key) == allNodes.end() || gCost < allNodes[key].gCost)
-            {
-                Node neighborNode = { neighborPos, gCost, hCost, &allNodes[getKey(current.position)] };
-                allNodes[key] = neighborNode;
-                openList.push(neighborNode);
-            }
-        }
-    }
-    return path;
+	if (auto * pNavigationManager = GetGameManager().GetManager<NavigationManager>())
+	{
+		sf::Vector2i tile = NavigationManager::WorldToTile(gameObjPos);
+		ImGui::Text("Steps to player: %d", pNavigationManager->GetDistanceToGoal(tile.x, tile.y));
+	}
+
+	if (auto * pInfluenceMapManager = GetGameManager().GetManager<InfluenceMapManager>())
+	{
+		ImGui::Text("Player threat: %.2f", pInfluenceMapManager->Sample(EInfluenceLayer::PlayerThreat, gameObjPos));
+		ImGui::Text("Enemy density: %.2f", pInfluenceMapManager->Sample(EInfluenceLayer::EnemyDensity, gameObjPos));
+		ImGui::Text("Projectile danger: %.2f", pInfluenceMapManager->Sample(EInfluenceLayer::ProjectileDanger, gameObjPos));
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-sf::Vector2i AIPathComponent::FindClosestWalkableTile(sf::Vector2i targetTile)
-{
-    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
-    if (pLevelManager->IsTileWalkableAI(targetTile.x, targetTile.y))
-    {
-        return targetTile;
-    }
-
-    sf::Vector2i closestTile = targetTile;
-    int closestDist = INT_MAX;
-
-    for (int dx = -skSearchRadius; dx <= skSearchRadius; ++dx)
-    {
-        for (int dy = -skSearchRadius; dy <= skSearchRadius; ++dy)
-        {
-            sf::Vector2i checkTile = { targetTile.x + dx, targetTile.y + dy };
-            if (pLevelManager->IsTileWalkableAI(checkTile.x, checkTile.y))
-            {
-                int dist = std::abs(dx) + std::abs(dy);
+BD_REGISTER_COMPONENT(AIPathComponent)
 
-                if (dist < closestDist)
-                {
-                    closestDist = dist;
-                    closestTile = checkTile;
-                }
-            }
-        }
-    }
-    return closestTile;
+void AIPathComponent::DescribeType(ComponentTypeInfo & typeInfo)
+{
+	typeInfo.AddField<&AIPathComponent::mStopDistance>("StopDistance");
+	typeInfo.AddField<&AIPathComponent::mMovementSpeed>("MovementSpeed");
+	typeInfo.AddField<&AIPathComponent::mTimeSinceLastPlayerMovement>("TimeSinceLastPlayerMovement");
+	typeInfo.AddField<&AIPathComponent::mPlayerPosition>("PlayerPosition");
+	typeInfo.AddField<&AIPathComponent::mDirection>("Direction");
+	typeInfo.AddField<&AIPathComponent::mNeedsRepath>("NeedsRepath");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
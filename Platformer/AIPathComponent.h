@@ -1,47 +1,41 @@
 #pragma once
 #include "GameComponent.h"
-
-struct Node
-{
-	sf::Vector2i position;
-	int gCost = 0;
-	int hCost = 0;
-
-	int fCost() const
-	{
-		return gCost + hCost;
-	}
-
-	Node * parent = nullptr;
-
-	bool operator>(const Node & other) const
-	{
-		return fCost() > other.fCost();
-	}
-};
+#include "PathfindingService.h"
+#include "SnapshotFormat.h"
 
 class AIPathComponent : public GameComponent
 {
+	BD_COMPONENT(AIPathComponent)
+
 public:
 	AIPathComponent(GameObject * pGameObject, GameManager & gameManager);
 	~AIPathComponent();
 
+	// Moves with the velocity picked by the last Think, every frame
 	virtual void Update(float deltaTime) override;
+
+	// Picks where to head next. Called by the AIScheduler, which may let several frames pass in between.
+	void Think(float elapsed);
+
+	// Appends the path to outPoints. Loading drops any path request in flight and asks again on the next Think.
+	void SaveState(SnapshotFormat::AIPathRecord & outRecord, std::vector<SnapshotFormat::PathPoint> & outPoints) const;
+	void LoadState(const SnapshotFormat::AIPathRecord & record, const SnapshotFormat::PathPoint * pPoints);
+
 	virtual void DebugImGuiComponentInfo() override;
-	virtual std::string & GetClassName() override;
 
 private:
-	std::vector<sf::Vector2i> FindPath(sf::Vector2i start, sf::Vector2i goal);
+	// Follows a path from the PathfindingService where the flow field does not reach
+	bool FollowPath(const sf::Vector2f & position, sf::Vector2f & outDirection);
 
-	sf::Vector2i FindClosestWalkableTile(sf::Vector2i targetTile);
-
-	std::string mName;
-	std::vector<sf::Vector2i> mPath;
-	size_t mPathIndex;
-	sf::Vector2i mLastPlayerTile;
 	float mStopDistance;
 	float mMovementSpeed;
 	float mTimeSinceLastPlayerMovement;
 	sf::Vector2f mPlayerPosition;
+	PathTicket mPathTicket;
+	std::vector<sf::Vector2i> mPath;
+	size_t mPathIndex;
+	bool mNeedsRepath;
+	sf::Vector2f mDirection;	// Unit heading from the last Think, zero to stand still
+	bool mIsScheduled;
 };
 
@@ -0,0 +1,192 @@
+#include "AstroidsPrivate.h"
+#include "AIScheduler.h"
+#include "AIPathComponent.h"
+#include "CameraManager.h"
+#include "BDConfig.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <imgui.h>
+
+namespace
+{
+    const float skDefaultBudgetMilliseconds = 1.f;
+
+    // Distance from the camera center in pixels and how many frames apart components in each tier think. Near covers
+    // the screen, far is everything well off it.
+    struct ThinkTier
+    {
+        float mMaxDistance;
+        int mInterval;
+    };
+
+    const ThinkTier skThinkTiers[] =
+    {
+        { 800.f, 1 },
+        { 1600.f, 2 },
+        { FLT_MAX, 4 },
+    };
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+AIScheduler::AIScheduler(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mEntries()
+    , mCursor(0)
+    , mBudgetMilliseconds(skDefaultBudgetMilliseconds)
+    , mThinkCountLastFrame(0)
+    , mOverdueCountLastFrame(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+AIScheduler::~AIScheduler()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AIScheduler::Update(float deltaTime)
+{
+    StopWatch stopWatch;
+    mThinkCountLastFrame = 0;
+    mOverdueCountLastFrame = 0;
+    if (mEntries.empty())
+    {
+        return;
+    }
+
+    for (auto & entry : mEntries)
+    {
+        entry.mElapsed += deltaTime;
+        ++entry.mFramesSinceThink;
+    }
+
+    sf::Vector2f cameraCenter;
+    if (auto * pCameraManager = GetGameManager().GetManager<CameraManager>())
+    {
+        cameraCenter = pCameraManager->GetView().getCenter();
+    }
+
+    // Round robin from where the last frame stopped. At least one component thinks every frame so a budget that is
+    // too small still makes progress.
+    size_t count = mEntries.size();
+    size_t index = mCursor < count ? mCursor : 0;
+    size_t visited = 0;
+    for (; visited < count; ++visited, index = (index + 1) % count)
+    {
+        Entry & entry = mEntries[index];
+        AIPathComponent * pComponent = entry.mpComponent;
+        if (entry.mFramesSinceThink < GetThinkInterval(pComponent->GetGameObject().GetPosition(), cameraCenter))
+        {
+            continue;
+        }
+
+        if (mThinkCountLastFrame > 0 && stopWatch.GetElapsedMilliseconds() >= mBudgetMilliseconds)
+        {
+            break;
+        }
+
+        pComponent->Think(entry.mElapsed);
+        entry.mElapsed = 0.f;
+        entry.mFramesSinceThink = 0;
+        ++mThinkCountLastFrame;
+    }
+    mCursor = index;
+
+    // Only for the debug window, the budget is already spent so this walk is not timed against it
+    for (; visited < count; ++visited, index = (index + 1) % count)
+    {
+        const Entry & entry = mEntries[index];
+        if (entry.mFramesSinceThink >= GetThinkInterval(entry.mpComponent->GetGameObject().GetPosition(), cameraCenter))
+        {
+            ++mOverdueCountLastFrame;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AIScheduler::OnGameEnd()
+{
+    mCursor = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AIScheduler::Register(AIPathComponent * pComponent)
+{
+    // Newcomers are due straight away so nothing stands still waiting for its first turn
+    mEntries.push_back({ pComponent, 0.f, INT_MAX / 2 });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AIScheduler::Unregister(AIPathComponent * pComponent)
+{
+    auto it = std::find_if(mEntries.begin(), mEntries.end(),
+        [pComponent](const Entry & entry) { return entry.mpComponent == pComponent; });
+    if (it == mEntries.end())
+    {
+        return;
+    }
+
+    *it = mEntries.back();
+    mEntries.pop_back();
+    if (mCursor >= mEntries.size())
+    {
+        mCursor = 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AIScheduler::SetBudgetMilliseconds(float budgetMilliseconds)
+{
+    mBudgetMilliseconds = std::max(0.f, budgetMilliseconds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float AIScheduler::GetBudgetMilliseconds() const
+{
+    return mBudgetMilliseconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AIScheduler::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("AI Scheduler");
+
+    ImGui::SliderFloat("Budget (ms)", &mBudgetMilliseconds, 0.1f, 8.f);
+    ImGui::Text("Components: %d", GetEntryCount());
+    ImGui::Text("Thought last frame: %d", mThinkCountLastFrame);
+    ImGui::Text("Overdue last frame: %d", mOverdueCountLastFrame);
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int AIScheduler::GetThinkInterval(const sf::Vector2f & position, const sf::Vector2f & cameraCenter) const
+{
+    sf::Vector2f offset = position - cameraCenter;
+    float distanceSquared = offset.x * offset.x + offset.y * offset.y;
+    for (const ThinkTier & tier : skThinkTiers)
+    {
+        if (distanceSquared <= tier.mMaxDistance * tier.mMaxDistance)
+        {
+            return tier.mInterval;
+        }
+    }
+    return skThinkTiers[std::size(skThinkTiers) - 1].mInterval;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,50 @@
+#pragma once
+#include "BaseManager.h"
+#include <vector>
+
+class AIPathComponent;
+
+// Spreads enemy thinking over frames. Each registered component is put in a tier by its distance to the camera, near
+// ones think every frame and far ones every few, and the due ones are visited round robin until the frame's time
+// budget runs out. Whoever is not reached keeps its place and goes first next frame. Between thinks a component keeps
+// moving with the velocity it last chose, so a skipped frame shows as nothing worse than a late turn.
+class AIScheduler : public BaseManager
+{
+public:
+    AIScheduler(GameManager * pGameManager);
+    ~AIScheduler();
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    void Register(AIPathComponent * pComponent);
+    void Unregister(AIPathComponent * pComponent);
+
+    void SetBudgetMilliseconds(float budgetMilliseconds);
+    float GetBudgetMilliseconds() const;
+
+    int GetEntryCount() const { return int(mEntries.size()); }
+    int GetThinkCountLastFrame() const { return mThinkCountLastFrame; }
+
+    void DebugImGuiInfo();
+
+private:
+    struct Entry
+    {
+        AIPathComponent * mpComponent;
+        float mElapsed;             // Seconds since this component last thought
+        int mFramesSinceThink;
+    };
+
+    int GetThinkInterval(const sf::Vector2f & position, const sf::Vector2f & cameraCenter) const;
+
+    std::vector<Entry> mEntries;
+    size_t mCursor;                 // Where the next frame's round robin starts
+    float mBudgetMilliseconds;
+    int mThinkCountLastFrame;
+    int mOverdueCountLastFrame;     // Due but left for next frame because the budget ran out
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,52 @@
+#include "AstroidsPrivate.h"
+#include "AnimationClip.h"
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float AnimationClip::GetDuration() const
+{
+    return mFrameEndTimes.empty() ? 0.f : mFrameEndTimes.back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int AnimationClip::GetFrameCount() const
+{
+    return int(mFrames.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int AnimationClip::GetFrameIndex(float elapsedTime) const
+{
+    if (mFrameEndTimes.empty())
+    {
+        return 0;
+    }
+
+    float duration = GetDuration();
+    if (mLoop && duration > 0.f)
+    {
+        elapsedTime = std::fmod(elapsedTime, duration);
+    }
+
+    auto it = std::upper_bound(mFrameEndTimes.begin(), mFrameEndTimes.end(), elapsedTime);
+    if (it == mFrameEndTimes.end())
+    {
+        return GetFrameCount() - 1;
+    }
+    return int(it - mFrameEndTimes.begin());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool AnimationClip::IsFinished(float elapsedTime) const
+{
+    return !mLoop && elapsedTime >= GetDuration();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
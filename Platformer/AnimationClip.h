@@ -0,0 +1,33 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include <SFML/Graphics.hpp>
+
+//------------------------------------------------------------------------------------------------------------------------
+// AnimationClip
+//
+// Immutable flipbook data (sheet, frame rects and timings). Clips are loaded once by the ResourceManager and shared by
+// every AnimationComponent and effect that plays them, so none of those ever copy the texture.
+//------------------------------------------------------------------------------------------------------------------------
+
+struct AnimationClip
+{
+    std::string mName;
+    std::shared_ptr<sf::Texture> mpSheet;
+    std::vector<sf::IntRect> mFrames;
+    std::vector<float> mFrameEndTimes; // Cumulative, mFrameEndTimes.back() is the clip duration
+    bool mLoop = false;
+
+    float GetDuration() const;
+    int GetFrameCount() const;
+
+    // Frame to show after elapsedTime seconds, wraps for looping clips and clamps to the last frame otherwise
+    int GetFrameIndex(float elapsedTime) const;
+
+    bool IsFinished(float elapsedTime) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
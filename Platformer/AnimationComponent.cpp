@@ -0,0 +1,140 @@
+#include "AstroidsPrivate.h"
+#include "AnimationComponent.h"
+#include "SpriteComponent.h"
+#include "CameraManager.h"
+#include "BDConfig.h"
+#include <cmath>
+#include "imgui.h"
+
+AnimationComponent::AnimationComponent(GameObject * pOwner, GameManager & gameManager, std::shared_ptr<const AnimationClip> pClip, float startTime)
+	: GameComponent(pOwner, gameManager)
+	, mpClip()
+	, mElapsedTime(startTime)
+	, mCurrentFrame(-1)
+{
+	SetClip(pClip);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+AnimationComponent::~AnimationComponent()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AnimationComponent::SetClip(std::shared_ptr<const AnimationClip> pClip)
+{
+	mpClip = pClip;
+	mCurrentFrame = -1;
+	if (!mpClip || !mpClip->mpSheet || mpClip->mFrames.empty())
+	{
+		return;
+	}
+
+	auto pSpriteComponent = GetGameObject().GetComponent<SpriteComponent>().lock();
+	if (pSpriteComponent)
+	{
+		pSpriteComponent->GetSprite().setTexture(*mpClip->mpSheet);
+		ApplyFrame(mpClip->GetFrameIndex(mElapsedTime));
+		pSpriteComponent->SetOriginToCenter();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AnimationComponent::Update(float deltaTime)
+{
+	if (!mpClip)
+	{
+		return;
+	}
+
+	mElapsedTime += deltaTime;
+
+	// Keep the timer small so float precision does not drift on long lived loops
+	float duration = mpClip->GetDuration();
+	if (mpClip->mLoop && duration > 0.f && mElapsedTime >= duration)
+	{
+		mElapsedTime = std::fmod(mElapsedTime, duration);
+	}
+
+	GameObject * pOwner = GetGameManager().GetGameObject(mOwnerHandle);
+	if (!pOwner || !pOwner->IsActive())
+	{
+		return;
+	}
+
+	auto pSpriteComponent = pOwner->GetComponent<SpriteComponent>().lock();
+	if (!pSpriteComponent)
+	{
+		return;
+	}
+
+	auto * pCameraManager = GetGameManager().GetManager<CameraManager>();
+	if (pCameraManager && !pCameraManager->GetViewBounds().intersects(pSpriteComponent->GetSprite().getGlobalBounds()))
+	{
+		return;
+	}
+
+	ApplyFrame(mpClip->GetFrameIndex(mElapsedTime));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AnimationComponent::ApplyFrame(int frame)
+{
+	if (frame == mCurrentFrame)
+	{
+		return;
+	}
+
+	auto pSpriteComponent = GetGameObject().GetComponent<SpriteComponent>().lock();
+	if (pSpriteComponent)
+	{
+		pSpriteComponent->GetSprite().setTextureRect(mpClip->mFrames[frame]);
+		mCurrentFrame = frame;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AnimationComponent::SaveState(SnapshotFormat::AnimationRecord & outRecord) const
+{
+	outRecord.mElapsedTime = mElapsedTime;
+	outRecord.mCurrentFrame = mCurrentFrame;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AnimationComponent::LoadState(const SnapshotFormat::AnimationRecord & record)
+{
+	mElapsedTime = record.mElapsedTime;
+	if (mpClip && record.mCurrentFrame >= 0 && record.mCurrentFrame < int(mpClip->mFrames.size()))
+	{
+		ApplyFrame(record.mCurrentFrame);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AnimationComponent::DebugImGuiComponentInfo()
+{
+#if IMGUI_ENABLED()
+	ImGui::Text("Clip: %s", mpClip ? mpClip->mName.c_str() : "None");
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD_REGISTER_COMPONENT(AnimationComponent)
+
+void AnimationComponent::DescribeType(ComponentTypeInfo & typeInfo)
+{
+	typeInfo.AddField<&AnimationComponent::mElapsedTime>("ElapsedTime");
+	typeInfo.AddField<&AnimationComponent::mCurrentFrame>("CurrentFrame");
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,35 @@
+#pragma once
+#include "GameComponent.h"
+#include "AnimationClip.h"
+#include "SnapshotFormat.h"
+
+// Loops a shared clip on the owner's SpriteComponent. Time always advances but the frame is only resolved while the
+// owner is inside the camera view, so off-screen enemies cost one float add per frame.
+class AnimationComponent : public GameComponent
+{
+	BD_COMPONENT(AnimationComponent)
+
+public:
+	AnimationComponent(GameObject * pOwner, GameManager & gameManager, std::shared_ptr<const AnimationClip> pClip, float startTime = 0.f);
+	~AnimationComponent();
+
+	void SetClip(std::shared_ptr<const AnimationClip> pClip);
+
+	// The clip itself is not saved, the owner's spawner sets it up again
+	void SaveState(SnapshotFormat::AnimationRecord & outRecord) const;
+	void LoadState(const SnapshotFormat::AnimationRecord & record);
+
+	virtual void Update(float deltaTime) override;
+	virtual void DebugImGuiComponentInfo() override;
+
+private:
+	void ApplyFrame(int frame);
+
+	std::shared_ptr<const AnimationClip> mpClip;
+	float mElapsedTime;
+	int mCurrentFrame;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,257 @@
+#include "AstroidsPrivate.h"
+#include "AudioManager.h"
+#include "CameraManager.h"
+#include "ResourceManager.h"
+#include <cmath>
+
+namespace
+{
+    const int skMaxVoices = 32;
+
+    const SoundDesc skSoundDescs[] =
+    {
+        // Path                       Volume  Pitch  Priority  MaxConcurrent  MaxDistance
+        { "Audio/explosion.wav",      20.f,   0.05f, 0,        6,             1600.f },
+        { "Audio/LoseLifeSound.wav",  100.f,  0.f,   10,       1,             0.f    },
+        { "Audio/Death.flac",         50.f,   0.f,   20,       1,             0.f    },
+    };
+    static_assert(sizeof(skSoundDescs) / sizeof(skSoundDescs[0]) == size_t(ESound::Count), "Missing SoundDesc for an ESound");
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+AudioManager::AudioManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mSoundBuffers()
+    , mVoices(skMaxVoices)
+    , mPlayTick(0)
+    , mRandom(std::random_device{}())
+{
+    // Decode every effect once up front so playing a sound never touches the disk
+    auto * pResourceManager = GetGameManager().GetManager<ResourceManager>();
+    for (int ii = 0; ii < int(ESound::Count); ++ii)
+    {
+        ResourceId resourceId(GetSoundDesc(ESound(ii)).mpFilePath);
+        mSoundBuffers[ii] = pResourceManager->GetSoundBuffer(resourceId);
+    }
+
+    for (auto & voice : mVoices)
+    {
+        voice.mType = ESound::Count;
+        voice.mPriority = 0;
+        voice.mStartTick = 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+AudioManager::~AudioManager()
+{
+    StopAllSounds();
+    StopMusic();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AudioManager::OnGameEnd()
+{
+    StopMusic();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool AudioManager::PlaySound(ESound sound)
+{
+    return PlayInternal(sound, 1.f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool AudioManager::PlaySound(ESound sound, const sf::Vector2f & position)
+{
+    float attenuation = GetAttenuation(sound, position);
+    if (attenuation <= 0.f)
+    {
+        return false;
+    }
+    return PlayInternal(sound, attenuation);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool AudioManager::PlayMusic(const std::string & filePath, float volume, bool loop)
+{
+    // sf::Music streams from disk in small chunks instead of decoding the whole track up front
+    if (!mMusic.openFromFile(filePath))
+    {
+        return false;
+    }
+    mMusic.setVolume(volume);
+    mMusic.setLoop(loop);
+    mMusic.play();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AudioManager::StopMusic()
+{
+    mMusic.stop();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void AudioManager::StopAllSounds()
+{
+    for (auto & voice : mVoices)
+    {
+        voice.mSound.stop();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int AudioManager::GetActiveVoiceCount() const
+{
+    int count = 0;
+    for (const auto & voice : mVoices)
+    {
+        if (voice.mSound.getStatus() == sf::Sound::Playing)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool AudioManager::PlayInternal(ESound sound, float volumeScale)
+{
+    auto & pBuffer = mSoundBuffers[int(sound)];
+    if (!pBuffer)
+    {
+        return false;
+    }
+
+    Voice * pVoice = AcquireVoice(sound);
+    if (!pVoice)
+    {
+        return false;
+    }
+
+    const SoundDesc & desc = GetSoundDesc(sound);
+    float pitch = 1.f;
+    if (desc.mPitchVariance > 0.f)
+    {
+        std::uniform_real_distribution<float> pitchDist(1.f - desc.mPitchVariance, 1.f + desc.mPitchVariance);
+        pitch = pitchDist(mRandom);
+    }
+
+    pVoice->mSound.stop();
+    if (pVoice->mSound.getBuffer() != pBuffer.get())
+    {
+        pVoice->mSound.setBuffer(*pBuffer);
+    }
+    pVoice->mSound.setVolume(desc.mVolume * volumeScale);
+    pVoice->mSound.setPitch(pitch);
+    pVoice->mType = sound;
+    pVoice->mPriority = desc.mPriority;
+    pVoice->mStartTick = ++mPlayTick;
+    pVoice->mSound.play();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+AudioManager::Voice * AudioManager::AcquireVoice(ESound sound)
+{
+    const SoundDesc & desc = GetSoundDesc(sound);
+
+    Voice * pFree = nullptr;
+    Voice * pOldestSameType = nullptr;
+    Voice * pSteal = nullptr;
+    int sameTypeCount = 0;
+
+    for (auto & voice : mVoices)
+    {
+        if (voice.mSound.getStatus() != sf::Sound::Playing)
+        {
+            if (!pFree)
+            {
+                pFree = &voice;
+            }
+            continue;
+        }
+
+        if (voice.mType == sound)
+        {
+            ++sameTypeCount;
+            if (!pOldestSameType || voice.mStartTick < pOldestSameType->mStartTick)
+            {
+                pOldestSameType = &voice;
+            }
+        }
+
+        // Lowest priority first, then the oldest voice within that priority
+        if (voice.mPriority <= desc.mPriority)
+        {
+            if (!pSteal || voice.mPriority < pSteal->mPriority
+                || (voice.mPriority == pSteal->mPriority && voice.mStartTick < pSteal->mStartTick))
+            {
+                pSteal = &voice;
+            }
+        }
+    }
+
+    // At the per type cap the newest request replaces the oldest instance of the same sound
+    if (sameTypeCount >= desc.mMaxConcurrent)
+    {
+        return pOldestSameType;
+    }
+
+    if (pFree)
+    {
+        return pFree;
+    }
+
+    return pSteal;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float AudioManager::GetAttenuation(ESound sound, const sf::Vector2f & position) const
+{
+    const SoundDesc & desc = GetSoundDesc(sound);
+    if (desc.mMaxDistance <= 0.f)
+    {
+        return 1.f;
+    }
+
+    auto * pCameraManager = GetGameManager().GetManager<CameraManager>();
+    if (!pCameraManager)
+    {
+        return 1.f;
+    }
+
+    sf::Vector2f delta = position - pCameraManager->GetView().getCenter();
+    float distanceSquared = delta.x * delta.x + delta.y * delta.y;
+    if (distanceSquared >= desc.mMaxDistance * desc.mMaxDistance)
+    {
+        return 0.f;
+    }
+
+    return 1.f - std::sqrt(distanceSquared) / desc.mMaxDistance;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const SoundDesc & AudioManager::GetSoundDesc(ESound sound)
+{
+    assert(sound < ESound::Count && "Invalid ESound");
+    return skSoundDescs[int(sound)];
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
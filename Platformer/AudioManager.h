@@ -0,0 +1,75 @@
+#pragma once
+#include "BaseManager.h"
+#include <vector>
+#include <random>
+
+enum class ESound
+{
+    Explosion,
+    LoseLife,
+    Death,
+    Count
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+struct SoundDesc
+{
+    const char * mpFilePath;
+    float mVolume;
+    float mPitchVariance;
+    int mPriority;          // Higher priority sounds may steal voices from lower priority ones
+    int mMaxConcurrent;     // Cap on how many voices of this type can play at once
+    float mMaxDistance;     // Positional sounds further than this from the camera are culled
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+class AudioManager : public BaseManager
+{
+public:
+    AudioManager(GameManager * pGameManager);
+    ~AudioManager();
+
+    virtual void OnGameEnd() override;
+
+    // Non positional, always audible
+    bool PlaySound(ESound sound);
+
+    // Attenuated by distance to the camera and culled past the sound's max distance
+    bool PlaySound(ESound sound, const sf::Vector2f & position);
+
+    bool PlayMusic(const std::string & filePath, float volume = 30.f, bool loop = true);
+    void StopMusic();
+
+    void StopAllSounds();
+
+    int GetActiveVoiceCount() const;
+
+private:
+    struct Voice
+    {
+        sf::Sound mSound;
+        ESound mType;
+        int mPriority;
+        BD::uint64 mStartTick;
+    };
+
+    bool PlayInternal(ESound sound, float volumeScale);
+    Voice * AcquireVoice(ESound sound);
+    float GetAttenuation(ESound sound, const sf::Vector2f & position) const;
+
+    static const SoundDesc & GetSoundDesc(ESound sound);
+
+    // Declared before the voices so the buffers outlive every sf::Sound that references them
+    std::shared_ptr<sf::SoundBuffer> mSoundBuffers[int(ESound::Count)];
+    std::vector<Voice> mVoices;
+    BD::uint64 mPlayTick;
+    std::mt19937 mRandom;
+
+    sf::Music mMusic;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -5,6 +5,13 @@
 
 #define IMGUI_ENABLED() (1) // Always true for now; can be updated later
 
+// Cook Tiled JSON in memory when a .bdlevel is missing or stale. Shipping builds only load cooked levels.
+#ifdef _DEBUG
+#define LEVEL_JSON_FALLBACK_ENABLED() (1)
+#else
+#define LEVEL_JSON_FALLBACK_ENABLED() (0)
+#endif
+
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------
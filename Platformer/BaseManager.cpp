@@ -36,6 +36,20 @@ void BaseManager::OnGameEnd()
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void BaseManager::OnGameStart()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BaseManager::OnLevelUnloading()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 GameManager & BaseManager::GetGameManager() const
 {
 	assert(mpGameManager && "mpGameManager is nullptr!");
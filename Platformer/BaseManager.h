@@ -6,12 +6,18 @@ class BaseManager
 {
 public:
 	explicit BaseManager(GameManager * pGameManager);
-	~BaseManager();
+	virtual ~BaseManager();
 
 	virtual void Update(float deltaTime);
 	virtual void Render(sf::RenderWindow & window);
 	virtual void OnGameEnd();
 
+	// A new game on the same managers, after GameManager::Reset has built a fresh root
+	virtual void OnGameStart();
+
+	// The LevelManager is about to release the current level's storage, nothing may still be reading it afterwards
+	virtual void OnLevelUnloading();
+
 	GameManager & GetGameManager() const;
 private:
 	GameManager * mpGameManager;
@@ -0,0 +1,343 @@
+#include "AstroidsPrivate.h"
+#include "BitGrid.h"
+#include <algorithm>
+#include <cassert>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    int PopCount(uint64_t word)
+    {
+#ifdef _MSC_VER
+        return int(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    int CountTrailingZeros(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return int(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // Bits [begin, end) of a single word, end may be 64
+    uint64_t RangeMask(int begin, int end)
+    {
+        uint64_t high = end >= 64 ? ~uint64_t(0) : ((uint64_t(1) << end) - 1);
+        uint64_t low = (uint64_t(1) << begin) - 1;
+        return high & ~low;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// BitGridView
+//------------------------------------------------------------------------------------------------------------------------
+
+BitGridView::BitGridView()
+    : mpWords(nullptr)
+    , mWidth(0)
+    , mHeight(0)
+    , mWordsPerRow(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BitGridView::BitGridView(const uint64_t * pWords, int width, int height)
+    : mpWords(pWords)
+    , mWidth(width)
+    , mHeight(height)
+    , mWordsPerRow(GetWordsPerRow(width))
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int BitGridView::CountSet() const
+{
+    int count = 0;
+    size_t wordCount = size_t(mWordsPerRow) * mHeight;
+    for (size_t word = 0; word < wordCount; ++word)
+    {
+        count += PopCount(mpWords[word]);
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int BitGridView::CountSetInRect(int x, int y, int width, int height) const
+{
+    int left = std::max(x, 0);
+    int top = std::max(y, 0);
+    int right = std::min(x + width, mWidth);
+    int bottom = std::min(y + height, mHeight);
+    if (left >= right || top >= bottom)
+    {
+        return 0;
+    }
+
+    int firstWord = left >> 6;
+    int lastWord = (right - 1) >> 6;
+
+    int count = 0;
+    for (int row = top; row < bottom; ++row)
+    {
+        const uint64_t * pRow = GetRowWords(row);
+        for (int word = firstWord; word <= lastWord; ++word)
+        {
+            int begin = word == firstWord ? (left & 63) : 0;
+            int end = word == lastWord ? ((right - 1) & 63) + 1 : 64;
+            count += PopCount(pRow[word] & RangeMask(begin, end));
+        }
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BitGridView::FloodFill(int x, int y, BitGrid & outRegion) const
+{
+    outRegion.Resize(mWidth, mHeight, false);
+    if (!Test(x, y))
+    {
+        return;
+    }
+    outRegion.Set(x, y);
+
+    // Grow the region a whole word at a time until it stops changing. Each step spreads one cell sideways through
+    // the shifts, one row vertically, and all the way to the top of a horizontal run in one go through the carry of
+    // mask + region, so open rooms fill in a handful of sweeps instead of one per cell.
+    std::vector<uint64_t> scratch(mWordsPerRow);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (int step = 0; step < mHeight; ++step)
+            {
+                int row = pass == 0 ? step : mHeight - 1 - step;
+                const uint64_t * pMask = GetRowWords(row);
+                uint64_t * pRegion = outRegion.GetMutableRowWords(row);
+                const uint64_t * pAbove = row > 0 ? outRegion.GetRowWords(row - 1) : nullptr;
+                const uint64_t * pBelow = row + 1 < mHeight ? outRegion.GetRowWords(row + 1) : nullptr;
+
+                for (int word = 0; word < mWordsPerRow; ++word)
+                {
+                    uint64_t region = pRegion[word];
+                    uint64_t grown = region | (region << 1) | (region >> 1);
+                    if (word > 0)
+                    {
+                        grown |= pRegion[word - 1] >> 63;
+                    }
+                    if (word + 1 < mWordsPerRow)
+                    {
+                        grown |= pRegion[word + 1] << 63;
+                    }
+                    if (pAbove)
+                    {
+                        grown |= pAbove[word];
+                    }
+                    if (pBelow)
+                    {
+                        grown |= pBelow[word];
+                    }
+
+                    uint64_t mask = pMask[word];
+                    grown &= mask;
+                    grown |= mask & ~(mask + grown);
+                    scratch[word] = grown;
+                }
+
+                for (int word = 0; word < mWordsPerRow; ++word)
+                {
+                    if (scratch[word] != pRegion[word])
+                    {
+                        pRegion[word] = scratch[word];
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int BitGridView::CountRegions() const
+{
+    BitGrid remaining(*this);
+    BitGrid region;
+    int regionCount = 0;
+
+    size_t wordCount = size_t(mWordsPerRow) * mHeight;
+    size_t searchFrom = 0;
+    while (true)
+    {
+        const uint64_t * pWords = remaining.GetRowWords(0);
+        while (searchFrom < wordCount && pWords[searchFrom] == 0)
+        {
+            ++searchFrom;
+        }
+        if (searchFrom == wordCount)
+        {
+            return regionCount;
+        }
+
+        int row = int(searchFrom / mWordsPerRow);
+        int column = int(searchFrom % mWordsPerRow) * 64 + CountTrailingZeros(pWords[searchFrom]);
+        FloodFill(column, row, region);
+        remaining.AndNot(region);
+        ++regionCount;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// BitGrid
+//------------------------------------------------------------------------------------------------------------------------
+
+BitGrid::BitGrid()
+    : BitGridView()
+    , mStorage()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BitGrid::BitGrid(int width, int height, bool value)
+    : BitGridView()
+    , mStorage()
+{
+    Resize(width, height, value);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BitGrid::BitGrid(const BitGridView & other)
+    : BitGridView()
+    , mStorage()
+{
+    Resize(other.GetWidth(), other.GetHeight(), false);
+    if (!other.IsEmpty())
+    {
+        std::copy(other.GetRowWords(0), other.GetRowWords(0) + mStorage.size(), mStorage.begin());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BitGrid::BitGrid(const BitGrid & other)
+    : BitGrid(static_cast<const BitGridView &>(other))
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BitGrid & BitGrid::operator=(const BitGrid & other)
+{
+    if (this != &other)
+    {
+        mStorage = other.mStorage;
+        mWidth = other.mWidth;
+        mHeight = other.mHeight;
+        mWordsPerRow = other.mWordsPerRow;
+        mpWords = mStorage.empty() ? nullptr : mStorage.data();
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BitGrid::Resize(int width, int height, bool value)
+{
+    mWidth = width;
+    mHeight = height;
+    mWordsPerRow = GetWordsPerRow(width);
+    mStorage.assign(size_t(mWordsPerRow) * height, value ? ~uint64_t(0) : uint64_t(0));
+    mpWords = mStorage.empty() ? nullptr : mStorage.data();
+    if (value)
+    {
+        ClearPadding();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BitGrid::SetAll(bool value)
+{
+    std::fill(mStorage.begin(), mStorage.end(), value ? ~uint64_t(0) : uint64_t(0));
+    if (value)
+    {
+        ClearPadding();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BitGrid::Or(const BitGridView & other)
+{
+    assert(other.GetWidth() == mWidth && other.GetHeight() == mHeight);
+    const uint64_t * pOther = other.GetRowWords(0);
+    for (size_t word = 0; word < mStorage.size(); ++word)
+    {
+        mStorage[word] |= pOther[word];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BitGrid::And(const BitGridView & other)
+{
+    assert(other.GetWidth() == mWidth && other.GetHeight() == mHeight);
+    const uint64_t * pOther = other.GetRowWords(0);
+    for (size_t word = 0; word < mStorage.size(); ++word)
+    {
+        mStorage[word] &= pOther[word];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BitGrid::AndNot(const BitGridView & other)
+{
+    assert(other.GetWidth() == mWidth && other.GetHeight() == mHeight);
+    const uint64_t * pOther = other.GetRowWords(0);
+    for (size_t word = 0; word < mStorage.size(); ++word)
+    {
+        mStorage[word] &= ~pOther[word];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void BitGrid::ClearPadding()
+{
+    int usedBits = mWidth & 63;
+    if (usedBits == 0)
+    {
+        return;
+    }
+
+    uint64_t lastWordMask = RangeMask(0, usedBits);
+    for (int row = 0; row < mHeight; ++row)
+    {
+        GetMutableRowWords(row)[mWordsPerRow - 1] &= lastWordMask;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
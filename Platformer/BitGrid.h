@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BitGrid;
+
+//------------------------------------------------------------------------------------------------------------------------
+// BitGridView
+//
+// Read-only, bit-packed boolean layer. Each row starts on a fresh 64-bit word and the padding bits past the width are
+// always zero, so whole-word operations never need masking. Views can point straight into memory they do not own,
+// such as the bitsets in a memory mapped .bdlevel.
+//------------------------------------------------------------------------------------------------------------------------
+
+class BitGridView
+{
+public:
+    BitGridView();
+    BitGridView(const uint64_t * pWords, int width, int height);
+
+    static int GetWordsPerRow(int width) { return (width + 63) / 64; }
+
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+    int GetWordsPerRow() const { return mWordsPerRow; }
+    bool IsEmpty() const { return mpWords == nullptr; }
+
+    bool IsInBounds(int x, int y) const
+    {
+        return unsigned(x) < unsigned(mWidth) && unsigned(y) < unsigned(mHeight);
+    }
+
+    // Cells off the grid read as false
+    bool Test(int x, int y) const
+    {
+        return IsInBounds(x, y) && ((mpWords[y * mWordsPerRow + (x >> 6)] >> (x & 63)) & 1u);
+    }
+
+    bool TestUnchecked(int x, int y) const
+    {
+        return (mpWords[y * mWordsPerRow + (x >> 6)] >> (x & 63)) & 1u;
+    }
+
+    const uint64_t * GetRowWords(int y) const { return mpWords + y * mWordsPerRow; }
+
+    int CountSet() const;
+    int CountSetInRect(int x, int y, int width, int height) const;
+
+    // 4-connected region of set cells containing (x, y); empty when that cell is clear
+    void FloodFill(int x, int y, BitGrid & outRegion) const;
+    int CountRegions() const;
+
+protected:
+    const uint64_t * mpWords;
+    int mWidth;
+    int mHeight;
+    int mWordsPerRow;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// BitGrid
+//
+// Owning, writable BitGridView.
+//------------------------------------------------------------------------------------------------------------------------
+
+class BitGrid : public BitGridView
+{
+public:
+    BitGrid();
+    BitGrid(int width, int height, bool value = false);
+    BitGrid(const BitGridView & other);
+    BitGrid(const BitGrid & other);
+    BitGrid & operator=(const BitGrid & other);
+
+    void Resize(int width, int height, bool value = false);
+    void SetAll(bool value);
+
+    void Set(int x, int y, bool value = true)
+    {
+        uint64_t & word = mStorage[size_t(y) * mWordsPerRow + (x >> 6)];
+        uint64_t bit = uint64_t(1) << (x & 63);
+        word = value ? (word | bit) : (word & ~bit);
+    }
+
+    uint64_t * GetMutableRowWords(int y) { return mStorage.data() + size_t(y) * mWordsPerRow; }
+
+    // Word-parallel set operations, both grids must be the same size
+    void Or(const BitGridView & other);
+    void And(const BitGridView & other);
+    void AndNot(const BitGridView & other);
+
+private:
+    void ClearPadding();
+
+    std::vector<uint64_t> mStorage;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
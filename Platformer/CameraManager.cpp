@@ -3,6 +3,7 @@
 #include "GameObject.h"
 #include "ResourceManager.h"
 #include "PlayerManager.h"
+#include "InputManager.h"
 
 CameraManager::CameraManager(GameManager * pGameManager)
 	: BaseManager(pGameManager)
@@ -47,9 +48,12 @@ void CameraManager::Update(float deltaTime)
 
 	gameManager.GetWindow().setView(mView);
 
-	sf::Vector2f cursorWorldPos = gameManager.GetWindow().mapPixelToCoords(
-		sf::Mouse::getPosition(gameManager.GetWindow()), mView
-	);
+	sf::Vector2i cursorPixelPos;
+	if (auto * pInputManager = gameManager.GetManager<InputManager>())
+	{
+		cursorPixelPos = pInputManager->GetSnapshot().mMousePosition;
+	}
+	sf::Vector2f cursorWorldPos = gameManager.GetWindow().mapPixelToCoords(cursorPixelPos, mView);
 
 	mCursorSprite.setPosition(cursorWorldPos);
 }
@@ -85,6 +89,14 @@ sf::View & CameraManager::GetView()
 
 //------------------------------------------------------------------------------------------------------------------------
 
+sf::FloatRect CameraManager::GetViewBounds() const
+{
+	sf::Vector2f size = mView.getSize();
+	return sf::FloatRect(mView.getCenter() - size / 2.f, size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 sf::Vector2f CameraManager::Lerp(sf::Vector2f start, sf::Vector2f end, float t)
 {
 	return start + (end - start) * t;
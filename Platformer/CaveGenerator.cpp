@@ -0,0 +1,535 @@
+#include "AstroidsPrivate.h"
+#include "CaveGenerator.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Rows per smoothing or run extraction job
+    const int skBandHeight = 64;
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    int CountTrailingZeros(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return int(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // splitmix64, every row gets its own stream so the fill does not depend on how rows are split between workers
+    uint64_t NextRandom(uint64_t & state)
+    {
+        uint64_t value = (state += 0x9E3779B97F4A7C15ull);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    int FindRoot(std::vector<int> & parents, int node)
+    {
+        while (node != parents[node])
+        {
+            parents[node] = parents[parents[node]];
+            node = parents[node];
+        }
+        return node;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // Cells whose 4 bit count, held as bit slices, is at least limit
+    uint64_t GreaterOrEqual(const uint64_t (&count)[4], int limit)
+    {
+        if (limit <= 0)
+        {
+            return ~uint64_t(0);
+        }
+        if (limit > 15)
+        {
+            return 0;
+        }
+
+        // Most significant bit first: greater as soon as a count bit is set where the limit's is clear, while all the
+        // bits above were equal
+        uint64_t greater = 0;
+        uint64_t equal = ~uint64_t(0);
+        for (int bit = 3; bit >= 0; --bit)
+        {
+            if ((limit >> bit) & 1)
+            {
+                equal &= count[bit];
+            }
+            else
+            {
+                greater |= equal & count[bit];
+                equal &= ~count[bit];
+            }
+        }
+        return greater | equal;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+CaveGenerator::CaveGenerator(JobSystem * pJobSystem)
+    : mpJobSystem(pJobSystem)
+    , mRock()
+    , mCurrent(0)
+    , mStartX(-1)
+    , mStartY(-1)
+    , mStats()
+    , mBandRuns()
+    , mRuns()
+    , mRowFirstRun()
+    , mParents()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CaveGenerator::Generate(const CaveSettings & settings)
+{
+    mStats = CaveStats();
+    mCurrent = 0;
+    mStartX = -1;
+    mStartY = -1;
+    mRock[0].Resize(settings.mWidth, settings.mHeight);
+    mRock[1].Resize(settings.mWidth, settings.mHeight);
+    if (settings.mWidth <= 0 || settings.mHeight <= 0)
+    {
+        return;
+    }
+
+    StopWatch stopWatch;
+    FillRandom(settings);
+    mStats.mFillMilliseconds = stopWatch.GetElapsedMilliseconds();
+
+    stopWatch.Reset();
+    for (int step = 0; step < settings.mSmoothSteps; ++step)
+    {
+        ForEachBand(settings.mHeight, [this, &settings](int begin, int end) { SmoothRows(settings, begin, end); });
+        mCurrent = 1 - mCurrent;
+    }
+    mStats.mSmoothMilliseconds = stopWatch.GetElapsedMilliseconds();
+
+    // Sealed edges, so nothing walks off the level
+    SetRowRange(0, 0, settings.mWidth, true);
+    SetRowRange(settings.mHeight - 1, 0, settings.mWidth, true);
+    for (int y = 1; y < settings.mHeight - 1; ++y)
+    {
+        SetRowRange(y, 0, 1, true);
+        SetRowRange(y, settings.mWidth - 1, settings.mWidth, true);
+    }
+
+    stopWatch.Reset();
+    ConnectRegions(settings);
+    mStats.mRegionMilliseconds = stopWatch.GetElapsedMilliseconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CaveGenerator::FillRandom(const CaveSettings & settings)
+{
+    // Each bit of the fill chance, lowest first, either ORs or ANDs in a fresh random word. After all eight a bit is
+    // set with exactly that chance, for eight random words per 64 cells.
+    int threshold = std::clamp(int(settings.mFillChance * 256.f + 0.5f), 0, 256);
+    BitGrid & rock = mRock[mCurrent];
+    int wordsPerRow = rock.GetWordsPerRow();
+    int tailBits = settings.mWidth & 63;
+    uint64_t lastMask = tailBits ? (uint64_t(1) << tailBits) - 1 : ~uint64_t(0);
+
+    ForEachBand(settings.mHeight, [&](int begin, int end)
+        {
+            for (int y = begin; y < end; ++y)
+            {
+                uint64_t state = (uint64_t(settings.mSeed) << 32) ^ (uint64_t(y) * 0xD1B54A32D192ED03ull);
+                uint64_t * pRow = rock.GetMutableRowWords(y);
+                for (int word = 0; word < wordsPerRow; ++word)
+                {
+                    uint64_t value = threshold == 256 ? ~uint64_t(0) : 0;
+                    for (int bit = 0; bit < 8 && threshold < 256; ++bit)
+                    {
+                        uint64_t random = NextRandom(state);
+                        value = ((threshold >> bit) & 1) ? (value | random) : (value & random);
+                    }
+                    pRow[word] = value;
+                }
+                pRow[wordsPerRow - 1] &= lastMask;
+            }
+        });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CaveGenerator::SmoothRows(const CaveSettings & settings, int begin, int end)
+{
+    const BitGrid & source = mRock[mCurrent];
+    BitGrid & target = mRock[1 - mCurrent];
+    int wordsPerRow = source.GetWordsPerRow();
+    int tailBits = settings.mWidth & 63;
+    uint64_t lastMask = tailBits ? (uint64_t(1) << tailBits) - 1 : ~uint64_t(0);
+
+    // Rows are copied with a word of rock on either side and the padding bits set, everything off the grid counts
+    // as rock so caves pull away from the edges. The inner loop then reads neighbors without any edge checks.
+    int paddedWords = wordsPerRow + 2;
+    std::vector<uint64_t> paddedRows(size_t(paddedWords) * 3, ~uint64_t(0));
+    auto loadRow = [&](int y, uint64_t * pPadded)
+        {
+            if (y < 0 || y >= settings.mHeight)
+            {
+                std::fill(pPadded, pPadded + paddedWords, ~uint64_t(0));
+                return;
+            }
+            const uint64_t * pRow = source.GetRowWords(y);
+            std::copy(pRow, pRow + wordsPerRow, pPadded + 1);
+            pPadded[wordsPerRow] |= ~lastMask;
+        };
+
+    uint64_t * pAbove = paddedRows.data();
+    uint64_t * pCenter = pAbove + paddedWords;
+    uint64_t * pBelow = pCenter + paddedWords;
+    loadRow(begin - 1, pAbove);
+    loadRow(begin, pCenter);
+
+    for (int y = begin; y < end; ++y)
+    {
+        loadRow(y + 1, pBelow);
+        uint64_t * pTarget = target.GetMutableRowWords(y);
+        const uint64_t * pRows[3] = { pAbove, pCenter, pBelow };
+
+        for (int word = 0; word < wordsPerRow; ++word)
+        {
+            // Bit planes of the eight neighbors: shifting a row up by one puts each cell's left neighbor on it
+            uint64_t planes[8];
+            int planeCount = 0;
+            uint64_t center = pCenter[word + 1];
+            for (int row = 0; row < 3; ++row)
+            {
+                const uint64_t * pWords = pRows[row] + word;
+                planes[planeCount++] = (pWords[1] << 1) | (pWords[0] >> 63);
+                planes[planeCount++] = (pWords[1] >> 1) | (pWords[2] << 63);
+                if (row != 1)
+                {
+                    planes[planeCount++] = pWords[1];
+                }
+            }
+
+            // Full adder tree, eight one bit inputs to a four bit count
+            auto fullAdd = [](uint64_t a, uint64_t b, uint64_t c, uint64_t & carry)
+                {
+                    uint64_t partial = a ^ b;
+                    carry = (a & b) | (partial & c);
+                    return partial ^ c;
+                };
+
+            uint64_t carryA;
+            uint64_t carryB;
+            uint64_t sumA = fullAdd(planes[0], planes[1], planes[2], carryA);
+            uint64_t sumB = fullAdd(planes[3], planes[4], planes[5], carryB);
+            uint64_t sumC = planes[6] ^ planes[7];
+            uint64_t carryC = planes[6] & planes[7];
+
+            uint64_t carryOnes;
+            uint64_t ones = fullAdd(sumA, sumB, sumC, carryOnes);
+
+            uint64_t carryTwos;
+            uint64_t partialTwos = fullAdd(carryA, carryB, carryC, carryTwos);
+            uint64_t twos = partialTwos ^ carryOnes;
+            uint64_t carryFours = partialTwos & carryOnes;
+
+            const uint64_t count[4] = { ones, twos, carryTwos ^ carryFours, carryTwos & carryFours };
+            uint64_t rock = (center & GreaterOrEqual(count, settings.mSurviveLimit)) |
+                (~center & GreaterOrEqual(count, settings.mBirthLimit));
+            pTarget[word] = rock;
+        }
+        pTarget[wordsPerRow - 1] &= lastMask;
+
+        uint64_t * pOldAbove = pAbove;
+        pAbove = pCenter;
+        pCenter = pBelow;
+        pBelow = pOldAbove;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CaveGenerator::ConnectRegions(const CaveSettings & settings)
+{
+    const BitGrid & rock = mRock[mCurrent];
+    int width = settings.mWidth;
+    int height = settings.mHeight;
+    int wordsPerRow = rock.GetWordsPerRow();
+    int tailBits = width & 63;
+    uint64_t lastMask = tailBits ? (uint64_t(1) << tailBits) - 1 : ~uint64_t(0);
+
+    // First cell from x on that is open (or rock), width when there is none
+    auto findNext = [width, wordsPerRow, lastMask](const uint64_t * pRow, int x, bool isOpen)
+        {
+            if (x >= width)
+            {
+                return width;
+            }
+            int word = x >> 6;
+            uint64_t bits = (isOpen ? ~pRow[word] : pRow[word]) & (~uint64_t(0) << (x & 63));
+            while (true)
+            {
+                if (word == wordsPerRow - 1)
+                {
+                    bits &= lastMask;
+                }
+                if (bits)
+                {
+                    return std::min(width, word * 64 + CountTrailingZeros(bits));
+                }
+                if (++word >= wordsPerRow)
+                {
+                    return width;
+                }
+                bits = isOpen ? ~pRow[word] : pRow[word];
+            }
+        };
+
+    // Runs of open cells, row by row
+    int bandCount = (height + skBandHeight - 1) / skBandHeight;
+    mBandRuns.resize(bandCount);
+    ForEachBand(height, [&](int begin, int end)
+        {
+            std::vector<Run> & runs = mBandRuns[begin / skBandHeight];
+            runs.clear();
+            for (int y = begin; y < end; ++y)
+            {
+                const uint64_t * pRow = rock.GetRowWords(y);
+                for (int x = findNext(pRow, 0, true); x < width; )
+                {
+                    int runEnd = findNext(pRow, x, false);
+                    runs.push_back({ y, x, runEnd });
+                    x = findNext(pRow, runEnd, true);
+                }
+            }
+        });
+
+    mRuns.clear();
+    for (const auto & runs : mBandRuns)
+    {
+        mRuns.insert(mRuns.end(), runs.begin(), runs.end());
+    }
+    int runCount = int(mRuns.size());
+    mRowFirstRun.assign(height + 1, 0);
+    for (const Run & run : mRuns)
+    {
+        ++mRowFirstRun[run.mY + 1];
+    }
+    std::partial_sum(mRowFirstRun.begin(), mRowFirstRun.end(), mRowFirstRun.begin());
+
+    // Runs on neighboring rows that overlap share a region. Both rows are sorted, so one merge-like walk per row pair
+    // finds every overlap.
+    mParents.resize(runCount);
+    std::iota(mParents.begin(), mParents.end(), 0);
+    auto joinRows = [this](int y)
+        {
+            int above = mRowFirstRun[y - 1];
+            int aboveEnd = mRowFirstRun[y];
+            int below = mRowFirstRun[y];
+            int belowEnd = mRowFirstRun[y + 1];
+            while (above < aboveEnd && below < belowEnd)
+            {
+                const Run & aboveRun = mRuns[above];
+                const Run & belowRun = mRuns[below];
+                if (aboveRun.mBegin < belowRun.mEnd && belowRun.mBegin < aboveRun.mEnd)
+                {
+                    int rootA = FindRoot(mParents, above);
+                    int rootB = FindRoot(mParents, below);
+                    if (rootA != rootB)
+                    {
+                        // Lower index wins, so the roots do not depend on the order of the unions
+                        mParents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+                    }
+                }
+                if (aboveRun.mEnd < belowRun.mEnd)
+                {
+                    ++above;
+                }
+                else
+                {
+                    ++below;
+                }
+            }
+        };
+
+    // Rows inside a band only ever join runs of that band, so bands are joined in parallel and the rows where two
+    // bands meet afterwards
+    ForEachBand(height, [&joinRows](int begin, int end)
+        {
+            for (int y = begin + 1; y < end; ++y)
+            {
+                joinRows(y);
+            }
+        });
+    for (int y = skBandHeight; y < height; y += skBandHeight)
+    {
+        joinRows(y);
+    }
+
+    // A region's root is its topmost run, which doubles as the point tunnels start from
+    std::vector<int> regionSizes(runCount, 0);
+    for (int run = 0; run < runCount; ++run)
+    {
+        mParents[run] = FindRoot(mParents, run);
+        regionSizes[mParents[run]] += mRuns[run].mEnd - mRuns[run].mBegin;
+    }
+
+    std::vector<int> regions;
+    for (int run = 0; run < runCount; ++run)
+    {
+        if (mParents[run] == run)
+        {
+            regions.push_back(run);
+        }
+    }
+    mStats.mRegionCount = int(regions.size());
+    if (regions.empty())
+    {
+        return;
+    }
+
+    std::stable_sort(regions.begin(), regions.end(),
+        [&regionSizes](int lhs, int rhs) { return regionSizes[lhs] > regionSizes[rhs]; });
+
+    // The largest region always stays, even when it is under the minimum
+    std::vector<uint8_t> isFilled(runCount, 0);
+    for (size_t region = 1; region < regions.size(); ++region)
+    {
+        if (regionSizes[regions[region]] < settings.mMinRegionSize)
+        {
+            isFilled[regions[region]] = 1;
+            ++mStats.mFilledRegionCount;
+        }
+    }
+    for (int run = 0; run < runCount; ++run)
+    {
+        if (isFilled[mParents[run]])
+        {
+            SetRowRange(mRuns[run].mY, mRuns[run].mBegin, mRuns[run].mEnd, true);
+        }
+    }
+
+    auto getAnchor = [this](int root)
+        {
+            const Run & run = mRuns[root];
+            return std::make_pair((run.mBegin + run.mEnd - 1) / 2, run.mY);
+        };
+
+    std::pair<int, int> start = getAnchor(regions[0]);
+    mStartX = start.first;
+    mStartY = start.second;
+
+    // Largest first, each region tunnels to the nearest one already joined to the largest
+    std::vector<std::pair<int, int>> connected = { start };
+    for (size_t region = 1; region < regions.size(); ++region)
+    {
+        if (isFilled[regions[region]])
+        {
+            continue;
+        }
+
+        std::pair<int, int> anchor = getAnchor(regions[region]);
+        size_t nearest = 0;
+        int64_t nearestDistance = INT64_MAX;
+        for (size_t other = 0; other < connected.size(); ++other)
+        {
+            int64_t dx = connected[other].first - anchor.first;
+            int64_t dy = connected[other].second - anchor.second;
+            int64_t distance = dx * dx + dy * dy;
+            if (distance < nearestDistance)
+            {
+                nearestDistance = distance;
+                nearest = other;
+            }
+        }
+
+        CarveTunnel(anchor.first, anchor.second, connected[nearest].first, connected[nearest].second, settings.mTunnelWidth);
+        connected.push_back(anchor);
+        ++mStats.mTunnelCount;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CaveGenerator::CarveTunnel(int fromX, int fromY, int toX, int toY, int width)
+{
+    // Along fromY to toX, then along toX to toY, kept off the sealed edges
+    BitGrid & rock = mRock[mCurrent];
+    int minX = 1;
+    int maxX = rock.GetWidth() - 1;
+    int maxY = rock.GetHeight() - 1;
+    width = std::max(1, width);
+
+    for (int y = fromY; y < fromY + width && y < maxY; ++y)
+    {
+        SetRowRange(y, std::max(minX, std::min(fromX, toX)), std::min(maxX, std::max(fromX, toX) + width), false);
+    }
+    for (int y = std::max(1, std::min(fromY, toY)); y <= std::max(fromY, toY) && y < maxY; ++y)
+    {
+        SetRowRange(y, std::max(minX, toX), std::min(maxX, toX + width), false);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CaveGenerator::SetRowRange(int y, int begin, int end, bool isRock)
+{
+    BitGrid & rock = mRock[mCurrent];
+    begin = std::max(begin, 0);
+    end = std::min(end, rock.GetWidth());
+    uint64_t * pRow = rock.GetMutableRowWords(y);
+    while (begin < end)
+    {
+        int bit = begin & 63;
+        int count = std::min(end - begin, 64 - bit);
+        uint64_t mask = (count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1) << bit;
+        uint64_t & word = pRow[begin >> 6];
+        word = isRock ? (word | mask) : (word & ~mask);
+        begin += count;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CaveGenerator::ForEachBand(int rowCount, const std::function<void(int begin, int end)> & func)
+{
+    int bandCount = (rowCount + skBandHeight - 1) / skBandHeight;
+    auto runBands = [rowCount, &func](int begin, int end)
+        {
+            for (int band = begin; band < end; ++band)
+            {
+                func(band * skBandHeight, std::min(rowCount, (band + 1) * skBandHeight));
+            }
+        };
+
+    if (mpJobSystem)
+    {
+        mpJobSystem->ParallelFor(bandCount, 1, runBands);
+    }
+    else
+    {
+        runBands(0, bandCount);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BitGrid.h"
+
+class JobSystem;
+
+struct CaveSettings
+{
+    uint32_t mSeed = 1;
+    int mWidth = 256;
+    int mHeight = 256;
+    float mFillChance = 0.45f;      // Share of cells that start as rock, in steps of 1/256
+    int mSmoothSteps = 5;
+    int mBirthLimit = 5;            // Rock neighbors that turn an open cell to rock
+    int mSurviveLimit = 4;          // Rock neighbors a rock cell needs to stay rock
+    int mMinRegionSize = 64;        // Open regions smaller than this are filled in, the rest are tunneled together
+    int mTunnelWidth = 2;
+};
+
+struct CaveStats
+{
+    float mFillMilliseconds = 0.f;
+    float mSmoothMilliseconds = 0.f;
+    float mRegionMilliseconds = 0.f;
+    int mRegionCount = 0;           // Open regions before small ones were filled and the rest joined
+    int mFilledRegionCount = 0;
+    int mTunnelCount = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// CaveGenerator
+//
+// Cellular automata caves on bit-packed rows, the same settings always give the same cave. Rows start from seeded
+// random words, then each smoothing step counts all eight neighbors of 64 cells at once: the neighbor rows are shifted
+// into eight bit planes and summed with a tree of word-wide full adders into a 4 bit count per cell, and the birth and
+// survive rules are a compare on those bit slices. Steps ping-pong between two grids and rows are split into bands on
+// the JobSystem. The open cells are then cut into horizontal runs, runs that touch across rows are merged with
+// union-find, small regions are filled and every other region is tunneled to its nearest already connected one.
+//------------------------------------------------------------------------------------------------------------------------
+
+class CaveGenerator
+{
+public:
+    // pJobSystem may be null to run on the calling thread
+    explicit CaveGenerator(JobSystem * pJobSystem);
+
+    void Generate(const CaveSettings & settings);
+
+    // Set cells are rock
+    const BitGrid & GetRock() const { return mRock[mCurrent]; }
+
+    // An open cell in the largest region, (-1, -1) when the cave is solid rock
+    int GetStartX() const { return mStartX; }
+    int GetStartY() const { return mStartY; }
+
+    const CaveStats & GetStats() const { return mStats; }
+
+private:
+    struct Run
+    {
+        int mY;
+        int mBegin;     // First open cell
+        int mEnd;       // One past the last
+    };
+
+    void FillRandom(const CaveSettings & settings);
+    void SmoothRows(const CaveSettings & settings, int begin, int end);
+    void ConnectRegions(const CaveSettings & settings);
+    void CarveTunnel(int fromX, int fromY, int toX, int toY, int width);
+    void SetRowRange(int y, int begin, int end, bool isRock);
+    void ForEachBand(int rowCount, const std::function<void(int begin, int end)> & func);
+
+    JobSystem * mpJobSystem;
+    BitGrid mRock[2];
+    int mCurrent;
+    int mStartX;
+    int mStartY;
+    CaveStats mStats;
+
+    // Region pass scratch, kept so regenerating does not reallocate
+    std::vector<std::vector<Run>> mBandRuns;
+    std::vector<Run> mRuns;
+    std::vector<int> mRowFirstRun;
+    std::vector<int> mParents;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,672 @@
+#include "AstroidsPrivate.h"
+#include "ChunkStreamer.h"
+#include "DungeonManager.h"
+#include "LevelManager.h"
+#include "LevelCook.h"
+#include "PlayerManager.h"
+#include "ResourceManager.h"
+#include "ControlledMovementComponent.h"
+#include "NavigationManager.h"
+#include "PathfindingService.h"
+#include "VisibilityService.h"
+#include "BDConfig.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <imgui.h>
+
+namespace
+{
+    // One 64 bit word per chunk row, so a chunk's nav bits drop straight into the level's layers
+    const int skChunkSize = 64;
+
+    // 2048 x 2048 tiles. The nav, visibility and crowd systems all index one contiguous tile grid, so the world has an
+    // edge; it is just far enough away not to matter in a run.
+    const int skWorldChunkCount = 32;
+
+    const size_t skDefaultMemoryBudget = 32 * 1024 * 1024;
+    const int skDefaultIntegrationsPerFrame = 2;
+    const int skDefaultDebugSeed = 1;
+
+    // Builds queued at once, so a burst of prefetches cannot starve the rest of the JobSystem
+    const int skMaxJobsInFlight = 8;
+
+    // Where the player will be after this many seconds at their current velocity is fetched ahead of time
+    const float skPrefetchSeconds[] = { 0.5f, 1.f, 1.5f };
+
+    const int skPieceCount = 4;
+
+    int FloorDiv(float value, float divisor)
+    {
+        return int(std::floor(value / divisor));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+size_t ChunkStreamer::ChunkData::GetMemorySize() const
+{
+    return sizeof(ChunkData) + mLayerRows.capacity() * sizeof(uint64_t) + mVertices.getVertexCount() * sizeof(sf::Vertex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ChunkStreamer::ChunkStreamer(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mIsStreaming(false)
+    , mWorld()
+    , mpTilesetTexture()
+    , mChunks()
+    , mFrame(0)
+    , mResidentBytes(0)
+    , mMemoryBudget(skDefaultMemoryBudget)
+    , mMaxIntegrationsPerFrame(skDefaultIntegrationsPerFrame)
+    , mReadyMutex()
+    , mReadyChunks()
+    , mJobsInFlight(0)
+    , mDebugSeed(skDefaultDebugSeed)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ChunkStreamer::~ChunkStreamer()
+{
+    // Jobs hold a pointer to this
+    WaitForJobs();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Update(float deltaTime)
+{
+    if (!mIsStreaming)
+    {
+        return;
+    }
+    ++mFrame;
+
+    auto & gameManager = GetGameManager();
+    auto * pPlayerManager = gameManager.GetManager<PlayerManager>();
+    GameObject * pPlayer = pPlayerManager && !pPlayerManager->GetPlayers().empty() ?
+        gameManager.GetGameObject(pPlayerManager->GetPlayers()[0]) : nullptr;
+    if (pPlayer)
+    {
+        float chunkPixelSize = skChunkSize * mWorld.mTileSize;
+        sf::Vector2f position = pPlayer->GetPosition();
+
+        // Around the player first, then around where they are heading
+        sf::Vector2i playerChunk(FloorDiv(position.x, chunkPixelSize), FloorDiv(position.y, chunkPixelSize));
+        RequestChunk(playerChunk);
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                RequestChunk(playerChunk + sf::Vector2i(dx, dy));
+            }
+        }
+
+        auto pMovementComponent = pPlayer->GetComponent<ControlledMovementComponent>().lock();
+        sf::Vector2f velocity = pMovementComponent ? pMovementComponent->GetVelocity() : sf::Vector2f();
+        if (velocity.x != 0.f || velocity.y != 0.f)
+        {
+            for (float seconds : skPrefetchSeconds)
+            {
+                sf::Vector2f ahead = position + velocity * seconds;
+                sf::Vector2i aheadChunk(FloorDiv(ahead.x, chunkPixelSize), FloorDiv(ahead.y, chunkPixelSize));
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        RequestChunk(aheadChunk + sf::Vector2i(dx, dy));
+                    }
+                }
+            }
+        }
+    }
+
+    IntegrateReadyChunks();
+    EvictOverBudget();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Render(sf::RenderWindow & window)
+{
+    if (!mIsStreaming || !mpTilesetTexture)
+    {
+        return;
+    }
+
+    const sf::View & view = window.getView();
+    sf::FloatRect viewBounds(view.getCenter() - view.getSize() * 0.5f, view.getSize());
+    float chunkPixelSize = skChunkSize * mWorld.mTileSize;
+
+    sf::RenderStates states(mpTilesetTexture.get());
+    for (const auto & entry : mChunks)
+    {
+        const Chunk & chunk = entry.second;
+        if (chunk.mState != EChunkState::Resident)
+        {
+            continue;
+        }
+
+        sf::FloatRect chunkBounds(chunk.mpData->mCoord.x * chunkPixelSize, chunk.mpData->mCoord.y * chunkPixelSize,
+            chunkPixelSize, chunkPixelSize);
+        if (viewBounds.intersects(chunkBounds))
+        {
+            window.draw(chunk.mpData->mVertices, states);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::OnGameEnd()
+{
+    // The next game starts back on the first level, see GameManager::Reset
+    DropWorld();
+    mDebugSeed = skDefaultDebugSeed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool ChunkStreamer::StartWorld(uint32_t seed)
+{
+    auto & gameManager = GetGameManager();
+    auto * pLevelManager = gameManager.GetManager<LevelManager>();
+    if (!pLevelManager)
+    {
+        return false;
+    }
+
+    DropWorld();
+
+    ++mWorld.mWorldId;
+    mWorld.mSeed = seed;
+    mWorld.mChunkCountX = skWorldChunkCount;
+    mWorld.mChunkCountY = skWorldChunkCount;
+    if (!LoadPieceTiles())
+    {
+        return false;
+    }
+
+    int tileSize = int(mWorld.mTileSize);
+    pLevelManager->CreateStreamedLevel(skWorldChunkCount * skChunkSize, skWorldChunkCount * skChunkSize, tileSize, tileSize);
+    mIsStreaming = true;
+
+    // The center chunk is built right here so the players have somewhere to stand on the first frame
+    sf::Vector2i centerChunk(skWorldChunkCount / 2, skWorldChunkCount / 2);
+    std::unique_ptr<ChunkData> pCenterData = BuildChunk(mWorld, centerChunk);
+    sf::Vector2i spawnTile = pCenterData->mSpawnTile;
+    mChunks[GetChunkKey(centerChunk)].mLastWantedFrame = mFrame;
+    Integrate(std::move(pCenterData));
+
+    if (auto * pPlayerManager = gameManager.GetManager<PlayerManager>())
+    {
+        sf::Vector2f spawnPosition((spawnTile.x + 0.5f) * mWorld.mTileSize, (spawnTile.y + 0.5f) * mWorld.mTileSize);
+        for (BD::Handle playerHandle : pPlayerManager->GetPlayers())
+        {
+            if (GameObject * pPlayer = gameManager.GetGameObject(playerHandle))
+            {
+                pPlayer->SetPosition(spawnPosition);
+            }
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::SetMemoryBudget(size_t bytes)
+{
+    mMemoryBudget = bytes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::SetMaxIntegrationsPerFrame(int count)
+{
+    mMaxIntegrationsPerFrame = std::max(1, count);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int ChunkStreamer::GetResidentChunkCount() const
+{
+    return int(std::count_if(mChunks.begin(), mChunks.end(),
+        [](const auto & entry) { return entry.second.mState == EChunkState::Resident; }));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int ChunkStreamer::GetChunkSize()
+{
+    return skChunkSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Chunk Streaming");
+
+    ImGui::InputInt("Seed", &mDebugSeed);
+    if (ImGui::Button("Start Streamed World"))
+    {
+        StartWorld(uint32_t(mDebugSeed));
+    }
+
+    if (mIsStreaming)
+    {
+        int budgetMegabytes = int(mMemoryBudget / (1024 * 1024));
+        if (ImGui::SliderInt("Budget (MB)", &budgetMegabytes, 4, 256))
+        {
+            SetMemoryBudget(size_t(budgetMegabytes) * 1024 * 1024);
+        }
+        ImGui::SliderInt("Integrations / frame", &mMaxIntegrationsPerFrame, 1, 16);
+        ImGui::Text("Resident: %d chunks, %.1f MB", GetResidentChunkCount(), mResidentBytes / (1024.f * 1024.f));
+        ImGui::Text("Known: %d  Building: %d", int(mChunks.size()), mJobsInFlight.load());
+    }
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+std::unique_ptr<ChunkStreamer::ChunkData> ChunkStreamer::BuildChunk(const WorldDesc & world, const sf::Vector2i & coord)
+{
+    DungeonSettings settings;
+    settings.mSeed = HashChunkEdge(world.mSeed, coord.x, coord.y, 2);
+    settings.mRoomCount = 8;
+    settings.mWidth = skChunkSize;
+    settings.mHeight = skChunkSize;
+    settings.mRoomMinSize = 5;
+    settings.mRoomMaxSize = 12;
+    settings.mRoomSpacing = 2;
+
+    // Already on a worker, carve inline
+    DungeonGenerator generator(nullptr);
+    generator.Generate(settings);
+
+    const std::vector<Room> & rooms = generator.GetRooms();
+    auto nearestRoomCenter = [&rooms](int x, int y)
+        {
+            sf::Vector2i best(skChunkSize / 2, skChunkSize / 2);
+            int bestDistance = INT_MAX;
+            for (const Room & room : rooms)
+            {
+                int distance = std::abs(room.centerX - x) + std::abs(room.centerY - y);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = sf::Vector2i(room.centerX, room.centerY);
+                }
+            }
+            return best;
+        };
+
+    // Doorways sit away from the corners, both chunks on an edge hash it the same way and carve to the same row or
+    // column, so the two corridors meet across the seam
+    auto doorOffset = [&world](int x, int y, int axis)
+        {
+            return 2 + int(HashChunkEdge(world.mSeed, x, y, axis) % uint32_t(skChunkSize - 4));
+        };
+
+    const int last = skChunkSize - 1;
+    if (coord.x > 0)
+    {
+        int door = doorOffset(coord.x - 1, coord.y, 0);
+        sf::Vector2i center = nearestRoomCenter(0, door);
+        generator.CarveCorridor(0, door, center.x, center.y);
+    }
+    if (coord.x + 1 < world.mChunkCountX)
+    {
+        int door = doorOffset(coord.x, coord.y, 0);
+        sf::Vector2i center = nearestRoomCenter(last, door);
+        generator.CarveCorridor(last, door, center.x, center.y);
+    }
+    if (coord.y > 0)
+    {
+        int door = doorOffset(coord.x, coord.y - 1, 1);
+        sf::Vector2i center = nearestRoomCenter(door, 0);
+        generator.CarveCorridor(center.x, center.y, door, 0);
+    }
+    if (coord.y + 1 < world.mChunkCountY)
+    {
+        int door = doorOffset(coord.x, coord.y, 1);
+        sf::Vector2i center = nearestRoomCenter(door, last);
+        generator.CarveCorridor(center.x, center.y, door, last);
+    }
+
+    auto pData = std::make_unique<ChunkData>();
+    pData->mWorldId = world.mWorldId;
+    pData->mCoord = coord;
+    sf::Vector2i origin(coord.x * skChunkSize, coord.y * skChunkSize);
+    pData->mSpawnTile = origin + (rooms.empty() ? sf::Vector2i(skChunkSize / 2, skChunkSize / 2) :
+        sf::Vector2i(rooms[0].centerX, rooms[0].centerY));
+
+    pData->mLayerRows.assign(size_t(LevelFormat::BitsetCount) * skChunkSize, 0);
+    pData->mVertices.setPrimitiveType(sf::Triangles);
+    pData->mVertices.resize(size_t(skChunkSize) * skChunkSize * 6);
+
+    const Grid2D<EDungeonPiece> & grid = generator.GetGrid();
+    float tileSize = world.mTileSize;
+    size_t vertex = 0;
+    for (int y = 0; y < skChunkSize; ++y)
+    {
+        for (int x = 0; x < skChunkSize; ++x)
+        {
+            const PieceTile & tile = world.mPieces[int(grid(x, y))];
+            for (int bitset = 0; bitset < LevelFormat::BitsetCount; ++bitset)
+            {
+                if (tile.mLayerBits[bitset])
+                {
+                    pData->mLayerRows[bitset * skChunkSize + y] |= uint64_t(1) << x;
+                }
+            }
+
+            float left = (origin.x + x) * tileSize;
+            float top = (origin.y + y) * tileSize;
+            sf::Vertex corners[4] =
+            {
+                sf::Vertex(sf::Vector2f(left, top), tile.mTexCoord),
+                sf::Vertex(sf::Vector2f(left + tileSize, top), tile.mTexCoord + sf::Vector2f(tileSize, 0.f)),
+                sf::Vertex(sf::Vector2f(left + tileSize, top + tileSize), tile.mTexCoord + sf::Vector2f(tileSize, tileSize)),
+                sf::Vertex(sf::Vector2f(left, top + tileSize), tile.mTexCoord + sf::Vector2f(0.f, tileSize))
+            };
+            pData->mVertices[vertex++] = corners[0];
+            pData->mVertices[vertex++] = corners[1];
+            pData->mVertices[vertex++] = corners[2];
+            pData->mVertices[vertex++] = corners[0];
+            pData->mVertices[vertex++] = corners[2];
+            pData->mVertices[vertex++] = corners[3];
+        }
+    }
+    return pData;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint32_t ChunkStreamer::HashChunkEdge(uint32_t seed, int x, int y, int axis)
+{
+    // Murmur style finalizer over the packed inputs
+    uint32_t hash = seed ^ (uint32_t(x) * 0x8DA6B343u) ^ (uint32_t(y) * 0xD8163841u) ^ (uint32_t(axis) * 0xCB1AB31Fu);
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool ChunkStreamer::LoadPieceTiles()
+{
+    // Cooking one tile of each piece reads the tileset the same way the level cooker does, so the pieces get the
+    // tileset's own walkable, solid and opaque properties
+    std::vector<uint32_t> palette(skPieceCount);
+    for (int piece = 0; piece < skPieceCount; ++piece)
+    {
+        palette[piece] = DungeonManager::GetPieceGid(EDungeonPiece(piece));
+    }
+
+    std::vector<uint8_t> cookedBytes;
+    std::string error;
+    if (!CookTileGrid(DungeonManager::GetTilesetPath(), uint32_t(skPieceCount), 1, palette, LevelCookOptions(), cookedBytes,
+        error))
+    {
+        std::cerr << error << std::endl;
+        return false;
+    }
+
+    const LevelFormat::Header * pHeader = LevelFormat::Validate(cookedBytes.data(), cookedBytes.size());
+    if (!pHeader || pHeader->mTilesetCount != 1)
+    {
+        return false;
+    }
+
+    const auto * pTileset = LevelFormat::GetSection<LevelFormat::TilesetDesc>(pHeader, pHeader->mTilesetsOffset);
+    const auto * pAtlas = LevelFormat::GetSection<LevelFormat::AtlasEntry>(pHeader, pHeader->mAtlasOffset);
+    mWorld.mTileSize = float(pTileset->mTileWidth);
+
+    for (int piece = 0; piece < skPieceCount; ++piece)
+    {
+        PieceTile & tile = mWorld.mPieces[piece];
+        tile.mGid = palette[piece];
+        const LevelFormat::AtlasEntry & entry = pAtlas[tile.mGid < pHeader->mAtlasEntryCount ? tile.mGid : 0];
+        tile.mTexCoord = sf::Vector2f(float(entry.mU), float(entry.mV));
+        for (int bitset = 0; bitset < LevelFormat::BitsetCount; ++bitset)
+        {
+            const uint64_t * pBits = LevelFormat::GetSection<uint64_t>(pHeader, pHeader->mBitsetOffsets[bitset]);
+            tile.mLayerBits[bitset] = ((pBits[0] >> piece) & 1) != 0;
+        }
+    }
+
+    std::string imagePath(pTileset->mImagePath);
+    ResourceId resourceId(imagePath);
+    mpTilesetTexture = imagePath.empty() ? nullptr : GetGameManager().GetManager<ResourceManager>()->GetTexture(resourceId);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint32_t ChunkStreamer::GetChunkKey(const sf::Vector2i & coord) const
+{
+    return uint32_t(coord.y * mWorld.mChunkCountX + coord.x);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool ChunkStreamer::IsChunkInWorld(const sf::Vector2i & coord) const
+{
+    return coord.x >= 0 && coord.y >= 0 && coord.x < mWorld.mChunkCountX && coord.y < mWorld.mChunkCountY;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::RequestChunk(const sf::Vector2i & coord)
+{
+    if (!IsChunkInWorld(coord))
+    {
+        return;
+    }
+
+    uint32_t key = GetChunkKey(coord);
+    auto it = mChunks.find(key);
+    if (it != mChunks.end())
+    {
+        it->second.mLastWantedFrame = mFrame;
+        if (it->second.mState != EChunkState::Evicted)
+        {
+            return;
+        }
+    }
+
+    // Asked again next frame if the workers are busy
+    if (mJobsInFlight.load() >= skMaxJobsInFlight)
+    {
+        return;
+    }
+
+    Chunk & chunk = mChunks[key];
+    chunk.mState = EChunkState::Building;
+    chunk.mLastWantedFrame = mFrame;
+
+    ++mJobsInFlight;
+    WorldDesc world = mWorld;
+    GetGameManager().GetJobSystem().Submit([this, world, coord]()
+        {
+            std::unique_ptr<ChunkData> pData = BuildChunk(world, coord);
+            {
+                std::lock_guard<std::mutex> lock(mReadyMutex);
+                mReadyChunks.push_back(std::move(pData));
+            }
+            --mJobsInFlight;
+        });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::IntegrateReadyChunks()
+{
+    std::vector<std::unique_ptr<ChunkData>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mReadyMutex);
+        ready.swap(mReadyChunks);
+    }
+
+    // The most wanted go in first, the rest wait for the next frame
+    std::stable_sort(ready.begin(), ready.end(), [this](const auto & lhs, const auto & rhs)
+        {
+            auto lhsIt = mChunks.find(GetChunkKey(lhs->mCoord));
+            auto rhsIt = mChunks.find(GetChunkKey(rhs->mCoord));
+            uint64_t lhsFrame = lhsIt != mChunks.end() ? lhsIt->second.mLastWantedFrame : 0;
+            uint64_t rhsFrame = rhsIt != mChunks.end() ? rhsIt->second.mLastWantedFrame : 0;
+            return lhsFrame > rhsFrame;
+        });
+
+    int integrated = 0;
+    std::vector<std::unique_ptr<ChunkData>> deferred;
+    for (auto & pData : ready)
+    {
+        if (pData->mWorldId != mWorld.mWorldId)
+        {
+            continue;
+        }
+        if (integrated < mMaxIntegrationsPerFrame)
+        {
+            Integrate(std::move(pData));
+            ++integrated;
+        }
+        else
+        {
+            deferred.push_back(std::move(pData));
+        }
+    }
+
+    if (!deferred.empty())
+    {
+        std::lock_guard<std::mutex> lock(mReadyMutex);
+        for (auto & pData : deferred)
+        {
+            mReadyChunks.push_back(std::move(pData));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Integrate(std::unique_ptr<ChunkData> pData)
+{
+    auto it = mChunks.find(GetChunkKey(pData->mCoord));
+    if (it == mChunks.end())
+    {
+        return;
+    }
+    Chunk & chunk = it->second;
+
+    // Chunks regenerate identically, the bits only go in the first time and never come out again
+    if (!chunk.mHasNavData)
+    {
+        auto & gameManager = GetGameManager();
+        auto * pLevelManager = gameManager.GetManager<LevelManager>();
+
+        // A pathfinding slice reads these words in place on a worker, it has to finish before they change
+        if (auto * pPathfindingService = gameManager.GetManager<PathfindingService>())
+        {
+            pPathfindingService->WaitForSlice();
+        }
+        for (int bitset = 0; bitset < LevelFormat::BitsetCount; ++bitset)
+        {
+            BitGrid * pLayer = pLevelManager ? pLevelManager->GetStreamedLayer(LevelFormat::EBitset(bitset)) : nullptr;
+            if (!pLayer)
+            {
+                continue;
+            }
+            for (int y = 0; y < skChunkSize; ++y)
+            {
+                pLayer->GetMutableRowWords(pData->mCoord.y * skChunkSize + y)[pData->mCoord.x] =
+                    pData->mLayerRows[bitset * skChunkSize + y];
+            }
+        }
+        chunk.mHasNavData = true;
+
+        // One tile of margin, cells on the far side of the seam can now reach across it
+        sf::IntRect changedTiles(pData->mCoord.x * skChunkSize - 1, pData->mCoord.y * skChunkSize - 1, skChunkSize + 2,
+            skChunkSize + 2);
+        if (auto * pPathfindingService = gameManager.GetManager<PathfindingService>())
+        {
+            pPathfindingService->MarkTilesChanged(changedTiles);
+        }
+        if (auto * pNavigationManager = gameManager.GetManager<NavigationManager>())
+        {
+            pNavigationManager->MarkTilesChanged(changedTiles);
+        }
+        if (auto * pVisibilityService = gameManager.GetManager<VisibilityService>())
+        {
+            pVisibilityService->MarkTilesChanged(changedTiles);
+        }
+    }
+
+    mResidentBytes += pData->GetMemorySize();
+    chunk.mpData = std::move(pData);
+    chunk.mState = EChunkState::Resident;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::EvictOverBudget()
+{
+    while (mResidentBytes > mMemoryBudget)
+    {
+        // Least recently wanted first, never one that was wanted this frame
+        Chunk * pOldest = nullptr;
+        for (auto & entry : mChunks)
+        {
+            Chunk & chunk = entry.second;
+            if (chunk.mState == EChunkState::Resident && chunk.mLastWantedFrame != mFrame &&
+                (!pOldest || chunk.mLastWantedFrame < pOldest->mLastWantedFrame))
+            {
+                pOldest = &chunk;
+            }
+        }
+        if (!pOldest)
+        {
+            break;
+        }
+
+        mResidentBytes -= pOldest->mpData->GetMemorySize();
+        pOldest->mpData.reset();
+        pOldest->mState = EChunkState::Evicted;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::WaitForJobs()
+{
+    while (mJobsInFlight.load() > 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::DropWorld()
+{
+    WaitForJobs();
+    mReadyChunks.clear();
+    mChunks.clear();
+    mResidentBytes = 0;
+    mIsStreaming = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "BaseManager.h"
+#include "DungeonGenerator.h"
+#include "LevelFormat.h"
+
+// Streams a large generated world in square chunks around the player. Each chunk is a small dungeon of its own,
+// generated from the world seed and its coordinates on a JobSystem worker together with its render mesh and nav bits,
+// and handed to the main thread where at most a few are integrated per frame. Doorways on the edge between two chunks
+// come from a hash of that edge, so both sides carve to the same tile and the seam always connects. Chunks ahead of
+// the player's velocity are requested early, and meshes are evicted least recently wanted first once they go over the
+// memory budget. Nav bits stay in the LevelManager's layers after eviction, they are small and regenerate identically,
+// so enemies and paths off screen never see the world change under them.
+class ChunkStreamer : public BaseManager
+{
+public:
+    ChunkStreamer(GameManager * pGameManager);
+    ~ChunkStreamer();
+
+    virtual void Update(float deltaTime) override;
+    virtual void Render(sf::RenderWindow & window) override;
+    virtual void OnGameEnd() override;
+
+    // Replaces the current level with a streamed world and drops the players into the center chunk
+    bool StartWorld(uint32_t seed);
+    bool IsStreaming() const { return mIsStreaming; }
+
+    void SetMemoryBudget(size_t bytes);
+    void SetMaxIntegrationsPerFrame(int count);
+    int GetResidentChunkCount() const;
+    static int GetChunkSize();
+
+    void DebugImGuiInfo();
+
+private:
+    enum class EChunkState
+    {
+        Building,       // Queued or running on a worker
+        Resident,       // Mesh and tiles in memory
+        Evicted         // Nav bits are in the level, the mesh was dropped
+    };
+
+    // What each dungeon piece turns into, read once from the cooked tileset
+    struct PieceTile
+    {
+        uint32_t mGid;
+        sf::Vector2f mTexCoord;
+        bool mLayerBits[LevelFormat::BitsetCount];
+    };
+
+    // Everything a worker builds for one chunk
+    struct ChunkData
+    {
+        uint32_t mWorldId;
+        sf::Vector2i mCoord;
+        sf::Vector2i mSpawnTile;                // Center of the chunk's first room, in world tiles
+        std::vector<uint64_t> mLayerRows;       // One word per row per layer, chunks are exactly one word wide
+        sf::VertexArray mVertices;
+
+        size_t GetMemorySize() const;
+    };
+
+    struct Chunk
+    {
+        EChunkState mState = EChunkState::Building;
+        std::unique_ptr<ChunkData> mpData;
+        uint64_t mLastWantedFrame = 0;
+        bool mHasNavData = false;
+    };
+
+    struct WorldDesc
+    {
+        uint32_t mWorldId;
+        uint32_t mSeed;
+        int mChunkCountX;
+        int mChunkCountY;
+        float mTileSize;
+        PieceTile mPieces[4];
+    };
+
+    static std::unique_ptr<ChunkData> BuildChunk(const WorldDesc & world, const sf::Vector2i & coord);
+    static uint32_t HashChunkEdge(uint32_t seed, int x, int y, int axis);
+
+    bool LoadPieceTiles();
+    uint32_t GetChunkKey(const sf::Vector2i & coord) const;
+    bool IsChunkInWorld(const sf::Vector2i & coord) const;
+    void RequestChunk(const sf::Vector2i & coord);
+    void IntegrateReadyChunks();
+    void Integrate(std::unique_ptr<ChunkData> pData);
+    void EvictOverBudget();
+    void WaitForJobs();
+
+    // Stops streaming and lets go of every chunk, after waiting out any still building
+    void DropWorld();
+
+    bool mIsStreaming;
+    WorldDesc mWorld;
+    std::shared_ptr<sf::Texture> mpTilesetTexture;
+
+    std::unordered_map<uint32_t, Chunk> mChunks;
+    uint64_t mFrame;
+    size_t mResidentBytes;
+    size_t mMemoryBudget;
+    int mMaxIntegrationsPerFrame;
+
+    // Worker to main thread hand-off
+    std::mutex mReadyMutex;
+    std::vector<std::unique_ptr<ChunkData>> mReadyChunks;
+    std::atomic<int> mJobsInFlight;
+
+    // Debug
+    int mDebugSeed;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -7,7 +7,6 @@ CollisionComponent::CollisionComponent(GameObject * pOwner, GameManager & gameMa
     , mpWorld(pWorld)
     , mpBody(pBody)
     , mSize(size)
-    , mName("CollisionComponent")
 {
     mpBody->SetSleepingAllowed(false);
 }
@@ -16,7 +15,31 @@ CollisionComponent::CollisionComponent(GameObject * pOwner, GameManager & gameMa
 
 CollisionComponent::~CollisionComponent()
 {
-    mpWorld->DestroyBody(mpBody);
+    if (mpBody)
+    {
+        mpWorld->DestroyBody(mpBody);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CollisionComponent::DestroyBody()
+{
+    if (!mpBody)
+    {
+        return;
+    }
+
+    GameObject * pOwner = GetGameManager().GetGameObject(mOwnerHandle);
+    if (pOwner && pOwner->GetPhysicsBody() == mpBody)
+    {
+        pOwner->DestroyPhysicsBody(mpWorld);
+    }
+    else
+    {
+        mpWorld->DestroyBody(mpBody);
+    }
+    mpBody = nullptr;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -43,16 +66,11 @@ void CollisionComponent::Update(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void CollisionComponent::DebugImGuiComponentInfo()
-{
-
-}
-
-//------------------------------------------------------------------------------------------------------------------------
+BD_REGISTER_COMPONENT(CollisionComponent)
 
-std::string & CollisionComponent::GetClassName()
+void CollisionComponent::DescribeType(ComponentTypeInfo & typeInfo)
 {
-    return mName;
+    typeInfo.AddField<&CollisionComponent::mSize>("Size");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -4,19 +4,21 @@
 
 class CollisionComponent : public GameComponent
 {
+    BD_COMPONENT(CollisionComponent)
+
 public:
     CollisionComponent(GameObject * pOwner, GameManager & gameManager, b2World * pWorld, b2Body * pBody, sf::Vector2f size, bool isDynamic);
     ~CollisionComponent();
 
     virtual void Update(float deltaTime) override;
-    virtual void DebugImGuiComponentInfo() override;
-    virtual std::string & GetClassName() override;
+
+    // Releases the Box2D body right away, used when the owner dies but is kept around for a frame
+    void DestroyBody();
 
 private:
     b2Body * mpBody;
     b2World * mpWorld;
     sf::Vector2f mSize;
-    std::string mName;
 };
 
 //------------------------------------------------------------------------------------------------------------------------
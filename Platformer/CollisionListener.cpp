@@ -3,6 +3,7 @@
 #include "GameObject.h"
 #include "ProjectileComponent.h"
 #include "HealthComponent.h"
+#include "ParticleManager.h"
 
 CollisionListener::CollisionListener(GameManager * pGameManager)
     : mpGameManager(pGameManager)
@@ -57,6 +58,7 @@ void CollisionListener::HandleCollision(GameObject * pObjA, GameObject * pObjB)
             auto pObjBHealthComp = pObjB->GetComponent<HealthComponent>().lock();
             if (pObjBHealthComp)
             {
+                SpawnImpactSparks(pObjA, pObjB);
                 pObjBHealthComp->LoseHealth(100);
                 pObjA->Destroy();
             }
@@ -69,6 +71,7 @@ void CollisionListener::HandleCollision(GameObject * pObjA, GameObject * pObjB)
             auto pObjAHealthComp = pObjA->GetComponent<HealthComponent>().lock();
             if (pObjAHealthComp)
             {
+                SpawnImpactSparks(pObjB, pObjA);
                 pObjAHealthComp->LoseHealth(100);
                 pObjB->Destroy();
             }
@@ -88,7 +91,7 @@ void CollisionListener::HandleCollision(GameObject * pObjA, GameObject * pObjB)
         if (pObjA->IsActive() && pObjB->IsActive())
         {
             mpGameManager->GetManager<EnemyAIManager>()->DestroyAllEnemies();
-            pObjB->Deactivate();
+            pObjA->Deactivate();
         }
     }
     // Life Drop
@@ -124,6 +127,19 @@ void CollisionListener::EndContact(b2Contact * contact)
 {
 }
 
+//------------------------------------------------------------------------------------------------------------------------
+
+void CollisionListener::SpawnImpactSparks(GameObject * pProjectile, GameObject * pTarget)
+{
+    auto * pParticleManager = mpGameManager->GetManager<ParticleManager>();
+    if (pParticleManager)
+    {
+        // Sparks kick back out of the target towards where the shot came from
+        sf::Vector2f position = pProjectile->GetPosition();
+        pParticleManager->Burst(EParticleEffect::ImpactSparks, position, -1, position - pTarget->GetPosition());
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------
 // EOF
 //------------------------------------------------------------------------------------------------------------------------
\ No newline at end of file
@@ -13,5 +13,7 @@ public:
     void HandleCollision(GameObject * pObjA, GameObject * pObjB);
 
 private:
+    void SpawnImpactSparks(GameObject * pProjectile, GameObject * pTarget);
+
     GameManager * mpGameManager;
 };
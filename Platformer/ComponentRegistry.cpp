@@ -0,0 +1,249 @@
+#include "AstroidsPrivate.h"
+#include "ComponentRegistry.h"
+#include "GameComponent.h"
+#include "BDConfig.h"
+#include <imgui.h>
+
+namespace
+{
+    const char * skFieldTypeNames[] =
+    {
+        "bool",
+        "int",
+        "float",
+        "Vector2f",
+        "Handle",
+    };
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ComponentTypeInfo::ComponentTypeInfo(const char * name, std::type_index type, size_t size, size_t alignment)
+    : mName(name)
+    , mType(type)
+    , mSize(size)
+    , mAlignment(alignment)
+    , mFields()
+    , mpSave(&ComponentRegistry::SaveFields)
+    , mpLoad(&ComponentRegistry::LoadFields)
+    , mpInspect(&ComponentRegistry::InspectFields)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ComponentRegistry & ComponentRegistry::Get()
+{
+    // Local so it exists before the first BD_REGISTER_COMPONENT, whichever file that is in
+    static ComponentRegistry sRegistry;
+    return sRegistry;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ComponentRegistry::ComponentRegistry()
+    : mTypes()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const ComponentTypeInfo * ComponentRegistry::Find(std::type_index type) const
+{
+    for (const auto & pTypeInfo : mTypes)
+    {
+        if (pTypeInfo->mType == type)
+        {
+            return pTypeInfo.get();
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const ComponentTypeInfo * ComponentRegistry::Find(const std::string & name) const
+{
+    for (const auto & pTypeInfo : mTypes)
+    {
+        if (pTypeInfo->mName == name)
+        {
+            return pTypeInfo.get();
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ComponentRegistry::SaveFields(const ComponentTypeInfo & typeInfo, GameComponent & component, nlohmann::json & outJson)
+{
+    for (const ComponentField & field : typeInfo.mFields)
+    {
+        void * pValue = field.mpGetAddress(component);
+        switch (field.mType)
+        {
+            case EFieldType::Bool:
+            {
+                outJson[field.mName] = *static_cast<bool *>(pValue);
+                break;
+            }
+            case EFieldType::Int:
+            {
+                outJson[field.mName] = *static_cast<int *>(pValue);
+                break;
+            }
+            case EFieldType::Float:
+            {
+                outJson[field.mName] = *static_cast<float *>(pValue);
+                break;
+            }
+            case EFieldType::Vector2f:
+            {
+                const sf::Vector2f & value = *static_cast<sf::Vector2f *>(pValue);
+                outJson[field.mName] = { value.x, value.y };
+                break;
+            }
+            case EFieldType::Handle:
+            {
+                outJson[field.mName] = *static_cast<BD::Handle *>(pValue);
+                break;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ComponentRegistry::LoadFields(const ComponentTypeInfo & typeInfo, GameComponent & component, const nlohmann::json & json)
+{
+    // Fields missing from the JSON, or of the wrong kind, keep the value they have
+    for (const ComponentField & field : typeInfo.mFields)
+    {
+        auto valueIt = json.find(field.mName);
+        if (valueIt == json.end())
+        {
+            continue;
+        }
+
+        void * pValue = field.mpGetAddress(component);
+        switch (field.mType)
+        {
+            case EFieldType::Bool:
+            {
+                if (valueIt->is_boolean())
+                {
+                    *static_cast<bool *>(pValue) = valueIt->get<bool>();
+                }
+                break;
+            }
+            case EFieldType::Int:
+            {
+                if (valueIt->is_number_integer())
+                {
+                    *static_cast<int *>(pValue) = valueIt->get<int>();
+                }
+                break;
+            }
+            case EFieldType::Float:
+            {
+                if (valueIt->is_number())
+                {
+                    *static_cast<float *>(pValue) = valueIt->get<float>();
+                }
+                break;
+            }
+            case EFieldType::Vector2f:
+            {
+                if (valueIt->is_array() && valueIt->size() == 2 && (*valueIt)[0].is_number() && (*valueIt)[1].is_number())
+                {
+                    *static_cast<sf::Vector2f *>(pValue) = sf::Vector2f((*valueIt)[0].get<float>(), (*valueIt)[1].get<float>());
+                }
+                break;
+            }
+            case EFieldType::Handle:
+            {
+                if (valueIt->is_number_unsigned())
+                {
+                    *static_cast<BD::Handle *>(pValue) = valueIt->get<BD::Handle>();
+                }
+                break;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ComponentRegistry::InspectFields(const ComponentTypeInfo & typeInfo, GameComponent & component)
+{
+#if IMGUI_ENABLED()
+    ImGui::PushID(&component);
+    for (const ComponentField & field : typeInfo.mFields)
+    {
+        void * pValue = field.mpGetAddress(component);
+        switch (field.mType)
+        {
+            case EFieldType::Bool:
+            {
+                ImGui::Checkbox(field.mName, static_cast<bool *>(pValue));
+                break;
+            }
+            case EFieldType::Int:
+            {
+                ImGui::InputInt(field.mName, static_cast<int *>(pValue));
+                break;
+            }
+            case EFieldType::Float:
+            {
+                ImGui::DragFloat(field.mName, static_cast<float *>(pValue), 0.1f);
+                break;
+            }
+            case EFieldType::Vector2f:
+            {
+                ImGui::DragFloat2(field.mName, &static_cast<sf::Vector2f *>(pValue)->x, 0.1f);
+                break;
+            }
+            case EFieldType::Handle:
+            {
+                // Editing a handle by hand would only ever break it
+                ImGui::Text("%s: %llu", field.mName, static_cast<unsigned long long>(*static_cast<BD::Handle *>(pValue)));
+                break;
+            }
+        }
+    }
+    ImGui::PopID();
+
+    // Whatever the component shows beyond its fields
+    component.DebugImGuiComponentInfo();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ComponentRegistry::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Component Types");
+
+    ImGui::Text("Registered: %d", int(mTypes.size()));
+    for (const auto & pTypeInfo : mTypes)
+    {
+        if (ImGui::TreeNode(pTypeInfo->mName.c_str()))
+        {
+            ImGui::Text("Size: %d bytes, align %d", int(pTypeInfo->mSize), int(pTypeInfo->mAlignment));
+            for (const ComponentField & field : pTypeInfo->mFields)
+            {
+                ImGui::BulletText("%s %s", skFieldTypeNames[int(field.mType)], field.mName);
+            }
+            ImGui::TreePop();
+        }
+    }
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "SFML/json.hpp"
+#include "TPool.h"
+
+class GameComponent;
+
+enum class EFieldType
+{
+    Bool,
+    Int,
+    Float,
+    Vector2f,
+    Handle
+};
+
+template <typename T>
+struct FieldTypeOf;
+template <> struct FieldTypeOf<bool> { static const EFieldType skType = EFieldType::Bool; };
+template <> struct FieldTypeOf<int> { static const EFieldType skType = EFieldType::Int; };
+template <> struct FieldTypeOf<float> { static const EFieldType skType = EFieldType::Float; };
+template <> struct FieldTypeOf<sf::Vector2f> { static const EFieldType skType = EFieldType::Vector2f; };
+template <> struct FieldTypeOf<BD::Handle> { static const EFieldType skType = EFieldType::Handle; };
+
+template <typename T>
+struct MemberPointerTraits;
+template <typename TClass, typename TField>
+struct MemberPointerTraits<TField TClass::*>
+{
+    using Class = TClass;
+    using Field = TField;
+};
+
+struct ComponentField
+{
+    const char * mName;                                 // Also the key in saved JSON
+    EFieldType mType;
+    void * (*mpGetAddress)(GameComponent & component);
+};
+
+struct ComponentTypeInfo;
+typedef void (*ComponentSaveHook)(const ComponentTypeInfo & typeInfo, GameComponent & component, nlohmann::json & outJson);
+typedef void (*ComponentLoadHook)(const ComponentTypeInfo & typeInfo, GameComponent & component, const nlohmann::json & json);
+typedef void (*ComponentInspectHook)(const ComponentTypeInfo & typeInfo, GameComponent & component);
+
+// Everything known about a component type without needing an instance of it. There is one per type, built the first
+// time the type is asked for, so instances carry nothing but their virtual table to say what they are.
+struct ComponentTypeInfo
+{
+    std::string mName;
+    std::type_index mType;
+    size_t mSize;
+    size_t mAlignment;
+    std::vector<ComponentField> mFields;
+
+    // Walk the fields by default, a DescribeType with state the fields cannot cover replaces them
+    ComponentSaveHook mpSave;
+    ComponentLoadHook mpLoad;
+    ComponentInspectHook mpInspect;
+
+    ComponentTypeInfo(const char * name, std::type_index type, size_t size, size_t alignment);
+
+    // Called from the component's own DescribeType, which can name its private members, as
+    // typeInfo.AddField<&HealthComponent::mHealth>("Health")
+    template <auto pMember>
+    void AddField(const char * name)
+    {
+        using Traits = MemberPointerTraits<decltype(pMember)>;
+        using TComponent = typename Traits::Class;
+        mFields.push_back({ name, FieldTypeOf<typename Traits::Field>::skType,
+            [](GameComponent & component) -> void *
+            {
+                return &(static_cast<TComponent &>(component).*pMember);
+            } });
+    }
+};
+
+// Every component type in the program, registered before main by BD_REGISTER_COMPONENT in the component's .cpp
+class ComponentRegistry
+{
+public:
+    static ComponentRegistry & Get();
+
+    template <typename TComponent>
+    const ComponentTypeInfo & Register(const char * name)
+    {
+        mTypes.push_back(std::make_unique<ComponentTypeInfo>(name, std::type_index(typeid(TComponent)),
+            sizeof(TComponent), alignof(TComponent)));
+        ComponentTypeInfo & typeInfo = *mTypes.back();
+        TComponent::DescribeType(typeInfo);
+        return typeInfo;
+    }
+
+    const ComponentTypeInfo * Find(std::type_index type) const;
+    const ComponentTypeInfo * Find(const std::string & name) const;
+    const std::vector<std::unique_ptr<ComponentTypeInfo>> & GetTypes() const { return mTypes; }
+
+    // The default hooks
+    static void SaveFields(const ComponentTypeInfo & typeInfo, GameComponent & component, nlohmann::json & outJson);
+    static void LoadFields(const ComponentTypeInfo & typeInfo, GameComponent & component, const nlohmann::json & json);
+    static void InspectFields(const ComponentTypeInfo & typeInfo, GameComponent & component);
+
+    void DebugImGuiInfo();
+
+private:
+    ComponentRegistry();
+
+    std::vector<std::unique_ptr<ComponentTypeInfo>> mTypes;
+};
+
+// First thing in a component's class body
+#define BD_COMPONENT(TComponent)                                                                                        \
+public:                                                                                                                 \
+    static const ComponentTypeInfo & GetStaticTypeInfo();                                                               \
+    virtual const ComponentTypeInfo & GetTypeInfo() const override { return GetStaticTypeInfo(); }                      \
+    static void DescribeType(ComponentTypeInfo & typeInfo);                                                             \
+private:
+
+// Once in the component's .cpp, next to its DescribeType
+#define BD_REGISTER_COMPONENT(TComponent)                                                                               \
+    const ComponentTypeInfo & TComponent::GetStaticTypeInfo()                                                           \
+    {                                                                                                                   \
+        static const ComponentTypeInfo & sTypeInfo = ComponentRegistry::Get().Register<TComponent>(#TComponent);        \
+        return sTypeInfo;                                                                                               \
+    }                                                                                                                   \
+    static const ComponentTypeInfo & sRegistered##TComponent = TComponent::GetStaticTypeInfo();
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
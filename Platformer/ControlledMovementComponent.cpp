@@ -7,17 +7,15 @@
 #include "ResourceManager.h"
 #include "CameraManager.h"
 #include "LevelManager.h"
+#include "NetInputComponent.h"
 #include "imgui.h"
 
 ControlledMovementComponent::ControlledMovementComponent(GameObject * pOwner, GameManager & gameManager)
     : GameComponent(pOwner, gameManager)
     , mVelocity(3.f, 3.f)
-    , mAcceleration(800.f)
-    , mDeceleration(1000.f)
-    , mMaxSpeed(300.f)
     , mVelocityX(0.f)
     , mVelocityY(0.f)
-    , mName("ControlledMovementComponent")
+    , mTuning()
     , mTilt(ESpriteTilt::Normal)
 {
 }
@@ -27,11 +25,9 @@ ControlledMovementComponent::ControlledMovementComponent(GameObject * pOwner, Ga
 ControlledMovementComponent::ControlledMovementComponent(GameObject * pOwner, GameManager & gameManager, float veloX, float veloY)
     : GameComponent(pOwner, gameManager)
     , mVelocity(3.f, 3.f)
-    , mAcceleration(800.f)
-    , mDeceleration(1000.f)
-    , mMaxSpeed(300.f)
     , mVelocityX(veloX)
 	, mVelocityY(veloY)
+    , mTuning()
     , mTilt(ESpriteTilt::Normal)
 {
 }
@@ -45,6 +41,17 @@ ControlledMovementComponent::~ControlledMovementComponent()
 //------------------------------------------------------------------------------------------------------------------------
 
 void ControlledMovementComponent::Update(float deltaTime)
+{
+    if (GetGameObject().HasComponent<NetInputComponent>())
+    {
+        return;
+    }
+    Step(SampleLocalPlayerInput(GetGameManager()), deltaTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ControlledMovementComponent::Step(const PlayerInput & input, float deltaTime)
 {
     GameObject * pOwner = GetGameManager().GetGameObject(mOwnerHandle);
     if (!pOwner || !pOwner->IsActive())
@@ -56,74 +63,71 @@ void ControlledMovementComponent::Update(float deltaTime)
 
     if (pSpriteComponent)
     {
-        // Get current position, size, and window bounds
-        auto position = pSpriteComponent->GetPosition();
-        sf::Vector2f size(pSpriteComponent->GetWidth(), pSpriteComponent->GetHeight());
-        sf::Vector2u windowSize = GetGameObject().GetGameManager().GetWindow().getSize();
+        MovementState state;
+        state.mPosition = pSpriteComponent->GetPosition();
+        state.mVelocity = mVelocity;
+        state.mRotation = pSpriteComponent->GetRotation();
 
-        sf::Vector2f inputDirection = { 0.f, 0.f };
+        Simulate(state, input, deltaTime, mTuning, GetGameManager().GetManager<LevelManager>());
 
-        // Input handling
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) inputDirection.y -= 1.f;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) inputDirection.y += 1.f;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) inputDirection.x -= 1.f;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) inputDirection.x += 1.f;
+        mVelocity = state.mVelocity;
+        pSpriteComponent->SetPosition(state.mPosition);
+        pSpriteComponent->SetRotation(state.mRotation);
+    }
+}
 
-        // Normalize input direction to prevent faster diagonal movement
-        if (inputDirection.x != 0.f || inputDirection.y != 0.f)
-        {
-            inputDirection /= std::sqrt(inputDirection.x * inputDirection.x + inputDirection.y * inputDirection.y);
-        }
+//------------------------------------------------------------------------------------------------------------------------
 
-        // Apply acceleration
-        mVelocity += inputDirection * mAcceleration * deltaTime;
+void ControlledMovementComponent::Simulate(MovementState & state, const PlayerInput & input, float deltaTime, const MovementTuning & tuning, LevelManager * pLevelManager)
+{
+    sf::Vector2f inputDirection = input.mMove;
 
-        // Clamp velocity to max speed
-        float velocityLength = std::hypot(mVelocity.x, mVelocity.y);
-        if (velocityLength > mMaxSpeed)
-        {
-            mVelocity = (mVelocity / velocityLength) * mMaxSpeed;
-        }
+    // Normalize input direction to prevent faster diagonal movement
+    if (inputDirection.x != 0.f || inputDirection.y != 0.f)
+    {
+        inputDirection /= std::sqrt(inputDirection.x * inputDirection.x + inputDirection.y * inputDirection.y);
+    }
 
-        // Apply deceleration if no input
-        if (inputDirection.x == 0)
-        {
-            mVelocity.x -= std::min(std::abs(mVelocity.x), mDeceleration * deltaTime) * (mVelocity.x > 0 ? 1 : -1);
-        }
-        if (inputDirection.y == 0)
-        {
-            mVelocity.y -= std::min(std::abs(mVelocity.y), mDeceleration * deltaTime) * (mVelocity.y > 0 ? 1 : -1);
-        }
+    // Apply acceleration
+    state.mVelocity += inputDirection * tuning.mAcceleration * deltaTime;
+
+    // Clamp velocity to max speed
+    float velocityLength = std::hypot(state.mVelocity.x, state.mVelocity.y);
+    if (velocityLength > tuning.mMaxSpeed)
+    {
+        state.mVelocity = (state.mVelocity / velocityLength) * tuning.mMaxSpeed;
+    }
+
+    // Apply deceleration if no input
+    if (inputDirection.x == 0)
+    {
+        state.mVelocity.x -= std::min(std::abs(state.mVelocity.x), tuning.mDeceleration * deltaTime) * (state.mVelocity.x > 0 ? 1 : -1);
+    }
+    if (inputDirection.y == 0)
+    {
+        state.mVelocity.y -= std::min(std::abs(state.mVelocity.y), tuning.mDeceleration * deltaTime) * (state.mVelocity.y > 0 ? 1 : -1);
+    }
 
-        // Calculate new position
-        sf::Vector2f newPosition = position + mVelocity * deltaTime;
+    // Calculate new position
+    sf::Vector2f newPosition = state.mPosition + state.mVelocity * deltaTime;
 
-        // Get grid and tile size
-        auto & gameManager = GetGameObject().GetGameManager();
-        auto pLevelManager = gameManager.GetManager<LevelManager>();
+    // Check if the tile is walkable
+    if (pLevelManager)
+    {
+        // Determine the tile under the new position
         float cellSize = BD::gsPixelCountCellSize;
+        int tileX = static_cast<int>(newPosition.x / cellSize);
+        int tileY = static_cast<int>(newPosition.y / cellSize);
 
-        // Check if the tile is walkable
+        if (pLevelManager->IsTileWalkablePlayer(tileX, tileY))
         {
-             if (pLevelManager)
-             {
-                 // Determine the tile under the new position
-                 int tileX = static_cast<int>(newPosition.x / cellSize);
-                 int tileY = static_cast<int>(newPosition.y / cellSize);
-
-                 if (pLevelManager->IsTileWalkablePlayer(tileX, tileY))
-                 {
-                     position = newPosition;
-                 }
-             }
+            state.mPosition = newPosition;
         }
-        pSpriteComponent->SetPosition(position);
-
-        auto crosshairPosition = GetGameObject().GetGameManager().GetManager<CameraManager>()->GetCrosshairPosition();
-        sf::Vector2f direction = crosshairPosition - position;
-        float angle = std::atan2(direction.y, direction.x) * 180.f / 3.14159f;
-        pSpriteComponent->SetRotation(angle + 90.f);
     }
+
+    sf::Vector2f direction = input.mAim - state.mPosition;
+    float angle = std::atan2(direction.y, direction.x) * 180.f / 3.14159f;
+    state.mRotation = angle + 90.f;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -136,9 +140,11 @@ void ControlledMovementComponent::DebugImGuiComponentInfo()
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & ControlledMovementComponent::GetClassName()
+BD_REGISTER_COMPONENT(ControlledMovementComponent)
+
+void ControlledMovementComponent::DescribeType(ComponentTypeInfo & typeInfo)
 {
-    return mName;
+    typeInfo.AddField<&ControlledMovementComponent::mVelocity>("Velocity");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -155,6 +161,48 @@ void ControlledMovementComponent::SetVelocityY(float velo)
 	mVelocityY = velo;
 }
 
+//------------------------------------------------------------------------------------------------------------------------
+
+sf::Vector2f ControlledMovementComponent::GetVelocity() const
+{
+	return mVelocity;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ControlledMovementComponent::SetVelocity(const sf::Vector2f & velocity)
+{
+	mVelocity = velocity;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const MovementTuning & ControlledMovementComponent::GetTuning() const
+{
+	return mTuning;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ControlledMovementComponent::SaveState(SnapshotFormat::MovementRecord & outRecord) const
+{
+	outRecord.mVelocityX = mVelocity.x;
+	outRecord.mVelocityY = mVelocity.y;
+	outRecord.mInputVelocityX = mVelocityX;
+	outRecord.mInputVelocityY = mVelocityY;
+	outRecord.mTilt = uint32_t(mTilt);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ControlledMovementComponent::LoadState(const SnapshotFormat::MovementRecord & record)
+{
+	mVelocity = sf::Vector2f(record.mVelocityX, record.mVelocityY);
+	mVelocityX = record.mInputVelocityX;
+	mVelocityY = record.mInputVelocityY;
+	mTilt = ESpriteTilt(record.mTilt);
+}
+
 //------------------------------------------------------------------------------------------------------------------------
 // EOF
 //------------------------------------------------------------------------------------------------------------------------
\ No newline at end of file
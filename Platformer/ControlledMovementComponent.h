@@ -2,6 +2,10 @@
 
 #include "GameComponent.h"
 #include "DungeonManager.h"
+#include "SnapshotFormat.h"
+#include "PlayerInput.h"
+
+class LevelManager;
 
 enum class ESpriteTilt
 {
@@ -10,29 +14,55 @@ enum class ESpriteTilt
 	Left
 };
 
+struct MovementTuning
+{
+	float mAcceleration = 800.f;
+	float mDeceleration = 1000.f;
+	float mMaxSpeed = 300.f;
+};
+
+struct MovementState
+{
+	sf::Vector2f mPosition;
+	sf::Vector2f mVelocity;
+	float mRotation = 0.f;	// Degrees
+};
+
 class ControlledMovementComponent : public GameComponent
 {
+	BD_COMPONENT(ControlledMovementComponent)
+
 public:
 	ControlledMovementComponent(GameObject * pOwner, GameManager & gameManager);
 	ControlledMovementComponent(GameObject * pOwner, GameManager & gameManager, float veloX, float veloY);
 
 	~ControlledMovementComponent();
 
+	// Moves with the local devices, unless the owner has a NetInputComponent and is stepped per command instead
 	virtual void Update(float deltaTime) override;
+
+	// One step of player movement for the given input
+	void Step(const PlayerInput & input, float deltaTime);
+
+	// The movement model on its own, so a network client can predict a player it has no GameObject for
+	static void Simulate(MovementState & state, const PlayerInput & input, float deltaTime, const MovementTuning & tuning, LevelManager * pLevelManager);
+
 	virtual void DebugImGuiComponentInfo() override;
-	virtual std::string & GetClassName() override;
 
 	void SetVelocityX(float velo);
 	void SetVelocityY(float velo);
+	sf::Vector2f GetVelocity() const;
+	void SetVelocity(const sf::Vector2f & velocity);
+	const MovementTuning & GetTuning() const;
+
+	void SaveState(SnapshotFormat::MovementRecord & outRecord) const;
+	void LoadState(const SnapshotFormat::MovementRecord & record);
 
 private:
 	sf::Vector2f mVelocity;
 	float mVelocityX;
 	float mVelocityY;
-	float mAcceleration;
-	float mDeceleration;
-	float mMaxSpeed;
-	std::string mName;
+	MovementTuning mTuning;
 	ESpriteTilt mTilt;
 };
 
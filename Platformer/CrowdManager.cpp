@@ -0,0 +1,454 @@
+#include "AstroidsPrivate.h"
+#include "CrowdManager.h"
+#include "LevelManager.h"
+#include "JobSystem.h"
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Agents closer than this push each other apart and match each other's heading. Also the smallest grid cell, so
+    // the 3x3 cells around an agent always cover its neighborhood.
+    const float skNeighborRadius = 32.f;
+    const int skMaxGridCells = 1 << 20;
+
+    const float skSeparationWeight = 1.5f;
+    const float skAlignmentWeight = 0.3f;
+
+    // How quickly the velocity turns toward the steering target, per second
+    const float skResponsiveness = 8.f;
+
+    // Agents stacked on one spot, like a fresh spawn wave, still need a direction to push each other in
+    const float skStackJitter = 0.05f;
+    const float skGoldenAngle = 2.39996323f;
+
+    const int skMinAgentsPerJob = 256;
+    const int skSimdPadding = 3;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+CrowdManager::CrowdManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mHandles()
+    , mFields()
+    , mAgentBySlot()
+    , mSortedFields()
+    , mSortedAgents()
+    , mCellStarts()
+    , mAgentCells()
+    , mCellCursors()
+    , mGridWidth(0)
+    , mGridHeight(0)
+    , mCellSize(skNeighborRadius)
+    , mNewPosX()
+    , mNewPosY()
+    , mUseWorkerThreads(true)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+CrowdManager::~CrowdManager()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::Update(float deltaTime)
+{
+    if (mHandles.empty() || deltaTime <= 0.f)
+    {
+        return;
+    }
+
+    GatherPositions();
+    BuildGrid();
+
+    int agentCount = int(mHandles.size());
+    auto steer = [this, deltaTime](int begin, int end) { Steer(begin, end, deltaTime); };
+    if (mUseWorkerThreads)
+    {
+        GetGameManager().GetJobSystem().ParallelFor(agentCount, skMinAgentsPerJob, steer);
+    }
+    else
+    {
+        steer(0, agentCount);
+    }
+
+    ApplyMoves();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::OnGameEnd()
+{
+    mHandles.clear();
+    for (auto & field : mFields)
+    {
+        field.clear();
+    }
+    mAgentBySlot.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::AddAgent(BD::Handle handle, float maxSpeed)
+{
+    int agent = GetAgentIndex(handle);
+    if (agent < 0)
+    {
+        int slot = GetSlot(handle);
+        if (slot >= int(mAgentBySlot.size()))
+        {
+            mAgentBySlot.resize(slot + 1, -1);
+        }
+
+        // The pool may have handed this slot to a new object before the old agent was removed
+        if (mAgentBySlot[slot] >= 0)
+        {
+            RemoveAgent(mHandles[mAgentBySlot[slot]]);
+        }
+
+        agent = int(mHandles.size());
+        mAgentBySlot[slot] = agent;
+        mHandles.push_back(handle);
+        for (auto & field : mFields)
+        {
+            field.push_back(0.f);
+        }
+    }
+
+    if (GameObject * pGameObject = GetGameManager().GetGameObject(handle))
+    {
+        sf::Vector2f position = pGameObject->GetPosition();
+        mFields[PosX][agent] = position.x;
+        mFields[PosY][agent] = position.y;
+    }
+    mFields[MaxSpeed][agent] = maxSpeed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::RemoveAgent(BD::Handle handle)
+{
+    int agent = GetAgentIndex(handle);
+    if (agent < 0)
+    {
+        return;
+    }
+
+    // Swap the last agent into the hole
+    int last = int(mHandles.size()) - 1;
+    mAgentBySlot[GetSlot(mHandles[last])] = agent;
+    mAgentBySlot[GetSlot(handle)] = -1;
+    mHandles[agent] = mHandles[last];
+    mHandles.pop_back();
+    for (auto & field : mFields)
+    {
+        field[agent] = field[last];
+        field.pop_back();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool CrowdManager::HasAgent(BD::Handle handle) const
+{
+    return GetAgentIndex(handle) >= 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::SetPreferredVelocity(BD::Handle handle, const sf::Vector2f & velocity)
+{
+    int agent = GetAgentIndex(handle);
+    if (agent >= 0)
+    {
+        mFields[PreferredVelX][agent] = velocity.x;
+        mFields[PreferredVelY][agent] = velocity.y;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+sf::Vector2f CrowdManager::GetVelocity(BD::Handle handle) const
+{
+    int agent = GetAgentIndex(handle);
+    return agent >= 0 ? sf::Vector2f(mFields[VelX][agent], mFields[VelY][agent]) : sf::Vector2f();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::SetUseWorkerThreads(bool useWorkerThreads)
+{
+    mUseWorkerThreads = useWorkerThreads;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int CrowdManager::GetAgentIndex(BD::Handle handle) const
+{
+    int slot = GetSlot(handle);
+    if (slot >= int(mAgentBySlot.size()))
+    {
+        return -1;
+    }
+
+    int agent = mAgentBySlot[slot];
+    return agent >= 0 && mHandles[agent] == handle ? agent : -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::GatherPositions()
+{
+    // Spawning and gameplay may have placed agents since last frame
+    GameManager & gameManager = GetGameManager();
+    for (int agent = 0; agent < int(mHandles.size()); ++agent)
+    {
+        if (GameObject * pGameObject = gameManager.GetGameObject(mHandles[agent]))
+        {
+            sf::Vector2f position = pGameObject->GetPosition();
+            mFields[PosX][agent] = position.x;
+            mFields[PosY][agent] = position.y;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::BuildGrid()
+{
+    int agentCount = int(mHandles.size());
+    const float * pPosX = mFields[PosX].data();
+    const float * pPosY = mFields[PosY].data();
+
+    // Dense row major grid over the agents' bounds, so the three cells of a row around an agent are one contiguous
+    // run of sorted agents. Widely scattered crowds get coarser cells rather than a huge grid.
+    float minX = pPosX[0], maxX = pPosX[0];
+    float minY = pPosY[0], maxY = pPosY[0];
+    for (int agent = 1; agent < agentCount; ++agent)
+    {
+        minX = std::min(minX, pPosX[agent]);
+        maxX = std::max(maxX, pPosX[agent]);
+        minY = std::min(minY, pPosY[agent]);
+        maxY = std::max(maxY, pPosY[agent]);
+    }
+
+    mCellSize = skNeighborRadius;
+    while ((maxX - minX) / mCellSize * ((maxY - minY) / mCellSize) > float(skMaxGridCells))
+    {
+        mCellSize *= 2.f;
+    }
+    mGridWidth = int((maxX - minX) / mCellSize) + 1;
+    mGridHeight = int((maxY - minY) / mCellSize) + 1;
+    int cellCount = mGridWidth * mGridHeight;
+
+    float invCellSize = 1.f / mCellSize;
+    mAgentCells.resize(agentCount);
+    mCellStarts.assign(cellCount + 1, 0);
+    for (int agent = 0; agent < agentCount; ++agent)
+    {
+        int cellX = std::min(int((pPosX[agent] - minX) * invCellSize), mGridWidth - 1);
+        int cellY = std::min(int((pPosY[agent] - minY) * invCellSize), mGridHeight - 1);
+        int cell = cellY * mGridWidth + cellX;
+        mAgentCells[agent] = cell;
+        ++mCellStarts[cell + 1];
+    }
+    for (int cell = 0; cell < cellCount; ++cell)
+    {
+        mCellStarts[cell + 1] += mCellStarts[cell];
+    }
+
+    for (auto & field : mSortedFields)
+    {
+        field.assign(agentCount + skSimdPadding, 0.f);
+    }
+    mSortedAgents.resize(agentCount);
+    mNewPosX.resize(agentCount);
+    mNewPosY.resize(agentCount);
+
+    // Counting sort, filling each cell from its end down so agents keep their relative order
+    mCellCursors.assign(mCellStarts.begin() + 1, mCellStarts.end());
+    for (int agent = agentCount - 1; agent >= 0; --agent)
+    {
+        int sorted = --mCellCursors[mAgentCells[agent]];
+        float jitterAngle = agent * skGoldenAngle;
+        mSortedAgents[sorted] = agent;
+        mSortedFields[SortedPosX][sorted] = pPosX[agent] + skStackJitter * std::cos(jitterAngle);
+        mSortedFields[SortedPosY][sorted] = pPosY[agent] + skStackJitter * std::sin(jitterAngle);
+        mSortedFields[SortedVelX][sorted] = mFields[VelX][agent];
+        mSortedFields[SortedVelY][sorted] = mFields[VelY][agent];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::Steer(int begin, int end, float deltaTime)
+{
+    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
+    const float invCellSize = 1.f / BD::gsPixelCountCellSize;
+    const float * pPosX = mSortedFields[SortedPosX].data();
+    const float * pPosY = mSortedFields[SortedPosY].data();
+    const float * pVelX = mSortedFields[SortedVelX].data();
+    const float * pVelY = mSortedFields[SortedVelY].data();
+
+    const __m128 radiusSquared = _mm_set1_ps(skNeighborRadius * skNeighborRadius);
+    const __m128 invRadius = _mm_set1_ps(1.f / skNeighborRadius);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 epsilon = _mm_set1_ps(1e-6f);
+    const __m128 laneIndex = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+
+    for (int sorted = begin; sorted < end; ++sorted)
+    {
+        int agent = mSortedAgents[sorted];
+        float x = pPosX[sorted];
+        float y = pPosY[sorted];
+        const __m128 agentX = _mm_set1_ps(x);
+        const __m128 agentY = _mm_set1_ps(y);
+
+        __m128 separationX = zero;
+        __m128 separationY = zero;
+        __m128 headingX = zero;
+        __m128 headingY = zero;
+        __m128 neighborCount = zero;
+
+        int cell = mAgentCells[agent];
+        int cellX = cell % mGridWidth;
+        int cellY = cell / mGridWidth;
+        int firstColumn = std::max(cellX - 1, 0);
+        int lastColumn = std::min(cellX + 1, mGridWidth - 1);
+        for (int row = std::max(cellY - 1, 0); row <= std::min(cellY + 1, mGridHeight - 1); ++row)
+        {
+            int runEnd = mCellStarts[row * mGridWidth + lastColumn + 1];
+            for (int ii = mCellStarts[row * mGridWidth + firstColumn]; ii < runEnd; ii += 4)
+            {
+                // Lanes past the end of the run belong to cells outside the neighborhood
+                __m128 inRun = _mm_cmplt_ps(laneIndex, _mm_set1_ps(float(runEnd - ii)));
+
+                __m128 deltaX = _mm_sub_ps(agentX, _mm_loadu_ps(pPosX + ii));
+                __m128 deltaY = _mm_sub_ps(agentY, _mm_loadu_ps(pPosY + ii));
+                __m128 distanceSquared = _mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaY, deltaY));
+
+                // The agent itself is the only one at exactly zero distance, the jitter sees to that
+                __m128 isNeighbor = _mm_and_ps(inRun,
+                    _mm_and_ps(_mm_cmplt_ps(distanceSquared, radiusSquared), _mm_cmpgt_ps(distanceSquared, zero)));
+
+                // Push away along the offset, fading out linearly toward the edge of the radius
+                __m128 invDistance = _mm_rsqrt_ps(_mm_max_ps(distanceSquared, epsilon));
+                __m128 falloff = _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(distanceSquared, invDistance), invRadius));
+                __m128 push = _mm_and_ps(isNeighbor, _mm_mul_ps(invDistance, falloff));
+                separationX = _mm_add_ps(separationX, _mm_mul_ps(deltaX, push));
+                separationY = _mm_add_ps(separationY, _mm_mul_ps(deltaY, push));
+
+                headingX = _mm_add_ps(headingX, _mm_and_ps(isNeighbor, _mm_loadu_ps(pVelX + ii)));
+                headingY = _mm_add_ps(headingY, _mm_and_ps(isNeighbor, _mm_loadu_ps(pVelY + ii)));
+                neighborCount = _mm_add_ps(neighborCount, _mm_and_ps(isNeighbor, one));
+            }
+        }
+
+        float lanes[5][4];
+        _mm_storeu_ps(lanes[0], separationX);
+        _mm_storeu_ps(lanes[1], separationY);
+        _mm_storeu_ps(lanes[2], headingX);
+        _mm_storeu_ps(lanes[3], headingY);
+        _mm_storeu_ps(lanes[4], neighborCount);
+        float sums[5];
+        for (int sum = 0; sum < 5; ++sum)
+        {
+            sums[sum] = lanes[sum][0] + lanes[sum][1] + lanes[sum][2] + lanes[sum][3];
+        }
+
+        float maxSpeed = mFields[MaxSpeed][agent];
+        float velX = mFields[VelX][agent];
+        float velY = mFields[VelY][agent];
+        float desiredX = mFields[PreferredVelX][agent] + sums[0] * maxSpeed * skSeparationWeight;
+        float desiredY = mFields[PreferredVelY][agent] + sums[1] * maxSpeed * skSeparationWeight;
+        if (sums[4] > 0.f)
+        {
+            desiredX += (sums[2] / sums[4] - velX) * skAlignmentWeight;
+            desiredY += (sums[3] / sums[4] - velY) * skAlignmentWeight;
+        }
+
+        float desiredSpeed = std::sqrt(desiredX * desiredX + desiredY * desiredY);
+        if (desiredSpeed > maxSpeed)
+        {
+            desiredX *= maxSpeed / desiredSpeed;
+            desiredY *= maxSpeed / desiredSpeed;
+        }
+
+        float blend = std::min(1.f, deltaTime * skResponsiveness);
+        velX += (desiredX - velX) * blend;
+        velY += (desiredY - velY) * blend;
+
+        // Slide along walls by dropping whichever axis would leave the walkable area
+        float oldX = mFields[PosX][agent];
+        float oldY = mFields[PosY][agent];
+        float newX = oldX + velX * deltaTime;
+        float newY = oldY + velY * deltaTime;
+        if (pLevelManager)
+        {
+            auto isWalkable = [pLevelManager, invCellSize](float worldX, float worldY)
+                {
+                    return pLevelManager->IsTileWalkableAI(int(std::floor(worldX * invCellSize)), int(std::floor(worldY * invCellSize)));
+                };
+
+            if (!isWalkable(newX, newY))
+            {
+                if (isWalkable(newX, oldY))
+                {
+                    newY = oldY;
+                    velY = 0.f;
+                }
+                else if (isWalkable(oldX, newY))
+                {
+                    newX = oldX;
+                    velX = 0.f;
+                }
+                else
+                {
+                    newX = oldX;
+                    newY = oldY;
+                    velX = 0.f;
+                    velY = 0.f;
+                }
+            }
+        }
+
+        mFields[VelX][agent] = velX;
+        mFields[VelY][agent] = velY;
+        mNewPosX[agent] = newX;
+        mNewPosY[agent] = newY;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void CrowdManager::ApplyMoves()
+{
+    // SetPosition feeds the SpatialIndex, which is main thread only
+    GameManager & gameManager = GetGameManager();
+    for (int agent = 0; agent < int(mHandles.size()); ++agent)
+    {
+        if (mNewPosX[agent] != mFields[PosX][agent] || mNewPosY[agent] != mFields[PosY][agent])
+        {
+            if (GameObject * pGameObject = gameManager.GetGameObject(mHandles[agent]))
+            {
+                pGameObject->SetPosition(sf::Vector2f(mNewPosX[agent], mNewPosY[agent]));
+            }
+            mFields[PosX][agent] = mNewPosX[agent];
+            mFields[PosY][agent] = mNewPosY[agent];
+        }
+
+        // Preferred velocities only last a frame, an agent nobody steers comes to rest
+        mFields[PreferredVelX][agent] = 0.f;
+        mFields[PreferredVelY][agent] = 0.f;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,75 @@
+#pragma once
+#include "BaseManager.h"
+#include <vector>
+
+// Moves every enemy as one crowd. Agents only say where they would like to go, and once a frame the manager blends
+// that with separation from and alignment to their neighbors, then moves them without stepping onto tiles the AI
+// cannot walk. Agents are counting sorted into a grid each frame so each one's neighbors sit in three contiguous runs
+// of SoA floats, which are scanned four at a time with SSE, and the agents are split across the JobSystem.
+class CrowdManager : public BaseManager
+{
+public:
+    CrowdManager(GameManager * pGameManager);
+    ~CrowdManager();
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    void AddAgent(BD::Handle handle, float maxSpeed);
+    void RemoveAgent(BD::Handle handle);
+    bool HasAgent(BD::Handle handle) const;
+
+    // Where the agent wants to go this frame, in pixels per second. Zero holds it in place apart from being pushed.
+    void SetPreferredVelocity(BD::Handle handle, const sf::Vector2f & velocity);
+    sf::Vector2f GetVelocity(BD::Handle handle) const;
+
+    void SetUseWorkerThreads(bool useWorkerThreads);
+    int GetAgentCount() const { return int(mHandles.size()); }
+
+private:
+    enum EField
+    {
+        PosX, PosY,
+        VelX, VelY,
+        PreferredVelX, PreferredVelY,
+        MaxSpeed,
+        FieldCount
+    };
+
+    // Neighbor data in grid order, padded so the SIMD loop can always load four lanes
+    enum ESortedField
+    {
+        SortedPosX, SortedPosY,
+        SortedVelX, SortedVelY,
+        SortedFieldCount
+    };
+
+    static int GetSlot(BD::Handle handle) { return int(handle & 0xFFFFFFFF); }
+    int GetAgentIndex(BD::Handle handle) const;
+
+    void GatherPositions();
+    void BuildGrid();
+    void Steer(int begin, int end, float deltaTime);
+    void ApplyMoves();
+
+    std::vector<BD::Handle> mHandles;
+    std::vector<float> mFields[FieldCount];
+    std::vector<int> mAgentBySlot;     // Pool slot to agent index, -1 when the object is not an agent
+
+    std::vector<float> mSortedFields[SortedFieldCount];
+    std::vector<int> mSortedAgents;    // Grid order to agent index
+    std::vector<int> mCellStarts;      // First sorted index of each cell, one extra entry closes the last one
+    std::vector<int> mAgentCells;
+    std::vector<int> mCellCursors;
+    int mGridWidth;
+    int mGridHeight;
+    float mCellSize;
+
+    std::vector<float> mNewPosX;
+    std::vector<float> mNewPosY;
+    bool mUseWorkerThreads;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
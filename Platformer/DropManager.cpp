@@ -4,7 +4,7 @@
 #include "CollisionComponent.h"
 #include "ResourceManager.h"
 #include "DropMovementComponent.h"
-#include "ExplosionComponent.h"
+#include "EffectsManager.h"
 
 DropManager::DropManager(GameManager * pGameManager)
 	: BaseManager(pGameManager)
@@ -17,25 +17,29 @@ DropManager::DropManager(GameManager * pGameManager)
 
 void DropManager::Update(float deltaTime)
 {
-    CleanUpDrops();
-
     GameManager & gameManager = GetGameManager();
     for (auto dropHandle : mDropHandles)
     {
         auto * pDrop = gameManager.GetGameObject(dropHandle);
-        if (!pDrop->IsActive())
+        if (pDrop && !pDrop->IsActive() && !pDrop->IsDestroyed())
         {
-            if (!pDrop->GetComponent<ExplosionComponent>().lock())
+            // Picked up nuke, the blast is a detached effect so the drop can go right away
+            auto & window = gameManager.GetWindow();
+            sf::Vector2u windowSize = window.getSize();
+            sf::Vector2f centerPosition(float(windowSize.x) / 2.0f, float(windowSize.y) / 2.0f);
+            ResourceId clipId("Explosion");
+            gameManager.GetManager<EffectsManager>()->PlayEffect(clipId, centerPosition, sf::Vector2f(50.f, 50.f));
+
+            auto pCollisionComp = pDrop->GetComponent<CollisionComponent>().lock();
+            if (pCollisionComp)
             {
-                auto & window = gameManager.GetWindow();
-                sf::Vector2u windowSize = window.getSize();
-                sf::Vector2f centerPosition(float(windowSize.x) / 2.0f, float(windowSize.y) / 2.0f);
-                auto explosionComp = std::make_shared<ExplosionComponent>(
-                    pDrop, gameManager, "Art/explosion.png", 32, 32, 7, 0.1f, sf::Vector2f(50.f, 50.f), centerPosition);
-                pDrop->AddComponent(explosionComp);
+                pCollisionComp->DestroyBody();
             }
+            pDrop->Destroy();
         }
     }
+
+    CleanUpDrops();
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -51,19 +55,6 @@ void DropManager::CleanUpDrops()
 {
     auto & gameManager = GetGameManager();
 
-    for (BD::Handle dropHandle : mDropHandles)
-    {
-        GameObject * pDrop = gameManager.GetGameObject(dropHandle);
-        if (pDrop && !pDrop->IsDestroyed())
-        {
-            auto explosionComp = pDrop->GetComponent<ExplosionComponent>().lock();
-            if (explosionComp && explosionComp->IsAnimationFinished())
-            {
-                pDrop->Destroy();
-            }
-        }
-    }
-
     auto removeStart = std::remove_if(mDropHandles.begin(), mDropHandles.end(),
         [&gameManager](BD::Handle handle)
         {
@@ -76,9 +67,9 @@ void DropManager::CleanUpDrops()
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void DropManager::SpawnDrop(EDropType dropType, const sf::Vector2f & position)
+BD::Handle DropManager::SpawnDrop(EDropType dropType, const sf::Vector2f & position)
 {
-    if (dropType == EDropType::None) return;
+    if (dropType == EDropType::None) return BD::Handle(0);
 
     auto & gameManager = GetGameManager();
     BD::Handle dropHandle;
@@ -122,7 +113,7 @@ void DropManager::SpawnDrop(EDropType dropType, const sf::Vector2f & position)
                 }
                 break;
             default:
-                return;
+                return dropHandle;
         }
         sf::Color greenTint(0, 255, 0, 255);
         pSpriteComp->GetSprite().setColor(greenTint);
@@ -140,6 +131,15 @@ void DropManager::SpawnDrop(EDropType dropType, const sf::Vector2f & position)
             pDrop, gameManager, &gameManager.GetPhysicsWorld(), pDrop->GetPhysicsBody(), pDrop->GetSize(), true);
         pDrop->AddComponent(pCollisionComp);
     }
+
+    return dropHandle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void DropManager::RestoreDrops(const std::vector<BD::Handle> & dropHandles)
+{
+    mDropHandles = dropHandles;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
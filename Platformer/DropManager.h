@@ -19,7 +19,11 @@ public:
 
 	void CleanUpDrops();
 
-	void SpawnDrop(EDropType dropType, const sf::Vector2f & position);
+	// Returns 0 when dropType is None
+	BD::Handle SpawnDrop(EDropType dropType, const sf::Vector2f & position);
+
+	// Replaces the tracked drops, used when a snapshot is loaded
+	void RestoreDrops(const std::vector<BD::Handle> & dropHandles);
 
 private:
 	std::vector<BD::Handle> mDropHandles;
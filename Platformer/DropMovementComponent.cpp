@@ -5,7 +5,6 @@
 DropMovementComponent::DropMovementComponent(GameObject * pGameOwner, GameManager & gameManager)
 	: GameComponent(pGameOwner, gameManager)
     , mVelocity(100.f)
-    , mName("DropMovementComponent")
 {
     auto pSpriteComponent = GetGameObject().GetComponent<SpriteComponent>().lock();
     if (pSpriteComponent)
@@ -63,16 +62,33 @@ void DropMovementComponent::Update(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void DropMovementComponent::DebugImGuiComponentInfo()
+void DropMovementComponent::SaveState(SnapshotFormat::DropMovementRecord & outRecord) const
 {
-    
+    outRecord.mDirectionX = mDirection.x;
+    outRecord.mDirectionY = mDirection.y;
+    outRecord.mVelocity = mVelocity;
+    outRecord.mStartPositionX = mStartPosition.x;
+    outRecord.mStartPositionY = mStartPosition.y;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & DropMovementComponent::GetClassName()
+void DropMovementComponent::LoadState(const SnapshotFormat::DropMovementRecord & record)
 {
-	return mName;
+    mDirection = sf::Vector2f(record.mDirectionX, record.mDirectionY);
+    mVelocity = record.mVelocity;
+    mStartPosition = sf::Vector2f(record.mStartPositionX, record.mStartPositionY);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD_REGISTER_COMPONENT(DropMovementComponent)
+
+void DropMovementComponent::DescribeType(ComponentTypeInfo & typeInfo)
+{
+	typeInfo.AddField<&DropMovementComponent::mDirection>("Direction");
+	typeInfo.AddField<&DropMovementComponent::mVelocity>("Velocity");
+	typeInfo.AddField<&DropMovementComponent::mStartPosition>("StartPosition");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -1,19 +1,22 @@
 #pragma once
 #include "GameComponent.h"
+#include "SnapshotFormat.h"
 
 class DropMovementComponent : public GameComponent
 {
+	BD_COMPONENT(DropMovementComponent)
+
 public:
 	DropMovementComponent(GameObject * pGameOwner, GameManager & gameManager);
 
+	void SaveState(SnapshotFormat::DropMovementRecord & outRecord) const;
+	void LoadState(const SnapshotFormat::DropMovementRecord & record);
+
 	virtual void Update(float deltaTime) override;
-	virtual void DebugImGuiComponentInfo() override;
-	virtual std::string & GetClassName() override;
 
 private:
 	sf::Vector2f mDirection;
 	float mVelocity; 
 	sf::Vector2f mStartPosition;
-	std::string mName;
 };
 
@@ -0,0 +1,812 @@
+#include "AstroidsPrivate.h"
+#include "DungeonGenerator.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+    // Rows per carving job, wide enough that a band is worth a job and narrow enough to keep every worker busy
+    const int skBandHeight = 64;
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // xorshift32, deterministic on every compiler unlike the std distributions
+    uint32_t NextRandom(uint32_t & state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    int RandomRange(uint32_t & state, int min, int max)
+    {
+        return min + int(NextRandom(state) % uint32_t(max - min + 1));
+    }
+
+    float RandomUnit(uint32_t & state)
+    {
+        return float(NextRandom(state) >> 8) * (1.f / 16777216.f);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    int FindRoot(std::vector<int> & parents, int node)
+    {
+        while (node != parents[node])
+        {
+            parents[node] = parents[parents[node]];
+            node = parents[node];
+        }
+        return node;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+    // Sweep hull Delaunay triangulation, after Delaunator. Points are added in order of distance from a seed
+    // triangle, each one is joined to the hull edges it can see and the new triangles are flipped until every edge is
+    // locally Delaunay. Room centers are small integers, so the orientation and in circle tests are exact in doubles.
+    //--------------------------------------------------------------------------------------------------------------------
+
+    class DelaunayTriangulation
+    {
+    public:
+        std::vector<int> mTriangles;    // Three point indices per triangle, counter clockwise
+        std::vector<int> mHalfedges;    // Opposite halfedge of each triangle edge, -1 on the hull
+
+        // False when every point is on one line, there are no triangles then
+        bool Triangulate(const std::vector<double> & coords)
+        {
+            mpCoords = &coords;
+            int count = int(coords.size() / 2);
+            mTriangles.clear();
+            mHalfedges.clear();
+            if (count < 3)
+            {
+                return false;
+            }
+
+            double minX = std::numeric_limits<double>::infinity();
+            double minY = minX;
+            double maxX = -minX;
+            double maxY = -minX;
+            for (int point = 0; point < count; ++point)
+            {
+                minX = std::min(minX, X(point));
+                minY = std::min(minY, Y(point));
+                maxX = std::max(maxX, X(point));
+                maxY = std::max(maxY, Y(point));
+            }
+            double centerX = (minX + maxX) * 0.5;
+            double centerY = (minY + maxY) * 0.5;
+
+            // Seed triangle: the point nearest the center, its nearest neighbor, and the point that makes the
+            // smallest circumcircle with them
+            int i0 = 0;
+            double bestDistance = std::numeric_limits<double>::infinity();
+            for (int point = 0; point < count; ++point)
+            {
+                double distance = DistanceSquared(centerX, centerY, X(point), Y(point));
+                if (distance < bestDistance)
+                {
+                    i0 = point;
+                    bestDistance = distance;
+                }
+            }
+
+            int i1 = -1;
+            bestDistance = std::numeric_limits<double>::infinity();
+            for (int point = 0; point < count; ++point)
+            {
+                double distance = DistanceSquared(X(i0), Y(i0), X(point), Y(point));
+                if (point != i0 && distance < bestDistance && distance > 0.0)
+                {
+                    i1 = point;
+                    bestDistance = distance;
+                }
+            }
+
+            int i2 = -1;
+            double bestRadius = std::numeric_limits<double>::infinity();
+            for (int point = 0; i1 >= 0 && point < count; ++point)
+            {
+                if (point == i0 || point == i1)
+                {
+                    continue;
+                }
+                double radius = Circumradius(X(i0), Y(i0), X(i1), Y(i1), X(point), Y(point));
+                if (radius < bestRadius)
+                {
+                    i2 = point;
+                    bestRadius = radius;
+                }
+            }
+            if (i2 < 0)
+            {
+                return false;
+            }
+
+            if (IsVisible(X(i0), Y(i0), X(i1), Y(i1), X(i2), Y(i2)))
+            {
+                std::swap(i1, i2);
+            }
+            Circumcenter(X(i0), Y(i0), X(i1), Y(i1), X(i2), Y(i2), mCenterX, mCenterY);
+
+            std::vector<double> distances(count);
+            std::vector<int> order(count);
+            for (int point = 0; point < count; ++point)
+            {
+                distances[point] = DistanceSquared(X(point), Y(point), mCenterX, mCenterY);
+            }
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&distances](int lhs, int rhs)
+                {
+                    return distances[lhs] < distances[rhs] || (distances[lhs] == distances[rhs] && lhs < rhs);
+                });
+
+            // Hull as a doubly linked list, plus a hash on the angle around the center to find a visible edge fast
+            mHashSize = std::max(1, int(std::ceil(std::sqrt(double(count)))));
+            mHullPrev.assign(count, 0);
+            mHullNext.assign(count, 0);
+            mHullTri.assign(count, 0);
+            mHullHash.assign(mHashSize, -1);
+
+            mHullStart = i0;
+            mHullNext[i0] = mHullPrev[i2] = i1;
+            mHullNext[i1] = mHullPrev[i0] = i2;
+            mHullNext[i2] = mHullPrev[i1] = i0;
+            mHullTri[i0] = 0;
+            mHullTri[i1] = 1;
+            mHullTri[i2] = 2;
+            mHullHash[HashKey(X(i0), Y(i0))] = i0;
+            mHullHash[HashKey(X(i1), Y(i1))] = i1;
+            mHullHash[HashKey(X(i2), Y(i2))] = i2;
+
+            int maxTriangles = std::max(2 * count - 5, 1);
+            mTriangles.reserve(size_t(maxTriangles) * 3);
+            mHalfedges.reserve(size_t(maxTriangles) * 3);
+            AddTriangle(i0, i1, i2, -1, -1, -1);
+
+            double previousX = 0.0;
+            double previousY = 0.0;
+            for (int k = 0; k < count; ++k)
+            {
+                int point = order[k];
+                double x = X(point);
+                double y = Y(point);
+
+                if (k > 0 && x == previousX && y == previousY)
+                {
+                    continue;
+                }
+                previousX = x;
+                previousY = y;
+
+                if (point == i0 || point == i1 || point == i2)
+                {
+                    continue;
+                }
+
+                // A hull edge the point can see, starting from the nearest hull point by angle
+                int start = 0;
+                int key = HashKey(x, y);
+                for (int j = 0; j < mHashSize; ++j)
+                {
+                    start = mHullHash[(key + j) % mHashSize];
+                    if (start != -1 && start != mHullNext[start])
+                    {
+                        break;
+                    }
+                }
+
+                start = mHullPrev[start];
+                int e = start;
+                int q = mHullNext[e];
+                while (!IsVisible(x, y, X(e), Y(e), X(q), Y(q)))
+                {
+                    e = q;
+                    if (e == start)
+                    {
+                        e = -1;
+                        break;
+                    }
+                    q = mHullNext[e];
+                }
+                if (e == -1)
+                {
+                    continue;
+                }
+
+                // Fan out to every hull edge the point sees, forward then backward
+                int t = AddTriangle(e, point, mHullNext[e], -1, -1, mHullTri[e]);
+                mHullTri[point] = Legalize(t + 2);
+                mHullTri[e] = t;
+
+                int n = mHullNext[e];
+                q = mHullNext[n];
+                while (IsVisible(x, y, X(n), Y(n), X(q), Y(q)))
+                {
+                    t = AddTriangle(n, point, q, mHullTri[point], -1, mHullTri[n]);
+                    mHullTri[point] = Legalize(t + 2);
+                    mHullNext[n] = n;
+                    n = q;
+                    q = mHullNext[n];
+                }
+
+                if (e == start)
+                {
+                    q = mHullPrev[e];
+                    while (IsVisible(x, y, X(q), Y(q), X(e), Y(e)))
+                    {
+                        t = AddTriangle(q, point, e, -1, mHullTri[e], mHullTri[q]);
+                        Legalize(t + 2);
+                        mHullTri[q] = t;
+                        mHullNext[e] = e;
+                        e = q;
+                        q = mHullPrev[e];
+                    }
+                }
+
+                mHullStart = mHullPrev[point] = e;
+                mHullNext[e] = mHullPrev[n] = point;
+                mHullNext[point] = n;
+
+                mHullHash[HashKey(x, y)] = point;
+                mHullHash[HashKey(X(e), Y(e))] = e;
+            }
+            return true;
+        }
+
+    private:
+        double X(int point) const { return (*mpCoords)[2 * point]; }
+        double Y(int point) const { return (*mpCoords)[2 * point + 1]; }
+
+        static double DistanceSquared(double ax, double ay, double bx, double by)
+        {
+            double dx = ax - bx;
+            double dy = ay - by;
+            return dx * dx + dy * dy;
+        }
+
+        // True when r is on the outer side of the edge p to q, i.e. the edge is visible from r
+        static bool IsVisible(double rx, double ry, double px, double py, double qx, double qy)
+        {
+            return (qy - py) * (rx - qx) - (qx - px) * (ry - qy) < 0.0;
+        }
+
+        static bool IsInCircle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+        {
+            double dx = ax - px;
+            double dy = ay - py;
+            double ex = bx - px;
+            double ey = by - py;
+            double fx = cx - px;
+            double fy = cy - py;
+            double ap = dx * dx + dy * dy;
+            double bp = ex * ex + ey * ey;
+            double cp = fx * fx + fy * fy;
+            return dx * (ey * cp - bp * fy) - dy * (ex * cp - bp * fx) + ap * (ex * fy - ey * fx) < 0.0;
+        }
+
+        static double Circumradius(double ax, double ay, double bx, double by, double cx, double cy)
+        {
+            double dx = bx - ax;
+            double dy = by - ay;
+            double ex = cx - ax;
+            double ey = cy - ay;
+            double cross = dx * ey - dy * ex;
+            if (cross == 0.0)
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+            double bl = dx * dx + dy * dy;
+            double cl = ex * ex + ey * ey;
+            double d = 0.5 / cross;
+            double x = (ey * bl - dy * cl) * d;
+            double y = (dx * cl - ex * bl) * d;
+            return x * x + y * y;
+        }
+
+        static void Circumcenter(double ax, double ay, double bx, double by, double cx, double cy, double & outX, double & outY)
+        {
+            double dx = bx - ax;
+            double dy = by - ay;
+            double ex = cx - ax;
+            double ey = cy - ay;
+            double bl = dx * dx + dy * dy;
+            double cl = ex * ex + ey * ey;
+            double d = 0.5 / (dx * ey - dy * ex);
+            outX = ax + (ey * bl - dy * cl) * d;
+            outY = ay + (dx * cl - ex * bl) * d;
+        }
+
+        int HashKey(double x, double y) const
+        {
+            // Monotonic in the angle around the center without any trigonometry
+            double dx = x - mCenterX;
+            double dy = y - mCenterY;
+            double sum = std::abs(dx) + std::abs(dy);
+            double p = sum > 0.0 ? dx / sum : 0.0;
+            double angle = (dy > 0.0 ? 3.0 - p : 1.0 + p) / 4.0;
+            return int(std::floor(angle * mHashSize)) % mHashSize;
+        }
+
+        void Link(int a, int b)
+        {
+            mHalfedges[a] = b;
+            if (b != -1)
+            {
+                mHalfedges[b] = a;
+            }
+        }
+
+        int AddTriangle(int i0, int i1, int i2, int a, int b, int c)
+        {
+            int t = int(mTriangles.size());
+            mTriangles.push_back(i0);
+            mTriangles.push_back(i1);
+            mTriangles.push_back(i2);
+            mHalfedges.resize(mTriangles.size(), -1);
+            Link(t, a);
+            Link(t + 1, b);
+            Link(t + 2, c);
+            return t;
+        }
+
+        // Flips edge a and the edges behind it until they are all locally Delaunay. Returns the halfedge that now
+        // holds a's place in its triangle.
+        int Legalize(int a)
+        {
+            int stackSize = 0;
+            int ar = 0;
+            while (true)
+            {
+                int b = mHalfedges[a];
+                int a0 = a - a % 3;
+                ar = a0 + (a + 2) % 3;
+
+                if (b == -1)
+                {
+                    if (stackSize == 0)
+                    {
+                        break;
+                    }
+                    a = mEdgeStack[--stackSize];
+                    continue;
+                }
+
+                int b0 = b - b % 3;
+                int al = a0 + (a + 1) % 3;
+                int bl = b0 + (b + 2) % 3;
+
+                int p0 = mTriangles[ar];
+                int pr = mTriangles[a];
+                int pl = mTriangles[al];
+                int p1 = mTriangles[bl];
+
+                if (IsInCircle(X(p0), Y(p0), X(pr), Y(pr), X(pl), Y(pl), X(p1), Y(p1)))
+                {
+                    mTriangles[a] = p1;
+                    mTriangles[b] = p0;
+
+                    int hbl = mHalfedges[bl];
+
+                    // The flipped edge was on the hull, point the hull at its new halfedge
+                    if (hbl == -1)
+                    {
+                        int e = mHullStart;
+                        do
+                        {
+                            if (mHullTri[e] == bl)
+                            {
+                                mHullTri[e] = a;
+                                break;
+                            }
+                            e = mHullPrev[e];
+                        } while (e != mHullStart);
+                    }
+                    Link(a, hbl);
+                    Link(b, mHalfedges[ar]);
+                    Link(ar, bl);
+
+                    int br = b0 + (b + 1) % 3;
+                    if (stackSize < int(std::size(mEdgeStack)))
+                    {
+                        mEdgeStack[stackSize++] = br;
+                    }
+                }
+                else
+                {
+                    if (stackSize == 0)
+                    {
+                        break;
+                    }
+                    a = mEdgeStack[--stackSize];
+                }
+            }
+            return ar;
+        }
+
+        const std::vector<double> * mpCoords = nullptr;
+        double mCenterX = 0.0;
+        double mCenterY = 0.0;
+        int mHashSize = 0;
+        int mHullStart = 0;
+        std::vector<int> mHullPrev;
+        std::vector<int> mHullNext;
+        std::vector<int> mHullTri;
+        std::vector<int> mHullHash;
+        int mEdgeStack[512];
+    };
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    struct CandidateEdge
+    {
+        int mRoomA;
+        int mRoomB;
+        int64_t mLengthSquared;
+
+        bool operator<(const CandidateEdge & other) const
+        {
+            // Ties broken by index so the tree does not depend on the sort implementation
+            if (mLengthSquared != other.mLengthSquared)
+            {
+                return mLengthSquared < other.mLengthSquared;
+            }
+            return mRoomA != other.mRoomA ? mRoomA < other.mRoomA : mRoomB < other.mRoomB;
+        }
+    };
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Room
+//------------------------------------------------------------------------------------------------------------------------
+
+Room::Room(int x, int y, int width, int height)
+    : x(x)
+    , y(y)
+    , width(width)
+    , height(height)
+    , centerX(x + width / 2)
+    , centerY(y + height / 2)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Connection
+//------------------------------------------------------------------------------------------------------------------------
+
+Connection::Connection(int a, int b, float dist)
+    : roomA(a)
+    , roomB(b)
+    , distance(dist)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// DungeonGenerator
+//------------------------------------------------------------------------------------------------------------------------
+
+DungeonGenerator::DungeonGenerator(JobSystem * pJobSystem)
+    : mpJobSystem(pJobSystem)
+    , mRandomState(1)
+    , mGrid()
+    , mRooms()
+    , mConnections()
+    , mStats()
+    , mBandRooms()
+    , mBandConnections()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void DungeonGenerator::Generate(const DungeonSettings & settings)
+{
+    // Spread the seed over all the bits, xorshift never leaves zero
+    mRandomState = settings.mSeed * 0x9E3779B9u ^ 0x85EBCA6Bu;
+    if (mRandomState == 0)
+    {
+        mRandomState = 1;
+    }
+    mStats = DungeonStats();
+
+    StopWatch stopWatch;
+    PlaceRooms(settings);
+    mStats.mPlaceMilliseconds = stopWatch.GetElapsedMilliseconds();
+
+    stopWatch.Reset();
+    ConnectRooms(settings);
+    mStats.mConnectMilliseconds = stopWatch.GetElapsedMilliseconds();
+
+    stopWatch.Reset();
+    mGrid.Resize(settings.mWidth, settings.mHeight, EDungeonPiece::Empty);
+    CarveBands();
+    mStats.mCarveMilliseconds = stopWatch.GetElapsedMilliseconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void DungeonGenerator::CarveCorridor(int fromX, int fromY, int toX, int toY)
+{
+    auto carve = [this](int x, int y)
+        {
+            if (mGrid.IsInBounds(x, y) && mGrid(x, y) == EDungeonPiece::Empty)
+            {
+                mGrid(x, y) = EDungeonPiece::Path;
+            }
+        };
+
+    for (int x = std::min(fromX, toX); x <= std::max(fromX, toX); ++x)
+    {
+        carve(x, fromY);
+    }
+    for (int y = std::min(fromY, toY); y <= std::max(fromY, toY); ++y)
+    {
+        carve(toX, y);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void DungeonGenerator::PlaceRooms(const DungeonSettings & settings)
+{
+    mRooms.clear();
+
+    int minSize = std::max(1, settings.mRoomMinSize);
+    int maxSize = std::max(minSize, settings.mRoomMaxSize);
+    int spacing = std::max(0, settings.mRoomSpacing);
+
+    // A one tile wall stays around the edge of the map
+    if (settings.mWidth < maxSize + 2 || settings.mHeight < maxSize + 2)
+    {
+        return;
+    }
+
+    // Rooms are filed by the cell their corner is in. A cell is as big as a room plus its spacing, so only rooms in
+    // the cells around a try can overlap it.
+    int cellSize = maxSize + spacing;
+    int cellsX = settings.mWidth / cellSize + 1;
+    int cellsY = settings.mHeight / cellSize + 1;
+    std::vector<int> cellFirstRoom(size_t(cellsX) * cellsY, -1);
+    std::vector<int> nextRoomInCell;
+
+    int attemptsLeft = settings.mRoomCount * std::max(1, settings.mPlacementAttempts);
+    while (int(mRooms.size()) < settings.mRoomCount && attemptsLeft-- > 0)
+    {
+        int width = RandomRange(mRandomState, minSize, maxSize);
+        int height = RandomRange(mRandomState, minSize, maxSize);
+        int x = RandomRange(mRandomState, 1, settings.mWidth - width - 1);
+        int y = RandomRange(mRandomState, 1, settings.mHeight - height - 1);
+
+        int firstCellX = std::max(0, (x - maxSize - spacing) / cellSize);
+        int firstCellY = std::max(0, (y - maxSize - spacing) / cellSize);
+        int lastCellX = std::min(cellsX - 1, (x + width + spacing) / cellSize);
+        int lastCellY = std::min(cellsY - 1, (y + height + spacing) / cellSize);
+
+        bool overlaps = false;
+        for (int cellY = firstCellY; cellY <= lastCellY && !overlaps; ++cellY)
+        {
+            for (int cellX = firstCellX; cellX <= lastCellX && !overlaps; ++cellX)
+            {
+                for (int other = cellFirstRoom[cellY * cellsX + cellX]; other != -1; other = nextRoomInCell[other])
+                {
+                    const Room & room = mRooms[other];
+                    if (x < room.x + room.width + spacing && room.x < x + width + spacing &&
+                        y < room.y + room.height + spacing && room.y < y + height + spacing)
+                    {
+                        overlaps = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (overlaps)
+        {
+            continue;
+        }
+
+        int cell = (y / cellSize) * cellsX + x / cellSize;
+        nextRoomInCell.push_back(cellFirstRoom[cell]);
+        cellFirstRoom[cell] = int(mRooms.size());
+        mRooms.emplace_back(x, y, width, height);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void DungeonGenerator::ConnectRooms(const DungeonSettings & settings)
+{
+    mConnections.clear();
+    int roomCount = int(mRooms.size());
+    if (roomCount < 2)
+    {
+        return;
+    }
+
+    std::vector<double> coords(size_t(roomCount) * 2);
+    for (int room = 0; room < roomCount; ++room)
+    {
+        coords[2 * room] = mRooms[room].centerX;
+        coords[2 * room + 1] = mRooms[room].centerY;
+    }
+
+    auto makeEdge = [this](int a, int b)
+        {
+            int64_t dx = mRooms[b].centerX - mRooms[a].centerX;
+            int64_t dy = mRooms[b].centerY - mRooms[a].centerY;
+            return CandidateEdge{ std::min(a, b), std::max(a, b), dx * dx + dy * dy };
+        };
+
+    // Every Delaunay edge once, from the halfedge with the larger index. All rooms on one line only need each
+    // neighbor along it.
+    std::vector<CandidateEdge> edges;
+    DelaunayTriangulation triangulation;
+    if (triangulation.Triangulate(coords))
+    {
+        const auto & triangles = triangulation.mTriangles;
+        const auto & halfedges = triangulation.mHalfedges;
+        mStats.mTriangleCount = int(triangles.size() / 3);
+        edges.reserve(triangles.size() / 2 + 1);
+        for (int e = 0; e < int(triangles.size()); ++e)
+        {
+            if (e > halfedges[e])
+            {
+                int next = (e % 3 == 2) ? e - 2 : e + 1;
+                edges.push_back(makeEdge(triangles[e], triangles[next]));
+            }
+        }
+    }
+    else
+    {
+        std::vector<int> order(roomCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [this](int lhs, int rhs)
+            {
+                return mRooms[lhs].centerX != mRooms[rhs].centerX ?
+                    mRooms[lhs].centerX < mRooms[rhs].centerX : mRooms[lhs].centerY < mRooms[rhs].centerY;
+            });
+        for (int i = 1; i < roomCount; ++i)
+        {
+            edges.push_back(makeEdge(order[i - 1], order[i]));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // Kruskal over the triangulation, then a seeded share of what is left for loops
+    std::vector<int> parents(roomCount);
+    std::iota(parents.begin(), parents.end(), 0);
+    for (const CandidateEdge & edge : edges)
+    {
+        int rootA = FindRoot(parents, edge.mRoomA);
+        int rootB = FindRoot(parents, edge.mRoomB);
+        bool isTreeEdge = rootA != rootB;
+        if (isTreeEdge)
+        {
+            parents[rootA] = rootB;
+        }
+
+        if (isTreeEdge || RandomUnit(mRandomState) < settings.mLoopChance)
+        {
+            mConnections.emplace_back(edge.mRoomA, edge.mRoomB, std::sqrt(float(edge.mLengthSquared)));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void DungeonGenerator::CarveBands()
+{
+    int bandCount = (mGrid.GetHeight() + skBandHeight - 1) / skBandHeight;
+    mBandRooms.resize(bandCount);
+    mBandConnections.resize(bandCount);
+    for (int band = 0; band < bandCount; ++band)
+    {
+        mBandRooms[band].clear();
+        mBandConnections[band].clear();
+    }
+    if (bandCount == 0)
+    {
+        return;
+    }
+
+    for (int room = 0; room < int(mRooms.size()); ++room)
+    {
+        const Room & carved = mRooms[room];
+        for (int band = carved.y / skBandHeight; band <= (carved.y + carved.height - 1) / skBandHeight; ++band)
+        {
+            mBandRooms[band].push_back(room);
+        }
+    }
+
+    // Corridors run along room A's center row, then down room B's center column
+    for (int connection = 0; connection < int(mConnections.size()); ++connection)
+    {
+        const Room & roomA = mRooms[mConnections[connection].roomA];
+        const Room & roomB = mRooms[mConnections[connection].roomB];
+        int top = std::min(roomA.centerY, roomB.centerY);
+        int bottom = std::max(roomA.centerY, roomB.centerY);
+        for (int band = top / skBandHeight; band <= bottom / skBandHeight; ++band)
+        {
+            mBandConnections[band].push_back(connection);
+        }
+    }
+
+    auto carveRange = [this](int begin, int end)
+        {
+            for (int band = begin; band < end; ++band)
+            {
+                CarveBand(band);
+            }
+        };
+
+    if (mpJobSystem)
+    {
+        mpJobSystem->ParallelFor(bandCount, 1, carveRange);
+    }
+    else
+    {
+        carveRange(0, bandCount);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void DungeonGenerator::CarveBand(int band)
+{
+    int bandTop = band * skBandHeight;
+    int bandBottom = std::min(bandTop + skBandHeight, mGrid.GetHeight()) - 1;
+
+    // Rooms first, corridors only break through rock so the order inside a band does not matter
+    for (int roomIndex : mBandRooms[band])
+    {
+        const Room & room = mRooms[roomIndex];
+        int top = std::max(room.y, bandTop);
+        int bottom = std::min(room.y + room.height - 1, bandBottom);
+        for (int y = top; y <= bottom; ++y)
+        {
+            EDungeonPiece * pRow = &mGrid(room.x, y);
+            std::fill(pRow, pRow + room.width, EDungeonPiece::Brick);
+        }
+    }
+
+    auto carveCorridor = [this](int x, int y)
+        {
+            EDungeonPiece & piece = mGrid(x, y);
+            if (piece == EDungeonPiece::Empty)
+            {
+                piece = EDungeonPiece::Path;
+            }
+        };
+
+    for (int connectionIndex : mBandConnections[band])
+    {
+        const Connection & connection = mConnections[connectionIndex];
+        const Room & roomA = mRooms[connection.roomA];
+        const Room & roomB = mRooms[connection.roomB];
+
+        if (roomA.centerY >= bandTop && roomA.centerY <= bandBottom)
+        {
+            int left = std::min(roomA.centerX, roomB.centerX);
+            int right = std::max(roomA.centerX, roomB.centerX);
+            for (int x = left; x <= right; ++x)
+            {
+                carveCorridor(x, roomA.centerY);
+            }
+        }
+
+        int top = std::max(std::min(roomA.centerY, roomB.centerY), bandTop);
+        int bottom = std::min(std::max(roomA.centerY, roomB.centerY), bandBottom);
+        for (int y = top; y <= bottom; ++y)
+        {
+            carveCorridor(roomB.centerX, y);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Grid2D.h"
+
+class JobSystem;
+
+enum class EDungeonPiece : unsigned char
+{
+    Empty,
+    Water,
+    Path,
+    Brick
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+struct Room
+{
+    int x;
+    int y;
+    int width;
+    int height;
+    int centerX;
+    int centerY;
+
+    Room(int x, int y, int width, int height);
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+struct Connection
+{
+    int roomA;
+    int roomB;
+    float distance;
+
+    Connection(int a, int b, float dist);
+
+    bool operator<(const Connection & other) const
+    {
+        return distance < other.distance;
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+struct DungeonSettings
+{
+    uint32_t mSeed = 1;
+    int mRoomCount = 60;
+    int mWidth = 256;
+    int mHeight = 256;
+    int mRoomMinSize = 5;
+    int mRoomMaxSize = 14;
+    int mRoomSpacing = 3;           // Tiles of rock kept between any two rooms
+    int mPlacementAttempts = 30;    // Tries per room before the generator settles for fewer rooms
+    float mLoopChance = 0.15f;      // Share of the non tree edges that are carved too, so not every route is unique
+};
+
+struct DungeonStats
+{
+    float mPlaceMilliseconds = 0.f;
+    float mConnectMilliseconds = 0.f;
+    float mCarveMilliseconds = 0.f;
+    int mTriangleCount = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// DungeonGenerator
+//
+// Rooms and corridors from a seed, the same settings always give the same map. Rooms are placed by rejection sampling
+// against a coarse grid of the rooms so far, so a try only looks at its neighbors. Room centers are Delaunay
+// triangulated (sweep hull, O(n log n)) and the triangle edges are the only corridor candidates: their minimum
+// spanning tree connects every room and a seeded share of the rest adds loops. Carving is split into horizontal bands
+// that are filled on the JobSystem, each band only touches its own rows.
+//------------------------------------------------------------------------------------------------------------------------
+
+class DungeonGenerator
+{
+public:
+    // pJobSystem may be null to carve on the calling thread
+    explicit DungeonGenerator(JobSystem * pJobSystem);
+
+    void Generate(const DungeonSettings & settings);
+
+    // Breaks through rock along row fromY to column toX, then down that column to toY. For corridors added after
+    // Generate, such as ones out to a doorway on the edge of the map.
+    void CarveCorridor(int fromX, int fromY, int toX, int toY);
+
+    const Grid2D<EDungeonPiece> & GetGrid() const { return mGrid; }
+    const std::vector<Room> & GetRooms() const { return mRooms; }
+    const std::vector<Connection> & GetConnections() const { return mConnections; }
+    const DungeonStats & GetStats() const { return mStats; }
+
+private:
+    void PlaceRooms(const DungeonSettings & settings);
+    void ConnectRooms(const DungeonSettings & settings);
+    void CarveBands();
+    void CarveBand(int band);
+
+    JobSystem * mpJobSystem;
+    uint32_t mRandomState;
+
+    Grid2D<EDungeonPiece> mGrid;
+    std::vector<Room> mRooms;
+    std::vector<Connection> mConnections;
+    DungeonStats mStats;
+
+    // Room and corridor indices that touch each band of rows, rebuilt every Generate
+    std::vector<std::vector<int>> mBandRooms;
+    std::vector<std::vector<int>> mBandConnections;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -1,220 +1,416 @@
 #include "AstroidsPrivate.h"
 #include "DungeonManager.h"
-#include <unordered_map>
+#include "LevelManager.h"
+#include "LevelCook.h"
+#include "PlayerManager.h"
+#include "WaveFunctionCollapse.h"
+#include "BDConfig.h"
 #include <algorithm>
-#include <cstdlib>
-#include <ctime>
-#include <cmath>
-#include <queue>
 #include <climits>
-#include <unordered_set>
-#include <numeric>
+#include <iostream>
+#include <imgui.h>
+
+namespace
+{
+    // Generated levels use the Tiles tileset (first gid 1). Its wall tile is marked unwalkable in the .tsx, which is
+    // what makes it solid and opaque once cooked.
+    const char * skTilesetPath = "../Tiled/Tiles.tsx";
+    const uint32_t skWallGid = 35;
+    const uint32_t skCorridorGid = 130;
+    const uint32_t skRoomFloorGid = 131;
+
+    const int skBenchmarkRoomCount = 10000;
+    const int skBenchmarkMapSize = 2048;
+    const int skWfcBenchmarkMapSize = 512;
+    const int skCaveBenchmarkMapSize = 4096;
+}
 
 //------------------------------------------------------------------------------------------------------------------------
-// Room
+// DungeonManager
 //------------------------------------------------------------------------------------------------------------------------
 
-Room::Room(int x, int y, int width, int height)
-    : x(x)
-    , y(y)
-    , width(width)
-    , height(height)
-    , centerX(x + width / 2)
-    , centerY(y + height / 2)
+DungeonManager::DungeonManager(GameManager * pGameManager, int roomCount, int gridWidth, int gridHeight, int minSize, int maxSize)
+    : BaseManager(pGameManager)
+    , mSettings()
+    , mGenerator(&pGameManager->GetJobSystem())
+    , mBenchmarkStats()
+    , mBenchmarkMilliseconds(0.f)
+    , mBenchmarkRoomCount(0)
+    , mTileRules()
+    , mWfcStats()
+    , mCaveStats()
+    , mCaveMilliseconds(0.f)
+    , mCaveSize(0)
 {
+    mSettings.mRoomCount = roomCount;
+    mSettings.mWidth = gridWidth;
+    mSettings.mHeight = gridHeight;
+    mSettings.mRoomMinSize = minSize;
+    mSettings.mRoomMaxSize = maxSize;
+
+    std::string error;
+    if (!mTileRules.LoadFromTileset(skTilesetPath, error))
+    {
+        std::cerr << error << ", using the built in piece rules" << std::endl;
+        BuildPieceRules();
+    }
+    mGenerator.Generate(mSettings);
 }
 
-//------------------------------------------------------------------------------------------------------------------------
-// Connection
 //------------------------------------------------------------------------------------------------------------------------
 
-Connection::Connection(int a, int b, float dist)
-    : roomA(a)
-    , roomB(b)
-    , distance(dist)
+void DungeonManager::BuildPieceRules()
 {
+    // Rock goes next to anything, water stays out of rooms and corridors
+    static const std::pair<EDungeonPiece, EDungeonPiece> skNeighborRules[] =
+    {
+        { EDungeonPiece::Empty, EDungeonPiece::Empty },
+        { EDungeonPiece::Empty, EDungeonPiece::Water },
+        { EDungeonPiece::Empty, EDungeonPiece::Path },
+        { EDungeonPiece::Empty, EDungeonPiece::Brick },
+        { EDungeonPiece::Water, EDungeonPiece::Water },
+        { EDungeonPiece::Path, EDungeonPiece::Path },
+        { EDungeonPiece::Path, EDungeonPiece::Brick },
+        { EDungeonPiece::Brick, EDungeonPiece::Brick },
+    };
+
+    // One rule tile per piece in enum order, tile ids are tileset ids like the ones loaded from a .tsx
+    mTileRules = WfcRules();
+    for (EDungeonPiece piece : { EDungeonPiece::Empty, EDungeonPiece::Water, EDungeonPiece::Path, EDungeonPiece::Brick })
+    {
+        mTileRules.AddTile(GetPieceGid(piece) - 1, 1.f);
+    }
+    for (const auto & rule : skNeighborRules)
+    {
+        for (EWfcDirection direction : { EWfcDirection::Up, EWfcDirection::Right, EWfcDirection::Down, EWfcDirection::Left })
+        {
+            mTileRules.Allow(int(rule.first), direction, int(rule.second));
+        }
+    }
 }
 
-//------------------------------------------------------------------------------------------------------------------------
-// DungeonManager
 //------------------------------------------------------------------------------------------------------------------------
 
-DungeonManager::DungeonManager(GameManager * pGameManager, int roomCount, int gridWidth, int gridHeight, int minSize, int maxSize)
-    : BaseManager(pGameManager)
-    , mRoomCount(roomCount)
-    , mGridWidth(gridWidth)
-    , mGridHeight(gridHeight)
-    , mRoomMinSize(minSize)
-    , mRoomMaxSize(maxSize)
-    , mDungeonGrid()
+uint32_t DungeonManager::GetPieceGid(EDungeonPiece piece)
 {
-    mNeighborRules = {
-        { EDungeonPiece::Water, { EDungeonPiece::Water, EDungeonPiece::Brick, EDungeonPiece::Path, EDungeonPiece::Empty } },
-        { EDungeonPiece::Brick, { EDungeonPiece::Brick, EDungeonPiece::Water, EDungeonPiece::Path, EDungeonPiece::Empty } },
-        { EDungeonPiece::Path,  { EDungeonPiece::Brick, EDungeonPiece::Water, EDungeonPiece::Path, EDungeonPiece::Empty } }
-        };
-    GenerateRooms();
-    GenerateConnections();
+    switch (piece)
+    {
+        case EDungeonPiece::Path: return skCorridorGid;
+        case EDungeonPiece::Brick: return skRoomFloorGid;
+        default: return skWallGid;
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-float DungeonManager::CalculateDistance(int x1, int y1, int x2, int y2)
+const char * DungeonManager::GetTilesetPath()
 {
-    return float(std::sqrt(std::pow(x2 - x1, 2) + std::pow(y2 - y1, 2)));
+    return skTilesetPath;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void DungeonManager::GenerateRooms()
+bool DungeonManager::GenerateLevel(uint32_t seed)
 {
-    mRooms.clear();
-    mDungeonGrid.assign(mGridHeight, std::vector<EDungeonPiece>(mGridWidth, EDungeonPiece::Empty));
-    srand(static_cast<unsigned>(time(nullptr)));
+    mSettings.mSeed = seed;
+    mGenerator.Generate(mSettings);
 
-    for (int i = 0; i < mRoomCount; ++i)
+    const Grid2D<EDungeonPiece> & grid = mGenerator.GetGrid();
+    std::vector<uint32_t> tiles(grid.GetCellCount());
+    const EDungeonPiece * pPieces = grid.GetData();
+    for (size_t cell = 0; cell < tiles.size(); ++cell)
     {
-        int width = rand() % (mRoomMaxSize - mRoomMinSize + 1) + mRoomMinSize;
-        int height = rand() % (mRoomMaxSize - mRoomMinSize + 1) + mRoomMinSize;
-        int x = rand() % (mGridWidth - width);
-        int y = rand() % (mGridHeight - height);
+        tiles[cell] = GetPieceGid(pPieces[cell]);
+    }
 
-        Room newRoom(x, y, width, height);
+    const std::vector<Room> & rooms = mGenerator.GetRooms();
+    sf::Vector2i startTile = rooms.empty() ? sf::Vector2i(grid.GetWidth() / 2, grid.GetHeight() / 2) :
+        sf::Vector2i(rooms[0].centerX, rooms[0].centerY);
+    return LoadTiles(grid.GetWidth(), grid.GetHeight(), tiles, &startTile);
+}
 
-        for (int row = y - 1; row <= y + height; ++row)
-        {
-            for (int col = x - 1; col <= x + width; ++col)
-            {
-                if (row >= 0 && row < mGridHeight && col >= 0 && col < mGridWidth)
-                {
-                    if (row == y - 1 || row == y + height || col == x - 1 || col == x + width)
-                    {
-                        if (mDungeonGrid[row][col] == EDungeonPiece::Empty)
-                        {
-                            mDungeonGrid[row][col] = EDungeonPiece::Water;
-                        }
-                    }
-                    else
-                    {
-                        mDungeonGrid[row][col] = EDungeonPiece::Brick;
-                    }
-                }
-            }
-        }
+//------------------------------------------------------------------------------------------------------------------------
+
+bool DungeonManager::GenerateWfcLevel(uint32_t seed)
+{
+    mSettings.mSeed = seed;
 
-        mRooms.push_back(newRoom);
+    WfcSettings settings;
+    settings.mSeed = seed;
+    settings.mWidth = mSettings.mWidth;
+    settings.mHeight = mSettings.mHeight;
+
+    WfcSolver solver(mTileRules);
+    bool isSolved = solver.Solve(settings);
+    mWfcStats = solver.GetStats();
+    if (!isSolved)
+    {
+        std::cerr << "Wave function collapse found no level for seed " << seed << std::endl;
+        return false;
     }
+
+    const uint8_t * pResult = solver.GetResult().GetData();
+    std::vector<uint32_t> tiles(size_t(settings.mWidth) * settings.mHeight);
+    for (size_t cell = 0; cell < tiles.size(); ++cell)
+    {
+        tiles[cell] = mTileRules.GetTileId(pResult[cell]) + 1;
+    }
+
+    // There are no rooms to start in, the players go to the walkable tile nearest the middle
+    return LoadTiles(settings.mWidth, settings.mHeight, tiles, nullptr);
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void DungeonManager::GenerateConnections()
+bool DungeonManager::GenerateCaveLevel(uint32_t seed)
 {
-    mConnections.clear();
-    std::vector<Connection> allConnections;
+    mSettings.mSeed = seed;
+
+    CaveSettings settings;
+    settings.mSeed = seed;
+    settings.mWidth = mSettings.mWidth;
+    settings.mHeight = mSettings.mHeight;
+
+    CaveGenerator generator(&GetGameManager().GetJobSystem());
+    StopWatch stopWatch;
+    generator.Generate(settings);
+    mCaveMilliseconds = stopWatch.GetElapsedMilliseconds();
+    mCaveStats = generator.GetStats();
+    mCaveSize = settings.mWidth;
+    if (generator.GetStartX() < 0)
+    {
+        return false;
+    }
 
-    // Create all possible connections
-    for (size_t i = 0; i < mRooms.size(); ++i)
+    const BitGrid & rock = generator.GetRock();
+    uint32_t rockGid = GetPieceGid(EDungeonPiece::Empty);
+    uint32_t floorGid = GetPieceGid(EDungeonPiece::Brick);
+    std::vector<uint32_t> tiles(size_t(settings.mWidth) * settings.mHeight);
+    for (int y = 0; y < settings.mHeight; ++y)
     {
-        for (size_t j = i + 1; j < mRooms.size(); ++j)
+        uint32_t * pRow = &tiles[size_t(y) * settings.mWidth];
+        for (int x = 0; x < settings.mWidth; ++x)
         {
-            float distance = CalculateDistance(mRooms[i].centerX, mRooms[i].centerY,
-                mRooms[j].centerX, mRooms[j].centerY);
-            allConnections.emplace_back(int(i), int(j), distance);
+            pRow[x] = rock.TestUnchecked(x, y) ? rockGid : floorGid;
         }
     }
 
-    // Sort connections by distance
-    std::sort(allConnections.begin(), allConnections.end());
+    sf::Vector2i startTile(generator.GetStartX(), generator.GetStartY());
+    return LoadTiles(settings.mWidth, settings.mHeight, tiles, &startTile);
+}
 
-    // Use MST (Kruskal's Algorithm) to ensure connectivity
-    std::vector<int> parent(mRooms.size());
-    std::iota(parent.begin(), parent.end(), 0); // Initialize disjoint set
+//------------------------------------------------------------------------------------------------------------------------
 
-    auto find = [&](int node) {
-        while (node != parent[node])
-        {
-            parent[node] = parent[parent[node]]; // Path compression
-            node = parent[node];
-        }
-        return node;
-        };
+bool DungeonManager::LoadTiles(int width, int height, const std::vector<uint32_t> & tiles, const sf::Vector2i * pStartTile)
+{
+    auto & gameManager = GetGameManager();
+    auto * pLevelManager = gameManager.GetManager<LevelManager>();
+    if (!pLevelManager)
+    {
+        return false;
+    }
 
-    auto unite = [&](int a, int b) {
-        parent[find(a)] = find(b);
-        };
+    std::vector<uint8_t> cookedBytes;
+    std::string error;
+    if (!CookTileGrid(skTilesetPath, uint32_t(width), uint32_t(height), tiles, LevelCookOptions(), cookedBytes, error))
+    {
+        std::cerr << error << std::endl;
+        return false;
+    }
+    if (!pLevelManager->LoadCookedBytes(std::move(cookedBytes)))
+    {
+        return false;
+    }
 
-    for (const auto & conn : allConnections)
+    sf::Vector2i startTile(width / 2, height / 2);
+    if (pStartTile)
     {
-        if (find(conn.roomA) != find(conn.roomB))
+        startTile = *pStartTile;
+    }
+    else
+    {
+        int bestDistance = INT_MAX;
+        for (int y = 0; y < height; ++y)
         {
-            mConnections.push_back(conn);
-
-            // Carve a path between the connected rooms
-            CreatePath(mRooms[conn.roomA].centerX, mRooms[conn.roomA].centerY,
-                mRooms[conn.roomB].centerX, mRooms[conn.roomB].centerY);
+            for (int x = 0; x < width; ++x)
+            {
+                int distance = std::abs(x - width / 2) + std::abs(y - height / 2);
+                if (distance < bestDistance && pLevelManager->IsTileWalkablePlayer(x, y))
+                {
+                    bestDistance = distance;
+                    startTile = sf::Vector2i(x, y);
+                }
+            }
+        }
+    }
 
-            unite(conn.roomA, conn.roomB);
+    if (auto * pPlayerManager = gameManager.GetManager<PlayerManager>())
+    {
+        sf::Vector2f startPosition((startTile.x + 0.5f) * BD::gsPixelCountCellSize,
+            (startTile.y + 0.5f) * BD::gsPixelCountCellSize);
+        for (BD::Handle playerHandle : pPlayerManager->GetPlayers())
+        {
+            if (GameObject * pPlayer = gameManager.GetGameObject(playerHandle))
+            {
+                pPlayer->SetPosition(startPosition);
+            }
         }
     }
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void DungeonManager::CreatePath(int startX, int startY, int endX, int endY)
+void DungeonManager::DebugImGuiInfo()
 {
-    int x = startX;
-    int y = startY;
+#if IMGUI_ENABLED()
+    ImGui::Begin("Dungeon");
 
-    // Horizontal path
-    while (x != endX)
+    int seed = int(mSettings.mSeed);
+    if (ImGui::InputInt("Seed", &seed))
+    {
+        mSettings.mSeed = uint32_t(seed);
+    }
+    if (ImGui::Button("Generate Level"))
+    {
+        GenerateLevel(mSettings.mSeed);
+    }
+    ImGui::Text("Rooms: %d  Corridors: %d", int(mGenerator.GetRooms().size()), int(mGenerator.GetConnections().size()));
+
+    ImGui::Separator();
+    if (ImGui::Button("Benchmark 10000 Rooms"))
+    {
+        RunBenchmark();
+    }
+    if (mBenchmarkRoomCount > 0)
+    {
+        ImGui::Text("%d rooms in %.2f ms", mBenchmarkRoomCount, mBenchmarkMilliseconds);
+        ImGui::Text("Place %.2f  Connect %.2f  Carve %.2f", mBenchmarkStats.mPlaceMilliseconds,
+            mBenchmarkStats.mConnectMilliseconds, mBenchmarkStats.mCarveMilliseconds);
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Wave function collapse: %d tiles", mTileRules.GetTileCount());
+    if (ImGui::Button("Generate WFC Level"))
+    {
+        GenerateWfcLevel(mSettings.mSeed);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark WFC 512x512"))
+    {
+        RunWfcBenchmark();
+    }
+    if (mWfcStats.mDecisionCount > 0)
     {
-        mDungeonGrid[y][x] = EDungeonPiece::Path;
-        x += (endX > x) ? 1 : -1;
+        ImGui::Text("%s in %.2f ms", mWfcStats.mIsSolved ? "Solved" : "Failed", mWfcStats.mMilliseconds);
+        ImGui::Text("Decisions %d  Backtracks %d  Narrowed %lld", mWfcStats.mDecisionCount, mWfcStats.mBacktrackCount,
+            (long long)mWfcStats.mNarrowCount);
     }
 
-    // Vertical path
-    while (y != endY)
+    ImGui::Separator();
+    if (ImGui::Button("Generate Cave Level"))
     {
-        mDungeonGrid[y][x] = EDungeonPiece::Path;
-        y += (endY > y) ? 1 : -1;
+        GenerateCaveLevel(mSettings.mSeed);
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Cave 4096x4096"))
+    {
+        RunCaveBenchmark();
+    }
+    if (mCaveSize > 0)
+    {
+        ImGui::Text("%dx%d in %.2f ms", mCaveSize, mCaveSize, mCaveMilliseconds);
+        ImGui::Text("Fill %.2f  Smooth %.2f  Regions %.2f", mCaveStats.mFillMilliseconds, mCaveStats.mSmoothMilliseconds,
+            mCaveStats.mRegionMilliseconds);
+        ImGui::Text("Regions %d  Filled %d  Tunnels %d", mCaveStats.mRegionCount, mCaveStats.mFilledRegionCount,
+            mCaveStats.mTunnelCount);
+    }
+
+    ImGui::End();
+#endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-bool DungeonManager::IsValidPlacement(int x, int y, EDungeonPiece type) const
+void DungeonManager::RunBenchmark()
 {
-    if (x < 0 || x >= mGridWidth || y < 0 || y >= mGridHeight) return false;
+    DungeonSettings settings = mSettings;
+    settings.mRoomCount = skBenchmarkRoomCount;
+    settings.mWidth = skBenchmarkMapSize;
+    settings.mHeight = skBenchmarkMapSize;
+
+    // Its own generator, so the benchmark leaves the current map alone
+    DungeonGenerator generator(&GetGameManager().GetJobSystem());
+    StopWatch stopWatch;
+    generator.Generate(settings);
+    mBenchmarkMilliseconds = stopWatch.GetElapsedMilliseconds();
+    mBenchmarkStats = generator.GetStats();
+    mBenchmarkRoomCount = int(generator.GetRooms().size());
+
+    printf("Dungeon benchmark: %d rooms, %d corridors, %d triangles on %dx%d in %.2f ms (place %.2f, connect %.2f, carve %.2f)\n",
+        mBenchmarkRoomCount, int(generator.GetConnections().size()), mBenchmarkStats.mTriangleCount, settings.mWidth,
+        settings.mHeight, mBenchmarkMilliseconds, mBenchmarkStats.mPlaceMilliseconds, mBenchmarkStats.mConnectMilliseconds,
+        mBenchmarkStats.mCarveMilliseconds);
+}
 
-    const auto & validNeighbors = mNeighborRules.at(type);
+//------------------------------------------------------------------------------------------------------------------------
 
-    // Check neighbors (up, right, down, left)
-    static const std::vector<std::pair<int, int>> directions = {
-        {0, -1}, {1, 0}, {0, 1}, {-1, 0}
-    };
+void DungeonManager::RunWfcBenchmark()
+{
+    WfcSettings settings;
+    settings.mSeed = mSettings.mSeed;
+    settings.mWidth = skWfcBenchmarkMapSize;
+    settings.mHeight = skWfcBenchmarkMapSize;
+
+    WfcSolver solver(mTileRules);
+    solver.Solve(settings);
+    mWfcStats = solver.GetStats();
+
+    printf("WFC benchmark: %s %dx%d with %d tiles in %.2f ms (%d decisions, %d backtracks, %lld narrowed)\n",
+        mWfcStats.mIsSolved ? "solved" : "failed", settings.mWidth, settings.mHeight, mTileRules.GetTileCount(),
+        mWfcStats.mMilliseconds, mWfcStats.mDecisionCount, mWfcStats.mBacktrackCount, (long long)mWfcStats.mNarrowCount);
+}
 
-    for (const auto & dir : directions)
-    {
-        int nx = x + dir.first;
-        int ny = y + dir.second;
+//------------------------------------------------------------------------------------------------------------------------
 
-        // Skip out-of-bounds neighbors
-        if (nx < 0 || nx >= mGridWidth || ny < 0 || ny >= mGridHeight) continue;
+void DungeonManager::RunCaveBenchmark()
+{
+    CaveSettings settings;
+    settings.mSeed = mSettings.mSeed;
+    settings.mWidth = skCaveBenchmarkMapSize;
+    settings.mHeight = skCaveBenchmarkMapSize;
+
+    CaveGenerator generator(&GetGameManager().GetJobSystem());
+    StopWatch stopWatch;
+    generator.Generate(settings);
+    mCaveMilliseconds = stopWatch.GetElapsedMilliseconds();
+    mCaveStats = generator.GetStats();
+    mCaveSize = settings.mWidth;
+
+    printf("Cave benchmark: %dx%d in %.2f ms (fill %.2f, smooth %.2f, regions %.2f), %d regions, %d filled, %d tunnels\n",
+        settings.mWidth, settings.mHeight, mCaveMilliseconds, mCaveStats.mFillMilliseconds, mCaveStats.mSmoothMilliseconds,
+        mCaveStats.mRegionMilliseconds, mCaveStats.mRegionCount, mCaveStats.mFilledRegionCount, mCaveStats.mTunnelCount);
+}
 
-        EDungeonPiece neighbor = mDungeonGrid[ny][nx];
-        if (std::find(validNeighbors.begin(), validNeighbors.end(), neighbor) == validNeighbors.end())
-        {
-            return false;
-        }
-    }
+//------------------------------------------------------------------------------------------------------------------------
 
-    return true;
+const Grid2D<EDungeonPiece> & DungeonManager::GetDungeonGrid() const
+{
+    return mGenerator.GetGrid();
 }
 
-const std::vector<std::vector<EDungeonPiece>> & DungeonManager::GetDungeonGrid() const
+//------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<Room> & DungeonManager::GetRooms() const
+{
+    return mGenerator.GetRooms();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint32_t DungeonManager::GetSeed() const
 {
-    return mDungeonGrid;
+    return mSettings.mSeed;
 }
 
 
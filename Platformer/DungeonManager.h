@@ -3,81 +3,70 @@
 #include <unordered_map>
 #include <string>
 #include "BaseManager.h"
-
-enum class EDungeonPiece : unsigned char
-{
-    Empty,
-    Water,
-    Path,
-    Brick
-};
+#include "Grid2D.h"
+#include "CaveGenerator.h"
+#include "DungeonGenerator.h"
+#include "WaveFunctionCollapse.h"
 
 //------------------------------------------------------------------------------------------------------------------------
 
-struct Room
+// Owns the DungeonGenerator and turns what it makes into a playable level: rooms, corridors and rock become tiles of
+// the shared Tiles tileset, which are cooked in memory and handed to the LevelManager like any other level.
+class BaseManager;
+class DungeonManager : public BaseManager
 {
-    int x;
-    int y;
-    int width;
-    int height;
-    int centerX;
-    int centerY;
-
-    Room(int x, int y, int width, int height);
-};
-
-//------------------------------------------------------------------------------------------------------------------------
+public:
 
-struct Connection
-{
-    int roomA;
-    int roomB;
-    float distance;
+    DungeonManager(GameManager * pGameManager, int roomCount, int gridWidth, int gridHeight, int minSize, int maxSize);
 
-    Connection(int a, int b, float dist);
+    // Generates the map for seed, loads it as the current level and moves the players into the first room
+    bool GenerateLevel(uint32_t seed);
 
-    bool operator<(const Connection & other) const
-    {
-        return distance < other.distance;
-    }
-};
+    // Solves a map of the same size with wave function collapse over the tileset's adjacency rules and loads it
+    bool GenerateWfcLevel(uint32_t seed);
 
-//------------------------------------------------------------------------------------------------------------------------
+    // Cellular automata caves of the same size, every open region joined to the largest one
+    bool GenerateCaveLevel(uint32_t seed);
 
-class BaseManager;
-class DungeonManager : public BaseManager
-{
-public:
+    const Grid2D<EDungeonPiece> & GetDungeonGrid() const;
+    const std::vector<Room> & GetRooms() const;
+    uint32_t GetSeed() const;
 
-    DungeonManager(GameManager * pGameManager, int roomCount, int gridWidth, int gridHeight, int minSize, int maxSize);
+    // The tile each piece becomes, in the tileset at GetTilesetPath
+    static uint32_t GetPieceGid(EDungeonPiece piece);
+    static const char * GetTilesetPath();
 
-    const std::vector<std::vector<EDungeonPiece>> & GetDungeonGrid() const;
+    // Seed controls and the room, WFC and cave benchmarks, drawn from the GameManager's ImGui pass
+    void DebugImGuiInfo();
 
 private:
-    
-    //void GenerateRooms();
-
-    float CalculateDistance(int x1, int y1, int x2, int y2);
 
-    void GenerateRooms();
+    // Fallback rules with one tile per EDungeonPiece, for when the tileset has none
+    void BuildPieceRules();
 
-    void GenerateConnections();
+    // Cooks and loads a width x height map of gids, the players start at pStartTile or near the middle when null
+    bool LoadTiles(int width, int height, const std::vector<uint32_t> & tiles, const sf::Vector2i * pStartTile);
 
-    void CreatePath(int startX, int startY, int endX, int endY);
+    void RunBenchmark();
+    void RunWfcBenchmark();
+    void RunCaveBenchmark();
 
-    bool IsValidPlacement(int x, int y, EDungeonPiece type) const;
+    DungeonSettings mSettings;
+    DungeonGenerator mGenerator;
 
-    int mRoomCount;
-    int mGridWidth;
-    int mGridHeight;
-    int mRoomMinSize;
-    int mRoomMaxSize;
+    // Last benchmark run, zero until one has been
+    DungeonStats mBenchmarkStats;
+    float mBenchmarkMilliseconds;
+    int mBenchmarkRoomCount;
 
-    std::unordered_map<EDungeonPiece, std::vector<EDungeonPiece>> mNeighborRules;
-    std::vector<std::vector<EDungeonPiece>> mDungeonGrid;
+    // Adjacency rules from the tileset, and the last WFC level or benchmark
+    WfcRules mTileRules;
+    WfcStats mWfcStats;
 
-    std::vector<Room> mRooms;
-    std::vector<Connection> mConnections;
+    // Last cave level or benchmark
+    CaveStats mCaveStats;
+    float mCaveMilliseconds;
+    int mCaveSize;
 };
 
 
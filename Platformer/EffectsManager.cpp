@@ -0,0 +1,246 @@
+#include "AstroidsPrivate.h"
+#include "EffectsManager.h"
+#include "CameraManager.h"
+
+namespace
+{
+    const int skMaxEffects = 1024;
+
+    BD::Handle PackEffectHandle(BD::uint32 slot, BD::uint32 version)
+    {
+        return (static_cast<BD::Handle>(version) << 32) | slot;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+EffectsManager::EffectsManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mClips()
+    , mClipDurations()
+    , mClipLookup()
+    , mClipVertices()
+    , mCount(0)
+{
+    mPositions.resize(skMaxEffects);
+    mScales.resize(skMaxEffects);
+    mElapsedTimes.resize(skMaxEffects);
+    mClipIndices.resize(skMaxEffects);
+    mDenseToSlot.resize(skMaxEffects);
+
+    mSlotToDense.resize(skMaxEffects);
+    mSlotVersions.assign(skMaxEffects, 0);
+    mFreeSlots.reserve(skMaxEffects);
+    for (int slot = skMaxEffects - 1; slot >= 0; --slot)
+    {
+        mFreeSlots.push_back(BD::uint32(slot));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+EffectsManager::~EffectsManager()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EffectsManager::Update(float deltaTime)
+{
+    for (int ii = 0; ii < mCount; ++ii)
+    {
+        mElapsedTimes[ii] += deltaTime;
+    }
+
+    // Walk backwards so the swap-remove never skips an element
+    for (int ii = mCount - 1; ii >= 0; --ii)
+    {
+        int clipIndex = mClipIndices[ii];
+        if (!mClips[clipIndex]->mLoop && mElapsedTimes[ii] >= mClipDurations[clipIndex])
+        {
+            RemoveAt(ii);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EffectsManager::Render(sf::RenderWindow & window)
+{
+    if (mCount == 0)
+    {
+        return;
+    }
+
+    sf::FloatRect viewBounds;
+    auto * pCameraManager = GetGameManager().GetManager<CameraManager>();
+    if (pCameraManager)
+    {
+        viewBounds = pCameraManager->GetViewBounds();
+    }
+
+    for (auto & vertices : mClipVertices)
+    {
+        vertices.clear();
+    }
+
+    for (int ii = 0; ii < mCount; ++ii)
+    {
+        const AnimationClip & clip = *mClips[mClipIndices[ii]];
+        const sf::IntRect & firstFrame = clip.mFrames[0];
+
+        sf::Vector2f halfSize(firstFrame.width * std::abs(mScales[ii].x) * 0.5f, firstFrame.height * std::abs(mScales[ii].y) * 0.5f);
+        sf::FloatRect bounds(mPositions[ii] - halfSize, halfSize * 2.f);
+        if (pCameraManager && !viewBounds.intersects(bounds))
+        {
+            continue; // Off-screen effects only advance their timer
+        }
+
+        const sf::IntRect & frame = clip.mFrames[clip.GetFrameIndex(mElapsedTimes[ii])];
+        float left = float(frame.left);
+        float top = float(frame.top);
+        float right = left + frame.width;
+        float bottom = top + frame.height;
+
+        sf::Vector2f topLeft = bounds.getPosition();
+        sf::Vector2f bottomRight = topLeft + bounds.getSize();
+
+        sf::VertexArray & vertices = mClipVertices[mClipIndices[ii]];
+        vertices.append(sf::Vertex(topLeft, sf::Vector2f(left, top)));
+        vertices.append(sf::Vertex(sf::Vector2f(bottomRight.x, topLeft.y), sf::Vector2f(right, top)));
+        vertices.append(sf::Vertex(bottomRight, sf::Vector2f(right, bottom)));
+        vertices.append(sf::Vertex(topLeft, sf::Vector2f(left, top)));
+        vertices.append(sf::Vertex(bottomRight, sf::Vector2f(right, bottom)));
+        vertices.append(sf::Vertex(sf::Vector2f(topLeft.x, bottomRight.y), sf::Vector2f(left, bottom)));
+    }
+
+    for (size_t clipIndex = 0; clipIndex < mClipVertices.size(); ++clipIndex)
+    {
+        if (mClipVertices[clipIndex].getVertexCount() > 0)
+        {
+            sf::RenderStates states(mClips[clipIndex]->mpSheet.get());
+            window.draw(mClipVertices[clipIndex], states);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EffectsManager::OnGameEnd()
+{
+    while (mCount > 0)
+    {
+        RemoveAt(mCount - 1);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle EffectsManager::PlayEffect(ResourceId & clipId, const sf::Vector2f & position, const sf::Vector2f & scale)
+{
+    int clipIndex = GetClipIndex(clipId);
+    if (clipIndex < 0 || mFreeSlots.empty())
+    {
+        return BD::Handle(0);
+    }
+
+    BD::uint32 slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+    ++mSlotVersions[slot];
+
+    int denseIndex = mCount++;
+    mPositions[denseIndex] = position;
+    mScales[denseIndex] = scale;
+    mElapsedTimes[denseIndex] = 0.f;
+    mClipIndices[denseIndex] = clipIndex;
+    mDenseToSlot[denseIndex] = slot;
+    mSlotToDense[slot] = BD::uint32(denseIndex);
+
+    return PackEffectHandle(slot, mSlotVersions[slot]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EffectsManager::StopEffect(BD::Handle handle)
+{
+    int denseIndex = GetDenseIndex(handle);
+    if (denseIndex >= 0)
+    {
+        RemoveAt(denseIndex);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool EffectsManager::IsPlaying(BD::Handle handle) const
+{
+    return GetDenseIndex(handle) >= 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int EffectsManager::GetActiveEffectCount() const
+{
+    return mCount;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int EffectsManager::GetClipIndex(ResourceId & clipId)
+{
+    auto it = mClipLookup.find(clipId);
+    if (it != mClipLookup.end())
+    {
+        return it->second;
+    }
+
+    auto pClip = GetGameManager().GetManager<ResourceManager>()->GetAnimationClip(clipId);
+    if (!pClip || !pClip->mpSheet || pClip->mFrames.empty())
+    {
+        return -1;
+    }
+
+    int clipIndex = int(mClips.size());
+    mClips.push_back(pClip);
+    mClipDurations.push_back(pClip->GetDuration());
+    mClipVertices.emplace_back(sf::Triangles);
+    mClipLookup[clipId] = clipIndex;
+    return clipIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int EffectsManager::GetDenseIndex(BD::Handle handle) const
+{
+    BD::uint32 slot = static_cast<BD::uint32>(handle & 0xFFFFFFFF);
+    BD::uint32 version = static_cast<BD::uint32>((handle >> 32) & 0xFFFFFFFF);
+    if (handle == BD::Handle(0) || slot >= mSlotVersions.size() || mSlotVersions[slot] != version)
+    {
+        return -1;
+    }
+    return int(mSlotToDense[slot]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EffectsManager::RemoveAt(int denseIndex)
+{
+    BD::uint32 slot = mDenseToSlot[denseIndex];
+    ++mSlotVersions[slot]; // Invalidates outstanding handles
+    mFreeSlots.push_back(slot);
+
+    int last = --mCount;
+    if (denseIndex != last)
+    {
+        mPositions[denseIndex] = mPositions[last];
+        mScales[denseIndex] = mScales[last];
+        mElapsedTimes[denseIndex] = mElapsedTimes[last];
+        mClipIndices[denseIndex] = mClipIndices[last];
+        mDenseToSlot[denseIndex] = mDenseToSlot[last];
+        mSlotToDense[mDenseToSlot[denseIndex]] = BD::uint32(denseIndex);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
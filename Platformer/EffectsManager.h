@@ -0,0 +1,53 @@
+#pragma once
+#include "BaseManager.h"
+#include "AnimationClip.h"
+#include "ResourceManager.h"
+#include <vector>
+
+// Plays one-shot flipbook effects (explosions, pickups) detached from any GameObject. Effects live in fixed capacity
+// SoA arrays, are packed densely and retired with a swap-remove, and all effects that share a clip are drawn with a
+// single vertex array. Handles stay valid across swaps through a version stamped slot table.
+class EffectsManager : public BaseManager
+{
+public:
+    EffectsManager(GameManager * pGameManager);
+    ~EffectsManager();
+
+    virtual void Update(float deltaTime) override;
+    virtual void Render(sf::RenderWindow & window) override;
+    virtual void OnGameEnd() override;
+
+    BD::Handle PlayEffect(ResourceId & clipId, const sf::Vector2f & position, const sf::Vector2f & scale = sf::Vector2f(1.f, 1.f));
+    void StopEffect(BD::Handle handle);
+    bool IsPlaying(BD::Handle handle) const;
+
+    int GetActiveEffectCount() const;
+
+private:
+    int GetClipIndex(ResourceId & clipId);
+    int GetDenseIndex(BD::Handle handle) const;
+    void RemoveAt(int denseIndex);
+
+    // Shared clips, indexed by mClipIndex
+    std::vector<std::shared_ptr<const AnimationClip>> mClips;
+    std::vector<float> mClipDurations;
+    std::unordered_map<ResourceId, int> mClipLookup;
+    std::vector<sf::VertexArray> mClipVertices;
+
+    // Dense SoA effect data
+    int mCount;
+    std::vector<sf::Vector2f> mPositions;
+    std::vector<sf::Vector2f> mScales;
+    std::vector<float> mElapsedTimes;
+    std::vector<int> mClipIndices;
+    std::vector<BD::uint32> mDenseToSlot;
+
+    // Slot table backing the handles
+    std::vector<BD::uint32> mSlotToDense;
+    std::vector<BD::uint32> mSlotVersions;
+    std::vector<BD::uint32> mFreeSlots;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -7,7 +7,10 @@
 #include "SpriteComponent.h"
 #include "CollisionComponent.h"
 #include "HealthComponent.h"
-#include "ExplosionComponent.h"
+#include "AnimationComponent.h"
+#include "EffectsManager.h"
+#include "AudioManager.h"
+#include "ParticleManager.h"
 #include "DropManager.h"
 #include "ResourceManager.h"
 #include "AIPathComponent.h"
@@ -15,15 +18,21 @@
 #include "TrackingComponent.h"
 #include "PlayerManager.h"
 #include "EnemyBulletComponent.h"
+#include "SpatialIndex.h"
+#include <algorithm>
 
 namespace
 {
     int skBossHealth = 100;
     int skMaxBossHealth = 100;
+
+    // Enemies keep apart through CrowdManager steering, so their bodies skip contacts with each other
+    const uint16 skEnemyCategoryBits = 0x0002;
 }
 
 EnemyAIManager::EnemyAIManager(GameManager * pGameManager)
 	: BaseManager(pGameManager)
+	, mIsSpawningEnabled(true)
 {
 
 }
@@ -39,6 +48,8 @@ EnemyAIManager::~EnemyAIManager()
 
 void EnemyAIManager::Update(float deltaTime)
 {
+    ParkReleasedEnemies();
+
     for (auto enemyHandle : mEnemyHandles)
     {
         auto * pEnemy = GetGameManager().GetGameObject(enemyHandle);
@@ -58,19 +69,34 @@ void EnemyAIManager::Update(float deltaTime)
         }
     }
 	CleanUpDeadEnemies();
-
-	while (mEnemyHandles.size() < mkMaxEnemies)
-	{
-		sf::Vector2f spawnPosition = sf::Vector2f(float(1183.723), float(851.008));
-		RespawnEnemy(EEnemy::Ogre, spawnPosition);
-	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
 void EnemyAIManager::OnGameEnd()
 {
+    // Parked enemies are off the root, so they outlive it and are ready for the next game, see GameManager::Reset.
+    // Everything else goes with the root.
+    std::unordered_map<BD::Handle, EEnemy> parkedTypes;
+    for (BD::Handle parkedHandle : mParkedHandles)
+    {
+        auto typeIt = mEnemyTypes.find(parkedHandle);
+        if (typeIt != mEnemyTypes.end())
+        {
+            parkedTypes.insert(*typeIt);
+        }
+    }
+    mEnemyTypes.swap(parkedTypes);
+
     mEnemyHandles.clear();
+    mReleasedHandles.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EnemyAIManager::SetSpawningEnabled(bool isEnabled)
+{
+    mIsSpawningEnabled = isEnabled;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -130,91 +156,153 @@ void EnemyAIManager::RespawnEnemy(EEnemy type, sf::Vector2f pos)
 
 void EnemyAIManager::AddEnemies(int count, EEnemy type, sf::Vector2f pos)
 {
-    auto & gameManager = GetGameManager();
     for (int i = 0; i < count; ++i)
     {
-        BD::Handle enemyHandle = gameManager.CreateNewGameObject(ETeam::Enemy, gameManager.GetRootGameObjectHandle());
-        auto * pEnemy = gameManager.GetGameObject(enemyHandle);
-        mEnemyHandles.push_back(enemyHandle);
+        SpawnEnemy(type, pos);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
 
-        auto pSpriteComp = pEnemy->GetComponent<SpriteComponent>().lock();
+BD::Handle EnemyAIManager::SpawnEnemy(EEnemy type, sf::Vector2f pos)
+{
+    auto & gameManager = GetGameManager();
 
-        if (!pSpriteComp)
+    BD::Handle enemyHandle = BD::Handle(0);
+    for (size_t index = mParkedHandles.size(); index-- > 0;)
+    {
+        if (GetEnemyType(mParkedHandles[index]) == type)
         {
-            return;
+            enemyHandle = mParkedHandles[index];
+            mParkedHandles.erase(mParkedHandles.begin() + index);
+            break;
         }
-        // Sprite Comp
-        SetUpSprite(*pSpriteComp, type);
-        pSpriteComp->SetPosition(pos);
+    }
+    if (enemyHandle == BD::Handle(0))
+    {
+        enemyHandle = CreateParkedEnemy(type);
+    }
 
-        // AI Path Movement
-        auto pAIPathComponentComp = std::make_shared<AIPathComponent>(pEnemy, gameManager);
-        pEnemy->AddComponent(pAIPathComponentComp);
+    auto * pEnemy = gameManager.GetGameObject(enemyHandle);
+    auto * pRoot = gameManager.GetRootGameObject();
+    if (!pEnemy || !pRoot)
+    {
+        return BD::Handle(0);
+    }
+    pRoot->AddChild(pEnemy);
+    mEnemyHandles.push_back(enemyHandle);
+    pEnemy->SetPosition(pos);
 
-        // Health Component
-        auto pHealthComponent = std::make_shared<HealthComponent>(pEnemy, gameManager, skBossHealth, skMaxBossHealth, 1, 1);
-        pEnemy->AddComponent(pHealthComponent);
+    // The body is moved before it is enabled so it never touches anything where the enemy was parked
+    if (b2Body * pBody = pEnemy->GetPhysicsBody())
+    {
+        float scale = pEnemy->PIXELS_PER_METER;
+        pBody->SetTransform(b2Vec2(pos.x / scale, pos.y / scale), pEnemy->GetRotationRadians());
+        pBody->SetLinearVelocity(b2Vec2(0.f, 0.f));
+        pBody->SetEnabled(true);
+    }
 
-        // Physics and Collision
+    if (auto pHealthComp = pEnemy->GetComponent<HealthComponent>().lock())
+    {
+        pHealthComp->Revive();
+    }
+
+    // AI Path Movement, a fresh one each time so no path or crowd state outlives the previous life
+    pEnemy->AddComponent(std::make_shared<AIPathComponent>(pEnemy, gameManager));
+
+    pEnemy->Activate();
+    return enemyHandle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle EnemyAIManager::PrewarmEnemy(EEnemy type)
+{
+    BD::Handle enemyHandle = CreateParkedEnemy(type);
+    if (enemyHandle != BD::Handle(0))
+    {
+        mParkedHandles.push_back(enemyHandle);
+    }
+    return enemyHandle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int EnemyAIManager::GetParkedCount(EEnemy type) const
+{
+    int count = 0;
+    for (BD::Handle parkedHandle : mParkedHandles)
+    {
+        if (GetEnemyType(parkedHandle) == type)
         {
-            pEnemy->CreatePhysicsBody(&gameManager.GetPhysicsWorld(), pEnemy->GetSize(), true);
-            auto pCollisionComp = std::make_shared<CollisionComponent>(
-                pEnemy,
-                gameManager,
-                &gameManager.GetPhysicsWorld(),
-                pEnemy->GetPhysicsBody(),
-                pEnemy->GetSize(),
-                true
-            );
-            pEnemy->AddComponent(pCollisionComp);
+            ++count;
         }
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle EnemyAIManager::CreateParkedEnemy(EEnemy type)
+{
+    auto & gameManager = GetGameManager();
+    BD::Handle enemyHandle = gameManager.CreateNewGameObject(ETeam::Enemy, BD::Handle(0));
+    auto * pEnemy = gameManager.GetGameObject(enemyHandle);
+    if (!pEnemy)
+    {
+        return BD::Handle(0);
+    }
+    mEnemyTypes[enemyHandle] = type;
+    pEnemy->Deactivate();
 
-#if 0
-        // Extra Tank GameObject Logic
+    auto pSpriteComp = pEnemy->GetComponent<SpriteComponent>().lock();
+
+    if (!pSpriteComp)
+    {
+        return enemyHandle;
+    }
+    // Sprite Comp
+    SetUpSprite(*pSpriteComp, type);
+
+    // Idle Animation
+    {
+        ResourceId clipId(GetEnemyIdleClip(type));
+        auto pClip = gameManager.GetManager<ResourceManager>()->GetAnimationClip(clipId);
+        if (pClip)
         {
-            // Tank Logic
-            BD::Handle gunHandle = gameManager.CreateNewGameObject(ETeam::Enemy, pEnemy->GetHandle());
-            auto * pGunGameObject = gameManager.GetGameObject(gunHandle);
-            if (!pGunGameObject)
-            {
-                return;
-            }
-            auto pGunSpriteComp = pGunGameObject->GetComponent<SpriteComponent>().lock();
-            if (pGunSpriteComp)
-            {
-                SetUpSprite(*pGunSpriteComp, EEnemy::TankGuns);
-                pGunSpriteComp->SetPosition(pos);
-
-                auto * pPlayerManager = gameManager.GetManager<PlayerManager>();
-                if (!pPlayerManager)
-                {
-                    return;
-                }
-                auto & players = pPlayerManager->GetPlayers();
-                if (players.empty())
-                {
-                    return;
-                }
-                BD::Handle playerHandle = players[0];
-                GameObject * pPlayerObject = gameManager.GetGameObject(playerHandle);
-                if (!pPlayerObject)
-                {
-                    return;
-                }
-
-                // Setup Components
-                {
-                    auto pFollowParentComponent = std::make_shared<FollowComponent>(pGunGameObject, gameManager, enemyHandle);
-                    pGunGameObject->AddComponent(pFollowParentComponent);
-                    auto pTrackingComponent = std::make_shared<TrackingComponent>(pGunGameObject, gameManager, playerHandle);
-                    pGunGameObject->AddComponent(pTrackingComponent);
-                    auto pEnemyBulletComponent = std::make_shared<EnemyBulletComponent>(pGunGameObject, gameManager);
-                    pGunGameObject->AddComponent(pEnemyBulletComponent);
-                }
-            }
+            // Random start offset so a wave does not animate in lockstep
+            float startTime = pClip->GetDuration() * float(rand() % 100) / 100.f;
+            pEnemy->AddComponent(std::make_shared<AnimationComponent>(pEnemy, gameManager, pClip, startTime));
+        }
+    }
+
+    // Health Component
+    auto pHealthComponent = std::make_shared<HealthComponent>(pEnemy, gameManager, skBossHealth, skMaxBossHealth, 1, 1);
+    pEnemy->AddComponent(pHealthComponent);
+
+    // Physics and Collision, disabled until SpawnEnemy places the enemy
+    {
+        pEnemy->CreatePhysicsBody(&gameManager.GetPhysicsWorld(), pEnemy->GetSize(), true);
+        for (b2Fixture * pFixture = pEnemy->GetPhysicsBody()->GetFixtureList(); pFixture; pFixture = pFixture->GetNext())
+        {
+            b2Filter filter = pFixture->GetFilterData();
+            filter.categoryBits = skEnemyCategoryBits;
+            filter.maskBits = uint16(~skEnemyCategoryBits);
+            pFixture->SetFilterData(filter);
         }
-#endif
+        pEnemy->GetPhysicsBody()->SetEnabled(false);
+        auto pCollisionComp = std::make_shared<CollisionComponent>(
+            pEnemy,
+            gameManager,
+            &gameManager.GetPhysicsWorld(),
+            pEnemy->GetPhysicsBody(),
+            pEnemy->GetSize(),
+            true
+        );
+        pEnemy->AddComponent(pCollisionComp);
     }
+
+    return enemyHandle;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -224,34 +312,71 @@ void EnemyAIManager::DestroyAllEnemies()
     for (auto enemyHandle : mEnemyHandles)
     {
         auto * pEnemy = GetGameManager().GetGameObject(enemyHandle);
-        pEnemy->Destroy();
+        if (pEnemy && pEnemy->IsActive())
+        {
+            ReleaseEnemy(*pEnemy);
+        }
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void EnemyAIManager::CleanUpDeadEnemies()
+void EnemyAIManager::ReleaseEnemy(GameObject & enemy)
 {
-    auto & gameManager = GetGameManager();
+    // Out of play right away, CollisionListener and the components skip inactive objects
+    enemy.Deactivate();
+    mReleasedHandles.push_back(enemy.GetHandle());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
 
-    for (BD::Handle enemyHandle : mEnemyHandles)
+void EnemyAIManager::ParkReleasedEnemies()
+{
+    auto & gameManager = GetGameManager();
+    GameObject * pRoot = gameManager.GetRootGameObject();
+    for (BD::Handle enemyHandle : mReleasedHandles)
     {
+        // Skip anything destroyed, parked twice or brought back by a snapshot load in the meantime
         GameObject * pEnemy = gameManager.GetGameObject(enemyHandle);
-        if (pEnemy && !pEnemy->IsDestroyed())
+        if (!pRoot || !pEnemy || pEnemy->IsDestroyed() || pEnemy->IsActive() ||
+            pEnemy->GetParentHandle() != pRoot->GetHandle())
         {
-            auto explosionComp = pEnemy->GetComponent<ExplosionComponent>().lock();
-            if (explosionComp && explosionComp->IsAnimationFinished())
-            {
-                pEnemy->Destroy();
-            }
+            continue;
+        }
+
+        pRoot->RemoveChild(pEnemy);
+        if (b2Body * pBody = pEnemy->GetPhysicsBody())
+        {
+            pBody->SetEnabled(false);
+        }
+        pEnemy->RemoveComponent<AIPathComponent>();
+        if (auto * pSpatialIndex = gameManager.GetManager<SpatialIndex>())
+        {
+            pSpatialIndex->Remove(enemyHandle);
         }
+
+        mEnemyHandles.erase(std::remove(mEnemyHandles.begin(), mEnemyHandles.end(), enemyHandle), mEnemyHandles.end());
+        mParkedHandles.push_back(enemyHandle);
     }
+    mReleasedHandles.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EnemyAIManager::CleanUpDeadEnemies()
+{
+    auto & gameManager = GetGameManager();
 
     auto removeStart = std::remove_if(mEnemyHandles.begin(), mEnemyHandles.end(),
-        [&gameManager](BD::Handle handle)
+        [this, &gameManager](BD::Handle handle)
         {
             GameObject * pObj = gameManager.GetGameObject(handle);
-            return pObj == nullptr || pObj->IsDestroyed();
+            if (pObj == nullptr || pObj->IsDestroyed())
+            {
+                mEnemyTypes.erase(handle);
+                return true;
+            }
+            return false;
         });
 
     mEnemyHandles.erase(removeStart, mEnemyHandles.end());
@@ -280,6 +405,24 @@ std::string EnemyAIManager::GetEnemyFile(EEnemy type)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+std::string EnemyAIManager::GetEnemyIdleClip(EEnemy type)
+{
+    switch (type)
+    {
+        case (EEnemy::LizardF):
+        {
+            return "LizardFIdle";
+        }
+        case (EEnemy::Ogre):
+        default:
+        {
+            return "OgreIdle";
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 const std::vector<BD::Handle> & EnemyAIManager::GetEnemies() const
 {
 	return mEnemyHandles;
@@ -287,15 +430,42 @@ const std::vector<BD::Handle> & EnemyAIManager::GetEnemies() const
 
 //------------------------------------------------------------------------------------------------------------------------
 
+EEnemy EnemyAIManager::GetEnemyType(BD::Handle enemyHandle) const
+{
+    auto it = mEnemyTypes.find(enemyHandle);
+    return it != mEnemyTypes.end() ? it->second : EEnemy::Ogre;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void EnemyAIManager::RestoreEnemies(const std::vector<BD::Handle> & enemyHandles)
+{
+    std::unordered_map<BD::Handle, EEnemy> enemyTypes;
+    for (BD::Handle enemyHandle : enemyHandles)
+    {
+        enemyTypes[enemyHandle] = GetEnemyType(enemyHandle);
+    }
+    for (BD::Handle parkedHandle : mParkedHandles)
+    {
+        enemyTypes[parkedHandle] = GetEnemyType(parkedHandle);
+    }
+    mEnemyHandles = enemyHandles;
+    mEnemyTypes.swap(enemyTypes);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void EnemyAIManager::OnDeath(GameObject * pEnemy)
 {
     auto & gameManager = GetGameManager();
-    // Explosion
-    if (!pEnemy->GetComponent<ExplosionComponent>().lock())
+    sf::Vector2f position = pEnemy->GetPosition();
+
+    // Explosion plays on its own, the enemy is parked for reuse on the next Update
     {
-        auto explosionComp = std::make_shared<ExplosionComponent>(
-            pEnemy, gameManager, "Art/explosion.png", 32, 32, 7, 0.1f, sf::Vector2f(2.f, 2.f), pEnemy->GetPosition());
-        pEnemy->AddComponent(explosionComp);
+        ResourceId clipId("Explosion");
+        gameManager.GetManager<EffectsManager>()->PlayEffect(clipId, position, sf::Vector2f(2.f, 2.f));
+        gameManager.GetManager<AudioManager>()->PlaySound(ESound::Explosion, position);
+        gameManager.GetManager<ParticleManager>()->Burst(EParticleEffect::DeathBurst, position);
     }
     // Add Score
     {
@@ -308,10 +478,10 @@ void EnemyAIManager::OnDeath(GameObject * pEnemy)
         auto pDropManager = gameManager.GetManager<DropManager>();
         if (pDropManager)
         {
-            sf::Vector2f position = pEnemy->GetPosition();
             pDropManager->SpawnDrop(dropType, position);
         }
     }
+    ReleaseEnemy(*pEnemy);
 }
 
 //------------------------------------------------------------------------------------------------------------------------
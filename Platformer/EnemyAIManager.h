@@ -1,21 +1,21 @@
 #pragma once
 #include "BaseManager.h"
 #include <vector>
+#include <unordered_map>
 #include "GameObject.h"
 #include "DropManager.h"
 #include "SpriteComponent.h"
 
-namespace
-{
-	const int mkMaxEnemies = 1;
-}
-
 enum class EEnemy
 {
 	LizardF,
 	Ogre
 };
 
+// Owns every enemy, in play or parked. A dead enemy is not destroyed but parked: taken off the root, its body disabled
+// and its AI dropped, until SpawnEnemy brings it back with full health somewhere else. Deaths arrive mid physics step
+// or mid hierarchy walk, so parking waits for the next Update. Parked enemies are kept when a game ends, ready for the
+// next one. When and where enemies spawn is up to the WaveManager.
 class EnemyAIManager : public BaseManager
 {
 public:
@@ -29,23 +29,49 @@ public:
 	void RespawnEnemy(EEnemy type, sf::Vector2f pos);
 
 	void AddEnemies(int count, EEnemy type, sf::Vector2f pos);
+	// Reuses a parked enemy of the type when there is one
+	BD::Handle SpawnEnemy(EEnemy type, sf::Vector2f pos);
+
+	// Builds a parked enemy ahead of time, so a later SpawnEnemy only has to place it
+	BD::Handle PrewarmEnemy(EEnemy type);
+	int GetParkedCount(EEnemy type) const;
+	int GetParkedCount() const { return int(mParkedHandles.size()); }
+
+	// Parks every enemy in play, without the score or drops of a death
 	void DestroyAllEnemies();
 
 	const std::vector<BD::Handle> & GetEnemies() const;
+	EEnemy GetEnemyType(BD::Handle enemyHandle) const;
+
+	// Replaces the tracked enemies, used when a snapshot is loaded
+	void RestoreEnemies(const std::vector<BD::Handle> & enemyHandles);
 
 	void OnDeath(GameObject * pEnemy);
 
+	// Off on a network client, the server owns the enemies and the client only draws proxies of them
+	void SetSpawningEnabled(bool isEnabled);
+	bool IsSpawningEnabled() const { return mIsSpawningEnabled; }
+
+	void SetUpSprite(SpriteComponent & spriteComp, EEnemy type);
+
 private:
 	std::string GetEnemyFile(EEnemy type);
+	std::string GetEnemyIdleClip(EEnemy type);
 	void CleanUpDeadEnemies();
 
+	BD::Handle CreateParkedEnemy(EEnemy type);
+	void ReleaseEnemy(GameObject & enemy);
+	void ParkReleasedEnemies();
+
 	sf::Vector2f GetRandomSpawnPosition();
 
 	EDropType DetermineDropType() const;
 
-	void SetUpSprite(SpriteComponent & spriteComp, EEnemy type);
-
 	std::vector<BD::Handle> mEnemyHandles;
+	std::unordered_map<BD::Handle, EEnemy> mEnemyTypes;      // In play and parked
+	std::vector<BD::Handle> mParkedHandles;
+	std::vector<BD::Handle> mReleasedHandles;                // Dead, parked on the next Update
+	bool mIsSpawningEnabled;
 };
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -19,7 +19,6 @@ EnemyBulletComponent::EnemyBulletComponent(GameObject * pOwner, GameManager & ga
 	, mCooldown(.1f)
 	, mTimeSinceLastShot(1.f)
 	, mLastUsedProjectile(EProjectileType::GreenLaser)
-	, mName("EnemyBulletComponent")
 {
 
 }
@@ -121,19 +120,6 @@ void EnemyBulletComponent::Update(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void EnemyBulletComponent::DebugImGuiComponentInfo()
-{
-}
-
-//------------------------------------------------------------------------------------------------------------------------
-
-std::string & EnemyBulletComponent::GetClassName()
-{
-	return mName;
-}
-
-//------------------------------------------------------------------------------------------------------------------------
-
 void EnemyBulletComponent::UpdateProjectiles(float deltaTime)
 {
 	auto & gameManager = GetGameManager();
@@ -164,6 +150,17 @@ void EnemyBulletComponent::UpdateProjectiles(float deltaTime)
 		mBullets.end());
 }
 
+//------------------------------------------------------------------------------------------------------------------------
+
+BD_REGISTER_COMPONENT(EnemyBulletComponent)
+
+void EnemyBulletComponent::DescribeType(ComponentTypeInfo & typeInfo)
+{
+	typeInfo.AddField<&EnemyBulletComponent::mSpeed>("Speed");
+	typeInfo.AddField<&EnemyBulletComponent::mCooldown>("Cooldown");
+	typeInfo.AddField<&EnemyBulletComponent::mTimeSinceLastShot>("TimeSinceLastShot");
+}
+
 //------------------------------------------------------------------------------------------------------------------------
 // EOF
 //------------------------------------------------------------------------------------------------------------------------
\ No newline at end of file
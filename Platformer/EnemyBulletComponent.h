@@ -4,6 +4,8 @@
 
 class EnemyBulletComponent : public GameComponent
 {
+    BD_COMPONENT(EnemyBulletComponent)
+
 public:
     EnemyBulletComponent(GameObject * pOwner, GameManager & gameManager);
     ~EnemyBulletComponent();
@@ -13,8 +15,6 @@ public:
     void Shoot();
 
     virtual void Update(float deltaTime) override;
-    virtual void DebugImGuiComponentInfo() override;
-    virtual std::string & GetClassName() override;
 
 private:
     void UpdateProjectiles(float deltaTime);
@@ -24,6 +24,5 @@ private:
     float mCooldown;
     float mTimeSinceLastShot;
     EProjectileType mLastUsedProjectile;
-    std::string mName;
 };
 
@@ -5,7 +5,6 @@ FollowComponent::FollowComponent(GameObject * pOwner, GameManager & gameManager,
 	: GameComponent(pOwner, gameManager)
 	, mFollowHandle(followHandle)
 	, mOffset(offset)
-	, mName("FollowComponent")
 {
 
 }
@@ -31,9 +30,12 @@ void FollowComponent::Update(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & FollowComponent::GetClassName()
+BD_REGISTER_COMPONENT(FollowComponent)
+
+void FollowComponent::DescribeType(ComponentTypeInfo & typeInfo)
 {
-	return mName;
+	typeInfo.AddField<&FollowComponent::mFollowHandle>("FollowHandle");
+	typeInfo.AddField<&FollowComponent::mOffset>("Offset");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,286 @@
+#include "AstroidsPrivate.h"
+#include "FramePacer.h"
+#include "BDConfig.h"
+#define NOMINMAX
+#include <windows.h>
+#include <algorithm>
+#include <cmath>
+#include <imgui.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace
+{
+    const float skDefaultFramesPerSecond = 300.f;
+    const float skDefaultRefreshRate = 60.f;
+
+    // Adaptive sync paces this far under the refresh rate, so frames never queue up behind the display
+    const float skAdaptiveSyncHeadroom = 0.97f;
+
+    // Sleeps are only started while at least this much more than the expected overshoot is left
+    const float skSpinMarginMicroseconds = 200.f;
+    const float skInitialOvershootMicroseconds = 1000.f;
+
+    const size_t skStatsFrameCount = 240;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+FramePacer::FramePacer()
+    : mMode(EFrameSync::Paced)
+    , mTargetFramesPerSecond(skDefaultFramesPerSecond)
+    , mRefreshRate(skDefaultRefreshRate)
+    , mpWaitableTimer(nullptr)
+    , mFrameStartTicks(0)
+    , mHasFrameStart(false)
+    , mSleepOvershootMicroseconds(skInitialOvershootMicroseconds)
+    , mFrameTimes(skStatsFrameCount, 0.f)
+    , mFrameTimeCursor(0)
+    , mFrameTimeCount(0)
+    , mStats()
+{
+    if (gsTicksPerSecond == 0)
+    {
+        TimerInit();
+    }
+
+    // Windows 10 1803 and later, older versions fall back to Sleep and lean on the spin more
+    mpWaitableTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+    DEVMODEW displayMode = {};
+    displayMode.dmSize = sizeof(displayMode);
+    if (EnumDisplaySettingsW(nullptr, ENUM_CURRENT_SETTINGS, &displayMode) && displayMode.dmDisplayFrequency > 1)
+    {
+        mRefreshRate = float(displayMode.dmDisplayFrequency);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+FramePacer::~FramePacer()
+{
+    if (mpWaitableTimer)
+    {
+        CloseHandle(mpWaitableTimer);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void FramePacer::SetMode(EFrameSync mode, sf::RenderWindow & window)
+{
+    mMode = mode;
+    window.setFramerateLimit(0);
+    window.setVerticalSyncEnabled(mode == EFrameSync::VSync);
+    ResetClock();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void FramePacer::SetTargetFramesPerSecond(float framesPerSecond)
+{
+    mTargetFramesPerSecond = std::max(0.f, framesPerSecond);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float FramePacer::GetFrameMicroseconds() const
+{
+    switch (mMode)
+    {
+        case EFrameSync::VSync:
+        {
+            return 1000000.f / mRefreshRate;
+        }
+        case EFrameSync::AdaptiveSync:
+        {
+            float framesPerSecond = mRefreshRate * skAdaptiveSyncHeadroom;
+            if (mTargetFramesPerSecond > 0.f)
+            {
+                framesPerSecond = std::min(framesPerSecond, mTargetFramesPerSecond);
+            }
+            return 1000000.f / framesPerSecond;
+        }
+        case EFrameSync::Paced:
+        default:
+        {
+            // Zero is uncapped
+            return mTargetFramesPerSecond > 0.f ? 1000000.f / mTargetFramesPerSecond : 0.f;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float FramePacer::BeginFrame()
+{
+    if (!mHasFrameStart)
+    {
+        mFrameStartTicks = TimerGetRawTicks();
+        mHasFrameStart = true;
+        return 0.f;
+    }
+
+    // Under vsync display() already waited for the refresh
+    float frameMicroseconds = GetFrameMicroseconds();
+    mStats.mSpinMicroseconds = 0.f;
+    if (mMode != EFrameSync::VSync && frameMicroseconds > 0.f)
+    {
+        WaitUntil(mFrameStartTicks + ConvertMicrosecondsToTicks(frameMicroseconds));
+    }
+
+    uint64 nowTicks = TimerGetRawTicks();
+    uint64 elapsedTicks = nowTicks - mFrameStartTicks;
+    mFrameStartTicks = nowTicks;
+
+    RecordFrame(ConvertTicksToMicroSeconds(elapsedTicks));
+    return ConvertTicksToSeconds(elapsedTicks);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void FramePacer::ResetClock()
+{
+    mHasFrameStart = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void FramePacer::WaitUntil(uint64 deadlineTicks)
+{
+    StopWatch spinWatch;
+    float spinMicroseconds = 0.f;
+    while (true)
+    {
+        uint64 nowTicks = TimerGetRawTicks();
+        if (nowTicks >= deadlineTicks)
+        {
+            break;
+        }
+
+        float remainingMicroseconds = ConvertTicksToMicroSeconds(deadlineTicks - nowTicks);
+        if (remainingMicroseconds > 1000.f + mSleepOvershootMicroseconds + skSpinMarginMicroseconds)
+        {
+            StopWatch sleepWatch;
+            SleepOneMillisecond();
+
+            // A sleep that ran long raises the estimate at once, good ones only bring it down slowly
+            float overshootMicroseconds = std::max(0.f, sleepWatch.GetElapsedMicroSeconds() - 1000.f);
+            if (overshootMicroseconds > mSleepOvershootMicroseconds)
+            {
+                mSleepOvershootMicroseconds = overshootMicroseconds;
+            }
+            else
+            {
+                mSleepOvershootMicroseconds += (overshootMicroseconds - mSleepOvershootMicroseconds) * 0.02f;
+            }
+            spinWatch.Reset();
+        }
+        else
+        {
+            YieldProcessor();
+            spinMicroseconds = spinWatch.GetElapsedMicroSeconds();
+        }
+    }
+    mStats.mSpinMicroseconds = spinMicroseconds;
+    mStats.mSleepOvershootMicroseconds = mSleepOvershootMicroseconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void FramePacer::SleepOneMillisecond()
+{
+    if (mpWaitableTimer)
+    {
+        // Relative, in 100 ns units
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -10000LL;
+        if (SetWaitableTimer(mpWaitableTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+        {
+            WaitForSingleObject(mpWaitableTimer, INFINITE);
+            return;
+        }
+    }
+    Sleep(1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void FramePacer::RecordFrame(float frameMicroseconds)
+{
+    mFrameTimes[mFrameTimeCursor] = frameMicroseconds;
+    mFrameTimeCursor = (mFrameTimeCursor + 1) % mFrameTimes.size();
+    mFrameTimeCount = std::min(mFrameTimeCount + 1, mFrameTimes.size());
+
+    float targetMicroseconds = GetFrameMicroseconds();
+    float sum = 0.f;
+    float errorSum = 0.f;
+    float maxError = 0.f;
+    int lateFrames = 0;
+    for (size_t index = 0; index < mFrameTimeCount; ++index)
+    {
+        float frameTime = mFrameTimes[index];
+        sum += frameTime;
+        if (targetMicroseconds > 0.f)
+        {
+            float error = std::abs(frameTime - targetMicroseconds);
+            errorSum += error;
+            maxError = std::max(maxError, error);
+            if (frameTime > targetMicroseconds * 1.5f)
+            {
+                ++lateFrames;
+            }
+        }
+    }
+
+    float mean = sum / float(mFrameTimeCount);
+    float varianceSum = 0.f;
+    for (size_t index = 0; index < mFrameTimeCount; ++index)
+    {
+        float offset = mFrameTimes[index] - mean;
+        varianceSum += offset * offset;
+    }
+
+    mStats.mTargetMicroseconds = targetMicroseconds;
+    mStats.mMeanErrorMicroseconds = errorSum / float(mFrameTimeCount);
+    mStats.mMaxErrorMicroseconds = maxError;
+    mStats.mJitterMicroseconds = std::sqrt(varianceSum / float(mFrameTimeCount));
+    mStats.mFramesPerSecond = mean > 0.f ? 1000000.f / mean : 0.f;
+    mStats.mLateFrames = lateFrames;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void FramePacer::DebugImGuiInfo(sf::RenderWindow & window)
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Frame Pacing");
+
+    int mode = int(mMode);
+    const char * modeNames[] = { "Paced", "VSync", "Adaptive Sync" };
+    if (ImGui::Combo("Mode", &mode, modeNames, IM_ARRAYSIZE(modeNames)))
+    {
+        SetMode(EFrameSync(mode), window);
+    }
+    ImGui::SliderFloat("Target FPS", &mTargetFramesPerSecond, 0.f, 500.f);
+    ImGui::Text("Display: %.0f Hz, %s timer", mRefreshRate, mpWaitableTimer ? "high resolution" : "Sleep");
+
+    ImGui::Separator();
+    ImGui::Text("FPS: %.1f", mStats.mFramesPerSecond);
+    ImGui::Text("Target: %.1f us", mStats.mTargetMicroseconds);
+    ImGui::Text("Mean error: %.1f us", mStats.mMeanErrorMicroseconds);
+    ImGui::Text("Max error: %.1f us", mStats.mMaxErrorMicroseconds);
+    ImGui::Text("Jitter: %.1f us", mStats.mJitterMicroseconds);
+    ImGui::Text("Late frames: %d of %d", mStats.mLateFrames, int(mFrameTimeCount));
+    ImGui::Text("Sleep overshoot: %.1f us", mStats.mSleepOvershootMicroseconds);
+    ImGui::Text("Spin last frame: %.1f us", mStats.mSpinMicroseconds);
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
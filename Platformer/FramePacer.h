@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include "Timer.h"
+
+enum class EFrameSync
+{
+    Paced,          // Vsync off, the pacer holds every frame to the target time
+    VSync,          // The display's refresh blocks in display(), the pacer only measures
+    AdaptiveSync    // Vsync off and paced a little under the refresh rate, so a variable refresh display follows every frame
+};
+
+struct FramePacingStats
+{
+    float mTargetMicroseconds = 0.f;
+    float mMeanErrorMicroseconds = 0.f;     // Mean of |frame time - target| over the window
+    float mMaxErrorMicroseconds = 0.f;
+    float mJitterMicroseconds = 0.f;        // Standard deviation of the frame time
+    float mFramesPerSecond = 0.f;
+    float mSleepOvershootMicroseconds = 0.f;
+    float mSpinMicroseconds = 0.f;          // Spent spinning last frame
+    int mLateFrames = 0;                    // More than half a frame late, in the window
+};
+
+// Holds frames to a target time more closely than sf::Window::setFramerateLimit, whose sf::sleep can overshoot by a
+// millisecond or more. The wait sleeps while well ahead of the deadline, on a high resolution waitable timer where the
+// OS has one, and spins out the last stretch. How far a sleep overshoots is learned as it goes, so the spin only covers
+// what the sleeps cannot. BeginFrame is called first thing each frame so input is polled right after the wait.
+class FramePacer
+{
+public:
+    FramePacer();
+    ~FramePacer();
+
+    // Applies the mode's vsync and framerate limit settings to the window
+    void SetMode(EFrameSync mode, sf::RenderWindow & window);
+    EFrameSync GetMode() const { return mMode; }
+
+    void SetTargetFramesPerSecond(float framesPerSecond);
+    float GetTargetFramesPerSecond() const { return mTargetFramesPerSecond; }
+
+    // Waits out the rest of the frame, returns the seconds since the last BeginFrame
+    float BeginFrame();
+
+    // After a blocking wait, so the time spent idle is neither measured nor handed to the game as one long frame
+    void ResetClock();
+
+    const FramePacingStats & GetStats() const { return mStats; }
+
+    void DebugImGuiInfo(sf::RenderWindow & window);
+
+private:
+    float GetFrameMicroseconds() const;
+    void WaitUntil(uint64 deadlineTicks);
+    void SleepOneMillisecond();
+    void RecordFrame(float frameMicroseconds);
+
+    EFrameSync mMode;
+    float mTargetFramesPerSecond;
+    float mRefreshRate;                     // Of the primary display, 60 when the OS does not say
+    void * mpWaitableTimer;                 // Windows HANDLE, null when high resolution timers are not available
+    uint64 mFrameStartTicks;
+    bool mHasFrameStart;
+    float mSleepOvershootMicroseconds;
+
+    // Frame times in microseconds, a ring of the most recent frames
+    std::vector<float> mFrameTimes;
+    size_t mFrameTimeCursor;
+    size_t mFrameTimeCount;
+    FramePacingStats mStats;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -5,7 +5,6 @@
 GameComponent::GameComponent(GameObject * pOwner, GameManager & gameManager)
     : mOwnerHandle(pOwner->GetHandle())
     , mGameManager(gameManager)
-    , mName("GameComponent")
 {
 }
 
@@ -50,9 +49,9 @@ void GameComponent::DebugImGuiComponentInfo()
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & GameComponent::GetClassName()
+const std::string & GameComponent::GetClassName() const
 {
-    return mName;
+    return GetTypeInfo().mName;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -1,4 +1,5 @@
 #pragma once
+#include "ComponentRegistry.h"
 
 class GameObject;
 class GameManager;
@@ -17,13 +18,14 @@ public:
     virtual void Update(float deltaTime) = 0;
     virtual void draw(sf::RenderTarget & target, sf::RenderStates states);
     virtual void DebugImGuiComponentInfo();
-    virtual std::string & GetClassName();
+
+    // From BD_COMPONENT, see ComponentRegistry
+    virtual const ComponentTypeInfo & GetTypeInfo() const = 0;
+    const std::string & GetClassName() const;
 
 protected:
     BD::Handle mOwnerHandle;
     GameManager & mGameManager;
-private:
-    std::string mName;
 };
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -13,18 +13,41 @@
 #include "DropManager.h"
 #include "ResourceManager.h"
 #include "DungeonManager.h"
+#include "ChunkStreamer.h"
 #include "CameraManager.h"
 #include "BaseManager.h"
 #include "LevelManager.h"
+#include "AudioManager.h"
+#include "EffectsManager.h"
+#include "ParticleManager.h"
+#include "NavigationManager.h"
+#include "PathfindingService.h"
+#include "SpatialIndex.h"
+#include "CrowdManager.h"
+#include "VisibilityService.h"
+#include "InfluenceMapManager.h"
+#include "AIScheduler.h"
+#include "WaveManager.h"
+#include "InputManager.h"
+#include "SnapshotManager.h"
+#include "RollbackManager.h"
+#include "NetworkManager.h"
+
+namespace
+{
+    const char * skStartLevelPath = "../Levels/Level1.bdlevel";
+}
 
 GameManager::GameManager(WindowManager & windowManager)
     : mWindowManager(windowManager)
     , mpWindow(windowManager.GetWindow())
     , mEvent(windowManager.GetEvent())
     , mShowImGuiWindow(false)
+    , mJobSystem()
+    , mUpdateStopWatch()
+    , mLastResetMilliseconds(0.f)
     , mRootHandle()
     , mManagers()
-    , mSoundPlayed(false)
     , mIsGameOver(false)
     , mPhysicsWorld(b2Vec2(0.0f, 0.f))
     , mCollisionListener(this)
@@ -32,7 +55,14 @@ GameManager::GameManager(WindowManager & windowManager)
 {
     // Order Matters
     {
+        // Main samples it at the start of every tick, so everything after reads the same input
+        AddManager<InputManager>();
         AddManager<ResourceManager>();
+        AddManager<AudioManager>();
+
+        // Ahead of anything that creates or moves GameObjects, so none of them are missed
+        AddManager<SpatialIndex>();
+        GetManager<ResourceManager>()->LoadAnimationClips("Art/Animations.json");
 
         InitWindow();
         InitImGui();
@@ -43,12 +73,28 @@ GameManager::GameManager(WindowManager & windowManager)
         //Level Manager
         {
             AddManager<LevelManager>();
-            GetManager<LevelManager>()->LoadLevel("../Levels/Level1.json");
+            GetManager<LevelManager>()->LoadLevel(skStartLevelPath);
         }
+        AddManager<DungeonManager>(60, 256, 256, 5, 14);
+        AddManager<ChunkStreamer>();
+        AddManager<NavigationManager>();
+        AddManager<PathfindingService>();
+        AddManager<VisibilityService>();
         AddManager<CameraManager>();
+        AddManager<EffectsManager>();
+        AddManager<ParticleManager>();
+        AddManager<CrowdManager>();
+        AddManager<InfluenceMapManager>();
+        AddManager<AIScheduler>();
         AddManager<EnemyAIManager>();
+        AddManager<WaveManager>();
         AddManager<ScoreManager>();
         AddManager<DropManager>();
+        AddManager<NetworkManager>();
+
+        // Last, so snapshots see every other manager's work for the frame
+        AddManager<SnapshotManager>();
+        AddManager<RollbackManager>();
     }
     
 
@@ -122,12 +168,7 @@ void GameManager::EndGame()
 
     if (mRootHandle != BD::Handle(0))
     {
-        CleanUpDestroyedGameObjects(mRootHandle);
-        if (auto * pRootObj = GetGameObject(mRootHandle))
-        {
-            delete pRootObj;
-        }
-        mPool.Remove(mRootHandle);
+        DeleteGameObjectTree(mRootHandle);
         mRootHandle = BD::Handle(0);
     }
 
@@ -137,14 +178,71 @@ void GameManager::EndGame()
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void GameManager::NotifyLevelUnloading()
+{
+    for (auto & manager : mManagers)
+    {
+        if (manager.second)
+        {
+            manager.second->OnLevelUnloading();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GameManager::Reset()
+{
+    StopWatch resetStopWatch;
+
+    if (!mIsGameOver)
+    {
+        EndGame();
+    }
+    mIsGameOver = false;
+
+    // The b2World stays, the bodies deleted with the old objects went back to its block allocator and the new ones
+    // are carved from the same blocks
+    mRootHandle = CreateNewGameObject(ETeam::Neutral, BD::Handle(0));
+
+    // Only a level that was replaced by a dungeon or a streamed world is loaded again, the first level's mapping and
+    // tile vertices are still resident otherwise
+    auto * pLevelManager = GetManager<LevelManager>();
+    if (pLevelManager && pLevelManager->GetLevelPath() != skStartLevelPath)
+    {
+        pLevelManager->LoadLevel(skStartLevelPath);
+    }
+
+    for (auto & manager : mManagers)
+    {
+        if (manager.second)
+        {
+            manager.second->OnGameStart();
+        }
+    }
+
+    mLastResetMilliseconds = resetStopWatch.GetElapsedMilliseconds();
+    std::cout << "Restart: " << mLastResetMilliseconds << " ms" << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float GameManager::GetLastResetMilliseconds() const
+{
+    return mLastResetMilliseconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void GameManager::Update(float deltaTime)
 {
-    // Game Audio
-    if (!mSoundPlayed)
+    // A rewound tick stays on screen until the RollbackManager resumes or re-simulates from it
+    auto * pRollbackManager = GetManager<RollbackManager>();
+    if (pRollbackManager && pRollbackManager->IsHoldingTick())
     {
-        mSound.play();
-        mSoundPlayed = true;
+        return;
     }
+    mUpdateStopWatch.Reset();
 
     // Physics
     {
@@ -167,6 +265,13 @@ void GameManager::Update(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+float GameManager::GetUpdateMilliseconds() const
+{
+    return mUpdateStopWatch.GetElapsedMilliseconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void GameManager::DebugUpdate(float deltaTime)
 {
     if (!mpWindow)
@@ -174,14 +279,30 @@ void GameManager::DebugUpdate(float deltaTime)
         return;
     }
 
+    const InputSnapshot & input = GetManager<InputManager>()->GetSnapshot();
+
     // DungeonManager
     {
         auto * pDungeonManager = GetManager<DungeonManager>();
-        if (pDungeonManager)
+        if (pDungeonManager && input.WasPressed(EAction::GenerateDungeon))
+        {
+            // A fresh seed per press, not per frame the key is held
+            pDungeonManager->GenerateLevel(pDungeonManager->GetSeed() + 1);
+        }
+    }
+
+    // SnapshotManager
+    {
+        auto * pSnapshotManager = GetManager<SnapshotManager>();
+        if (pSnapshotManager)
         {
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::H))
+            if (input.WasPressed(EAction::QuickSave))
             {
-                //pDungeonManager->GenerateDungeonGrid();
+                pSnapshotManager->SaveToFile("Quicksave.bdsave");
+            }
+            if (input.WasPressed(EAction::QuickLoad))
+            {
+                pSnapshotManager->LoadFromFile("Quicksave.bdsave");
             }
         }
     }
@@ -204,6 +325,13 @@ void GameManager::UpdateGameObjects(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void GameManager::RemoveDestroyedGameObjects()
+{
+    CleanUpDestroyedGameObjects(mRootHandle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void GameManager::CleanUpDestroyedGameObjects(BD::Handle rootHandle)
 {
     GameObject * pRoot = GetGameObject(rootHandle);
@@ -256,12 +384,34 @@ void GameManager::CleanUpDestroyedGameObjects(BD::Handle rootHandle)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void GameManager::DeleteGameObjectTree(BD::Handle handle)
+{
+    GameObject * pObject = GetGameObject(handle);
+    if (!pObject)
+    {
+        return;
+    }
+
+    // Children first, so each delete only finds handles that are already gone and the components' destructors, such
+    // as the CollisionComponent's DestroyBody, run for every object in the tree
+    std::vector<BD::Handle> children = pObject->GetChildrenHandles();
+    for (BD::Handle childHandle : children)
+    {
+        DeleteGameObjectTree(childHandle);
+    }
+
+    delete pObject;
+    mPool.Remove(handle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void GameManager::RenderImGui()
 {
 #if IMGUI_ENABLED()
     static GameObject * pSelectedGameObject = nullptr;
 
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::G))
+    if (GetManager<InputManager>()->GetSnapshot().IsDown(EAction::ToggleDebugWindow))
     {
         mShowImGuiWindow = true;
     }
@@ -270,6 +420,8 @@ void GameManager::RenderImGui()
     {
         ImGui::Begin("Game Objects", &mShowImGuiWindow, ImGuiWindowFlags_NoCollapse);
 
+        ImGui::Text("Last restart: %.2f ms", mLastResetMilliseconds);
+
         ImGui::Columns(2, "GameObjectsColumns", true);
 
         // LEFT SIDE: GameObject Tree
@@ -317,11 +469,19 @@ void GameManager::RenderImGui()
 
             for (auto * pComponent : pSelectedGameObject->GetAllComponents())
             {
-                std::string componentLabel = "" + pComponent->GetClassName();
-
-                if (ImGui::CollapsingHeader(componentLabel.c_str()))
+                const ComponentTypeInfo & typeInfo = pComponent->GetTypeInfo();
+                if (ImGui::CollapsingHeader(typeInfo.mName.c_str()))
                 {
-                    pComponent->DebugImGuiComponentInfo();
+                    typeInfo.mpInspect(typeInfo, *pComponent);
+
+                    ImGui::PushID(pComponent);
+                    if (ImGui::Button("Copy as JSON"))
+                    {
+                        nlohmann::json componentJson;
+                        typeInfo.mpSave(typeInfo, *pComponent, componentJson);
+                        ImGui::SetClipboardText(componentJson.dump(4).c_str());
+                    }
+                    ImGui::PopID();
                 }
             }
         }
@@ -334,6 +494,45 @@ void GameManager::RenderImGui()
         ImGui::Columns(1);
 
         ImGui::End();
+
+        if (auto * pInfluenceMapManager = GetManager<InfluenceMapManager>())
+        {
+            pInfluenceMapManager->DebugImGuiInfo();
+        }
+        if (auto * pAIScheduler = GetManager<AIScheduler>())
+        {
+            pAIScheduler->DebugImGuiInfo();
+        }
+        if (auto * pWaveManager = GetManager<WaveManager>())
+        {
+            pWaveManager->DebugImGuiInfo();
+        }
+        if (auto * pDungeonManager = GetManager<DungeonManager>())
+        {
+            pDungeonManager->DebugImGuiInfo();
+        }
+        if (auto * pChunkStreamer = GetManager<ChunkStreamer>())
+        {
+            pChunkStreamer->DebugImGuiInfo();
+        }
+        if (auto * pSnapshotManager = GetManager<SnapshotManager>())
+        {
+            pSnapshotManager->DebugImGuiInfo();
+        }
+        if (auto * pRollbackManager = GetManager<RollbackManager>())
+        {
+            pRollbackManager->DebugImGuiInfo();
+        }
+        if (auto * pNetworkManager = GetManager<NetworkManager>())
+        {
+            pNetworkManager->DebugImGuiInfo();
+        }
+        if (auto * pInputManager = GetManager<InputManager>())
+        {
+            pInputManager->DebugImGuiInfo();
+        }
+        mWindowManager.GetFramePacer().DebugImGuiInfo(*mpWindow);
+        ComponentRegistry::Get().DebugImGuiInfo();
     }
 #endif
 }
@@ -435,6 +634,10 @@ GameObject * GameManager::GetGameObject(BD::Handle handle)
 
 void GameManager::RemoveGameObject(BD::Handle handle)
 {
+    if (auto * pSpatialIndex = GetManager<SpatialIndex>())
+    {
+        pSpatialIndex->Remove(handle);
+    }
     mPool.Remove(handle);
 }
 
@@ -521,6 +724,13 @@ std::vector<BD::Handle> GameManager::GetGameObjectsByTeam(ETeam team)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+JobSystem & GameManager::GetJobSystem()
+{
+    return mJobSystem;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void GameManager::InitWindow()
 {
     mpWindow->setMouseCursorVisible(false);
@@ -9,6 +9,8 @@
 #include "WindowManager.h"
 #include "CollisionListener.h"
 #include "TPool.h"
+#include "JobSystem.h"
+#include "Timer.h"
 
 class BaseManager;
 struct ParallaxLayer
@@ -27,8 +29,20 @@ public:
 
 	void EndGame();
 
+	// Called by the LevelManager before it frees a level, see BaseManager::OnLevelUnloading
+	void NotifyLevelUnloading();
+
+	// Starts a new game in place of a fresh GameManager. Resources, fonts, audio, the ImGui context, the b2World and an
+	// unchanged level all stay resident, only GameObjects and per game manager state are rebuilt. Ends the current
+	// game first if it is still running.
+	void Reset();
+	float GetLastResetMilliseconds() const;
+
 	void Update(float deltaTime);
 
+	// Time spent in the Update in progress, or in the last one once it has returned
+	float GetUpdateMilliseconds() const;
+
 	void DebugUpdate(float deltaTime);
 
 	void UpdateGameObjects(float deltaTime);
@@ -71,6 +85,11 @@ public:
 
 	std::vector<BD::Handle> GetGameObjectsByTeam(ETeam team);
 
+	// Deletes GameObjects marked destroyed now rather than at the end of the next UpdateGameObjects
+	void RemoveDestroyedGameObjects();
+
+	JobSystem & GetJobSystem();
+
 	// Window
 	WindowManager & mWindowManager;
 	sf::Event mEvent;
@@ -79,6 +98,9 @@ private:
 
 	void CleanUpDestroyedGameObjects(BD::Handle rootHandle);
 
+	// Deletes the object and everything under it, destroyed or not
+	void DeleteGameObjectTree(BD::Handle handle);
+
 	void RenderImGui();
 
 	void InitWindow();
@@ -90,15 +112,13 @@ private:
 	std::vector<std::string> GetCommonResourcePaths();
 
 	bool mShowImGuiWindow;
+	JobSystem mJobSystem;
+	StopWatch mUpdateStopWatch;
+	float mLastResetMilliseconds;
 	std::vector<std::pair<std::type_index, BaseManager *>> mManagers;
 	BD::Handle mRootHandle;
 	TPool<GameObject> mPool;
 
-	// Audio
-	sf::SoundBuffer mSoundBuffer;
-	sf::Sound mSound;
-	bool mSoundPlayed;
-
 	// GameOver
 	bool mIsGameOver;
 	sf::Text mGameOverText;
@@ -6,6 +6,7 @@
 #include "BDConfig.h"
 #include "GameComponent.h"
 #include "PlayerManager.h"
+#include "SpatialIndex.h"
 
 //------------------------------------------------------------------------------------------------------------------------
 
@@ -17,6 +18,7 @@ GameObject::GameObject(GameManager * pGameManager, ETeam team, BD::Handle handle
     , mChildHandles()
     , mHandle(handle)
     , mParentHandle(parentHandle)
+    , mpPhysicsBody(nullptr)
 {
 }
 
@@ -48,6 +50,10 @@ void GameObject::CleanUpChildren()
 void GameObject::Destroy()
 {
     mIsDestroyed = true;
+    if (auto * pSpatialIndex = GetGameManager().GetManager<SpatialIndex>())
+    {
+        pSpatialIndex->MarkMoved(mHandle);
+    }
     for (auto childHandle : mChildHandles)
     {
         auto * pChild = GetGameManager().GetGameObject(childHandle);
@@ -168,6 +174,10 @@ ETeam GameObject::GetTeam() const
 void GameObject::SetTeam(ETeam team)
 {
     mTeam = team;
+    if (auto * pSpatialIndex = GetGameManager().GetManager<SpatialIndex>())
+    {
+        pSpatialIndex->MarkMoved(mHandle);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -400,9 +410,10 @@ void GameObject::DebugImGuiInfo()
             ImGui::Text("Children count: %zu", childObjs.size());
         }
         // Update each component
-        if (ImGui::CollapsingHeader(component.first.name()))
+        const ComponentTypeInfo & typeInfo = component.second->GetTypeInfo();
+        if (ImGui::CollapsingHeader(typeInfo.mName.c_str()))
         {
-            component.second->DebugImGuiComponentInfo();
+            typeInfo.mpInspect(typeInfo, *component.second);
         }
     }
 #endif
@@ -63,6 +63,12 @@ public:
         return mComponents.find(std::type_index(typeid(T))) != mComponents.end();
     }
 
+    template <typename T>
+    void RemoveComponent()
+    {
+        mComponents.erase(std::type_index(typeid(T)));
+    }
+
     void Update(float deltaTime);
 
     ETeam GetTeam() const;
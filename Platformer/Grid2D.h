@@ -0,0 +1,188 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------
+// GridRowView / GridRectView
+//
+// Non-owning windows into a Grid2D. Rows are contiguous so they can be walked with a plain pointer; a rect view hands
+// out one row view per line of the rect.
+//------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class GridRowView
+{
+public:
+    GridRowView(T * pData, int count)
+        : mpData(pData)
+        , mCount(count)
+    {
+    }
+
+    T & operator[](int index) const { return mpData[index]; }
+    T * begin() const { return mpData; }
+    T * end() const { return mpData + mCount; }
+    int GetCount() const { return mCount; }
+
+private:
+    T * mpData;
+    int mCount;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class GridRectView
+{
+public:
+    GridRectView(T * pTopLeft, int stride, int width, int height)
+        : mpTopLeft(pTopLeft)
+        , mStride(stride)
+        , mWidth(width)
+        , mHeight(height)
+    {
+    }
+
+    GridRowView<T> GetRow(int row) const { return GridRowView<T>(mpTopLeft + row * mStride, mWidth); }
+    T & operator()(int x, int y) const { return mpTopLeft[y * mStride + x]; }
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+
+    template <typename Func>
+    void ForEach(Func && func) const
+    {
+        for (int y = 0; y < mHeight; ++y)
+        {
+            T * pRow = mpTopLeft + y * mStride;
+            for (int x = 0; x < mWidth; ++x)
+            {
+                func(x, y, pRow[x]);
+            }
+        }
+    }
+
+private:
+    T * mpTopLeft;
+    int mStride;
+    int mWidth;
+    int mHeight;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// Grid2D
+//
+// Row-major grid in one contiguous allocation. operator() is unchecked for hot loops that already know they are in
+// bounds, At() asserts, and Get() returns a fallback for cells off the grid.
+//------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class Grid2D
+{
+    static_assert(!std::is_same<T, bool>::value, "Use BitGrid for boolean layers");
+
+public:
+    Grid2D()
+        : mWidth(0)
+        , mHeight(0)
+        , mCells()
+    {
+    }
+
+    Grid2D(int width, int height, const T & fillValue = T())
+        : mWidth(width)
+        , mHeight(height)
+        , mCells(size_t(width) * height, fillValue)
+    {
+    }
+
+    void Resize(int width, int height, const T & fillValue = T())
+    {
+        mWidth = width;
+        mHeight = height;
+        mCells.assign(size_t(width) * height, fillValue);
+    }
+
+    void Fill(const T & value)
+    {
+        std::fill(mCells.begin(), mCells.end(), value);
+    }
+
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+    int GetCellCount() const { return int(mCells.size()); }
+    bool IsEmpty() const { return mCells.empty(); }
+
+    bool IsInBounds(int x, int y) const
+    {
+        return unsigned(x) < unsigned(mWidth) && unsigned(y) < unsigned(mHeight);
+    }
+
+    int GetIndex(int x, int y) const { return y * mWidth + x; }
+
+    // Unchecked
+    T & operator()(int x, int y) { return mCells[size_t(y) * mWidth + x]; }
+    const T & operator()(int x, int y) const { return mCells[size_t(y) * mWidth + x]; }
+
+    // Checked
+    T & At(int x, int y)
+    {
+        assert(IsInBounds(x, y) && "Grid2D access out of bounds");
+        return (*this)(x, y);
+    }
+
+    const T & At(int x, int y) const
+    {
+        assert(IsInBounds(x, y) && "Grid2D access out of bounds");
+        return (*this)(x, y);
+    }
+
+    T Get(int x, int y, const T & outOfBoundsValue) const
+    {
+        return IsInBounds(x, y) ? (*this)(x, y) : outOfBoundsValue;
+    }
+
+    T * GetData() { return mCells.data(); }
+    const T * GetData() const { return mCells.data(); }
+
+    GridRowView<T> GetRow(int y) { return GridRowView<T>(&(*this)(0, y), mWidth); }
+    GridRowView<const T> GetRow(int y) const { return GridRowView<const T>(&(*this)(0, y), mWidth); }
+
+    // The rect is clipped to the grid
+    GridRectView<T> GetRect(int x, int y, int width, int height)
+    {
+        ClipRect(x, y, width, height);
+        return GridRectView<T>(mCells.data() + GetIndex(x, y), mWidth, width, height);
+    }
+
+    GridRectView<const T> GetRect(int x, int y, int width, int height) const
+    {
+        ClipRect(x, y, width, height);
+        return GridRectView<const T>(mCells.data() + GetIndex(x, y), mWidth, width, height);
+    }
+
+private:
+    void ClipRect(int & x, int & y, int & width, int & height) const
+    {
+        int right = std::min(x + width, mWidth);
+        int bottom = std::min(y + height, mHeight);
+        x = std::max(x, 0);
+        y = std::max(y, 0);
+        width = std::max(0, right - x);
+        height = std::max(0, bottom - y);
+        if (width == 0 || height == 0)
+        {
+            x = 0;
+            y = 0;
+        }
+    }
+
+    int mWidth;
+    int mHeight;
+    std::vector<T> mCells;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
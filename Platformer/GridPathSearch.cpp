@@ -0,0 +1,466 @@
+#include "AstroidsPrivate.h"
+#include "GridPathSearch.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace
+{
+    const int skClosed = -1;
+    const int skStraightCost = 10;
+    const int skDiagonalCost = 14;
+
+    int Sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    int OctileDistance(int dx, int dy)
+    {
+        dx = std::abs(dx);
+        dy = std::abs(dy);
+        return skStraightCost * std::max(dx, dy) + (skDiagonalCost - skStraightCost) * std::min(dx, dy);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+GridPathSearch::GridPathSearch()
+    : mWalkable()
+    , mNodes()
+    , mHeap()
+    , mGeneration(0)
+    , mWidth(0)
+    , mStartCell(-1)
+    , mGoalCell(-1)
+    , mGoalX(0)
+    , mGoalY(0)
+    , mStatus(ESearchStatus::NotFound)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::Begin(const BitGridView & walkable, const sf::Vector2i & start, const sf::Vector2i & goal)
+{
+    mWalkable = walkable;
+    mWidth = walkable.GetWidth();
+    mHeap.clear();
+
+    int cellCount = walkable.GetWidth() * walkable.GetHeight();
+    if (int(mNodes.size()) != cellCount)
+    {
+        ResetNodes(cellCount);
+    }
+
+    // Generation zero marks untouched nodes, so wrapping has to clear the stamps
+    if (++mGeneration == 0)
+    {
+        ResetNodes(cellCount);
+        mGeneration = 1;
+    }
+
+    // The start may be off the walkable layer (an enemy squeezed against a wall), the goal may not
+    if (!walkable.IsInBounds(start.x, start.y) || !walkable.Test(goal.x, goal.y))
+    {
+        mStatus = ESearchStatus::NotFound;
+        return;
+    }
+
+    mStartCell = start.y * mWidth + start.x;
+    mGoalCell = goal.y * mWidth + goal.x;
+    mGoalX = goal.x;
+    mGoalY = goal.y;
+    mStatus = ESearchStatus::Running;
+    OpenNode(mStartCell, -1, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ESearchStatus GridPathSearch::Step(int maxExpansions, int & outExpansions)
+{
+    outExpansions = 0;
+    while (mStatus == ESearchStatus::Running && outExpansions < maxExpansions)
+    {
+        if (mHeap.empty())
+        {
+            mStatus = ESearchStatus::NotFound;
+            break;
+        }
+
+        int cell = HeapPop();
+        ++outExpansions;
+        if (cell == mGoalCell)
+        {
+            mStatus = ESearchStatus::Found;
+            break;
+        }
+        Expand(cell);
+    }
+    return mStatus;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool GridPathSearch::FindPath(const BitGridView & walkable, const sf::Vector2i & start, const sf::Vector2i & goal, std::vector<sf::Vector2i> & outPath)
+{
+    Begin(walkable, start, goal);
+
+    int expansions = 0;
+    while (Step(INT_MAX, expansions) == ESearchStatus::Running)
+    {
+    }
+
+    GetPath(outPath);
+    return mStatus == ESearchStatus::Found;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::GetPath(std::vector<sf::Vector2i> & outPath) const
+{
+    outPath.clear();
+    if (mStatus != ESearchStatus::Found)
+    {
+        return;
+    }
+
+    // Walk the jump points back to the start, filling in the straight or diagonal run between each pair
+    for (int cell = mGoalCell; cell != -1; cell = mNodes[cell].mParent)
+    {
+        sf::Vector2i tile(cell % mWidth, cell / mWidth);
+        outPath.push_back(tile);
+
+        int parent = mNodes[cell].mParent;
+        if (parent == -1)
+        {
+            break;
+        }
+
+        sf::Vector2i parentTile(parent % mWidth, parent / mWidth);
+        sf::Vector2i step(Sign(parentTile.x - tile.x), Sign(parentTile.y - tile.y));
+        for (tile += step; tile != parentTile; tile += step)
+        {
+            outPath.push_back(tile);
+        }
+    }
+    std::reverse(outPath.begin(), outPath.end());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int GridPathSearch::GetPathCost() const
+{
+    return mStatus == ESearchStatus::Found ? mNodes[mGoalCell].mG : -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::ResetNodes(int cellCount)
+{
+    mNodes.assign(cellCount, SearchNode{ 0, -1, 0, 0, skClosed });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::OpenNode(int cell, int parent, int g)
+{
+    SearchNode & node = mNodes[cell];
+    if (node.mGeneration != mGeneration)
+    {
+        node.mGeneration = mGeneration;
+        node.mParent = parent;
+        node.mG = g;
+        node.mF = g + Heuristic(cell % mWidth, cell / mWidth);
+        HeapPush(cell);
+    }
+    else if (node.mHeapIndex != skClosed && g < node.mG)
+    {
+        // Decrease-key, the heuristic part of f is unchanged
+        node.mF -= node.mG - g;
+        node.mG = g;
+        node.mParent = parent;
+        HeapSiftUp(node.mHeapIndex);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::Expand(int cell)
+{
+    int x = cell % mWidth;
+    int y = cell / mWidth;
+    int parent = mNodes[cell].mParent;
+
+    if (parent == -1)
+    {
+        // The start has no direction to prune by, so try every legal move
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                if ((dx != 0 || dy != 0) && IsOpen(x + dx, y + dy) && (dx == 0 || dy == 0 || (IsOpen(x + dx, y) && IsOpen(x, y + dy))))
+                {
+                    AddJumpPoint(cell, Jump(x, y, dx, dy));
+                }
+            }
+        }
+        return;
+    }
+
+    int dx = Sign(x - parent % mWidth);
+    int dy = Sign(y - parent / mWidth);
+
+    // Natural and forced neighbors for the no corner cutting rule set. Diagonal moves need both sides open, so only
+    // straight moves can have forced neighbors, found where a wall beside the run ends.
+    if (dx != 0 && dy != 0)
+    {
+        bool verticalOpen = IsOpen(x, y + dy);
+        bool horizontalOpen = IsOpen(x + dx, y);
+        if (verticalOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, 0, dy));
+        }
+        if (horizontalOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, dx, 0));
+        }
+        if (verticalOpen && horizontalOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, dx, dy));
+        }
+    }
+    else if (dx != 0)
+    {
+        bool nextOpen = IsOpen(x + dx, y);
+        bool belowOpen = IsOpen(x, y + 1);
+        bool aboveOpen = IsOpen(x, y - 1);
+        if (nextOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, dx, 0));
+            if (belowOpen)
+            {
+                AddJumpPoint(cell, Jump(x, y, dx, 1));
+            }
+            if (aboveOpen)
+            {
+                AddJumpPoint(cell, Jump(x, y, dx, -1));
+            }
+        }
+        if (belowOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, 0, 1));
+        }
+        if (aboveOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, 0, -1));
+        }
+    }
+    else
+    {
+        bool nextOpen = IsOpen(x, y + dy);
+        bool rightOpen = IsOpen(x + 1, y);
+        bool leftOpen = IsOpen(x - 1, y);
+        if (nextOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, 0, dy));
+            if (rightOpen)
+            {
+                AddJumpPoint(cell, Jump(x, y, 1, dy));
+            }
+            if (leftOpen)
+            {
+                AddJumpPoint(cell, Jump(x, y, -1, dy));
+            }
+        }
+        if (rightOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, 1, 0));
+        }
+        if (leftOpen)
+        {
+            AddJumpPoint(cell, Jump(x, y, -1, 0));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::AddJumpPoint(int parentCell, int jumpPoint)
+{
+    if (jumpPoint == -1 || (mNodes[jumpPoint].mGeneration == mGeneration && mNodes[jumpPoint].mHeapIndex == skClosed))
+    {
+        return;
+    }
+
+    int dx = jumpPoint % mWidth - parentCell % mWidth;
+    int dy = jumpPoint / mWidth - parentCell / mWidth;
+    OpenNode(jumpPoint, parentCell, mNodes[parentCell].mG + OctileDistance(dx, dy));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int GridPathSearch::JumpStraight(int x, int y, int dx, int dy) const
+{
+    while (true)
+    {
+        x += dx;
+        y += dy;
+        if (!IsOpen(x, y))
+        {
+            return -1;
+        }
+        if (x == mGoalX && y == mGoalY)
+        {
+            return y * mWidth + x;
+        }
+
+        // A side cell that opens up just past a wall is a forced neighbor
+        if (dx != 0)
+        {
+            if ((IsOpen(x, y - 1) && !IsOpen(x - dx, y - 1)) || (IsOpen(x, y + 1) && !IsOpen(x - dx, y + 1)))
+            {
+                return y * mWidth + x;
+            }
+        }
+        else
+        {
+            if ((IsOpen(x - 1, y) && !IsOpen(x - 1, y - dy)) || (IsOpen(x + 1, y) && !IsOpen(x + 1, y - dy)))
+            {
+                return y * mWidth + x;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int GridPathSearch::Jump(int x, int y, int dx, int dy) const
+{
+    if (dx == 0 || dy == 0)
+    {
+        return JumpStraight(x, y, dx, dy);
+    }
+
+    while (true)
+    {
+        if (!IsOpen(x + dx, y) || !IsOpen(x, y + dy))
+        {
+            return -1;
+        }
+        x += dx;
+        y += dy;
+        if (!IsOpen(x, y))
+        {
+            return -1;
+        }
+        if (x == mGoalX && y == mGoalY)
+        {
+            return y * mWidth + x;
+        }
+
+        // A diagonal cell is a jump point whenever either straight run leaving it finds one
+        if (JumpStraight(x, y, dx, 0) != -1 || JumpStraight(x, y, 0, dy) != -1)
+        {
+            return y * mWidth + x;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int GridPathSearch::Heuristic(int x, int y) const
+{
+    return OctileDistance(mGoalX - x, mGoalY - y);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool GridPathSearch::HeapLess(int cellA, int cellB) const
+{
+    const SearchNode & a = mNodes[cellA];
+    const SearchNode & b = mNodes[cellB];
+    return a.mF < b.mF || (a.mF == b.mF && a.mG > b.mG);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::HeapPush(int cell)
+{
+    mHeap.push_back(cell);
+    mNodes[cell].mHeapIndex = int(mHeap.size()) - 1;
+    HeapSiftUp(mNodes[cell].mHeapIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int GridPathSearch::HeapPop()
+{
+    int top = mHeap.front();
+    mNodes[top].mHeapIndex = skClosed;
+
+    int last = mHeap.back();
+    mHeap.pop_back();
+    if (!mHeap.empty())
+    {
+        mHeap[0] = last;
+        mNodes[last].mHeapIndex = 0;
+        HeapSiftDown(0);
+    }
+    return top;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::HeapSiftUp(int heapIndex)
+{
+    int cell = mHeap[heapIndex];
+    while (heapIndex > 0)
+    {
+        int parentIndex = (heapIndex - 1) / 2;
+        if (!HeapLess(cell, mHeap[parentIndex]))
+        {
+            break;
+        }
+        mHeap[heapIndex] = mHeap[parentIndex];
+        mNodes[mHeap[heapIndex]].mHeapIndex = heapIndex;
+        heapIndex = parentIndex;
+    }
+    mHeap[heapIndex] = cell;
+    mNodes[cell].mHeapIndex = heapIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void GridPathSearch::HeapSiftDown(int heapIndex)
+{
+    int cell = mHeap[heapIndex];
+    int count = int(mHeap.size());
+    while (true)
+    {
+        int childIndex = heapIndex * 2 + 1;
+        if (childIndex >= count)
+        {
+            break;
+        }
+        if (childIndex + 1 < count && HeapLess(mHeap[childIndex + 1], mHeap[childIndex]))
+        {
+            ++childIndex;
+        }
+        if (!HeapLess(mHeap[childIndex], cell))
+        {
+            break;
+        }
+        mHeap[heapIndex] = mHeap[childIndex];
+        mNodes[mHeap[heapIndex]].mHeapIndex = heapIndex;
+        heapIndex = childIndex;
+    }
+    mHeap[heapIndex] = cell;
+    mNodes[cell].mHeapIndex = heapIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
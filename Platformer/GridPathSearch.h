@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BitGrid.h"
+
+enum class ESearchStatus
+{
+    Running,
+    Found,
+    NotFound
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// GridPathSearch
+//
+// Jump Point Search over a uniform cost walkable layer with 8-way movement that never cuts a wall corner. Node state
+// lives in flat arrays sized to the grid and stamped with a search generation, so starting a new search costs nothing
+// and nodes are never allocated. The open list is a binary heap over cell indices with decrease-key. Step() runs a
+// bounded number of expansions so a caller can spread one search across frames.
+//------------------------------------------------------------------------------------------------------------------------
+
+class GridPathSearch
+{
+public:
+    GridPathSearch();
+
+    void Begin(const BitGridView & walkable, const sf::Vector2i & start, const sf::Vector2i & goal);
+
+    // Expands at most maxExpansions nodes. outExpansions receives how many were used.
+    ESearchStatus Step(int maxExpansions, int & outExpansions);
+
+    // Runs the whole search at once
+    bool FindPath(const BitGridView & walkable, const sf::Vector2i & start, const sf::Vector2i & goal, std::vector<sf::Vector2i> & outPath);
+
+    ESearchStatus GetStatus() const { return mStatus; }
+
+    // Every tile from start to goal inclusive, only valid once the search is Found
+    void GetPath(std::vector<sf::Vector2i> & outPath) const;
+
+    // Path length in tenths of a tile (straight steps cost 10, diagonal steps 14)
+    int GetPathCost() const;
+
+private:
+    struct SearchNode
+    {
+        uint32_t mGeneration;
+        int mParent;
+        int mG;
+        int mF;
+        int mHeapIndex;  // skClosed once expanded
+    };
+
+    void ResetNodes(int cellCount);
+    void OpenNode(int cell, int parent, int g);
+    void Expand(int cell);
+    void AddJumpPoint(int parentCell, int jumpPoint);
+    int JumpStraight(int x, int y, int dx, int dy) const;
+    int Jump(int x, int y, int dx, int dy) const;
+    int Heuristic(int x, int y) const;
+
+    bool IsOpen(int x, int y) const { return mWalkable.Test(x, y); }
+
+    // Binary heap on mF, ties broken toward the goal
+    bool HeapLess(int cellA, int cellB) const;
+    void HeapPush(int cell);
+    int HeapPop();
+    void HeapSiftUp(int heapIndex);
+    void HeapSiftDown(int heapIndex);
+
+    BitGridView mWalkable;
+    std::vector<SearchNode> mNodes;
+    std::vector<int> mHeap;
+    uint32_t mGeneration;
+
+    int mWidth;
+    int mStartCell;
+    int mGoalCell;
+    int mGoalX;
+    int mGoalY;
+    ESearchStatus mStatus;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -2,7 +2,6 @@
 #include "HealthComponent.h"
 #include <iostream>
 #include "PlayerManager.h"
-#include "ExplosionComponent.h"
 #include "SpriteComponent.h"
 #include <functional>
 #include <cmath>
@@ -16,7 +15,6 @@ HealthComponent::HealthComponent(GameObject * pOwner, GameManager & gameManager,
     , mMaxLives(maxLives)
     , mHitCooldown(hitCooldown)
     , mTimeSinceLastHit(0.f)
-    , mName("HealthComponent")
 {
 }
 
@@ -83,6 +81,15 @@ void HealthComponent::AddMaxHealth(int amount)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void HealthComponent::Revive()
+{
+    mHealth = mMaxHealth;
+    mLifeCount = mMaxLives;
+    mTimeSinceLastHit = 0.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void HealthComponent::SetDeathCallBack(std::function<void()> callback)
 {
     mDeathCallback = callback;
@@ -97,6 +104,30 @@ void HealthComponent::SetLifeLostCallback(std::function<void()> callback)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void HealthComponent::SaveState(SnapshotFormat::HealthRecord & outRecord) const
+{
+    outRecord.mHealth = mHealth;
+    outRecord.mMaxHealth = mMaxHealth;
+    outRecord.mLifeCount = mLifeCount;
+    outRecord.mMaxLives = mMaxLives;
+    outRecord.mHitCooldown = mHitCooldown;
+    outRecord.mTimeSinceLastHit = mTimeSinceLastHit;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HealthComponent::LoadState(const SnapshotFormat::HealthRecord & record)
+{
+    mHealth = record.mHealth;
+    mMaxHealth = record.mMaxHealth;
+    mLifeCount = record.mLifeCount;
+    mMaxLives = record.mMaxLives;
+    mHitCooldown = record.mHitCooldown;
+    mTimeSinceLastHit = record.mTimeSinceLastHit;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void HealthComponent::LoseLife()
 {
     if (mLifeCount == 1)
@@ -170,19 +201,16 @@ void HealthComponent::Update(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void HealthComponent::DebugImGuiComponentInfo()
-{
-    ImGui::Text("Current amount of lives: %i", mLifeCount);
-    ImGui::Text("Max Lives: %i", mMaxLives);
-    ImGui::Text("Current Health: %i", mHealth);
-    ImGui::Text("Max Health: %i", mMaxHealth);
-}
-
-//------------------------------------------------------------------------------------------------------------------------
+BD_REGISTER_COMPONENT(HealthComponent)
 
-std::string & HealthComponent::GetClassName()
+void HealthComponent::DescribeType(ComponentTypeInfo & typeInfo)
 {
-    return mName;
+    typeInfo.AddField<&HealthComponent::mHealth>("Health");
+    typeInfo.AddField<&HealthComponent::mMaxHealth>("MaxHealth");
+    typeInfo.AddField<&HealthComponent::mLifeCount>("Lives");
+    typeInfo.AddField<&HealthComponent::mMaxLives>("MaxLives");
+    typeInfo.AddField<&HealthComponent::mHitCooldown>("HitCooldown");
+    typeInfo.AddField<&HealthComponent::mTimeSinceLastHit>("TimeSinceLastHit");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
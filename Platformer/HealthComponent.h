@@ -1,9 +1,12 @@
 #pragma once
 #include "GameComponent.h"
+#include "SnapshotFormat.h"
 #include <functional>
 
 class HealthComponent : public GameComponent
 {
+	BD_COMPONENT(HealthComponent)
+
 public:
 	HealthComponent(GameObject * pOwner, GameManager & gameManager, int initialHealth, int maxHealth, int lifeCount, int maxLives, float hitCooldown = 0.f);
 
@@ -18,12 +21,17 @@ public:
 	int GetMaxHealth() const;
 	void AddMaxHealth(int amount);
 
+	// Back to full health and lives, for an owner that is reused after dying
+	void Revive();
+
 	void SetDeathCallBack(std::function<void()> callback);
 	void SetLifeLostCallback(std::function<void()> callback);
 
+	// Snapshot state, the callbacks are not saved since the owning managers set them every Update
+	void SaveState(SnapshotFormat::HealthRecord & outRecord) const;
+	void LoadState(const SnapshotFormat::HealthRecord & record);
+
 	virtual void Update(float deltaTime) override;
-	virtual void DebugImGuiComponentInfo() override;
-	virtual std::string & GetClassName() override;
 
 private:
 	int mHealth;
@@ -32,7 +40,6 @@ private:
 	int mMaxLives;
 	float mHitCooldown;
 	float mTimeSinceLastHit;
-	std::string mName;
 	
 	std::function<void()> mLifeLostCallback;
 	std::function<void()> mDeathCallback;
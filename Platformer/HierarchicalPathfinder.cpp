@@ -0,0 +1,611 @@
+#include "AstroidsPrivate.h"
+#include "HierarchicalPathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace
+{
+    const int skStraightCost = 10;
+    const int skDiagonalCost = 14;
+
+    // Border runs at least this long get a transition at each end instead of one in the middle
+    const int skLongEntranceLength = 6;
+
+    int OctileDistance(int dx, int dy)
+    {
+        dx = std::abs(dx);
+        dy = std::abs(dy);
+        return skStraightCost * std::max(dx, dy) + (skDiagonalCost - skStraightCost) * std::min(dx, dy);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+HierarchicalPathfinder::HierarchicalPathfinder(int clusterSize)
+    : mWalkable()
+    , mClusterSize(clusterSize)
+    , mClustersWide(0)
+    , mClustersHigh(0)
+    , mClusters()
+    , mHasDirtyClusters(false)
+    , mNodeCluster()
+    , mNodeCell()
+    , mSearchRect()
+    , mClusterBuckets()
+    , mClusterCost(size_t(clusterSize) * clusterSize)
+    , mClusterParent(size_t(clusterSize) * clusterSize)
+    , mClusterGeneration(size_t(clusterSize) * clusterSize, 0)
+    , mClusterSearchGeneration(0)
+    , mNodeOpen()
+    , mNodeG()
+    , mNodeParent()
+    , mNodeGeneration()
+    , mNodeClosedGeneration()
+    , mAbstractSearchGeneration(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::Build(const BitGridView & walkable)
+{
+    mWalkable = walkable;
+    mClustersWide = (walkable.GetWidth() + mClusterSize - 1) / mClusterSize;
+    mClustersHigh = (walkable.GetHeight() + mClusterSize - 1) / mClusterSize;
+    mClusters.assign(size_t(mClustersWide) * mClustersHigh, Cluster());
+    mHasDirtyClusters = true;
+    RebuildDirtyClusters();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::MarkDirty(const sf::IntRect & tiles)
+{
+    if (!IsBuilt())
+    {
+        return;
+    }
+
+    // Grow by a tile so a change on a cluster edge also dirties the neighbor sharing that border
+    int left = std::max(tiles.left - 1, 0) / mClusterSize;
+    int top = std::max(tiles.top - 1, 0) / mClusterSize;
+    int right = std::min(tiles.left + tiles.width, mWalkable.GetWidth() - 1) / mClusterSize;
+    int bottom = std::min(tiles.top + tiles.height, mWalkable.GetHeight() - 1) / mClusterSize;
+    for (int cy = top; cy <= bottom; ++cy)
+    {
+        for (int cx = left; cx <= right; ++cx)
+        {
+            mClusters[cy * mClustersWide + cx].mDirty = true;
+            mHasDirtyClusters = true;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool HierarchicalPathfinder::FindPath(const sf::Vector2i & start, const sf::Vector2i & goal, HierarchicalPath & outPath)
+{
+    outPath.mWaypoints.clear();
+    outPath.mNextSegment = 0;
+    if (!IsBuilt() || !mWalkable.IsInBounds(start.x, start.y) || !mWalkable.Test(goal.x, goal.y))
+    {
+        return false;
+    }
+    RebuildDirtyClusters();
+
+    int width = mWalkable.GetWidth();
+    int startCell = start.y * width + start.x;
+    int goalCell = goal.y * width + goal.x;
+    int startCluster = GetClusterIndex(start.x, start.y);
+    int goalCluster = GetClusterIndex(goal.x, goal.y);
+
+    if (startCell == goalCell)
+    {
+        outPath.mWaypoints.push_back(start);
+        return true;
+    }
+
+    // Within one cluster a path that stays inside it is good enough
+    if (startCluster == goalCluster)
+    {
+        SearchCluster(startCluster, startCell, goalCell);
+        if (GetClusterCost(goalCell) >= 0)
+        {
+            outPath.mWaypoints.push_back(start);
+            outPath.mWaypoints.push_back(goal);
+            return true;
+        }
+    }
+
+    // Link the query's endpoints to the entrances of their clusters
+    const Cluster & startClusterData = mClusters[startCluster];
+    const Cluster & goalClusterData = mClusters[goalCluster];
+
+    std::vector<int> startCosts(startClusterData.mEntrances.size());
+    SearchCluster(startCluster, startCell, -1);
+    for (size_t entrance = 0; entrance < startCosts.size(); ++entrance)
+    {
+        startCosts[entrance] = GetClusterCost(startClusterData.mEntrances[entrance].mCell);
+    }
+
+    std::vector<int> goalCosts(goalClusterData.mEntrances.size());
+    SearchCluster(goalCluster, goalCell, -1);
+    for (size_t entrance = 0; entrance < goalCosts.size(); ++entrance)
+    {
+        goalCosts[entrance] = GetClusterCost(goalClusterData.mEntrances[entrance].mCell);
+    }
+
+    // A* over the abstract graph
+    int nodeCount = int(mNodeCluster.size());
+    int startNode = nodeCount;
+    int goalNode = nodeCount + 1;
+
+    if (++mAbstractSearchGeneration == 0)
+    {
+        std::fill(mNodeGeneration.begin(), mNodeGeneration.end(), 0u);
+        std::fill(mNodeClosedGeneration.begin(), mNodeClosedGeneration.end(), 0u);
+        mAbstractSearchGeneration = 1;
+    }
+    uint32_t generation = mAbstractSearchGeneration;
+
+    auto getCell = [&](int node) { return node == startNode ? startCell : node == goalNode ? goalCell : mNodeCell[node]; };
+    auto heuristic = [&](int node)
+    {
+        int cell = getCell(node);
+        return OctileDistance(cell % width - goal.x, cell / width - goal.y);
+    };
+    auto relax = [&](int node, int parent, int g)
+    {
+        if (mNodeClosedGeneration[node] == generation)
+        {
+            return;
+        }
+        if (mNodeGeneration[node] != generation || g < mNodeG[node])
+        {
+            mNodeGeneration[node] = generation;
+            mNodeG[node] = g;
+            mNodeParent[node] = parent;
+            int h = heuristic(node);
+            mNodeOpen.push_back({ g + h, h, node });
+            std::push_heap(mNodeOpen.begin(), mNodeOpen.end(), std::greater<AbstractStep>());
+        }
+    };
+
+    mNodeOpen.clear();
+    relax(startNode, -1, 0);
+
+    bool found = false;
+    while (!mNodeOpen.empty())
+    {
+        std::pop_heap(mNodeOpen.begin(), mNodeOpen.end(), std::greater<AbstractStep>());
+        int node = mNodeOpen.back().mNode;
+        mNodeOpen.pop_back();
+        if (mNodeClosedGeneration[node] == generation)
+        {
+            continue;
+        }
+        mNodeClosedGeneration[node] = generation;
+
+        if (node == goalNode)
+        {
+            found = true;
+            break;
+        }
+
+        int g = mNodeG[node];
+        if (node == startNode)
+        {
+            for (size_t entrance = 0; entrance < startCosts.size(); ++entrance)
+            {
+                if (startCosts[entrance] >= 0)
+                {
+                    relax(startClusterData.mFirstNode + int(entrance), node, g + startCosts[entrance]);
+                }
+            }
+            continue;
+        }
+
+        int clusterIndex = mNodeCluster[node];
+        const Cluster & cluster = mClusters[clusterIndex];
+        int entrance = node - cluster.mFirstNode;
+        int entranceCount = int(cluster.mEntrances.size());
+
+        for (int other = 0; other < entranceCount; ++other)
+        {
+            int distance = cluster.mDistances[entrance * entranceCount + other];
+            if (other != entrance && distance >= 0)
+            {
+                relax(cluster.mFirstNode + other, node, g + distance);
+            }
+        }
+
+        for (int side = 0; side < SideCount; ++side)
+        {
+            int linkedNode = cluster.mEntrances[entrance].mLinkedNode[side];
+            if (linkedNode >= 0)
+            {
+                relax(linkedNode, node, g + skStraightCost);
+            }
+        }
+
+        if (clusterIndex == goalCluster && goalCosts[entrance] >= 0)
+        {
+            relax(goalNode, node, g + goalCosts[entrance]);
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+
+    for (int node = goalNode; node != -1; node = mNodeParent[node])
+    {
+        int cell = getCell(node);
+        outPath.mWaypoints.push_back(sf::Vector2i(cell % width, cell / width));
+    }
+    std::reverse(outPath.mWaypoints.begin(), outPath.mWaypoints.end());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool HierarchicalPathfinder::RefineNextSegment(HierarchicalPath & path, std::vector<sf::Vector2i> & outTiles)
+{
+    if (path.IsComplete())
+    {
+        return false;
+    }
+
+    sf::Vector2i from = path.mWaypoints[path.mNextSegment];
+    sf::Vector2i to = path.mWaypoints[path.mNextSegment + 1];
+    ++path.mNextSegment;
+
+    // Border crossings are a single straight step
+    if (std::abs(to.x - from.x) + std::abs(to.y - from.y) == 1)
+    {
+        if (!mWalkable.Test(to.x, to.y))
+        {
+            return false;
+        }
+        outTiles.push_back(to);
+        return true;
+    }
+
+    int cluster = GetClusterIndex(from.x, from.y);
+    if (!mWalkable.IsInBounds(to.x, to.y) || cluster != GetClusterIndex(to.x, to.y))
+    {
+        return false;
+    }
+
+    int width = mWalkable.GetWidth();
+    int fromCell = from.y * width + from.x;
+    int toCell = to.y * width + to.x;
+    SearchCluster(cluster, fromCell, toCell);
+    if (GetClusterCost(toCell) < 0)
+    {
+        return false;
+    }
+
+    size_t firstTile = outTiles.size();
+    int localCell = (to.y - mSearchRect.top) * mClusterSize + (to.x - mSearchRect.left);
+    int fromLocalCell = (from.y - mSearchRect.top) * mClusterSize + (from.x - mSearchRect.left);
+    while (localCell != fromLocalCell)
+    {
+        outTiles.push_back(sf::Vector2i(mSearchRect.left + localCell % mClusterSize, mSearchRect.top + localCell / mClusterSize));
+        localCell = mClusterParent[localCell];
+    }
+    std::reverse(outTiles.begin() + firstTile, outTiles.end());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int HierarchicalPathfinder::GetClusterIndex(int x, int y) const
+{
+    return (y / mClusterSize) * mClustersWide + x / mClusterSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+sf::IntRect HierarchicalPathfinder::GetClusterRect(int cluster) const
+{
+    int left = (cluster % mClustersWide) * mClusterSize;
+    int top = (cluster / mClustersWide) * mClusterSize;
+    return sf::IntRect(left, top, std::min(mClusterSize, mWalkable.GetWidth() - left), std::min(mClusterSize, mWalkable.GetHeight() - top));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::RebuildDirtyClusters()
+{
+    if (!mHasDirtyClusters)
+    {
+        return;
+    }
+
+    // Entrances on a shared border come out the same from either side, so dirty clusters can be redone on their
+    // own before the links between them are resolved
+    for (int cluster = 0; cluster < int(mClusters.size()); ++cluster)
+    {
+        if (mClusters[cluster].mDirty)
+        {
+            BuildEntrances(cluster);
+            BuildDistances(cluster);
+            mClusters[cluster].mDirty = false;
+        }
+    }
+
+    ResolveNodes();
+    mHasDirtyClusters = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::BuildEntrances(int cluster)
+{
+    mClusters[cluster].mEntrances.clear();
+    for (int side = 0; side < SideCount; ++side)
+    {
+        AddTransitions(cluster, ESide(side));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::AddTransitions(int cluster, ESide side)
+{
+    int cx = cluster % mClustersWide;
+    int cy = cluster / mClustersWide;
+    if ((side == Left && cx == 0) || (side == Right && cx == mClustersWide - 1) ||
+        (side == Up && cy == 0) || (side == Down && cy == mClustersHigh - 1))
+    {
+        return;
+    }
+
+    sf::IntRect rect = GetClusterRect(cluster);
+    bool vertical = side == Left || side == Right;
+    int length = vertical ? rect.height : rect.width;
+
+    // Walk along the border with (x, y) inside this cluster and (x + dx, y + dy) across it
+    int x = side == Right ? rect.left + rect.width - 1 : rect.left;
+    int y = side == Down ? rect.top + rect.height - 1 : rect.top;
+    int dx = side == Left ? -1 : side == Right ? 1 : 0;
+    int dy = side == Up ? -1 : side == Down ? 1 : 0;
+    int stepX = vertical ? 0 : 1;
+    int stepY = vertical ? 1 : 0;
+
+    int width = mWalkable.GetWidth();
+    auto addTransition = [&](int offset)
+    {
+        int ix = x + stepX * offset;
+        int iy = y + stepY * offset;
+        AddEntrance(mClusters[cluster], iy * width + ix, side, (iy + dy) * width + ix + dx);
+    };
+
+    int runStart = -1;
+    for (int offset = 0; offset <= length; ++offset)
+    {
+        int ix = x + stepX * offset;
+        int iy = y + stepY * offset;
+        bool open = offset < length && mWalkable.Test(ix, iy) && mWalkable.Test(ix + dx, iy + dy);
+        if (open && runStart < 0)
+        {
+            runStart = offset;
+        }
+        else if (!open && runStart >= 0)
+        {
+            int runEnd = offset - 1;
+            if (runEnd - runStart + 1 >= skLongEntranceLength)
+            {
+                addTransition(runStart);
+                addTransition(runEnd);
+            }
+            else
+            {
+                addTransition((runStart + runEnd) / 2);
+            }
+            runStart = -1;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::AddEntrance(Cluster & cluster, int cell, ESide side, int linkedCell)
+{
+    auto it = std::find_if(cluster.mEntrances.begin(), cluster.mEntrances.end(),
+        [cell](const Entrance & entrance) { return entrance.mCell == cell; });
+    if (it == cluster.mEntrances.end())
+    {
+        Entrance entrance;
+        entrance.mCell = cell;
+        std::fill(std::begin(entrance.mLinkedCell), std::end(entrance.mLinkedCell), -1);
+        std::fill(std::begin(entrance.mLinkedNode), std::end(entrance.mLinkedNode), -1);
+        cluster.mEntrances.push_back(entrance);
+        it = cluster.mEntrances.end() - 1;
+    }
+    it->mLinkedCell[side] = linkedCell;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::BuildDistances(int cluster)
+{
+    Cluster & data = mClusters[cluster];
+    int entranceCount = int(data.mEntrances.size());
+    data.mDistances.assign(size_t(entranceCount) * entranceCount, -1);
+
+    // Moves are symmetric, so each search fills a row and the matching column
+    for (int from = 0; from < entranceCount; ++from)
+    {
+        data.mDistances[from * entranceCount + from] = 0;
+        if (from + 1 == entranceCount)
+        {
+            break;
+        }
+
+        SearchCluster(cluster, data.mEntrances[from].mCell, -1);
+        for (int to = from + 1; to < entranceCount; ++to)
+        {
+            int cost = GetClusterCost(data.mEntrances[to].mCell);
+            data.mDistances[from * entranceCount + to] = cost;
+            data.mDistances[to * entranceCount + from] = cost;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::ResolveNodes()
+{
+    mNodeCluster.clear();
+    mNodeCell.clear();
+    for (int cluster = 0; cluster < int(mClusters.size()); ++cluster)
+    {
+        Cluster & data = mClusters[cluster];
+        data.mFirstNode = int(mNodeCluster.size());
+        for (const auto & entrance : data.mEntrances)
+        {
+            mNodeCluster.push_back(cluster);
+            mNodeCell.push_back(entrance.mCell);
+        }
+    }
+
+    for (auto & cluster : mClusters)
+    {
+        for (auto & entrance : cluster.mEntrances)
+        {
+            for (int side = 0; side < SideCount; ++side)
+            {
+                entrance.mLinkedNode[side] = entrance.mLinkedCell[side] >= 0 ? FindNode(entrance.mLinkedCell[side]) : -1;
+            }
+        }
+    }
+
+    size_t searchNodeCount = mNodeCluster.size() + 2;
+    mNodeG.resize(searchNodeCount);
+    mNodeParent.resize(searchNodeCount);
+    mNodeGeneration.assign(searchNodeCount, 0);
+    mNodeClosedGeneration.assign(searchNodeCount, 0);
+    mAbstractSearchGeneration = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int HierarchicalPathfinder::FindNode(int cell) const
+{
+    int width = mWalkable.GetWidth();
+    const Cluster & cluster = mClusters[GetClusterIndex(cell % width, cell / width)];
+    for (size_t entrance = 0; entrance < cluster.mEntrances.size(); ++entrance)
+    {
+        if (cluster.mEntrances[entrance].mCell == cell)
+        {
+            return cluster.mFirstNode + int(entrance);
+        }
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void HierarchicalPathfinder::SearchCluster(int cluster, int startCell, int targetCell)
+{
+    mSearchRect = GetClusterRect(cluster);
+    if (++mClusterSearchGeneration == 0)
+    {
+        std::fill(mClusterGeneration.begin(), mClusterGeneration.end(), 0u);
+        mClusterSearchGeneration = 1;
+    }
+
+    int width = mWalkable.GetWidth();
+    int left = mSearchRect.left;
+    int top = mSearchRect.top;
+    int right = left + mSearchRect.width;
+    int bottom = top + mSearchRect.height;
+    auto isOpen = [&](int x, int y) { return x >= left && x < right && y >= top && y < bottom && mWalkable.TestUnchecked(x, y); };
+    auto toLocal = [&](int x, int y) { return (y - top) * mClusterSize + (x - left); };
+
+    int startLocal = toLocal(startCell % width, startCell / width);
+    int targetLocal = targetCell >= 0 ? toLocal(targetCell % width, targetCell / width) : -1;
+
+    mClusterGeneration[startLocal] = mClusterSearchGeneration;
+    mClusterCost[startLocal] = 0;
+    mClusterParent[startLocal] = -1;
+    for (auto & bucket : mClusterBuckets)
+    {
+        bucket.clear();
+    }
+    mClusterBuckets[0].push_back(startLocal);
+
+    // Dial's algorithm: costs only ever grow by 10 or 14, so sweeping a ring of buckets in cost order replaces the heap
+    size_t queuedCount = 1;
+    for (int cost = 0; queuedCount > 0; ++cost)
+    {
+        std::vector<int> & bucket = mClusterBuckets[cost % skCostBucketCount];
+        for (size_t entry = 0; entry < bucket.size(); ++entry)
+        {
+            int localCell = bucket[entry];
+            if (mClusterCost[localCell] != cost)
+            {
+                continue;
+            }
+            if (localCell == targetLocal)
+            {
+                return;
+            }
+
+            int x = left + localCell % mClusterSize;
+            int y = top + localCell / mClusterSize;
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    if ((dx == 0 && dy == 0) || !isOpen(x + dx, y + dy))
+                    {
+                        continue;
+                    }
+                    bool diagonal = dx != 0 && dy != 0;
+                    if (diagonal && (!isOpen(x + dx, y) || !isOpen(x, y + dy)))
+                    {
+                        continue;
+                    }
+
+                    int neighbor = toLocal(x + dx, y + dy);
+                    int neighborCost = cost + (diagonal ? skDiagonalCost : skStraightCost);
+                    if (mClusterGeneration[neighbor] != mClusterSearchGeneration || neighborCost < mClusterCost[neighbor])
+                    {
+                        mClusterGeneration[neighbor] = mClusterSearchGeneration;
+                        mClusterCost[neighbor] = neighborCost;
+                        mClusterParent[neighbor] = localCell;
+                        mClusterBuckets[neighborCost % skCostBucketCount].push_back(neighbor);
+                        ++queuedCount;
+                    }
+                }
+            }
+        }
+        queuedCount -= bucket.size();
+        bucket.clear();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int HierarchicalPathfinder::GetClusterCost(int cell) const
+{
+    int width = mWalkable.GetWidth();
+    int x = cell % width;
+    int y = cell / width;
+    if (!mSearchRect.contains(x, y))
+    {
+        return -1;
+    }
+
+    int localCell = (y - mSearchRect.top) * mClusterSize + (x - mSearchRect.left);
+    return mClusterGeneration[localCell] == mClusterSearchGeneration ? mClusterCost[localCell] : -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BitGrid.h"
+
+// Abstract route from start to goal through cluster entrances. Consecutive waypoints either share a cluster or sit
+// on opposite sides of a cluster border, and are only expanded into tiles on demand.
+struct HierarchicalPath
+{
+    std::vector<sf::Vector2i> mWaypoints;
+    size_t mNextSegment = 0;
+
+    bool IsComplete() const { return mNextSegment + 1 >= mWaypoints.size(); }
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// HierarchicalPathfinder
+//
+// HPA* over a walkable layer cut into fixed square clusters. Every border between two clusters gets entrances where
+// both sides are open, and each cluster keeps a matrix of in-cluster distances between its entrances. A query links
+// start and goal to the entrances of their own clusters, searches the small abstract graph, and leaves the tile level
+// path to RefineNextSegment, which only ever searches inside one cluster. Changing tiles marks clusters dirty, and
+// only those and their neighbors are rebuilt.
+//------------------------------------------------------------------------------------------------------------------------
+
+class HierarchicalPathfinder
+{
+public:
+    explicit HierarchicalPathfinder(int clusterSize = 32);
+
+    void Build(const BitGridView & walkable);
+    bool IsBuilt() const { return !mWalkable.IsEmpty(); }
+
+    // The layer changed inside the given tiles, it must keep the size it had in Build()
+    void MarkDirty(const sf::IntRect & tiles);
+
+    bool FindPath(const sf::Vector2i & start, const sf::Vector2i & goal, HierarchicalPath & outPath);
+
+    // Appends the tiles of the next segment, leaving out its first tile, which the previous segment ended on
+    bool RefineNextSegment(HierarchicalPath & path, std::vector<sf::Vector2i> & outTiles);
+
+    int GetClusterCount() const { return int(mClusters.size()); }
+    int GetEntranceCount() const { return int(mNodeCluster.size()); }
+
+private:
+    enum ESide
+    {
+        Left,
+        Right,
+        Up,
+        Down,
+        SideCount
+    };
+
+    struct Entrance
+    {
+        int mCell;
+        int mLinkedCell[SideCount];  // Cell across each border, -1 when there is no transition that way
+        int mLinkedNode[SideCount];  // Abstract node of that cell, resolved after every rebuild
+    };
+
+    struct Cluster
+    {
+        std::vector<Entrance> mEntrances;
+        std::vector<int> mDistances;  // mEntrances.size() squared, -1 when unreachable inside the cluster
+        int mFirstNode = 0;
+        bool mDirty = true;
+    };
+
+    // Open list entry for the abstract search, ties on f go to the entry nearer the goal
+    struct AbstractStep
+    {
+        int mF;
+        int mH;
+        int mNode;
+
+        bool operator>(const AbstractStep & other) const { return mF > other.mF || (mF == other.mF && mH > other.mH); }
+    };
+
+    // Step costs are 10 and 14, so a ring of 16 cost buckets is enough for the in-cluster Dijkstra
+    static const int skCostBucketCount = 16;
+
+    int GetClusterIndex(int x, int y) const;
+    sf::IntRect GetClusterRect(int cluster) const;
+    void RebuildDirtyClusters();
+    void BuildEntrances(int cluster);
+    void AddTransitions(int cluster, ESide side);
+    void AddEntrance(Cluster & cluster, int cell, ESide side, int linkedCell);
+    void BuildDistances(int cluster);
+    void ResolveNodes();
+    int FindNode(int cell) const;
+
+    // Dijkstra from startCell that never leaves the cluster. Stops early once targetCell is settled, if given.
+    void SearchCluster(int cluster, int startCell, int targetCell);
+    int GetClusterCost(int cell) const;
+
+    BitGridView mWalkable;
+    int mClusterSize;
+    int mClustersWide;
+    int mClustersHigh;
+    std::vector<Cluster> mClusters;
+    bool mHasDirtyClusters;
+
+    // Flattened abstract graph, node ids are Cluster::mFirstNode + entrance index
+    std::vector<int> mNodeCluster;
+    std::vector<int> mNodeCell;
+
+    // Cluster search scratch, indexed by cell within the cluster
+    sf::IntRect mSearchRect;
+    std::vector<int> mClusterBuckets[skCostBucketCount];
+    std::vector<int> mClusterCost;
+    std::vector<int> mClusterParent;
+    std::vector<uint32_t> mClusterGeneration;
+    uint32_t mClusterSearchGeneration;
+
+    // Abstract search scratch, two extra slots for the query's start and goal
+    std::vector<AbstractStep> mNodeOpen;
+    std::vector<int> mNodeG;
+    std::vector<int> mNodeParent;
+    std::vector<uint32_t> mNodeGeneration;
+    std::vector<uint32_t> mNodeClosedGeneration;
+    uint32_t mAbstractSearchGeneration;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,421 @@
+#include "AstroidsPrivate.h"
+#include "InfluenceMapManager.h"
+#include "LevelManager.h"
+#include "SpatialIndex.h"
+#include "CameraManager.h"
+#include "BDConfig.h"
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <imgui.h>
+
+namespace
+{
+    // Four tiles per influence cell
+    const int skTilesPerCell = 4;
+    const float skTickInterval = 0.1f;
+
+    // Share of the freshly blurred stamps mixed into the values each tick, the rest is what the values remember
+    const float skBlendPerTick = 0.35f;
+
+    struct InfluenceLayerDesc
+    {
+        const char * mpName;
+        TeamMask mTeams;
+        int mRadius;        // Cells, the stamp falls off linearly to zero at this distance
+        bool mTopLevelOnly; // Projectiles are children of whoever fired them and share their team, this leaves them out
+        sf::Color mColor;
+    };
+
+    const InfluenceLayerDesc skLayerDescs[int(EInfluenceLayer::Count)] =
+    {
+        { "Player Threat", TeamBit(ETeam::Player), 6, true, sf::Color(255, 60, 40) },
+        { "Enemy Density", TeamBit(ETeam::Enemy), 2, true, sf::Color(60, 220, 80) },
+        { "Projectile Danger", TeamBit(ETeam::Friendly), 2, false, sf::Color(255, 220, 40) },
+    };
+
+    // 1 2 1 over the neighbors in one direction, cells off the map count as zero
+    void BlurRow(const float * pIn, float * pOut, int width)
+    {
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        int x = 1;
+        for (; x + 4 <= width - 1; x += 4)
+        {
+            __m128 sides = _mm_add_ps(_mm_loadu_ps(pIn + x - 1), _mm_loadu_ps(pIn + x + 1));
+            _mm_storeu_ps(pOut + x, _mm_add_ps(_mm_mul_ps(sides, quarter), _mm_mul_ps(_mm_loadu_ps(pIn + x), half)));
+        }
+        for (; x < width - 1; ++x)
+        {
+            pOut[x] = (pIn[x - 1] + pIn[x + 1]) * 0.25f + pIn[x] * 0.5f;
+        }
+
+        pOut[0] = pIn[0] * 0.5f + (width > 1 ? pIn[1] * 0.25f : 0.f);
+        if (width > 1)
+        {
+            pOut[width - 1] = pIn[width - 1] * 0.5f + pIn[width - 2] * 0.25f;
+        }
+    }
+
+    void BlurColumns(const float * pAbove, const float * pRow, const float * pBelow, float * pOut, int width)
+    {
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128 sides = _mm_setzero_ps();
+            if (pAbove)
+            {
+                sides = _mm_loadu_ps(pAbove + x);
+            }
+            if (pBelow)
+            {
+                sides = _mm_add_ps(sides, _mm_loadu_ps(pBelow + x));
+            }
+            _mm_storeu_ps(pOut + x, _mm_add_ps(_mm_mul_ps(sides, quarter), _mm_mul_ps(_mm_loadu_ps(pRow + x), half)));
+        }
+        for (; x < width; ++x)
+        {
+            float sides = (pAbove ? pAbove[x] : 0.f) + (pBelow ? pBelow[x] : 0.f);
+            pOut[x] = sides * 0.25f + pRow[x] * 0.5f;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+InfluenceMapManager::InfluenceMapManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mLayers()
+    , mBlurScratch()
+    , mBlurred()
+    , mSources()
+    , mQueryHandles()
+    , mTick(0)
+    , mTickAccumulator(0.f)
+    , mOverlayLayer(-1)
+    , mOverlayVertices(sf::Quads)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+InfluenceMapManager::~InfluenceMapManager()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::Update(float deltaTime)
+{
+    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
+    if (!pLevelManager)
+    {
+        return;
+    }
+
+    int width = (pLevelManager->GetWidth() + skTilesPerCell - 1) / skTilesPerCell;
+    int height = (pLevelManager->GetHeight() + skTilesPerCell - 1) / skTilesPerCell;
+    if (width != mBlurred.GetWidth() || height != mBlurred.GetHeight())
+    {
+        Resize(width, height);
+    }
+    if (mBlurred.IsEmpty())
+    {
+        return;
+    }
+
+    // Fixed tick so spread and fade do not depend on the frame rate. A long hitch runs one tick, not a burst.
+    mTickAccumulator += deltaTime;
+    if (mTickAccumulator >= skTickInterval)
+    {
+        mTickAccumulator = std::fmod(mTickAccumulator, skTickInterval);
+        Tick();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::Render(sf::RenderWindow & window)
+{
+    if (mOverlayLayer < 0 || mBlurred.IsEmpty())
+    {
+        return;
+    }
+
+    const Layer & layer = mLayers[mOverlayLayer];
+    if (layer.mPeakValue <= 0.f)
+    {
+        return;
+    }
+
+    // Only the cells on screen
+    float cellSize = GetCellSize();
+    int minX = 0;
+    int minY = 0;
+    int maxX = mBlurred.GetWidth() - 1;
+    int maxY = mBlurred.GetHeight() - 1;
+    if (auto * pCameraManager = GetGameManager().GetManager<CameraManager>())
+    {
+        sf::FloatRect view = pCameraManager->GetViewBounds();
+        minX = std::max(minX, int(view.left / cellSize));
+        minY = std::max(minY, int(view.top / cellSize));
+        maxX = std::min(maxX, int((view.left + view.width) / cellSize));
+        maxY = std::min(maxY, int((view.top + view.height) / cellSize));
+    }
+
+    sf::Color color = skLayerDescs[mOverlayLayer].mColor;
+    float alphaScale = 160.f / layer.mPeakValue;
+    mOverlayVertices.clear();
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            float value = layer.mValues(x, y);
+            if (value <= 0.f)
+            {
+                continue;
+            }
+
+            color.a = sf::Uint8(std::min(160.f, value * alphaScale));
+            sf::Vector2f topLeft(x * cellSize, y * cellSize);
+            mOverlayVertices.append(sf::Vertex(topLeft, color));
+            mOverlayVertices.append(sf::Vertex(topLeft + sf::Vector2f(cellSize, 0.f), color));
+            mOverlayVertices.append(sf::Vertex(topLeft + sf::Vector2f(cellSize, cellSize), color));
+            mOverlayVertices.append(sf::Vertex(topLeft + sf::Vector2f(0.f, cellSize), color));
+        }
+    }
+    window.draw(mOverlayVertices);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::OnGameEnd()
+{
+    mSources.clear();
+    for (auto & layer : mLayers)
+    {
+        layer.mStamps.Fill(0.f);
+        layer.mValues.Fill(0.f);
+        layer.mPeakValue = 0.f;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float InfluenceMapManager::Sample(EInfluenceLayer layer, const sf::Vector2f & position) const
+{
+    const Grid2D<float> & values = mLayers[int(layer)].mValues;
+    if (values.IsEmpty())
+    {
+        return 0.f;
+    }
+
+    // Bilinear between the four nearest cell centers
+    float cellX = position.x / GetCellSize() - 0.5f;
+    float cellY = position.y / GetCellSize() - 0.5f;
+    int x = int(std::floor(cellX));
+    int y = int(std::floor(cellY));
+    float fracX = cellX - x;
+    float fracY = cellY - y;
+
+    float top = values.Get(x, y, 0.f) + (values.Get(x + 1, y, 0.f) - values.Get(x, y, 0.f)) * fracX;
+    float bottom = values.Get(x, y + 1, 0.f) + (values.Get(x + 1, y + 1, 0.f) - values.Get(x, y + 1, 0.f)) * fracX;
+    return top + (bottom - top) * fracY;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float InfluenceMapManager::GetCellSize() const
+{
+    return BD::gsPixelCountCellSize * skTilesPerCell;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Influence Maps");
+
+    ImGui::RadioButton("Off", &mOverlayLayer, -1);
+    for (int layer = 0; layer < int(EInfluenceLayer::Count); ++layer)
+    {
+        ImGui::RadioButton(skLayerDescs[layer].mpName, &mOverlayLayer, layer);
+        ImGui::SameLine();
+        ImGui::Text("peak %.2f", mLayers[layer].mPeakValue);
+    }
+    ImGui::Text("Sources: %d", int(mSources.size()));
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::Resize(int width, int height)
+{
+    for (auto & layer : mLayers)
+    {
+        layer.mStamps.Resize(width, height, 0.f);
+        layer.mValues.Resize(width, height, 0.f);
+        layer.mPeakValue = 0.f;
+    }
+    mBlurScratch.Resize(width, height, 0.f);
+    mBlurred.Resize(width, height, 0.f);
+
+    // Stamps went with the old grids
+    mSources.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::Tick()
+{
+    ++mTick;
+    RefreshSources();
+    for (auto & layer : mLayers)
+    {
+        BlurAndBlend(layer);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::RefreshSources()
+{
+    auto * pSpatialIndex = GetGameManager().GetManager<SpatialIndex>();
+    if (!pSpatialIndex)
+    {
+        return;
+    }
+
+    float cellSize = GetCellSize();
+    sf::FloatRect mapBounds(0.f, 0.f, mBlurred.GetWidth() * cellSize, mBlurred.GetHeight() * cellSize);
+    GameManager & gameManager = GetGameManager();
+    BD::Handle rootHandle = gameManager.GetRootGameObjectHandle();
+    for (int layerIndex = 0; layerIndex < int(EInfluenceLayer::Count); ++layerIndex)
+    {
+        EInfluenceLayer layer = EInfluenceLayer(layerIndex);
+        pSpatialIndex->QueryAABB(mapBounds, skLayerDescs[layerIndex].mTeams, mQueryHandles);
+        for (BD::Handle handle : mQueryHandles)
+        {
+            GameObject * pGameObject = gameManager.GetGameObject(handle);
+            if (!pGameObject || (skLayerDescs[layerIndex].mTopLevelOnly && pGameObject->GetParentHandle() != rootHandle))
+            {
+                continue;
+            }
+
+            sf::Vector2f position = pGameObject->GetPosition();
+            sf::Vector2i cell(int(position.x / cellSize), int(position.y / cellSize));
+
+            // Only sources that crossed into another cell, or changed layer, touch the stamps
+            auto it = mSources.find(handle);
+            if (it == mSources.end())
+            {
+                Stamp(layer, cell, 1.f);
+                mSources.emplace(handle, StampedSource{ layer, cell, mTick });
+                continue;
+            }
+
+            StampedSource & source = it->second;
+            if (source.mCell != cell || source.mLayer != layer)
+            {
+                Stamp(source.mLayer, source.mCell, -1.f);
+                Stamp(layer, cell, 1.f);
+                source.mLayer = layer;
+                source.mCell = cell;
+            }
+            source.mSeenTick = mTick;
+        }
+    }
+
+    // Whatever was not seen this tick is gone or off the map
+    for (auto it = mSources.begin(); it != mSources.end();)
+    {
+        if (it->second.mSeenTick != mTick)
+        {
+            Stamp(it->second.mLayer, it->second.mCell, -1.f);
+            it = mSources.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::Stamp(EInfluenceLayer layer, const sf::Vector2i & cell, float sign)
+{
+    int radius = skLayerDescs[int(layer)].mRadius;
+    Grid2D<float> & stamps = mLayers[int(layer)].mStamps;
+    auto rect = stamps.GetRect(cell.x - radius, cell.y - radius, radius * 2 + 1, radius * 2 + 1);
+    int left = std::max(cell.x - radius, 0);
+    int top = std::max(cell.y - radius, 0);
+    float invRadius = 1.f / float(radius + 1);
+    rect.ForEach([&](int x, int y, float & value)
+        {
+            float dx = float(left + x - cell.x);
+            float dy = float(top + y - cell.y);
+            float falloff = 1.f - std::sqrt(dx * dx + dy * dy) * invRadius;
+            if (falloff > 0.f)
+            {
+                value += sign * falloff;
+            }
+        });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InfluenceMapManager::BlurAndBlend(Layer & layer)
+{
+    int width = mBlurred.GetWidth();
+    int height = mBlurred.GetHeight();
+
+    for (int y = 0; y < height; ++y)
+    {
+        BlurRow(&layer.mStamps(0, y), &mBlurScratch(0, y), width);
+    }
+    for (int y = 0; y < height; ++y)
+    {
+        const float * pAbove = y > 0 ? &mBlurScratch(0, y - 1) : nullptr;
+        const float * pBelow = y + 1 < height ? &mBlurScratch(0, y + 1) : nullptr;
+        BlurColumns(pAbove, &mBlurScratch(0, y), pBelow, &mBlurred(0, y), width);
+    }
+
+    // values += (blurred - values) * blend, clamped at zero so stamp round-off never goes negative
+    const __m128 blend = _mm_set1_ps(skBlendPerTick);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 peak = zero;
+    float * pValues = layer.mValues.GetData();
+    const float * pBlurred = mBlurred.GetData();
+    int count = layer.mValues.GetCellCount();
+    int ii = 0;
+    for (; ii + 4 <= count; ii += 4)
+    {
+        __m128 values = _mm_loadu_ps(pValues + ii);
+        values = _mm_add_ps(values, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pBlurred + ii), values), blend));
+        values = _mm_max_ps(values, zero);
+        _mm_storeu_ps(pValues + ii, values);
+        peak = _mm_max_ps(peak, values);
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, peak);
+    float peakValue = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    for (; ii < count; ++ii)
+    {
+        pValues[ii] = std::max(0.f, pValues[ii] + (pBlurred[ii] - pValues[ii]) * skBlendPerTick);
+        peakValue = std::max(peakValue, pValues[ii]);
+    }
+    layer.mPeakValue = peakValue;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
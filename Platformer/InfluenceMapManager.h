@@ -0,0 +1,71 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "BaseManager.h"
+#include "Grid2D.h"
+
+enum class EInfluenceLayer
+{
+    PlayerThreat,
+    EnemyDensity,
+    ProjectileDanger,
+    Count
+};
+
+// Low resolution float maps of where things are, for AI that needs more than a path to the player. Every source
+// leaves a stamp in its layer that is only redrawn when the source crosses into another cell. On a fixed tick each
+// layer's stamps are blurred with a separable SSE pass and blended into the sampled values, so influence spreads and
+// fades over time instead of snapping. Sampling is a bilinear read of one layer.
+class InfluenceMapManager : public BaseManager
+{
+public:
+    InfluenceMapManager(GameManager * pGameManager);
+    ~InfluenceMapManager();
+
+    virtual void Update(float deltaTime) override;
+    virtual void Render(sf::RenderWindow & window) override;
+    virtual void OnGameEnd() override;
+
+    float Sample(EInfluenceLayer layer, const sf::Vector2f & position) const;
+    float GetCellSize() const;
+
+    // Heatmap overlay controls, drawn from the GameManager's ImGui pass
+    void DebugImGuiInfo();
+
+private:
+    struct Layer
+    {
+        Grid2D<float> mStamps;
+        Grid2D<float> mValues;
+        float mPeakValue = 0.f;     // Largest value after the last tick, used to scale the overlay
+    };
+
+    struct StampedSource
+    {
+        EInfluenceLayer mLayer;
+        sf::Vector2i mCell;
+        uint32_t mSeenTick;
+    };
+
+    void Resize(int width, int height);
+    void Tick();
+    void RefreshSources();
+    void Stamp(EInfluenceLayer layer, const sf::Vector2i & cell, float sign);
+    void BlurAndBlend(Layer & layer);
+
+    Layer mLayers[int(EInfluenceLayer::Count)];
+    Grid2D<float> mBlurScratch;
+    Grid2D<float> mBlurred;
+
+    std::unordered_map<BD::Handle, StampedSource> mSources;
+    std::vector<BD::Handle> mQueryHandles;
+    uint32_t mTick;
+    float mTickAccumulator;
+
+    int mOverlayLayer;  // -1 hides the overlay
+    sf::VertexArray mOverlayVertices;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,312 @@
+#include "AstroidsPrivate.h"
+#include "InputManager.h"
+#include "BDConfig.h"
+#include <algorithm>
+#include <imgui.h>
+
+namespace
+{
+    const char * skActionNames[] =
+    {
+        "MoveUp",
+        "MoveDown",
+        "MoveLeft",
+        "MoveRight",
+        "Fire",
+        "Pause",
+        "ToggleDebugWindow",
+        "GenerateDungeon",
+        "QuickSave",
+        "QuickLoad",
+    };
+    static_assert(sizeof(skActionNames) / sizeof(skActionNames[0]) == size_t(EAction::Count), "One name per EAction");
+
+    uint32_t ActionBit(EAction action)
+    {
+        return uint32_t(1) << int(action);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+InputManager::InputManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mKeyActions(sf::Keyboard::KeyCount, 0)
+    , mButtonActions(sf::Mouse::ButtonCount, 0)
+    , mKeysHeld(sf::Keyboard::KeyCount, false)
+    , mButtonsHeld(sf::Mouse::ButtonCount, false)
+    , mTapped(0)
+    , mMousePosition()
+    , mSnapshot()
+    , mNextTick(0)
+    , mClock()
+    , mIsRecording(false)
+    , mRecording()
+    , mIsReplaying(false)
+    , mReplay()
+    , mReplayIndex(0)
+{
+    BindDefaults();
+
+    // Only moves arrive as events, so the starting position is the one thing asked of the OS
+    mMousePosition = sf::Mouse::getPosition(GetGameManager().GetWindow());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+InputManager::~InputManager()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::BindDefaults()
+{
+    Bind(EAction::MoveUp, sf::Keyboard::W);
+    Bind(EAction::MoveDown, sf::Keyboard::S);
+    Bind(EAction::MoveLeft, sf::Keyboard::A);
+    Bind(EAction::MoveRight, sf::Keyboard::D);
+    Bind(EAction::Fire, sf::Mouse::Left);
+    Bind(EAction::Pause, sf::Keyboard::Escape);
+    Bind(EAction::ToggleDebugWindow, sf::Keyboard::G);
+    Bind(EAction::GenerateDungeon, sf::Keyboard::H);
+    Bind(EAction::QuickSave, sf::Keyboard::F5);
+    Bind(EAction::QuickLoad, sf::Keyboard::F9);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::Bind(EAction action, sf::Keyboard::Key key)
+{
+    if (key >= 0 && key < sf::Keyboard::KeyCount)
+    {
+        mKeyActions[key] |= ActionBit(action);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::Bind(EAction action, sf::Mouse::Button button)
+{
+    if (button >= 0 && button < sf::Mouse::ButtonCount)
+    {
+        mButtonActions[button] |= ActionBit(action);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::ClearBindings(EAction action)
+{
+    for (uint32_t & actions : mKeyActions)
+    {
+        actions &= ~ActionBit(action);
+    }
+    for (uint32_t & actions : mButtonActions)
+    {
+        actions &= ~ActionBit(action);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::Sample(const std::vector<sf::Event> & events, float deltaTime)
+{
+    for (const sf::Event & event : events)
+    {
+        ApplyEvent(event);
+    }
+
+    InputSnapshot snapshot;
+    if (mIsReplaying && mReplayIndex < mReplay.size())
+    {
+        snapshot = mReplay[mReplayIndex++];
+    }
+    else
+    {
+        mIsReplaying = false;
+
+        uint32_t held = 0;
+        for (int key = 0; key < sf::Keyboard::KeyCount; ++key)
+        {
+            if (mKeysHeld[key])
+            {
+                held |= mKeyActions[key];
+            }
+        }
+        for (int button = 0; button < sf::Mouse::ButtonCount; ++button)
+        {
+            if (mButtonsHeld[button])
+            {
+                held |= mButtonActions[button];
+            }
+        }
+
+        // A tap that came and went between ticks still counts as down for this one
+        snapshot.mDown = held | mTapped;
+        snapshot.mPressed = snapshot.mDown & ~mSnapshot.mDown;
+        snapshot.mReleased = mSnapshot.mDown & ~snapshot.mDown;
+        snapshot.mMousePosition = mMousePosition;
+    }
+    snapshot.mTick = mNextTick++;
+    snapshot.mTime = mClock.GetElapsedSeconds();
+    snapshot.mDeltaTime = deltaTime;
+    mTapped = 0;
+
+    mSnapshot = snapshot;
+    if (mIsRecording)
+    {
+        mRecording.push_back(snapshot);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::ApplyEvent(const sf::Event & event)
+{
+    switch (event.type)
+    {
+        case sf::Event::KeyPressed:
+        {
+            // Key repeats arrive as more presses of a key that is already held
+            if (event.key.code >= 0 && event.key.code < sf::Keyboard::KeyCount && !mKeysHeld[event.key.code])
+            {
+                mKeysHeld[event.key.code] = true;
+                mTapped |= mKeyActions[event.key.code];
+            }
+            break;
+        }
+        case sf::Event::KeyReleased:
+        {
+            if (event.key.code >= 0 && event.key.code < sf::Keyboard::KeyCount)
+            {
+                mKeysHeld[event.key.code] = false;
+            }
+            break;
+        }
+        case sf::Event::MouseButtonPressed:
+        {
+            if (event.mouseButton.button >= 0 && event.mouseButton.button < sf::Mouse::ButtonCount)
+            {
+                mButtonsHeld[event.mouseButton.button] = true;
+                mTapped |= mButtonActions[event.mouseButton.button];
+            }
+            break;
+        }
+        case sf::Event::MouseButtonReleased:
+        {
+            if (event.mouseButton.button >= 0 && event.mouseButton.button < sf::Mouse::ButtonCount)
+            {
+                mButtonsHeld[event.mouseButton.button] = false;
+            }
+            break;
+        }
+        case sf::Event::MouseMoved:
+        {
+            mMousePosition = sf::Vector2i(event.mouseMove.x, event.mouseMove.y);
+            break;
+        }
+        case sf::Event::LostFocus:
+        {
+            // The releases go to whichever window has focus now, so nothing can be trusted to still be held
+            ReleaseAll();
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::ReleaseAll()
+{
+    std::fill(mKeysHeld.begin(), mKeysHeld.end(), false);
+    std::fill(mButtonsHeld.begin(), mButtonsHeld.end(), false);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::StartRecording()
+{
+    mRecording.clear();
+    mIsRecording = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::StopRecording()
+{
+    mIsRecording = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::StartReplay(const std::vector<InputSnapshot> & snapshots)
+{
+    mReplay = snapshots;
+    mReplayIndex = 0;
+    mIsReplaying = !mReplay.empty();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::StopReplay()
+{
+    mIsReplaying = false;
+    mReplay.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void InputManager::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Input");
+
+    ImGui::Text("Tick: %u at %.3f s", mSnapshot.mTick, mSnapshot.mTime);
+    ImGui::Text("Mouse: %d, %d", mSnapshot.mMousePosition.x, mSnapshot.mMousePosition.y);
+    for (int action = 0; action < int(EAction::Count); ++action)
+    {
+        if (mSnapshot.IsDown(EAction(action)))
+        {
+            ImGui::Text("%s", skActionNames[action]);
+        }
+    }
+
+    ImGui::Separator();
+    if (mIsRecording)
+    {
+        if (ImGui::Button("Stop Recording"))
+        {
+            StopRecording();
+        }
+    }
+    else if (ImGui::Button("Record"))
+    {
+        StartRecording();
+    }
+    ImGui::SameLine();
+    if (mIsReplaying)
+    {
+        if (ImGui::Button("Stop Replay"))
+        {
+            StopReplay();
+        }
+        ImGui::Text("Replaying %d of %d", int(mReplayIndex), int(mReplay.size()));
+    }
+    else if (ImGui::Button("Replay") && !mIsRecording)
+    {
+        StartReplay(mRecording);
+    }
+    ImGui::Text("Recorded ticks: %d", int(mRecording.size()));
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BaseManager.h"
+
+// What the game asks of the keyboard and mouse, bound to keys and buttons by the InputManager
+enum class EAction
+{
+    MoveUp,
+    MoveDown,
+    MoveLeft,
+    MoveRight,
+    Fire,
+    Pause,
+    ToggleDebugWindow,
+    GenerateDungeon,
+    QuickSave,
+    QuickLoad,
+    Count
+};
+
+// The input for one tick, never changed once sampled. A press and release that both land between two ticks still
+// shows as pressed and down for the tick that follows them.
+struct InputSnapshot
+{
+    uint32_t mTick = 0;
+    float mTime = 0.f;                  // Seconds since the InputManager was created, when this was sampled
+    float mDeltaTime = 0.f;
+    uint32_t mDown = 0;                 // Bit per EAction
+    uint32_t mPressed = 0;              // Went down since the last tick
+    uint32_t mReleased = 0;             // Went up since the last tick
+    sf::Vector2i mMousePosition;        // Window pixels
+
+    bool IsDown(EAction action) const { return (mDown >> int(action)) & 1u; }
+    bool WasPressed(EAction action) const { return (mPressed >> int(action)) & 1u; }
+    bool WasReleased(EAction action) const { return (mReleased >> int(action)) & 1u; }
+};
+
+// The one place the game reads the keyboard and mouse. Once per tick Sample drains the window's buffered events into
+// the bound actions and publishes the result as an InputSnapshot, so every reader in the tick sees the same input and
+// nothing queries the OS on its own. Recording keeps every snapshot sampled; replaying hands them back in order in
+// place of the devices.
+class InputManager : public BaseManager
+{
+public:
+    InputManager(GameManager * pGameManager);
+    ~InputManager();
+
+    // Call once per tick, before anything reads input. events are everything the window delivered since the last call.
+    void Sample(const std::vector<sf::Event> & events, float deltaTime);
+
+    const InputSnapshot & GetSnapshot() const { return mSnapshot; }
+
+    void Bind(EAction action, sf::Keyboard::Key key);
+    void Bind(EAction action, sf::Mouse::Button button);
+    void ClearBindings(EAction action);
+
+    void StartRecording();
+    void StopRecording();
+    bool IsRecording() const { return mIsRecording; }
+    const std::vector<InputSnapshot> & GetRecording() const { return mRecording; }
+
+    // Plays the snapshots back one per Sample, the devices are ignored until it runs out or is stopped
+    void StartReplay(const std::vector<InputSnapshot> & snapshots);
+    void StopReplay();
+    bool IsReplaying() const { return mIsReplaying; }
+
+    void DebugImGuiInfo();
+
+private:
+    void BindDefaults();
+    void ApplyEvent(const sf::Event & event);
+    void ReleaseAll();
+
+    std::vector<uint32_t> mKeyActions;      // By sf::Keyboard::Key, the actions the key is bound to
+    std::vector<uint32_t> mButtonActions;   // By sf::Mouse::Button
+    std::vector<bool> mKeysHeld;
+    std::vector<bool> mButtonsHeld;
+    uint32_t mTapped;                       // Actions with a press since the last Sample, even if already released
+    sf::Vector2i mMousePosition;
+
+    InputSnapshot mSnapshot;
+    uint32_t mNextTick;
+    StopWatch mClock;
+
+    bool mIsRecording;
+    std::vector<InputSnapshot> mRecording;
+    bool mIsReplaying;
+    std::vector<InputSnapshot> mReplay;
+    size_t mReplayIndex;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,159 @@
+#include "AstroidsPrivate.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    struct ParallelForState
+    {
+        explicit ParallelForState(int chunkCount)
+            : mNextChunk(0)
+            , mChunksLeft(chunkCount)
+        {
+        }
+
+        std::atomic<int> mNextChunk;
+        std::atomic<int> mChunksLeft;
+    };
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+JobSystem::JobSystem(int workerCount)
+    : mWorkers()
+    , mJobs()
+    , mShuttingDown(false)
+{
+    if (workerCount < 0)
+    {
+        workerCount = std::max(0, int(std::thread::hardware_concurrency()) - 1);
+    }
+
+    mWorkers.reserve(workerCount);
+    for (int ii = 0; ii < workerCount; ++ii)
+    {
+        mWorkers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mShuttingDown = true;
+    }
+    mJobAvailable.notify_all();
+
+    for (auto & worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void JobSystem::ParallelFor(int count, int minChunkSize, const std::function<void(int begin, int end)> & func)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    minChunkSize = std::max(1, minChunkSize);
+    int maxChunks = int(mWorkers.size()) + 1;
+    int chunkCount = std::min(maxChunks, (count + minChunkSize - 1) / minChunkSize);
+
+    if (chunkCount <= 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    // Chunks are claimed from a shared counter by the caller and by however many helpers get to run in time, so the
+    // caller only ever runs its own range and never waits on a helper queued behind some unrelated Submit. The state is
+    // shared because a helper can start after the call has returned, by then it finds nothing left and never touches func.
+    auto pState = std::make_shared<ParallelForState>(chunkCount);
+    int chunkSize = (count + chunkCount - 1) / chunkCount;
+    auto runChunks = [pState, &func, count, chunkCount, chunkSize]()
+        {
+            int chunk;
+            while ((chunk = pState->mNextChunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount)
+            {
+                int begin = chunk * chunkSize;
+                int end = std::min(count, begin + chunkSize);
+                if (begin < end)
+                {
+                    func(begin, end);
+                }
+                pState->mChunksLeft.fetch_sub(1, std::memory_order_release);
+            }
+        };
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int helper = 1; helper < chunkCount; ++helper)
+        {
+            mJobs.emplace_back(runChunks);
+        }
+    }
+    mJobAvailable.notify_all();
+
+    // Whatever is left unclaimed when the caller finishes a chunk it takes too, then it only waits for chunks in flight
+    runChunks();
+    while (pState->mChunksLeft.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void JobSystem::Submit(std::function<void()> job)
+{
+    if (mWorkers.empty())
+    {
+        job();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push_back(std::move(job));
+    }
+    mJobAvailable.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int JobSystem::GetWorkerCount() const
+{
+    return int(mWorkers.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void JobSystem::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobAvailable.wait(lock, [this]() { return mShuttingDown || !mJobs.empty(); });
+            if (mJobs.empty())
+            {
+                return; // Shutting down with nothing left to run
+            }
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+        job();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------
+// JobSystem
+//
+// Small fixed pool of worker threads. ParallelFor splits a range into chunks that the calling thread and the workers
+// claim between them until every chunk has run, Submit queues fire-and-forget work that only the workers pick up.
+//------------------------------------------------------------------------------------------------------------------------
+
+class JobSystem
+{
+public:
+    // workerCount < 0 picks hardware_concurrency - 1
+    explicit JobSystem(int workerCount = -1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem & operator=(const JobSystem &) = delete;
+
+    void ParallelFor(int count, int minChunkSize, const std::function<void(int begin, int end)> & func);
+
+    void Submit(std::function<void()> job);
+
+    int GetWorkerCount() const;
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> mWorkers;
+    std::deque<std::function<void()>> mJobs;
+    std::mutex mMutex;
+    std::condition_variable mJobAvailable;
+    bool mShuttingDown;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
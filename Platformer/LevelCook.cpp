@@ -0,0 +1,810 @@
+// Built without the precompiled header, see LevelCook.h
+#include "LevelCook.h"
+#include "LevelFormat.h"
+#include "SFML/json.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    struct TileProperties
+    {
+        bool mWalkablePlayer = true;
+        bool mWalkableAI = true;
+        bool mSolid = false;
+        bool mOpaque = false;
+    };
+
+    struct SourceTileset
+    {
+        std::string mName;
+        std::string mImagePath;
+        std::string mGameImagePath;
+        uint32_t mFirstGid = 0;
+        uint32_t mTileCount = 0;
+        uint32_t mColumns = 0;
+        uint32_t mTileWidth = 0;
+        uint32_t mTileHeight = 0;
+        std::unordered_map<uint32_t, TileProperties> mTileProperties;
+    };
+
+    struct SourceLayer
+    {
+        std::string mName;
+        std::vector<uint32_t> mTiles;
+    };
+
+    struct XmlTag
+    {
+        std::string mName;
+        bool mIsClosing = false;
+        bool mIsSelfClosing = false;
+        std::unordered_map<std::string, std::string> mAttributes;
+    };
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    bool ReadTextFile(const std::string & path, std::string & outText)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        outText = buffer.str();
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    std::string GetDirectory(const std::string & path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    std::string GetFileName(const std::string & path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    std::string DecodeXmlEntities(const std::string & text)
+    {
+        static const std::pair<const char *, char> skEntities[] =
+        {
+            { "&amp;", '&' }, { "&quot;", '"' }, { "&apos;", '\'' }, { "&lt;", '<' }, { "&gt;", '>' }
+        };
+
+        std::string decoded;
+        decoded.reserve(text.size());
+        for (size_t ii = 0; ii < text.size(); ++ii)
+        {
+            bool replaced = false;
+            if (text[ii] == '&')
+            {
+                for (const auto & entity : skEntities)
+                {
+                    size_t length = std::strlen(entity.first);
+                    if (text.compare(ii, length, entity.first) == 0)
+                    {
+                        decoded.push_back(entity.second);
+                        ii += length - 1;
+                        replaced = true;
+                        break;
+                    }
+                }
+            }
+            if (!replaced)
+            {
+                decoded.push_back(text[ii]);
+            }
+        }
+        return decoded;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // Tilesets only use a handful of flat tags, so a tag scanner is all the XML support the cooker needs
+    bool NextXmlTag(const std::string & text, size_t & cursor, XmlTag & tag)
+    {
+        while (true)
+        {
+            size_t open = text.find('<', cursor);
+            if (open == std::string::npos)
+            {
+                return false;
+            }
+
+            if (text.compare(open, 4, "<!--") == 0)
+            {
+                size_t endComment = text.find("-->", open);
+                cursor = endComment == std::string::npos ? text.size() : endComment + 3;
+                continue;
+            }
+
+            size_t close = text.find('>', open);
+            if (close == std::string::npos)
+            {
+                return false;
+            }
+            cursor = close + 1;
+
+            if (text[open + 1] == '?' || text[open + 1] == '!')
+            {
+                continue;
+            }
+
+            std::string body = text.substr(open + 1, close - open - 1);
+            tag = XmlTag();
+            tag.mIsClosing = !body.empty() && body[0] == '/';
+            tag.mIsSelfClosing = !body.empty() && body.back() == '/';
+
+            size_t pos = tag.mIsClosing ? 1 : 0;
+            size_t nameEnd = body.find_first_of(" \t\r\n/", pos);
+            tag.mName = body.substr(pos, nameEnd == std::string::npos ? std::string::npos : nameEnd - pos);
+
+            pos = nameEnd;
+            while (pos != std::string::npos && pos < body.size())
+            {
+                size_t keyStart = body.find_first_not_of(" \t\r\n/", pos);
+                if (keyStart == std::string::npos)
+                {
+                    break;
+                }
+                size_t equals = body.find('=', keyStart);
+                size_t quoteOpen = equals == std::string::npos ? std::string::npos : body.find_first_of("\"'", equals);
+                if (quoteOpen == std::string::npos)
+                {
+                    break;
+                }
+                size_t quoteClose = body.find(body[quoteOpen], quoteOpen + 1);
+                if (quoteClose == std::string::npos)
+                {
+                    break;
+                }
+
+                std::string key = body.substr(keyStart, equals - keyStart);
+                key.erase(key.find_last_not_of(" \t\r\n") + 1);
+                tag.mAttributes[key] = DecodeXmlEntities(body.substr(quoteOpen + 1, quoteClose - quoteOpen - 1));
+                pos = quoteClose + 1;
+            }
+            return true;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    uint32_t GetUIntAttribute(const XmlTag & tag, const char * pName)
+    {
+        auto it = tag.mAttributes.find(pName);
+        return it == tag.mAttributes.end() ? 0u : uint32_t(std::stoul(it->second));
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    struct TilePropertyOverrides
+    {
+        bool mWalkableAI = false;
+        bool mSolid = false;
+        bool mOpaque = false;
+    };
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    void ApplyTileProperty(TileProperties & properties, TilePropertyOverrides & overrides, const std::string & name, bool value)
+    {
+        if (name == "walkable")
+        {
+            properties.mWalkablePlayer = value;
+        }
+        else if (name == "aiWalkable")
+        {
+            properties.mWalkableAI = value;
+            overrides.mWalkableAI = true;
+        }
+        else if (name == "solid")
+        {
+            properties.mSolid = value;
+            overrides.mSolid = true;
+        }
+        else if (name == "opaque")
+        {
+            properties.mOpaque = value;
+            overrides.mOpaque = true;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // AI walkability and solidity follow "walkable", and opacity follows solidity, unless they were set explicitly
+    void FinishTileProperties(TileProperties & properties, const TilePropertyOverrides & overrides)
+    {
+        if (!overrides.mWalkableAI)
+        {
+            properties.mWalkableAI = properties.mWalkablePlayer;
+        }
+        if (!overrides.mSolid)
+        {
+            properties.mSolid = !properties.mWalkablePlayer;
+        }
+        if (!overrides.mOpaque)
+        {
+            properties.mOpaque = properties.mSolid;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    bool ParseTsx(const std::string & tsxPath, SourceTileset & tileset, std::string & outError)
+    {
+        std::string text;
+        if (!ReadTextFile(tsxPath, text))
+        {
+            outError = "Failed to open tileset " + tsxPath;
+            return false;
+        }
+
+        size_t cursor = 0;
+        XmlTag tag;
+        bool inTile = false;
+        uint32_t tileId = 0;
+        TileProperties tileProperties;
+        TilePropertyOverrides overrides;
+
+        while (NextXmlTag(text, cursor, tag))
+        {
+            if (tag.mName == "tileset" && !tag.mIsClosing)
+            {
+                tileset.mName = tag.mAttributes["name"];
+                tileset.mTileWidth = GetUIntAttribute(tag, "tilewidth");
+                tileset.mTileHeight = GetUIntAttribute(tag, "tileheight");
+                tileset.mTileCount = GetUIntAttribute(tag, "tilecount");
+                tileset.mColumns = GetUIntAttribute(tag, "columns");
+            }
+            else if (tag.mName == "image" && !inTile)
+            {
+                tileset.mImagePath = tag.mAttributes["source"];
+            }
+            else if (tag.mName == "tile" && !tag.mIsClosing)
+            {
+                inTile = !tag.mIsSelfClosing;
+                tileId = GetUIntAttribute(tag, "id");
+                tileProperties = TileProperties();
+                overrides = TilePropertyOverrides();
+            }
+            else if (tag.mName == "tile" && tag.mIsClosing)
+            {
+                FinishTileProperties(tileProperties, overrides);
+                tileset.mTileProperties[tileId] = tileProperties;
+                inTile = false;
+            }
+            else if (tag.mName == "property")
+            {
+                const std::string & name = tag.mAttributes["name"];
+                const std::string & value = tag.mAttributes["value"];
+                if (inTile)
+                {
+                    ApplyTileProperty(tileProperties, overrides, name, value == "true");
+                }
+                else if (name == "gameImage")
+                {
+                    tileset.mGameImagePath = value;
+                }
+            }
+        }
+
+        if (tileset.mColumns == 0 || tileset.mTileWidth == 0 || tileset.mTileHeight == 0)
+        {
+            outError = "Tileset " + tsxPath + " is missing its tile size or column count";
+            return false;
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    bool ParseEmbeddedTileset(const nlohmann::json & tilesetData, SourceTileset & tileset, std::string & outError)
+    {
+        tileset.mName = tilesetData.value("name", "");
+        tileset.mImagePath = tilesetData.value("image", "");
+        tileset.mTileWidth = tilesetData.value("tilewidth", 0u);
+        tileset.mTileHeight = tilesetData.value("tileheight", 0u);
+        tileset.mTileCount = tilesetData.value("tilecount", 0u);
+        tileset.mColumns = tilesetData.value("columns", 0u);
+
+        if (tilesetData.contains("properties"))
+        {
+            for (const auto & property : tilesetData["properties"])
+            {
+                if (property.value("name", "") == "gameImage")
+                {
+                    tileset.mGameImagePath = property.value("value", "");
+                }
+            }
+        }
+
+        if (tilesetData.contains("tiles"))
+        {
+            for (const auto & tile : tilesetData["tiles"])
+            {
+                TileProperties tileProperties;
+                TilePropertyOverrides overrides;
+                if (tile.contains("properties"))
+                {
+                    for (const auto & property : tile["properties"])
+                    {
+                        if (property.contains("value") && property["value"].is_boolean())
+                        {
+                            ApplyTileProperty(tileProperties, overrides, property.value("name", ""), property["value"].get<bool>());
+                        }
+                    }
+                }
+                FinishTileProperties(tileProperties, overrides);
+                tileset.mTileProperties[tile.value("id", 0u)] = tileProperties;
+            }
+        }
+
+        if (tileset.mColumns == 0 || tileset.mTileWidth == 0 || tileset.mTileHeight == 0)
+        {
+            outError = "Embedded tileset " + tileset.mName + " is missing its tile size or column count";
+            return false;
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    void FinishTileset(SourceTileset & tileset, const LevelCookOptions & options)
+    {
+        if (tileset.mTileCount == 0)
+        {
+            tileset.mTileCount = tileset.mColumns;
+        }
+
+        auto overrideIt = options.mImageOverrides.find(tileset.mName);
+        if (overrideIt != options.mImageOverrides.end())
+        {
+            tileset.mGameImagePath = overrideIt->second;
+        }
+        else if (tileset.mGameImagePath.empty() && !tileset.mImagePath.empty())
+        {
+            tileset.mGameImagePath = "Art/" + GetFileName(tileset.mImagePath);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    template <typename T>
+    T * Reserve(std::vector<uint8_t> & bytes, uint32_t offset)
+    {
+        return reinterpret_cast<T *>(bytes.data() + offset);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    void CopyString(char * pDest, size_t destSize, const std::string & source)
+    {
+        std::memset(pDest, 0, destSize);
+        std::memcpy(pDest, source.c_str(), std::min(source.size(), destSize - 1));
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    void LayOutLevel(uint32_t width, uint32_t height, uint32_t tileWidth, uint32_t tileHeight,
+        const std::vector<SourceTileset> & tilesets, const std::vector<SourceLayer> & layers, std::vector<uint8_t> & outBytes)
+    {
+        size_t cellCount = size_t(width) * height;
+
+        // Resolve every gid to its tileset, atlas position and properties once
+        uint32_t atlasEntryCount = 1;
+        for (const auto & tileset : tilesets)
+        {
+            atlasEntryCount = std::max(atlasEntryCount, tileset.mFirstGid + tileset.mTileCount);
+        }
+
+        std::vector<LevelFormat::AtlasEntry> atlas(atlasEntryCount, LevelFormat::AtlasEntry{ LevelFormat::skNoTileset, 0, 0, 0 });
+        std::vector<TileProperties> gidProperties(atlasEntryCount);
+        for (size_t tilesetIndex = 0; tilesetIndex < tilesets.size(); ++tilesetIndex)
+        {
+            const SourceTileset & tileset = tilesets[tilesetIndex];
+            for (uint32_t localId = 0; localId < tileset.mTileCount; ++localId)
+            {
+                uint32_t gid = tileset.mFirstGid + localId;
+                atlas[gid].mTileset = uint16_t(tilesetIndex);
+                atlas[gid].mU = uint16_t((localId % tileset.mColumns) * tileset.mTileWidth);
+                atlas[gid].mV = uint16_t((localId / tileset.mColumns) * tileset.mTileHeight);
+
+                auto propertiesIt = tileset.mTileProperties.find(localId);
+                if (propertiesIt != tileset.mTileProperties.end())
+                {
+                    gidProperties[gid] = propertiesIt->second;
+                }
+            }
+        }
+
+        // Layout
+        LevelFormat::Header header = {};
+        header.mMagic = LevelFormat::skMagic;
+        header.mVersion = LevelFormat::skVersion;
+        header.mWidth = width;
+        header.mHeight = height;
+        header.mTileWidth = tileWidth;
+        header.mTileHeight = tileHeight;
+        header.mLayerCount = uint32_t(layers.size());
+        header.mTilesetCount = uint32_t(tilesets.size());
+        header.mAtlasEntryCount = atlasEntryCount;
+        header.mBitsetWordCount = LevelFormat::GetBitsetWordCount(width, height);
+
+        uint32_t offset = LevelFormat::AlignOffset(sizeof(LevelFormat::Header));
+        header.mLayersOffset = offset;
+        offset = LevelFormat::AlignOffset(offset + header.mLayerCount * sizeof(LevelFormat::LayerDesc));
+
+        std::vector<uint32_t> layerTileOffsets;
+        for (size_t layer = 0; layer < layers.size(); ++layer)
+        {
+            layerTileOffsets.push_back(offset);
+            offset = LevelFormat::AlignOffset(offset + uint32_t(cellCount * sizeof(uint32_t)));
+        }
+
+        header.mTilesetsOffset = offset;
+        offset = LevelFormat::AlignOffset(offset + header.mTilesetCount * sizeof(LevelFormat::TilesetDesc));
+        header.mAtlasOffset = offset;
+        offset = LevelFormat::AlignOffset(offset + atlasEntryCount * sizeof(LevelFormat::AtlasEntry));
+        for (uint32_t bitset = 0; bitset < LevelFormat::BitsetCount; ++bitset)
+        {
+            header.mBitsetOffsets[bitset] = offset;
+            offset += header.mBitsetWordCount * sizeof(uint64_t);
+        }
+        header.mFileSize = offset;
+
+        // Write
+        outBytes.assign(offset, 0);
+        *Reserve<LevelFormat::Header>(outBytes, 0) = header;
+
+        auto * pLayerDescs = Reserve<LevelFormat::LayerDesc>(outBytes, header.mLayersOffset);
+        for (size_t layer = 0; layer < layers.size(); ++layer)
+        {
+            CopyString(pLayerDescs[layer].mName, sizeof(pLayerDescs[layer].mName), layers[layer].mName);
+            pLayerDescs[layer].mTilesOffset = layerTileOffsets[layer];
+            std::memcpy(outBytes.data() + layerTileOffsets[layer], layers[layer].mTiles.data(), cellCount * sizeof(uint32_t));
+        }
+
+        auto * pTilesetDescs = Reserve<LevelFormat::TilesetDesc>(outBytes, header.mTilesetsOffset);
+        for (size_t tilesetIndex = 0; tilesetIndex < tilesets.size(); ++tilesetIndex)
+        {
+            const SourceTileset & tileset = tilesets[tilesetIndex];
+            LevelFormat::TilesetDesc & desc = pTilesetDescs[tilesetIndex];
+            CopyString(desc.mName, sizeof(desc.mName), tileset.mName);
+            CopyString(desc.mImagePath, sizeof(desc.mImagePath), tileset.mGameImagePath);
+            desc.mFirstGid = tileset.mFirstGid;
+            desc.mTileCount = tileset.mTileCount;
+            desc.mColumns = tileset.mColumns;
+            desc.mTileWidth = tileset.mTileWidth;
+            desc.mTileHeight = tileset.mTileHeight;
+        }
+
+        std::memcpy(outBytes.data() + header.mAtlasOffset, atlas.data(), atlas.size() * sizeof(LevelFormat::AtlasEntry));
+
+        // A cell is walkable when it has a tile and no tile in any layer forbids it, and solid or opaque when any tile
+        // says so. Rows start on a fresh word to match BitGridView.
+        uint64_t * pBitsets[LevelFormat::BitsetCount];
+        for (uint32_t bitset = 0; bitset < LevelFormat::BitsetCount; ++bitset)
+        {
+            pBitsets[bitset] = Reserve<uint64_t>(outBytes, header.mBitsetOffsets[bitset]);
+        }
+
+        uint32_t wordsPerRow = (width + 63u) / 64u;
+        for (size_t cell = 0; cell < cellCount; ++cell)
+        {
+            bool hasTile = false;
+            bool walkablePlayer = true;
+            bool walkableAI = true;
+            bool solid = false;
+            bool opaque = false;
+            for (const auto & layer : layers)
+            {
+                uint32_t gid = layer.mTiles[cell] & LevelFormat::skGidMask;
+                if (gid == 0 || gid >= atlasEntryCount)
+                {
+                    continue;
+                }
+                hasTile = true;
+                walkablePlayer = walkablePlayer && gidProperties[gid].mWalkablePlayer;
+                walkableAI = walkableAI && gidProperties[gid].mWalkableAI;
+                solid = solid || gidProperties[gid].mSolid;
+                opaque = opaque || gidProperties[gid].mOpaque;
+            }
+
+            uint32_t x = uint32_t(cell % width);
+            uint32_t y = uint32_t(cell / width);
+            size_t word = size_t(y) * wordsPerRow + x / 64;
+            uint64_t bit = uint64_t(1) << (x % 64);
+            if (hasTile && walkablePlayer)
+            {
+                pBitsets[LevelFormat::WalkablePlayer][word] |= bit;
+            }
+            if (hasTile && walkableAI)
+            {
+                pBitsets[LevelFormat::WalkableAI][word] |= bit;
+            }
+            if (solid)
+            {
+                pBitsets[LevelFormat::Solid][word] |= bit;
+            }
+            if (opaque)
+            {
+                pBitsets[LevelFormat::Opaque][word] |= bit;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool CookLevel(const std::string & levelPath, const LevelCookOptions & options, std::vector<uint8_t> & outBytes, std::string & outError)
+{
+    std::string text;
+    if (!ReadTextFile(levelPath, text))
+    {
+        outError = "Failed to open level " + levelPath;
+        return false;
+    }
+
+    nlohmann::json levelData = nlohmann::json::parse(text, nullptr, false);
+    if (levelData.is_discarded())
+    {
+        outError = "Level " + levelPath + " is not valid JSON";
+        return false;
+    }
+
+    uint32_t width = levelData.value("width", 0u);
+    uint32_t height = levelData.value("height", 0u);
+    uint32_t tileWidth = levelData.value("tilewidth", 0u);
+    uint32_t tileHeight = levelData.value("tileheight", 0u);
+    if (width == 0 || height == 0 || tileWidth == 0 || tileHeight == 0)
+    {
+        outError = "Level " + levelPath + " is missing its size";
+        return false;
+    }
+    size_t cellCount = size_t(width) * height;
+
+    // Tilesets
+    std::vector<SourceTileset> tilesets;
+    {
+        std::string levelDirectory = GetDirectory(levelPath);
+        for (const auto & tilesetData : levelData.value("tilesets", nlohmann::json::array()))
+        {
+            SourceTileset tileset;
+            tileset.mFirstGid = tilesetData.value("firstgid", 1u);
+
+            bool parsed = tilesetData.contains("source")
+                ? ParseTsx(levelDirectory + tilesetData["source"].get<std::string>(), tileset, outError)
+                : ParseEmbeddedTileset(tilesetData, tileset, outError);
+            if (!parsed)
+            {
+                return false;
+            }
+
+            FinishTileset(tileset, options);
+            tilesets.push_back(tileset);
+        }
+
+        std::sort(tilesets.begin(), tilesets.end(),
+            [](const SourceTileset & lhs, const SourceTileset & rhs) { return lhs.mFirstGid < rhs.mFirstGid; });
+    }
+
+    // Tile layers
+    std::vector<SourceLayer> layers;
+    for (const auto & layerData : levelData.value("layers", nlohmann::json::array()))
+    {
+        if (layerData.value("type", "") != "tilelayer")
+        {
+            continue;
+        }
+        if (layerData.contains("encoding") && layerData["encoding"] != "csv")
+        {
+            outError = "Layer " + layerData.value("name", "") + " uses an unsupported encoding, save the map as CSV";
+            return false;
+        }
+
+        const auto & data = layerData["data"];
+        if (!data.is_array() || data.size() != cellCount)
+        {
+            outError = "Layer " + layerData.value("name", "") + " does not match the map size";
+            return false;
+        }
+
+        SourceLayer layer;
+        layer.mName = layerData.value("name", "");
+        layer.mTiles.resize(cellCount);
+        for (size_t cell = 0; cell < cellCount; ++cell)
+        {
+            layer.mTiles[cell] = data[cell].get<uint32_t>();
+        }
+        layers.push_back(std::move(layer));
+    }
+
+    LayOutLevel(width, height, tileWidth, tileHeight, tilesets, layers, outBytes);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool CookTileGrid(const std::string & tilesetPath, uint32_t width, uint32_t height, const std::vector<uint32_t> & tiles,
+    const LevelCookOptions & options, std::vector<uint8_t> & outBytes, std::string & outError)
+{
+    if (width == 0 || height == 0 || tiles.size() != size_t(width) * height)
+    {
+        outError = "Generated level does not match its size";
+        return false;
+    }
+
+    SourceTileset tileset;
+    tileset.mFirstGid = 1;
+    if (!ParseTsx(tilesetPath, tileset, outError))
+    {
+        return false;
+    }
+    FinishTileset(tileset, options);
+
+    SourceLayer layer;
+    layer.mName = "Generated";
+    layer.mTiles = tiles;
+
+    LayOutLevel(width, height, tileset.mTileWidth, tileset.mTileHeight, { tileset }, { layer }, outBytes);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool ReadTileAdjacency(const std::string & tsxPath, TileAdjacency & outAdjacency, std::string & outError)
+{
+    std::string text;
+    if (!ReadTextFile(tsxPath, text))
+    {
+        outError = "Failed to open tileset " + tsxPath;
+        return false;
+    }
+
+    // Edge colors in Tiled's wangid order are top, top right, right, ... so the sides are every other entry
+    struct WangTile
+    {
+        uint32_t mTileId;
+        uint32_t mEdges[4];
+    };
+
+    std::unordered_map<uint32_t, float> probabilities;
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> neighborLists;
+    std::vector<std::vector<WangTile>> wangSets;
+
+    size_t cursor = 0;
+    XmlTag tag;
+    bool inTile = false;
+    bool inEdgeSet = false;
+    uint32_t tileId = 0;
+    while (NextXmlTag(text, cursor, tag))
+    {
+        if (tag.mName == "tile" && !tag.mIsClosing)
+        {
+            inTile = !tag.mIsSelfClosing;
+            tileId = GetUIntAttribute(tag, "id");
+            auto it = tag.mAttributes.find("probability");
+            if (it != tag.mAttributes.end())
+            {
+                probabilities[tileId] = std::stof(it->second);
+            }
+        }
+        else if (tag.mName == "tile" && tag.mIsClosing)
+        {
+            inTile = false;
+        }
+        else if (tag.mName == "property" && inTile && tag.mAttributes["name"] == "wfcNeighbors")
+        {
+            std::vector<uint32_t> neighbors;
+            std::stringstream list(tag.mAttributes["value"]);
+            std::string entry;
+            while (std::getline(list, entry, ','))
+            {
+                if (entry.find_first_of("0123456789") != std::string::npos)
+                {
+                    neighbors.push_back(uint32_t(std::stoul(entry)));
+                }
+            }
+            neighborLists.emplace_back(tileId, std::move(neighbors));
+        }
+        else if (tag.mName == "wangset" && !tag.mIsClosing)
+        {
+            const std::string & type = tag.mAttributes["type"];
+            inEdgeSet = !tag.mIsSelfClosing && (type == "edge" || type == "mixed");
+            if (inEdgeSet)
+            {
+                wangSets.emplace_back();
+            }
+        }
+        else if (tag.mName == "wangset" && tag.mIsClosing)
+        {
+            inEdgeSet = false;
+        }
+        else if (tag.mName == "wangtile" && inEdgeSet)
+        {
+            std::vector<uint32_t> colors;
+            std::stringstream list(tag.mAttributes["wangid"]);
+            std::string entry;
+            while (std::getline(list, entry, ','))
+            {
+                colors.push_back(uint32_t(std::stoul(entry)));
+            }
+            if (colors.size() == 8)
+            {
+                wangSets.back().push_back({ GetUIntAttribute(tag, "tileid"), { colors[0], colors[2], colors[4], colors[6] } });
+            }
+        }
+    }
+
+    outAdjacency = TileAdjacency();
+    std::unordered_map<uint32_t, uint32_t> tileIndices;
+    auto getTileIndex = [&](uint32_t id)
+        {
+            auto it = tileIndices.find(id);
+            if (it != tileIndices.end())
+            {
+                return it->second;
+            }
+            uint32_t index = uint32_t(outAdjacency.mTileIds.size());
+            auto probability = probabilities.find(id);
+            outAdjacency.mTileIds.push_back(id);
+            outAdjacency.mWeights.push_back(probability == probabilities.end() ? 1.f : probability->second);
+            tileIndices[id] = index;
+            return index;
+        };
+
+    for (const auto & neighborList : neighborLists)
+    {
+        uint32_t tile = getTileIndex(neighborList.first);
+        for (uint32_t neighborId : neighborList.second)
+        {
+            uint32_t neighbor = getTileIndex(neighborId);
+            for (uint8_t direction = 0; direction < 4; ++direction)
+            {
+                outAdjacency.mRules.push_back({ tile, neighbor, direction });
+                outAdjacency.mRules.push_back({ neighbor, tile, direction });
+            }
+        }
+    }
+
+    for (const auto & wangSet : wangSets)
+    {
+        for (const WangTile & first : wangSet)
+        {
+            for (const WangTile & second : wangSet)
+            {
+                for (uint8_t direction = 0; direction < 4; ++direction)
+                {
+                    if (first.mEdges[direction] == second.mEdges[(direction + 2) & 3])
+                    {
+                        outAdjacency.mRules.push_back({ getTileIndex(first.mTileId), getTileIndex(second.mTileId), direction });
+                    }
+                }
+            }
+        }
+    }
+
+    if (outAdjacency.mRules.empty())
+    {
+        outError = "Tileset " + tsxPath + " has no adjacency rules";
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compiled into both the game (development fallback) and the LevelCooker tool, so this stays free of the
+// precompiled header and of anything but the standard library and nlohmann json.
+struct LevelCookOptions
+{
+    // Tileset name -> image path the game should load. Wins over the tileset's own "gameImage" property and the
+    // default of Art/<image file name>.
+    std::unordered_map<std::string, std::string> mImageOverrides;
+};
+
+// Reads a Tiled JSON map plus its embedded or external (.tsx) tilesets and lays it out in the LevelFormat byte layout.
+// Tile properties "walkable", "aiWalkable", "solid" and "opaque" (bool) feed the precomputed bitsets.
+bool CookLevel(const std::string & levelPath, const LevelCookOptions & options, std::vector<uint8_t> & outBytes, std::string & outError);
+
+// Lays out a map built in code, a single layer of gids from one .tsx tileset whose first gid is 1. Tile properties
+// feed the bitsets the same way they do for Tiled maps.
+bool CookTileGrid(const std::string & tilesetPath, uint32_t width, uint32_t height, const std::vector<uint32_t> & tiles,
+    const LevelCookOptions & options, std::vector<uint8_t> & outBytes, std::string & outError);
+
+// Which tiles of a .tsx tileset may sit next to each other, for the wave function collapse solver. Tiles of an edge
+// (or mixed) Wang set may touch where the colors of the touching edges match. A tile's "wfcNeighbors" string property,
+// a comma separated list of tile ids, allows those tiles on every side of it and it on every side of them. Weights
+// are the tiles' Tiled "probability".
+struct TileAdjacency
+{
+    struct Rule
+    {
+        uint32_t mTile;         // Indices into mTileIds
+        uint32_t mNeighbor;
+        uint8_t mDirection;     // Where mNeighbor is from mTile: 0 up, 1 right, 2 down, 3 left
+    };
+
+    std::vector<uint32_t> mTileIds;
+    std::vector<float> mWeights;
+    std::vector<Rule> mRules;
+};
+
+bool ReadTileAdjacency(const std::string & tsxPath, TileAdjacency & outAdjacency, std::string & outError);
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//------------------------------------------------------------------------------------------------------------------------
+// Cooked level format (.bdlevel)
+//
+// Written by the LevelCooker tool and used in place by LevelManager straight out of a memory mapped file, so every
+// section is plain old data at an 8 byte aligned offset from the start of the file. Bump skVersion whenever a struct
+// below changes; stale files are rejected and recooked instead of being misread.
+//
+//   Header
+//   LayerDesc[mLayerCount]          each points at mWidth * mHeight raw Tiled gids (flip flags kept in the top bits)
+//   TilesetDesc[mTilesetCount]
+//   AtlasEntry[mAtlasEntryCount]    indexed by gid without flip flags, entry 0 is the empty tile
+//   uint64_t[mBitsetWordCount] x4   walkable player, walkable AI, solid, opaque; rows padded to whole words so they
+//                                   load directly as BitGridViews
+//------------------------------------------------------------------------------------------------------------------------
+
+namespace LevelFormat
+{
+    const uint32_t skMagic = 0x4C564442; // "BDVL"
+    const uint32_t skVersion = 2;
+
+    const uint32_t skFlippedHorizontally = 0x80000000;
+    const uint32_t skFlippedVertically = 0x40000000;
+    const uint32_t skFlippedDiagonally = 0x20000000;
+    const uint32_t skGidMask = 0x1FFFFFFF;
+
+    const uint16_t skNoTileset = 0xFFFF;
+
+    const int skMaxNameLength = 32;
+    const int skMaxPathLength = 128;
+
+    enum EBitset
+    {
+        WalkablePlayer,
+        WalkableAI,
+        Solid,
+        Opaque,
+        BitsetCount
+    };
+
+    struct Header
+    {
+        uint32_t mMagic;
+        uint32_t mVersion;
+        uint32_t mFileSize;
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint32_t mTileWidth;
+        uint32_t mTileHeight;
+        uint32_t mLayerCount;
+        uint32_t mTilesetCount;
+        uint32_t mAtlasEntryCount;
+        uint32_t mBitsetWordCount;
+        uint32_t mLayersOffset;
+        uint32_t mTilesetsOffset;
+        uint32_t mAtlasOffset;
+        uint32_t mBitsetOffsets[BitsetCount];
+    };
+
+    struct LayerDesc
+    {
+        char mName[skMaxNameLength];
+        uint32_t mTilesOffset;
+        uint32_t mPadding;
+    };
+
+    struct TilesetDesc
+    {
+        char mName[skMaxNameLength];
+        char mImagePath[skMaxPathLength];  // Relative to the game's working directory, empty if unresolved
+        uint32_t mFirstGid;
+        uint32_t mTileCount;
+        uint32_t mColumns;
+        uint32_t mTileWidth;
+        uint32_t mTileHeight;
+        uint32_t mPadding;
+    };
+
+    struct AtlasEntry
+    {
+        uint16_t mTileset;  // skNoTileset for gid 0 and gaps between tilesets
+        uint16_t mU;        // Pixel offset of the tile in the tileset image
+        uint16_t mV;
+        uint16_t mPadding;
+    };
+
+    inline uint32_t AlignOffset(uint32_t offset)
+    {
+        return (offset + 7u) & ~7u;
+    }
+
+    inline uint32_t GetBitsetWordCount(uint32_t width, uint32_t height)
+    {
+        return ((width + 63u) / 64u) * height;
+    }
+
+    // Returns the header if pData holds a complete level of the current version, nullptr otherwise
+    inline const Header * Validate(const void * pData, size_t size)
+    {
+        if (!pData || size < sizeof(Header))
+        {
+            return nullptr;
+        }
+
+        const Header * pHeader = static_cast<const Header *>(pData);
+        if (pHeader->mMagic != skMagic || pHeader->mVersion != skVersion || pHeader->mFileSize != size)
+        {
+            return nullptr;
+        }
+
+        auto fits = [size](uint32_t offset, size_t bytes) { return (offset % 8) == 0 && size_t(offset) + bytes <= size; };
+
+        size_t cellCount = size_t(pHeader->mWidth) * pHeader->mHeight;
+        if (!fits(pHeader->mLayersOffset, pHeader->mLayerCount * sizeof(LayerDesc)) ||
+            !fits(pHeader->mTilesetsOffset, pHeader->mTilesetCount * sizeof(TilesetDesc)) ||
+            !fits(pHeader->mAtlasOffset, pHeader->mAtlasEntryCount * sizeof(AtlasEntry)) ||
+            pHeader->mBitsetWordCount != GetBitsetWordCount(pHeader->mWidth, pHeader->mHeight))
+        {
+            return nullptr;
+        }
+
+        for (uint32_t bitset = 0; bitset < BitsetCount; ++bitset)
+        {
+            if (!fits(pHeader->mBitsetOffsets[bitset], pHeader->mBitsetWordCount * sizeof(uint64_t)))
+            {
+                return nullptr;
+            }
+        }
+
+        const LayerDesc * pLayers = reinterpret_cast<const LayerDesc *>(static_cast<const char *>(pData) + pHeader->mLayersOffset);
+        for (uint32_t layer = 0; layer < pHeader->mLayerCount; ++layer)
+        {
+            if (!fits(pLayers[layer].mTilesOffset, cellCount * sizeof(uint32_t)))
+            {
+                return nullptr;
+            }
+        }
+
+        return pHeader;
+    }
+
+    template <typename T>
+    const T * GetSection(const Header * pHeader, uint32_t offset)
+    {
+        return reinterpret_cast<const T *>(reinterpret_cast<const char *>(pHeader) + offset);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
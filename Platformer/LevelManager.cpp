@@ -1,19 +1,40 @@
 #include "AstroidsPrivate.h"
 #include "LevelManager.h"
+#include "LevelCook.h"
 #include "ResourceManager.h"
-#include <fstream>
+#include "BDConfig.h"
 #include <iostream>
 
-LevelManager::LevelManager(GameManager * pGameManager)
-	: BaseManager(pGameManager)
-	, mTileData()
-	, mWidth(0)
-	, mHeight(0)
-	, mTileWidth(0)
-	, mTileHeight(0)
-	, mTileSprites()
+namespace
 {
+    bool HasExtension(const std::string & path, const char * pExtension)
+    {
+        size_t length = std::strlen(pExtension);
+        return path.size() >= length && path.compare(path.size() - length, length, pExtension) == 0;
+    }
+}
 
+//------------------------------------------------------------------------------------------------------------------------
+
+LevelManager::LevelManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mMappedFile()
+    , mCookedBytes()
+    , mLevelPath()
+    , mLevelGeneration(1)
+    , mpHeader(nullptr)
+    , mpTilesets(nullptr)
+    , mpAtlas(nullptr)
+    , mLayers()
+    , mStreamedLayers()
+    , mLayerTiles()
+    , mWidth(0)
+    , mHeight(0)
+    , mTileWidth(0)
+    , mTileHeight(0)
+    , mTilesetTextures()
+    , mTilesetVertices()
+{
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -27,149 +48,298 @@ LevelManager::~LevelManager()
 
 bool LevelManager::LoadLevel(const std::string & filePath)
 {
-	std::ifstream file(filePath);
-	if (!file.is_open())
-	{
-		printf("Failed to open file %s, is already open.", filePath.c_str());
-		return false;
-	}
-
-	json levelData;
-	file >> levelData;
+    ClearLevel();
 
-	mWidth = levelData["width"];
-	mHeight = levelData["height"];
-	mTileWidth = levelData["tilewidth"];
-	mTileHeight = levelData["tileheight"];
+    bool isLoaded = false;
+    if (HasExtension(filePath, ".json"))
+    {
+        isLoaded = LoadJson(filePath);
+    }
+    else if (LoadCooked(filePath))
+    {
+        isLoaded = true;
+    }
+    else
+    {
+#if LEVEL_JSON_FALLBACK_ENABLED()
+        std::string jsonPath = filePath.substr(0, filePath.find_last_of('.')) + ".json";
+        printf("Cooked level %s is missing or stale, cooking %s in memory.\n", filePath.c_str(), jsonPath.c_str());
+        isLoaded = LoadJson(jsonPath);
+#else
+        printf("Failed to load cooked level %s.\n", filePath.c_str());
+#endif
+    }
 
-	ParseTileData(levelData);
-	return true;
+    if (isLoaded)
+    {
+        mLevelPath = filePath;
+    }
+    return isLoaded;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void LevelManager::Render(sf::RenderWindow & window)
+bool LevelManager::LoadCookedBytes(std::vector<uint8_t> && cookedBytes)
 {
-	for (const auto & sprite : mTileSprites)
-	{
-		window.draw(sprite);
-	}
+    ClearLevel();
+
+    mCookedBytes = std::move(cookedBytes);
+    if (!BindLevelData(mCookedBytes.data(), mCookedBytes.size()))
+    {
+        mCookedBytes.clear();
+        return false;
+    }
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-bool LevelManager::IsTileWalkableAI(int x, int y) const
+void LevelManager::CreateStreamedLevel(int width, int height, int tileWidth, int tileHeight)
 {
-#if 0
-    if (y < 0 || y >= mHeight || x < 0 || x >= mWidth)
-        return false;
+    ClearLevel();
 
-    int tile = mTileData[y][x];
-    return (tile == 70);
-#endif
-    return true;
+    mWidth = width;
+    mHeight = height;
+    mTileWidth = tileWidth;
+    mTileHeight = tileHeight;
+    for (int bitset = 0; bitset < LevelFormat::BitsetCount; ++bitset)
+    {
+        mStreamedLayers[bitset].Resize(width, height, false);
+        mLayers[bitset] = BitGridView(mStreamedLayers[bitset].GetRowWords(0), width, height);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-bool LevelManager::IsTileWalkablePlayer(int x, int y) const
+bool LevelManager::LoadCooked(const std::string & filePath)
 {
-#if 0
-    if (y < 0 || y >= mHeight || x < 0 || x >= mWidth)
+    if (!mMappedFile.Open(filePath))
+    {
         return false;
+    }
 
-    int tile = mTileData[y][x];
-    return (tile == 7 || tile == 70);
-#endif
+    if (!BindLevelData(mMappedFile.GetData(), mMappedFile.GetSize()))
+    {
+        mMappedFile.Close();
+        return false;
+    }
     return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void LevelManager::ClearLevel()
+bool LevelManager::LoadJson(const std::string & filePath)
 {
-	mTileData.clear();
-	mTileSprites.clear();
+#if LEVEL_JSON_FALLBACK_ENABLED()
+    std::string error;
+    if (!CookLevel(filePath, LevelCookOptions(), mCookedBytes, error))
+    {
+        std::cerr << error << std::endl;
+        return false;
+    }
+    return BindLevelData(mCookedBytes.data(), mCookedBytes.size());
+#else
+    printf("Loading Tiled JSON (%s) is only supported in development builds, run LevelCooker.\n", filePath.c_str());
+    return false;
+#endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void LevelManager::ParseTileData(const json & levelData)
+bool LevelManager::BindLevelData(const void * pData, size_t size)
 {
-    mTileSprites.clear();
-    mTileData.clear();
+    mpHeader = LevelFormat::Validate(pData, size);
+    if (!mpHeader)
+    {
+        return false;
+    }
 
-    ResourceManager * resourceManager = GetGameManager().GetManager<ResourceManager>();
-    auto resourceID = ResourceId("Art/TileSet.png");
-    auto tilesetTexture = resourceManager->GetTexture(resourceID);
-    if (!tilesetTexture)
+    mWidth = int(mpHeader->mWidth);
+    mHeight = int(mpHeader->mHeight);
+    mTileWidth = int(mpHeader->mTileWidth);
+    mTileHeight = int(mpHeader->mTileHeight);
+
+    mpTilesets = LevelFormat::GetSection<LevelFormat::TilesetDesc>(mpHeader, mpHeader->mTilesetsOffset);
+    mpAtlas = LevelFormat::GetSection<LevelFormat::AtlasEntry>(mpHeader, mpHeader->mAtlasOffset);
+    for (int bitset = 0; bitset < LevelFormat::BitsetCount; ++bitset)
     {
-        std::cerr << "Failed to load tileset texture." << std::endl;
-        return;
+        mLayers[bitset] = BitGridView(LevelFormat::GetSection<uint64_t>(mpHeader, mpHeader->mBitsetOffsets[bitset]), mWidth, mHeight);
     }
 
-    if (!levelData.contains("layers") || !levelData["layers"].is_array())
+    const auto * pLayers = LevelFormat::GetSection<LevelFormat::LayerDesc>(mpHeader, mpHeader->mLayersOffset);
+    for (uint32_t layer = 0; layer < mpHeader->mLayerCount; ++layer)
     {
-        std::cerr << "No layers found in level file." << std::endl;
-        return;
+        mLayerTiles.push_back(LevelFormat::GetSection<uint32_t>(mpHeader, pLayers[layer].mTilesOffset));
     }
 
-    for (const auto & layer : levelData["layers"])
+    BuildTileVertices();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void LevelManager::Render(sf::RenderWindow & window)
+{
+    for (size_t tileset = 0; tileset < mTilesetVertices.size(); ++tileset)
     {
-        if (layer["type"] == "tilelayer" && layer.contains("data"))
+        if (mTilesetTextures[tileset] && mTilesetVertices[tileset].getVertexCount() > 0)
         {
-            const auto & data = layer["data"];
-            if (!data.is_array())
-            {
-                std::cerr << "Invalid layer data." << std::endl;
-                return;
-            }
+            sf::RenderStates states(mTilesetTextures[tileset].get());
+            window.draw(mTilesetVertices[tileset], states);
+        }
+    }
+}
 
-            mTileData.resize(mHeight, std::vector<int>(mWidth));
+//------------------------------------------------------------------------------------------------------------------------
 
-            for (int y = 0; y < mHeight; ++y)
-            {
-                for (int x = 0; x < mWidth; ++x)
-                {
-                    int tileID = data[y * mWidth + x].get<int>();
+int LevelManager::GetWidth() const
+{
+    return mWidth;
+}
 
-                    // Extract transformation flags
-                    int actualTileID = tileID & 0x1FFFFFFF;
-                    bool flippedHorizontally = (tileID & 0x80000000) != 0;
-                    bool flippedVertically = (tileID & 0x40000000) != 0;
-                    bool flippedDiagonally = (tileID & 0x20000000) != 0;
+//------------------------------------------------------------------------------------------------------------------------
 
-                    mTileData[y][x] = actualTileID;
+int LevelManager::GetHeight() const
+{
+    return mHeight;
+}
 
-                    if (actualTileID > 0)
-                    {
-                        sf::Sprite sprite;
-                        sprite.setTexture(*tilesetTexture);
+//------------------------------------------------------------------------------------------------------------------------
 
-                        int columns = tilesetTexture->getSize().x / mTileWidth;
-                        int row = (actualTileID - 1) / columns;
-                        int column = (actualTileID - 1) % columns;
+int LevelManager::GetLayerCount() const
+{
+    return int(mLayerTiles.size());
+}
 
-                        sprite.setTextureRect(sf::IntRect(column * mTileWidth, row * mTileHeight, mTileWidth, mTileHeight));
+//------------------------------------------------------------------------------------------------------------------------
 
-                        float worldX = static_cast<float>(x * mTileWidth);
-                        float worldY = static_cast<float>(y * mTileHeight);
-                        sprite.setPosition(worldX, worldY);
+uint32_t LevelManager::GetTileGid(int layer, int x, int y) const
+{
+    if (layer < 0 || layer >= GetLayerCount() || y < 0 || y >= mHeight || x < 0 || x >= mWidth)
+    {
+        return 0;
+    }
+    return mLayerTiles[layer][y * mWidth + x];
+}
 
-                        // Apply transformations
-                        sf::Vector2f origin(mTileWidth / 2.0f, mTileHeight / 2.0f);
-                        sprite.setOrigin(origin);
+//------------------------------------------------------------------------------------------------------------------------
+
+void LevelManager::ClearLevel()
+{
+    // Workers can be reading the layers in place, they have to be done before the bytes go away
+    GetGameManager().NotifyLevelUnloading();
+
+    mTilesetVertices.clear();
+    mTilesetTextures.clear();
+    mLayerTiles.clear();
+    mpHeader = nullptr;
+    mpTilesets = nullptr;
+    mpAtlas = nullptr;
+    for (auto & layer : mLayers)
+    {
+        layer = BitGridView();
+    }
+    for (auto & layer : mStreamedLayers)
+    {
+        layer = BitGrid();
+    }
 
-                        if (flippedHorizontally)
-                            sprite.scale(-1.f, 1.f); // Flip horizontally
-                        if (flippedVertically)
-                            sprite.scale(1.f, -1.f); // Flip vertically
-                        if (flippedDiagonally)
-                            sprite.setRotation(90.f); // 90-degree diagonal flip
+    mMappedFile.Close();
+    mCookedBytes.clear();
+    mLevelPath.clear();
+    mWidth = 0;
+    mHeight = 0;
 
-                        mTileSprites.push_back(sprite);
+    if (++mLevelGeneration == 0)
+    {
+        ++mLevelGeneration;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void LevelManager::BuildTileVertices()
+{
+    ResourceManager * pResourceManager = GetGameManager().GetManager<ResourceManager>();
+
+    mTilesetTextures.resize(mpHeader->mTilesetCount);
+    mTilesetVertices.assign(mpHeader->mTilesetCount, sf::VertexArray(sf::Triangles));
+    for (uint32_t tileset = 0; tileset < mpHeader->mTilesetCount; ++tileset)
+    {
+        std::string imagePath(mpTilesets[tileset].mImagePath);
+        ResourceId resourceId(imagePath);
+        mTilesetTextures[tileset] = imagePath.empty() ? nullptr : pResourceManager->GetTexture(resourceId);
+        if (!mTilesetTextures[tileset])
+        {
+            std::cerr << "Tileset " << mpTilesets[tileset].mName << " has no loadable image (" << imagePath << "), its tiles are skipped." << std::endl;
+        }
+    }
+
+    for (const uint32_t * pTiles : mLayerTiles)
+    {
+        for (int y = 0; y < mHeight; ++y)
+        {
+            for (int x = 0; x < mWidth; ++x)
+            {
+                uint32_t rawGid = pTiles[y * mWidth + x];
+                uint32_t gid = rawGid & LevelFormat::skGidMask;
+                if (gid == 0 || gid >= mpHeader->mAtlasEntryCount)
+                {
+                    continue;
+                }
+
+                // skNoTileset is past the end as well, and a stale or corrupt file can name a tileset it does not have
+                const LevelFormat::AtlasEntry & entry = mpAtlas[gid];
+                if (entry.mTileset >= mpHeader->mTilesetCount || !mTilesetTextures[entry.mTileset])
+                {
+                    continue;
+                }
+
+                const LevelFormat::TilesetDesc & tileset = mpTilesets[entry.mTileset];
+                float left = float(entry.mU);
+                float top = float(entry.mV);
+                float width = float(tileset.mTileWidth);
+                float height = float(tileset.mTileHeight);
+
+                // Corners in draw order (top left, top right, bottom right, bottom left), flips are applied to the
+                // texture coordinates the same way Tiled does: vertical, then horizontal, then the diagonal swap
+                sf::Vector2f texCoords[4];
+                const sf::Vector2f unitCorners[4] = { {0.f, 0.f}, {1.f, 0.f}, {1.f, 1.f}, {0.f, 1.f} };
+                for (int corner = 0; corner < 4; ++corner)
+                {
+                    sf::Vector2f unit = unitCorners[corner];
+                    if (rawGid & LevelFormat::skFlippedVertically)
+                    {
+                        unit.y = 1.f - unit.y;
                     }
+                    if (rawGid & LevelFormat::skFlippedHorizontally)
+                    {
+                        unit.x = 1.f - unit.x;
+                    }
+                    if (rawGid & LevelFormat::skFlippedDiagonally)
+                    {
+                        std::swap(unit.x, unit.y);
+                    }
+                    texCoords[corner] = sf::Vector2f(left + unit.x * width, top + unit.y * height);
                 }
+
+                float worldX = float(x * mTileWidth);
+                float worldY = float(y * mTileHeight);
+                sf::Vector2f positions[4] =
+                {
+                    { worldX, worldY },
+                    { worldX + mTileWidth, worldY },
+                    { worldX + mTileWidth, worldY + mTileHeight },
+                    { worldX, worldY + mTileHeight }
+                };
+
+                sf::VertexArray & vertices = mTilesetVertices[entry.mTileset];
+                vertices.append(sf::Vertex(positions[0], texCoords[0]));
+                vertices.append(sf::Vertex(positions[1], texCoords[1]));
+                vertices.append(sf::Vertex(positions[2], texCoords[2]));
+                vertices.append(sf::Vertex(positions[0], texCoords[0]));
+                vertices.append(sf::Vertex(positions[2], texCoords[2]));
+                vertices.append(sf::Vertex(positions[3], texCoords[3]));
             }
         }
     }
@@ -177,4 +347,4 @@ void LevelManager::ParseTileData(const json & levelData)
 
 //------------------------------------------------------------------------------------------------------------------------
 // EOF
-//------------------------------------------------------------------------------------------------------------------------
\ No newline at end of file
+//------------------------------------------------------------------------------------------------------------------------
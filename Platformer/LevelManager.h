@@ -4,32 +4,80 @@
 #include <unordered_map>
 #include "BaseManager.h"
 #include "SFML/Graphics.hpp"
-#include "BaseManager.h"
+#include "LevelFormat.h"
+#include "MappedFile.h"
+#include "BitGrid.h"
 
-using json = nlohmann::json;
+// Levels are cooked offline into the LevelFormat layout (see LevelCooker) and used in place from a memory mapped
+// .bdlevel file. Development builds fall back to cooking the Tiled JSON in memory when the cooked file is missing or
+// out of date, so both paths share the same views below.
 class LevelManager : public BaseManager
 {
 public:
 	LevelManager(GameManager * pGameManager);
 	~LevelManager();
 
+	// Accepts a .bdlevel or, in development builds, a Tiled .json
 	bool LoadLevel(const std::string & filePath);
+
+	// The file the current level came from, empty for cooked bytes, a streamed level or none at all
+	const std::string & GetLevelPath() const { return mLevelPath; }
+
+	// Goes up every time the level is cleared or replaced, even by one of the same size. Never 0.
+	uint32_t GetLevelGeneration() const { return mLevelGeneration; }
+
+	// Takes over a level cooked in memory, such as a generated dungeon
+	bool LoadCookedBytes(std::vector<uint8_t> && cookedBytes);
+
+	// A level with no tiles of its own whose layers are filled in piece by piece, see ChunkStreamer. Every cell starts
+	// out unwalkable.
+	void CreateStreamedLevel(int width, int height, int tileWidth, int tileHeight);
+	bool IsStreamedLevel() const { return !mStreamedLayers[0].IsEmpty(); }
+	BitGrid * GetStreamedLayer(LevelFormat::EBitset bitset) { return IsStreamedLevel() ? &mStreamedLayers[bitset] : nullptr; }
 	void ClearLevel();
 
 	virtual void Render(sf::RenderWindow & window) override;
 
-	bool IsTileWalkableAI(int x, int y) const;
-	bool IsTileWalkablePlayer(int x, int y) const;
+	// Single bit tests against the cooked layers, cells off the map read as false
+	bool IsTileWalkableAI(int x, int y) const { return mLayers[LevelFormat::WalkableAI].Test(x, y); }
+	bool IsTileWalkablePlayer(int x, int y) const { return mLayers[LevelFormat::WalkablePlayer].Test(x, y); }
+	bool IsTileSolid(int x, int y) const { return mLayers[LevelFormat::Solid].Test(x, y); }
+	bool IsTileOpaque(int x, int y) const { return mLayers[LevelFormat::Opaque].Test(x, y); }
+
+	// Whole layers for systems that scan the map a word at a time, empty until a level is loaded
+	const BitGridView & GetLayer(LevelFormat::EBitset bitset) const { return mLayers[bitset]; }
+
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetLayerCount() const;
+	uint32_t GetTileGid(int layer, int x, int y) const;
 
 private:
-	void ParseTileData(const json & levelData);
+	bool LoadCooked(const std::string & filePath);
+	bool LoadJson(const std::string & filePath);
+	bool BindLevelData(const void * pData, size_t size);
+	void BuildTileVertices();
+
+	// Backing storage, only one of these holds the level at a time
+	MappedFile mMappedFile;
+	std::vector<uint8_t> mCookedBytes;
+	std::string mLevelPath;
+	uint32_t mLevelGeneration;
+
+	// Views into the cooked level
+	const LevelFormat::Header * mpHeader;
+	const LevelFormat::TilesetDesc * mpTilesets;
+	const LevelFormat::AtlasEntry * mpAtlas;
+	BitGridView mLayers[LevelFormat::BitsetCount];
+	BitGrid mStreamedLayers[LevelFormat::BitsetCount];
+	std::vector<const uint32_t *> mLayerTiles;
 
-	std::vector<std::vector<int>> mTileData;
 	int mWidth;
 	int mHeight;
 	int mTileWidth;
 	int mTileHeight;
 
-	std::vector<sf::Sprite> mTileSprites;
+	// One vertex array per tileset texture
+	std::vector<std::shared_ptr<sf::Texture>> mTilesetTextures;
+	std::vector<sf::VertexArray> mTilesetVertices;
 };
-
@@ -1,63 +1,112 @@
 #include "AstroidsPrivate.h"
 #include <iostream>
 #include <cstdlib>
+#include "InputManager.h"
+#include "NetworkManager.h"
+
+namespace
+{
+    // A networked game keeps running when it loses focus, the other players are still playing
+    bool CanIdleUnfocused(GameManager & gameManager)
+    {
+        auto * pNetworkManager = gameManager.GetManager<NetworkManager>();
+        return !pNetworkManager || pNetworkManager->GetMode() == ENetMode::Off;
+    }
+
+    bool IsRestartPressed(const std::vector<sf::Event> & events)
+    {
+        for (const sf::Event & event : events)
+        {
+            if (event.type == sf::Event::KeyPressed &&
+                (event.key.code == sf::Keyboard::Enter || event.key.code == sf::Keyboard::Space))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
 
 int main()
 {
     WindowManager windowManager;
+    FramePacer & framePacer = windowManager.GetFramePacer();
     bool paused = false;
-    sf::Clock clock;
     float fpsTimer = 0.f;
-    int frameCount = 0;
+
+    // Built once, a restart resets it in place so nothing that outlives a game is loaded twice
+    GameManager * pGameManager = new GameManager(windowManager);
 
     while (windowManager.GetWindow()->isOpen())
     {
-        GameManager * pGameManager = new GameManager(windowManager);
+        framePacer.ResetClock();
 
         while (windowManager.GetWindow()->isOpen() && !pGameManager->IsGameOver())
         {
-            windowManager.PollEvents();
+            // Paused or in the background nothing moves, so the loop sleeps until an event could change that
+            bool isIdle = paused || (!windowManager.HasFocus() && CanIdleUnfocused(*pGameManager));
+            float deltaTime = 0.f;
+            if (isIdle)
+            {
+                windowManager.WaitEvents();
+            }
+            else
+            {
+                // Input is polled right after the pacer's wait, so it is as fresh as it can be when the frame uses it
+                deltaTime = framePacer.BeginFrame();
+                windowManager.PollEvents();
+            }
+
+            // Once per tick, everything after this reads the same snapshot
+            auto * pInputManager = pGameManager->GetManager<InputManager>();
+            pInputManager->Sample(windowManager.GetEvents(), deltaTime);
 
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
+            if (pInputManager->GetSnapshot().WasPressed(EAction::Pause))
             {
                 paused = !paused;
                 pGameManager->SetPausedState(paused);
             }
 
-            float deltaTime = clock.restart().asSeconds();
-
-            frameCount++;
             fpsTimer += deltaTime;
-
             if (fpsTimer >= 1.f) // Once every second
             {
-                std::cout << "FPS: " << frameCount << std::endl;
+                const FramePacingStats & stats = framePacer.GetStats();
+                std::cout << "FPS: " << int(stats.mFramesPerSecond + 0.5f)
+                    << " pacing error: " << stats.mMeanErrorMicroseconds << " us mean, "
+                    << stats.mMaxErrorMicroseconds << " us max" << std::endl;
                 fpsTimer = 0.f;
-                frameCount = 0;
             }
-            if (!paused)
+
+            if (!paused && !isIdle)
             {
                 pGameManager->Update(deltaTime);
             }
             else
             {
                 pGameManager->DebugUpdate(deltaTime);
-                clock.restart();
             }
             pGameManager->Render(deltaTime);
         }
-        delete pGameManager;
-        pGameManager = nullptr;
 
         bool waitingForRestart = true;
         while (windowManager.GetWindow()->isOpen() && waitingForRestart)
         {
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Enter) || sf::Keyboard::isKeyPressed(sf::Keyboard::Space))
+            windowManager.WaitEvents();
+            if (IsRestartPressed(windowManager.GetEvents()))
             {
                 waitingForRestart = false;
             }
         }
+
+        if (waitingForRestart)
+        {
+            break;
+        }
+        pGameManager->Reset();
     }
 
+    delete pGameManager;
+    pGameManager = nullptr;
+
     return 0;
-}
\ No newline at end of file
+}
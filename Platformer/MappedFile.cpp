@@ -0,0 +1,145 @@
+#include "AstroidsPrivate.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : mpData(nullptr)
+    , mSize(0)
+#ifdef _WIN32
+    , mFileHandle(INVALID_HANDLE_VALUE)
+    , mMappingHandle(nullptr)
+#else
+    , mFileDescriptor(-1)
+#endif
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool MappedFile::Open(const std::string & path)
+{
+    Close();
+
+#ifdef _WIN32
+    mFileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(mFileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+    mSize = size_t(fileSize.QuadPart);
+
+    mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mMappingHandle)
+    {
+        Close();
+        return false;
+    }
+
+    mpData = MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+    mFileDescriptor = open(path.c_str(), O_RDONLY);
+    if (mFileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(mFileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+    mSize = size_t(fileStat.st_size);
+
+    void * pData = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+    mpData = pData == MAP_FAILED ? nullptr : pData;
+#endif
+
+    if (!mpData)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (mpData)
+    {
+        UnmapViewOfFile(mpData);
+    }
+    if (mMappingHandle)
+    {
+        CloseHandle(mMappingHandle);
+        mMappingHandle = nullptr;
+    }
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (mpData)
+    {
+        munmap(const_cast<void *>(mpData), mSize);
+    }
+    if (mFileDescriptor >= 0)
+    {
+        close(mFileDescriptor);
+        mFileDescriptor = -1;
+    }
+#endif
+    mpData = nullptr;
+    mSize = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool MappedFile::IsOpen() const
+{
+    return mpData != nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const void * MappedFile::GetData() const
+{
+    return mpData;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+size_t MappedFile::GetSize() const
+{
+    return mSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+
+// Read-only memory mapping of a whole file. The view stays valid until Close() or destruction.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    bool Open(const std::string & path);
+    void Close();
+
+    bool IsOpen() const;
+    const void * GetData() const;
+    size_t GetSize() const;
+
+private:
+    const void * mpData;
+    size_t mSize;
+#ifdef _WIN32
+    void * mFileHandle;
+    void * mMappingHandle;
+#else
+    int mFileDescriptor;
+#endif
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
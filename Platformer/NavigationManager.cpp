@@ -0,0 +1,316 @@
+#include "AstroidsPrivate.h"
+#include "NavigationManager.h"
+#include "LevelManager.h"
+#include "PlayerManager.h"
+#include <climits>
+#include <cmath>
+
+namespace
+{
+    const uint16_t skUnreached = 0xFFFF;
+    const uint8_t skNoDirection = 0xFF;
+
+    // Steps from the goal before the search stops. Enemies farther out than this steer straight at the player.
+    const int skFieldRadius = 96;
+
+    // How far around the player's tile to look for an AI walkable goal
+    const int skGoalSearchRadius = 5;
+
+    // Orthogonal directions first so ties prefer them; diagonals follow in the same order as their two sides
+    const sf::Vector2i skDirections[] =
+    {
+        { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 },
+        { 1, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }
+    };
+    const int skOrthogonalCount = 4;
+    const int skDirectionCount = 8;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NavigationManager::NavigationManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mCost()
+    , mDirection()
+    , mTouchedCells()
+    , mTargetTile(INT_MIN, INT_MIN)
+    , mGoalTile()
+    , mHasGoal(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NavigationManager::~NavigationManager()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NavigationManager::Update(float deltaTime)
+{
+    auto & gameManager = GetGameManager();
+    auto * pLevelManager = gameManager.GetManager<LevelManager>();
+    auto * pPlayerManager = gameManager.GetManager<PlayerManager>();
+    if (!pLevelManager || !pPlayerManager || pPlayerManager->GetPlayers().empty())
+    {
+        return;
+    }
+
+    GameObject * pPlayer = gameManager.GetGameObject(pPlayerManager->GetPlayers()[0]);
+    if (!pPlayer)
+    {
+        return;
+    }
+
+    // A new level invalidates everything, including the touched list
+    if (mCost.GetWidth() != pLevelManager->GetWidth() || mCost.GetHeight() != pLevelManager->GetHeight())
+    {
+        mCost.Resize(pLevelManager->GetWidth(), pLevelManager->GetHeight(), skUnreached);
+        mDirection.Resize(pLevelManager->GetWidth(), pLevelManager->GetHeight(), skNoDirection);
+        mTouchedCells.clear();
+        mTargetTile = sf::Vector2i(INT_MIN, INT_MIN);
+        mHasGoal = false;
+    }
+
+    sf::Vector2i targetTile = WorldToTile(pPlayer->GetPosition());
+    if (targetTile == mTargetTile)
+    {
+        return;
+    }
+    mTargetTile = targetTile;
+
+    sf::Vector2i goalTile;
+    if (!FindGoalTile(targetTile, goalTile))
+    {
+        ResetTouchedCells();
+        mHasGoal = false;
+        return;
+    }
+
+    if (!mHasGoal || goalTile != mGoalTile)
+    {
+        RebuildField(goalTile);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NavigationManager::OnGameEnd()
+{
+    ResetTouchedCells();
+    mHasGoal = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NavigationManager::GetFlowDirection(const sf::Vector2f & position, sf::Vector2f & outDirection) const
+{
+    sf::Vector2i tile = WorldToTile(position);
+    uint8_t direction = mDirection.Get(tile.x, tile.y, skNoDirection);
+    if (direction == skNoDirection)
+    {
+        return false;
+    }
+
+    float cellSize = BD::gsPixelCountCellSize;
+    sf::Vector2i nextTile = tile + skDirections[direction];
+    sf::Vector2f toNext(
+        (nextTile.x + 0.5f) * cellSize - position.x,
+        (nextTile.y + 0.5f) * cellSize - position.y);
+
+    float length = std::sqrt(toNext.x * toNext.x + toNext.y * toNext.y);
+    if (length < 0.01f)
+    {
+        return false;
+    }
+    outDirection = toNext / length;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int NavigationManager::GetDistanceToGoal(int x, int y) const
+{
+    uint16_t cost = mCost.Get(x, y, skUnreached);
+    return cost == skUnreached ? -1 : int(cost);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NavigationManager::HasGoal() const
+{
+    return mHasGoal;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+sf::Vector2i NavigationManager::GetGoalTile() const
+{
+    return mGoalTile;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int NavigationManager::GetReachedCellCount() const
+{
+    return int(mTouchedCells.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+sf::Vector2i NavigationManager::WorldToTile(const sf::Vector2f & position)
+{
+    float cellSize = BD::gsPixelCountCellSize;
+    return sf::Vector2i(int(std::floor(position.x / cellSize)), int(std::floor(position.y / cellSize)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NavigationManager::MarkTilesChanged(const sf::IntRect & tiles)
+{
+    sf::IntRect fieldBounds(mGoalTile.x - skFieldRadius, mGoalTile.y - skFieldRadius, 2 * skFieldRadius + 1, 2 * skFieldRadius + 1);
+    if (!mHasGoal || fieldBounds.intersects(tiles))
+    {
+        ResetTouchedCells();
+        mTargetTile = sf::Vector2i(INT_MIN, INT_MIN);
+        mHasGoal = false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NavigationManager::FindGoalTile(const sf::Vector2i & targetTile, sf::Vector2i & outGoal) const
+{
+    const BitGridView & walkable = GetGameManager().GetManager<LevelManager>()->GetLayer(LevelFormat::WalkableAI);
+    if (walkable.Test(targetTile.x, targetTile.y))
+    {
+        outGoal = targetTile;
+        return true;
+    }
+
+    int closestDistance = INT_MAX;
+    for (int dy = -skGoalSearchRadius; dy <= skGoalSearchRadius; ++dy)
+    {
+        for (int dx = -skGoalSearchRadius; dx <= skGoalSearchRadius; ++dx)
+        {
+            int distance = std::abs(dx) + std::abs(dy);
+            if (distance < closestDistance && walkable.Test(targetTile.x + dx, targetTile.y + dy))
+            {
+                closestDistance = distance;
+                outGoal = sf::Vector2i(targetTile.x + dx, targetTile.y + dy);
+            }
+        }
+    }
+    return closestDistance != INT_MAX;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NavigationManager::RebuildField(const sf::Vector2i & goalTile)
+{
+    ResetTouchedCells();
+
+    const BitGridView & walkable = GetGameManager().GetManager<LevelManager>()->GetLayer(LevelFormat::WalkableAI);
+    int width = mCost.GetWidth();
+    uint16_t * pCost = mCost.GetData();
+
+    mGoalTile = goalTile;
+    mHasGoal = true;
+
+    int goalCell = mCost.GetIndex(goalTile.x, goalTile.y);
+    pCost[goalCell] = 0;
+    mTouchedCells.push_back(goalCell);
+
+    // Every step costs the same, so a plain FIFO gives Dijkstra's order. The touched list is the queue.
+    for (size_t head = 0; head < mTouchedCells.size(); ++head)
+    {
+        int cell = mTouchedCells[head];
+        uint16_t nextCost = uint16_t(pCost[cell] + 1);
+        if (nextCost > skFieldRadius)
+        {
+            continue;
+        }
+
+        int x = cell % width;
+        int y = cell / width;
+        for (int dir = 0; dir < skOrthogonalCount; ++dir)
+        {
+            int nx = x + skDirections[dir].x;
+            int ny = y + skDirections[dir].y;
+            if (!walkable.Test(nx, ny))
+            {
+                continue;
+            }
+
+            int neighbor = ny * width + nx;
+            if (pCost[neighbor] == skUnreached)
+            {
+                pCost[neighbor] = nextCost;
+                mTouchedCells.push_back(neighbor);
+            }
+        }
+    }
+
+    BuildDirections();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NavigationManager::BuildDirections()
+{
+    const BitGridView & walkable = GetGameManager().GetManager<LevelManager>()->GetLayer(LevelFormat::WalkableAI);
+    int width = mCost.GetWidth();
+    const uint16_t * pCost = mCost.GetData();
+    uint8_t * pDirection = mDirection.GetData();
+
+    // Point each cell at its cheapest neighbor. Diagonals are allowed when both sides are open so enemies cut across
+    // open floor instead of walking staircases, but never through a wall corner.
+    for (int cell : mTouchedCells)
+    {
+        int x = cell % width;
+        int y = cell / width;
+        uint16_t bestCost = pCost[cell];
+        uint8_t bestDirection = skNoDirection;
+
+        for (int dir = 0; dir < skDirectionCount; ++dir)
+        {
+            int nx = x + skDirections[dir].x;
+            int ny = y + skDirections[dir].y;
+            if (!walkable.Test(nx, ny))
+            {
+                continue;
+            }
+            if (dir >= skOrthogonalCount && (!walkable.Test(nx, y) || !walkable.Test(x, ny)))
+            {
+                continue;
+            }
+
+            uint16_t cost = pCost[ny * width + nx];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestDirection = uint8_t(dir);
+            }
+        }
+        pDirection[cell] = bestDirection;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NavigationManager::ResetTouchedCells()
+{
+    uint16_t * pCost = mCost.GetData();
+    uint8_t * pDirection = mDirection.GetData();
+    for (int cell : mTouchedCells)
+    {
+        pCost[cell] = skUnreached;
+        pDirection[cell] = skNoDirection;
+    }
+    mTouchedCells.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include "BaseManager.h"
+#include "Grid2D.h"
+
+// Shared flow field toward the player. One breadth first search from the player's tile fills an integration field of
+// step counts over the AI walkable layer, and every reached cell stores which neighbor leads downhill. Enemies then
+// read their next step in constant time instead of running a search each. The field only reaches skFieldRadius steps
+// from the goal and is rebuilt when the goal tile changes, resetting just the cells the previous build touched.
+class NavigationManager : public BaseManager
+{
+public:
+    NavigationManager(GameManager * pGameManager);
+    ~NavigationManager();
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    // Unit vector from position toward the center of the next tile downhill. False when position is outside the
+    // field or already on the goal tile, callers then steer straight at the goal themselves.
+    bool GetFlowDirection(const sf::Vector2f & position, sf::Vector2f & outDirection) const;
+
+    // Steps to the goal, -1 outside the field
+    int GetDistanceToGoal(int x, int y) const;
+    bool HasGoal() const;
+    sf::Vector2i GetGoalTile() const;
+    int GetReachedCellCount() const;
+
+    static sf::Vector2i WorldToTile(const sf::Vector2f & position);
+
+    // Walkability changed inside these tiles, the field is rebuilt next Update if it reaches them
+    void MarkTilesChanged(const sf::IntRect & tiles);
+
+private:
+    bool FindGoalTile(const sf::Vector2i & targetTile, sf::Vector2i & outGoal) const;
+    void RebuildField(const sf::Vector2i & goalTile);
+    void BuildDirections();
+    void ResetTouchedCells();
+
+    Grid2D<uint16_t> mCost;
+    Grid2D<uint8_t> mDirection;
+
+    // Cells reached by the last build, in BFS order. Doubles as the BFS queue.
+    std::vector<int> mTouchedCells;
+
+    sf::Vector2i mTargetTile;
+    sf::Vector2i mGoalTile;
+    bool mHasGoal;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
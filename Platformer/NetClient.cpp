@@ -0,0 +1,469 @@
+#include "AstroidsPrivate.h"
+#include "NetClient.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace NetProtocol;
+
+namespace
+{
+    const float skHelloInterval = 0.5f;
+    const float skDefaultInterpolationDelay = 0.1f;
+    const size_t skMaxPendingInputs = 128;
+    const uint32_t skMaxRemovals = 1024;
+
+    // Past this the estimate jumps instead of easing, after a stall or when first connecting
+    const float skServerTimeSnap = 0.5f;
+    const float skServerTimeEase = 0.1f;
+
+    bool IsLessById(const EntityState & state, uint32_t id)
+    {
+        return state.mId < id;
+    }
+
+    float LerpDegrees(float from, float to, float t)
+    {
+        float delta = std::fmod(to - from + 540.f, 360.f) - 180.f;
+        return from + delta * t;
+    }
+}
+
+NetClient::NetClient(NetTransport & transport)
+    : mTransport(transport)
+    , mServer()
+    , mViewWidth(0)
+    , mViewHeight(0)
+    , mIsConnecting(false)
+    , mIsConnected(false)
+    , mTimeSinceHello(0.f)
+    , mTimeSinceHeard(0.f)
+    , mTime(0.f)
+    , mServerTime(0.f)
+    , mInterpolationDelay(skDefaultInterpolationDelay)
+    , mIsServerTimeSynced(false)
+    , mPlayerId(0)
+    , mScore(0)
+    , mLastProcessedInput(0)
+    , mHasNewPlayerState(false)
+    , mPlayerState()
+    , mNextSequence(1)
+    , mNewestSentSequence(0)
+    , mPendingInputs()
+    , mInputSendTimes()
+    , mSnapshots()
+    , mPacket()
+    , mReceived()
+    , mRemoved()
+    , mStats()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::Connect(const NetAddress & server, uint16_t viewWidth, uint16_t viewHeight)
+{
+    Disconnect();
+
+    mServer = server;
+    mViewWidth = viewWidth;
+    mViewHeight = viewHeight;
+    mIsConnecting = true;
+    mTimeSinceHeard = 0.f;
+    SendHello();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::Disconnect()
+{
+    if (mIsConnected)
+    {
+        NetWriter writer(mPacket);
+        WriteHeader(writer, NetProtocol::Disconnect);
+        mTransport.Send(mServer, mPacket.data(), mPacket.size());
+    }
+
+    mIsConnecting = false;
+    mIsConnected = false;
+    mIsServerTimeSynced = false;
+    mPlayerId = 0;
+    mScore = 0;
+    mLastProcessedInput = 0;
+    mHasNewPlayerState = false;
+    mNextSequence = 1;
+    mNewestSentSequence = 0;
+    mPendingInputs.clear();
+    mSnapshots.clear();
+    mStats = NetClientStats();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::Update(float deltaTime)
+{
+    mTime += deltaTime;
+    mServerTime += deltaTime;
+
+    if (!mIsConnecting && !mIsConnected)
+    {
+        return;
+    }
+
+    mTimeSinceHeard += deltaTime;
+    if (mIsConnecting)
+    {
+        mTimeSinceHello += deltaTime;
+        if (mTimeSinceHello >= skHelloInterval)
+        {
+            SendHello();
+        }
+    }
+
+    NetAddress from;
+    while (mTransport.Receive(mReceived, from))
+    {
+        NetReader reader(mReceived.data(), mReceived.size());
+        EMessage message;
+        if (from != mServer || !ReadHeader(reader, message))
+        {
+            continue;
+        }
+
+        mTimeSinceHeard = 0.f;
+        switch (message)
+        {
+            case Welcome:
+            {
+                ReadWelcome(reader);
+                break;
+            }
+            case Snapshot:
+            {
+                if (mIsConnected)
+                {
+                    ReadSnapshot(reader, mReceived.size());
+                }
+                break;
+            }
+            case NetProtocol::Disconnect:
+            {
+                mIsConnected = false;
+                Disconnect();
+                return;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    if (mTimeSinceHeard > skTimeoutSeconds)
+    {
+        Disconnect();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const InputCommand & NetClient::AddInput(const PlayerInput & input, float deltaTime)
+{
+    InputCommand command = MakeInputCommand(input, deltaTime);
+    command.mSequence = mNextSequence++;
+    mPendingInputs.push_back(command);
+
+    // Nothing has been acked for a long while, the oldest are past saving
+    while (mPendingInputs.size() > skMaxPendingInputs)
+    {
+        mPendingInputs.pop_front();
+    }
+    return mPendingInputs.back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::SendInputs()
+{
+    if (!mIsConnected)
+    {
+        return;
+    }
+
+    // The newest commands, so a long stall leaves gaps on the server rather than holding it back
+    size_t count = std::min(mPendingInputs.size(), size_t(skMaxInputsPerPacket));
+    size_t first = mPendingInputs.size() - count;
+
+    NetWriter writer(mPacket);
+    WriteHeader(writer, Input);
+    writer.WriteVarint(GetNewestTick());
+    writer.WriteVarint(count > 0 ? mPendingInputs[first].mSequence : mNextSequence);
+    writer.WriteU8(uint8_t(count));
+    for (size_t i = first; i < mPendingInputs.size(); ++i)
+    {
+        const InputCommand & command = mPendingInputs[i];
+        WriteInputCommand(writer, command);
+        if (command.mSequence > mNewestSentSequence)
+        {
+            mNewestSentSequence = command.mSequence;
+            mInputSendTimes[command.mSequence % 64] = mTime;
+        }
+    }
+
+    mTransport.Send(mServer, mPacket.data(), mPacket.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NetClient::TakePlayerState(EntityState & outState)
+{
+    if (!mHasNewPlayerState)
+    {
+        return false;
+    }
+
+    outState = mPlayerState;
+    mHasNewPlayerState = false;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::SampleEntities(std::vector<NetInterpolatedEntity> & outEntities) const
+{
+    outEntities.clear();
+    if (mSnapshots.empty())
+    {
+        return;
+    }
+
+    // The newest snapshot at or before the render time, and the one after it
+    float renderTick = (mServerTime - mInterpolationDelay) / skTickSeconds;
+    size_t fromIndex = 0;
+    for (size_t i = 0; i < mSnapshots.size(); ++i)
+    {
+        if (float(mSnapshots[i].mTick) <= renderTick)
+        {
+            fromIndex = i;
+        }
+    }
+
+    const ReceivedSnapshot & from = mSnapshots[fromIndex];
+    const ReceivedSnapshot * pTo = fromIndex + 1 < mSnapshots.size() ? &mSnapshots[fromIndex + 1] : nullptr;
+    float t = 0.f;
+    if (pTo)
+    {
+        t = std::min(std::max((renderTick - float(from.mTick)) / float(pTo->mTick - from.mTick), 0.f), 1.f);
+    }
+
+    // Entities that appear in the later snapshot only show up once the render time reaches it
+    size_t toIndex = 0;
+    for (const EntityState & state : from.mEntities)
+    {
+        if (state.mId == mPlayerId)
+        {
+            continue;
+        }
+
+        NetInterpolatedEntity entity;
+        entity.mId = state.mId;
+        entity.mArchetype = state.mArchetype;
+        entity.mVariant = state.mVariant;
+        entity.mPosition = sf::Vector2f(DequantizePosition(state.mX), DequantizePosition(state.mY));
+        entity.mRotation = DequantizeRotation(state.mRotation);
+        entity.mHealth = state.mHealth;
+        entity.mLives = state.mLives;
+
+        if (pTo)
+        {
+            while (toIndex < pTo->mEntities.size() && pTo->mEntities[toIndex].mId < state.mId)
+            {
+                ++toIndex;
+            }
+            if (toIndex < pTo->mEntities.size() && pTo->mEntities[toIndex].mId == state.mId)
+            {
+                const EntityState & next = pTo->mEntities[toIndex];
+                sf::Vector2f nextPosition(DequantizePosition(next.mX), DequantizePosition(next.mY));
+                entity.mPosition += (nextPosition - entity.mPosition) * t;
+                entity.mRotation = LerpDegrees(entity.mRotation, DequantizeRotation(next.mRotation), t);
+            }
+        }
+
+        outEntities.push_back(entity);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NetClientStats NetClient::GetStats() const
+{
+    NetClientStats stats = mStats;
+    stats.mInterpolationDelayMilliseconds = mInterpolationDelay * 1000.f;
+    stats.mPendingInputs = mPendingInputs.size();
+    stats.mBufferedSnapshots = mSnapshots.size();
+    return stats;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::ReadWelcome(NetReader & reader)
+{
+    reader.ReadU8();
+    uint32_t tick = reader.ReadVarint();
+    if (!reader.IsOk() || mIsConnected)
+    {
+        return;
+    }
+
+    mIsConnecting = false;
+    mIsConnected = true;
+    mServerTime = float(tick) * skTickSeconds;
+    mIsServerTimeSynced = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::ReadSnapshot(NetReader & reader, size_t size)
+{
+    uint32_t tick = reader.ReadVarint();
+    uint32_t baselineTick = reader.ReadVarint();
+    uint32_t lastProcessedInput = reader.ReadVarint();
+    uint32_t playerId = reader.ReadVarint();
+    int32_t score = reader.ReadSigned();
+    if (!reader.IsOk())
+    {
+        return;
+    }
+
+    // Older than what is held, and the newer one already covers everything it could say
+    if (!mSnapshots.empty() && tick <= mSnapshots.back().mTick)
+    {
+        ++mStats.mSnapshotsDropped;
+        return;
+    }
+
+    const ReceivedSnapshot * pBaseline = nullptr;
+    if (baselineTick != 0)
+    {
+        pBaseline = FindSnapshot(baselineTick);
+        if (!pBaseline)
+        {
+            ++mStats.mSnapshotsDropped;
+            return;
+        }
+    }
+
+    ReceivedSnapshot snapshot;
+    snapshot.mTick = tick;
+    if (pBaseline)
+    {
+        snapshot.mEntities = pBaseline->mEntities;
+    }
+
+    uint32_t removalCount = std::min(reader.ReadVarint(), skMaxRemovals);
+    mRemoved.clear();
+    for (uint32_t i = 0; i < removalCount; ++i)
+    {
+        mRemoved.push_back(reader.ReadVarint());
+    }
+    std::sort(mRemoved.begin(), mRemoved.end());
+    auto removeStart = std::remove_if(snapshot.mEntities.begin(), snapshot.mEntities.end(),
+        [this](const EntityState & state) { return std::binary_search(mRemoved.begin(), mRemoved.end(), state.mId); });
+    snapshot.mEntities.erase(removeStart, snapshot.mEntities.end());
+
+    while (reader.IsOk())
+    {
+        uint32_t id = reader.ReadVarint();
+        if (id == 0)
+        {
+            break;
+        }
+
+        auto it = std::lower_bound(snapshot.mEntities.begin(), snapshot.mEntities.end(), id, IsLessById);
+        if (it == snapshot.mEntities.end() || it->mId != id)
+        {
+            EntityState state;
+            state.mId = id;
+            it = snapshot.mEntities.insert(it, state);
+        }
+        ReadEntityDelta(reader, *it);
+    }
+
+    if (!reader.IsOk())
+    {
+        ++mStats.mSnapshotsDropped;
+        return;
+    }
+
+    // Round trip from when the newest processed command was first sent
+    if (lastProcessedInput > mLastProcessedInput && lastProcessedInput <= mNewestSentSequence && mNewestSentSequence - lastProcessedInput < 64)
+    {
+        float sample = (mTime - mInputSendTimes[lastProcessedInput % 64]) * 1000.f;
+        mStats.mRoundTripMilliseconds += (sample - mStats.mRoundTripMilliseconds) * (mStats.mRoundTripMilliseconds == 0.f ? 1.f : 0.1f);
+    }
+    mLastProcessedInput = std::max(mLastProcessedInput, lastProcessedInput);
+    while (!mPendingInputs.empty() && mPendingInputs.front().mSequence <= mLastProcessedInput)
+    {
+        mPendingInputs.pop_front();
+    }
+
+    mPlayerId = playerId;
+    mScore = score;
+    auto playerIt = std::lower_bound(snapshot.mEntities.begin(), snapshot.mEntities.end(), playerId, IsLessById);
+    if (playerId != 0 && playerIt != snapshot.mEntities.end() && playerIt->mId == playerId)
+    {
+        mPlayerState = *playerIt;
+        mHasNewPlayerState = true;
+    }
+
+    float snapshotTime = float(tick) * skTickSeconds;
+    if (!mIsServerTimeSynced || std::abs(snapshotTime - mServerTime) > skServerTimeSnap)
+    {
+        mServerTime = snapshotTime;
+        mIsServerTimeSynced = true;
+    }
+    else
+    {
+        mServerTime += (snapshotTime - mServerTime) * skServerTimeEase;
+    }
+
+    mSnapshots.push_back(std::move(snapshot));
+    while (mSnapshots.size() > size_t(skSnapshotHistory))
+    {
+        mSnapshots.pop_front();
+    }
+
+    ++mStats.mSnapshotsReceived;
+    mStats.mLastSnapshotBytes = size;
+    mStats.mBytesPerSecond += (float(size * skTickRate) - mStats.mBytesPerSecond) * 0.1f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetClient::SendHello()
+{
+    mTimeSinceHello = 0.f;
+
+    NetWriter writer(mPacket);
+    WriteHeader(writer, Hello);
+    writer.WriteU16(mViewWidth);
+    writer.WriteU16(mViewHeight);
+    mTransport.Send(mServer, mPacket.data(), mPacket.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const NetClient::ReceivedSnapshot * NetClient::FindSnapshot(uint32_t tick) const
+{
+    for (auto it = mSnapshots.rbegin(); it != mSnapshots.rend(); ++it)
+    {
+        if (it->mTick == tick)
+        {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "NetProtocol.h"
+#include "NetTransport.h"
+
+struct NetInterpolatedEntity
+{
+    uint32_t mId;
+    uint8_t mArchetype;
+    uint8_t mVariant;
+    sf::Vector2f mPosition;
+    float mRotation;
+    int mHealth;
+    int mLives;
+};
+
+struct NetClientStats
+{
+    float mRoundTripMilliseconds = 0.f;
+    float mInterpolationDelayMilliseconds = 0.f;
+    uint32_t mSnapshotsReceived = 0;
+    uint32_t mSnapshotsDropped = 0;     // Out of order, or their baseline was no longer held
+    size_t mLastSnapshotBytes = 0;
+    float mBytesPerSecond = 0.f;
+    size_t mPendingInputs = 0;
+    size_t mBufferedSnapshots = 0;
+};
+
+// Client side of the co-op protocol in NetProtocol.h. Keeps the snapshots it has decoded both as baselines for the
+// deltas still to come and as the buffer other entities are drawn from, a fixed delay behind the estimated server
+// time so there is nearly always a snapshot on either side to blend between. Input commands stay pending until a
+// snapshot says the server has stepped them; the NetworkManager replays the pending ones on top of the authoritative
+// player state to predict the local player.
+class NetClient
+{
+public:
+    NetClient(NetTransport & transport);
+
+    void Connect(const NetAddress & server, uint16_t viewWidth, uint16_t viewHeight);
+    void Disconnect();
+
+    bool IsConnecting() const { return mIsConnecting; }
+    bool IsConnected() const { return mIsConnected; }
+
+    // Reads everything waiting and advances the estimated server time
+    void Update(float deltaTime);
+
+    // Queues this frame's command, returns it with its sequence
+    const NetProtocol::InputCommand & AddInput(const PlayerInput & input, float deltaTime);
+
+    // Sends the unacked commands and the newest snapshot tick as the ack
+    void SendInputs();
+
+    const std::deque<NetProtocol::InputCommand> & GetPendingInputs() const { return mPendingInputs; }
+
+    // The player's state in the newest snapshot, only once per snapshot; the pending inputs come after it
+    bool TakePlayerState(NetProtocol::EntityState & outState);
+
+    uint32_t GetPlayerId() const { return mPlayerId; }
+    int32_t GetScore() const { return mScore; }
+    uint32_t GetNewestTick() const { return mSnapshots.empty() ? 0 : mSnapshots.back().mTick; }
+
+    // Every entity but the local player, as it was the interpolation delay ago
+    void SampleEntities(std::vector<NetInterpolatedEntity> & outEntities) const;
+
+    void SetInterpolationDelay(float seconds) { mInterpolationDelay = seconds; }
+    NetClientStats GetStats() const;
+
+private:
+    struct ReceivedSnapshot
+    {
+        uint32_t mTick;
+        std::vector<NetProtocol::EntityState> mEntities;   // Sorted by id
+    };
+
+    void ReadWelcome(NetProtocol::NetReader & reader);
+    void ReadSnapshot(NetProtocol::NetReader & reader, size_t size);
+    void SendHello();
+    const ReceivedSnapshot * FindSnapshot(uint32_t tick) const;
+
+    NetTransport & mTransport;
+    NetAddress mServer;
+    uint16_t mViewWidth;
+    uint16_t mViewHeight;
+    bool mIsConnecting;
+    bool mIsConnected;
+    float mTimeSinceHello;
+    float mTimeSinceHeard;
+    float mTime;
+
+    // Estimated server time, in seconds of ticks, as of the newest snapshot's arrival
+    float mServerTime;
+    float mInterpolationDelay;
+    bool mIsServerTimeSynced;
+
+    uint32_t mPlayerId;
+    int32_t mScore;
+    uint32_t mLastProcessedInput;
+    bool mHasNewPlayerState;
+    NetProtocol::EntityState mPlayerState;
+
+    uint32_t mNextSequence;
+    uint32_t mNewestSentSequence;
+    std::deque<NetProtocol::InputCommand> mPendingInputs;
+    float mInputSendTimes[64];                              // By sequence % 64, for the round trip time
+
+    std::deque<ReceivedSnapshot> mSnapshots;
+    std::vector<uint8_t> mPacket;
+    std::vector<uint8_t> mReceived;
+    std::vector<uint32_t> mRemoved;
+
+    NetClientStats mStats;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,54 @@
+#include "AstroidsPrivate.h"
+#include "NetInputComponent.h"
+#include "BDConfig.h"
+#include "imgui.h"
+
+NetInputComponent::NetInputComponent(GameObject * pOwner, GameManager & gameManager)
+    : GameComponent(pOwner, gameManager)
+    , mInput()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetInputComponent::SetInput(const PlayerInput & input)
+{
+    mInput = input;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+const PlayerInput & NetInputComponent::GetInput() const
+{
+    return mInput;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetInputComponent::Update(float deltaTime)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetInputComponent::DebugImGuiComponentInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Text("Move: %.0f, %.0f", mInput.mMove.x, mInput.mMove.y);
+    ImGui::Text("Aim: %.1f, %.1f", mInput.mAim.x, mInput.mAim.y);
+    ImGui::Text("Firing: %s", mInput.mIsFiring ? "yes" : "no");
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD_REGISTER_COMPONENT(NetInputComponent)
+
+void NetInputComponent::DescribeType(ComponentTypeInfo & /*typeInfo*/)
+{
+    // PlayerInput is shown by DebugImGuiComponentInfo, it is not a field type the registry knows
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,27 @@
+#pragma once
+#include "GameComponent.h"
+#include "PlayerInput.h"
+
+// Marks a player as driven by input commands instead of the local devices. Its ControlledMovementComponent no longer
+// moves on its own; the NetworkManager steps it once per command, on the server for remote players and on a client to
+// predict the local one. The ProjectileComponent fires from the newest command's input.
+class NetInputComponent : public GameComponent
+{
+    BD_COMPONENT(NetInputComponent)
+
+public:
+    NetInputComponent(GameObject * pOwner, GameManager & gameManager);
+
+    void SetInput(const PlayerInput & input);
+    const PlayerInput & GetInput() const;
+
+    virtual void Update(float deltaTime) override;
+    virtual void DebugImGuiComponentInfo() override;
+
+private:
+    PlayerInput mInput;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
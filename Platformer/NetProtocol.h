@@ -0,0 +1,419 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "PlayerInput.h"
+
+//------------------------------------------------------------------------------------------------------------------------
+// Co-op network protocol
+//
+// Spoken by NetServer and NetClient over any NetTransport. Every packet fits one UDP datagram and starts with
+// skProtocolId and an EMessage byte. Integers are written as varints, signed ones zigzagged first, so the small numbers
+// that make up most of a delta cost a byte.
+//
+//   Hello          client -> server    view width, view height
+//   Welcome        server -> client    client id, server tick
+//   Input          client -> server    acked snapshot tick, first sequence, count, InputCommand[count]
+//                                      The last unacked commands go out every time, so a lost packet costs nothing.
+//   Snapshot       server -> client    tick, baseline tick (0 for none), last processed input, player id, score,
+//                                      removed ids, then for each changed entity its id, an EField mask and the
+//                                      masked fields, ending with id 0. Positions are deltas from the baseline's.
+//   Disconnect     either way
+//
+// Entities are quantized to EntityState before they are compared or sent, so the server's copy of what a client knows
+// matches the client's bit for bit and deltas never drift.
+//------------------------------------------------------------------------------------------------------------------------
+
+namespace NetProtocol
+{
+    const uint32_t skProtocolId = 0x314E4442; // "BDN1"
+    const int skTickRate = 30;
+    const float skTickSeconds = 1.f / float(skTickRate);
+    const size_t skMaxPacketSize = 1200;
+    const int skMaxInputsPerPacket = 16;
+    const int skSnapshotHistory = 32;       // Ticks a baseline stays usable
+    const float skTimeoutSeconds = 5.f;
+
+    const float skPositionScale = 8.f;      // 1/8 pixel
+    const float skVelocityScale = 4.f;      // 1/4 pixel per second
+    const float skAimScale = 1.f;
+
+    enum EMessage : uint8_t
+    {
+        Hello,
+        Welcome,
+        Input,
+        Snapshot,
+        Disconnect
+    };
+
+    enum EField : uint8_t
+    {
+        FieldType       = 1 << 0,
+        FieldPosition   = 1 << 1,
+        FieldRotation   = 1 << 2,
+        FieldVelocity   = 1 << 3,
+        FieldHealth     = 1 << 4,
+        FieldLives      = 1 << 5,
+        FieldAll        = 0x3F
+    };
+
+    struct InputCommand
+    {
+        uint32_t mSequence = 0;
+        int8_t mMoveX = 0;          // -1, 0 or 1
+        int8_t mMoveY = 0;
+        bool mIsFiring = false;
+        int32_t mAimX = 0;          // World pixels * skAimScale
+        int32_t mAimY = 0;
+        uint8_t mMilliseconds = 0;  // Frame time the command covers
+    };
+
+    struct EntityState
+    {
+        uint32_t mId = 0;
+        uint8_t mArchetype = 0;     // SnapshotFormat::EArchetype
+        uint8_t mVariant = 0;
+        int32_t mX = 0;             // Pixels * skPositionScale
+        int32_t mY = 0;
+        uint16_t mRotation = 0;     // Full turn is 65536
+        int16_t mVelocityX = 0;     // Pixels per second * skVelocityScale
+        int16_t mVelocityY = 0;
+        int16_t mHealth = 0;
+        uint8_t mLives = 0;
+    };
+
+    inline int32_t QuantizePosition(float value)
+    {
+        return int32_t(std::lround(value * skPositionScale));
+    }
+
+    inline float DequantizePosition(int32_t value)
+    {
+        return float(value) / skPositionScale;
+    }
+
+    inline int16_t QuantizeVelocity(float value)
+    {
+        float scaled = std::round(value * skVelocityScale);
+        return int16_t(scaled < -32768.f ? -32768.f : (scaled > 32767.f ? 32767.f : scaled));
+    }
+
+    inline float DequantizeVelocity(int16_t value)
+    {
+        return float(value) / skVelocityScale;
+    }
+
+    inline uint16_t QuantizeRotation(float degrees)
+    {
+        float turns = degrees / 360.f;
+        turns -= std::floor(turns);
+        return uint16_t(uint32_t(std::lround(turns * 65536.f)) & 0xFFFF);
+    }
+
+    inline float DequantizeRotation(uint16_t value)
+    {
+        return float(value) * (360.f / 65536.f);
+    }
+
+    inline uint8_t GetChangedFields(const EntityState & baseline, const EntityState & state)
+    {
+        uint8_t mask = 0;
+        if (baseline.mArchetype != state.mArchetype || baseline.mVariant != state.mVariant) mask |= FieldType;
+        if (baseline.mX != state.mX || baseline.mY != state.mY) mask |= FieldPosition;
+        if (baseline.mRotation != state.mRotation) mask |= FieldRotation;
+        if (baseline.mVelocityX != state.mVelocityX || baseline.mVelocityY != state.mVelocityY) mask |= FieldVelocity;
+        if (baseline.mHealth != state.mHealth) mask |= FieldHealth;
+        if (baseline.mLives != state.mLives) mask |= FieldLives;
+        return mask;
+    }
+
+    inline uint32_t ZigZag(int32_t value)
+    {
+        return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+    }
+
+    inline int32_t UnZigZag(uint32_t value)
+    {
+        return int32_t(value >> 1) ^ -int32_t(value & 1);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    class NetWriter
+    {
+    public:
+        NetWriter(std::vector<uint8_t> & buffer)
+            : mBuffer(buffer)
+        {
+            mBuffer.clear();
+        }
+
+        void WriteU8(uint8_t value)
+        {
+            mBuffer.push_back(value);
+        }
+
+        void WriteU16(uint16_t value)
+        {
+            mBuffer.push_back(uint8_t(value));
+            mBuffer.push_back(uint8_t(value >> 8));
+        }
+
+        void WriteU32(uint32_t value)
+        {
+            WriteU16(uint16_t(value));
+            WriteU16(uint16_t(value >> 16));
+        }
+
+        void WriteVarint(uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                mBuffer.push_back(uint8_t(value | 0x80));
+                value >>= 7;
+            }
+            mBuffer.push_back(uint8_t(value));
+        }
+
+        void WriteSigned(int32_t value)
+        {
+            WriteVarint(ZigZag(value));
+        }
+
+        void WriteFloat(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            WriteU32(bits);
+        }
+
+        size_t GetSize() const
+        {
+            return mBuffer.size();
+        }
+
+        // Drops everything written after size, used to back out an entity that did not fit
+        void Truncate(size_t size)
+        {
+            mBuffer.resize(size);
+        }
+
+    private:
+        std::vector<uint8_t> & mBuffer;
+    };
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // Reads past the end return zeros and clear IsOk, so a packet is checked once after it has been parsed
+    class NetReader
+    {
+    public:
+        NetReader(const uint8_t * pData, size_t size)
+            : mpData(pData)
+            , mSize(size)
+            , mPosition(0)
+            , mIsOk(true)
+        {
+        }
+
+        uint8_t ReadU8()
+        {
+            if (mPosition >= mSize)
+            {
+                mIsOk = false;
+                return 0;
+            }
+            return mpData[mPosition++];
+        }
+
+        uint16_t ReadU16()
+        {
+            uint16_t low = ReadU8();
+            return uint16_t(low | (uint16_t(ReadU8()) << 8));
+        }
+
+        uint32_t ReadU32()
+        {
+            uint32_t low = ReadU16();
+            return low | (uint32_t(ReadU16()) << 16);
+        }
+
+        uint32_t ReadVarint()
+        {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7)
+            {
+                uint8_t byte = ReadU8();
+                value |= uint32_t(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            mIsOk = false;
+            return 0;
+        }
+
+        int32_t ReadSigned()
+        {
+            return UnZigZag(ReadVarint());
+        }
+
+        float ReadFloat()
+        {
+            uint32_t bits = ReadU32();
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        bool IsOk() const
+        {
+            return mIsOk;
+        }
+
+    private:
+        const uint8_t * mpData;
+        size_t mSize;
+        size_t mPosition;
+        bool mIsOk;
+    };
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    inline void WriteHeader(NetWriter & writer, EMessage message)
+    {
+        writer.WriteU32(skProtocolId);
+        writer.WriteU8(message);
+    }
+
+    // Returns false if the packet is not ours
+    inline bool ReadHeader(NetReader & reader, EMessage & outMessage)
+    {
+        uint32_t protocolId = reader.ReadU32();
+        outMessage = EMessage(reader.ReadU8());
+        return reader.IsOk() && protocolId == skProtocolId && outMessage <= Disconnect;
+    }
+
+    inline void WriteInputCommand(NetWriter & writer, const InputCommand & command)
+    {
+        uint8_t bits = uint8_t((command.mMoveX + 1) | ((command.mMoveY + 1) << 2) | (command.mIsFiring ? 0x10 : 0));
+        writer.WriteU8(bits);
+        writer.WriteSigned(command.mAimX);
+        writer.WriteSigned(command.mAimY);
+        writer.WriteU8(command.mMilliseconds);
+    }
+
+    inline void ReadInputCommand(NetReader & reader, InputCommand & outCommand)
+    {
+        uint8_t bits = reader.ReadU8();
+        outCommand.mMoveX = int8_t(int(bits & 0x3) - 1);
+        outCommand.mMoveY = int8_t(int((bits >> 2) & 0x3) - 1);
+        outCommand.mIsFiring = (bits & 0x10) != 0;
+        outCommand.mAimX = reader.ReadSigned();
+        outCommand.mAimY = reader.ReadSigned();
+        outCommand.mMilliseconds = reader.ReadU8();
+    }
+
+    // Commands carry the quantized frame time, and both ends step with that rather than the real one so the client's
+    // prediction replays exactly what the server ran
+    inline InputCommand MakeInputCommand(const PlayerInput & input, float deltaTime)
+    {
+        InputCommand command;
+        command.mMoveX = int8_t(input.mMove.x < 0.f ? -1 : (input.mMove.x > 0.f ? 1 : 0));
+        command.mMoveY = int8_t(input.mMove.y < 0.f ? -1 : (input.mMove.y > 0.f ? 1 : 0));
+        command.mIsFiring = input.mIsFiring;
+        command.mAimX = int32_t(std::lround(input.mAim.x * skAimScale));
+        command.mAimY = int32_t(std::lround(input.mAim.y * skAimScale));
+        long milliseconds = std::lround(deltaTime * 1000.f);
+        command.mMilliseconds = uint8_t(milliseconds < 1 ? 1 : (milliseconds > 255 ? 255 : milliseconds));
+        return command;
+    }
+
+    inline PlayerInput GetPlayerInput(const InputCommand & command)
+    {
+        PlayerInput input;
+        input.mMove = sf::Vector2f(float(command.mMoveX), float(command.mMoveY));
+        input.mAim = sf::Vector2f(float(command.mAimX) / skAimScale, float(command.mAimY) / skAimScale);
+        input.mIsFiring = command.mIsFiring;
+        return input;
+    }
+
+    inline float GetDeltaTime(const InputCommand & command)
+    {
+        return float(command.mMilliseconds) / 1000.f;
+    }
+
+    // Writes the fields in mask, positions as deltas from baseline
+    inline void WriteEntityDelta(NetWriter & writer, const EntityState & baseline, const EntityState & state, uint8_t mask)
+    {
+        writer.WriteVarint(state.mId);
+        writer.WriteU8(mask);
+        if (mask & FieldType)
+        {
+            writer.WriteU8(state.mArchetype);
+            writer.WriteU8(state.mVariant);
+        }
+        if (mask & FieldPosition)
+        {
+            writer.WriteSigned(state.mX - baseline.mX);
+            writer.WriteSigned(state.mY - baseline.mY);
+        }
+        if (mask & FieldRotation)
+        {
+            writer.WriteU16(state.mRotation);
+        }
+        if (mask & FieldVelocity)
+        {
+            writer.WriteSigned(state.mVelocityX);
+            writer.WriteSigned(state.mVelocityY);
+        }
+        if (mask & FieldHealth)
+        {
+            writer.WriteSigned(state.mHealth);
+        }
+        if (mask & FieldLives)
+        {
+            writer.WriteU8(state.mLives);
+        }
+    }
+
+    // inOutState holds the baseline on entry; mId has already been read
+    inline void ReadEntityDelta(NetReader & reader, EntityState & inOutState)
+    {
+        uint8_t mask = reader.ReadU8();
+        if (mask & FieldType)
+        {
+            inOutState.mArchetype = reader.ReadU8();
+            inOutState.mVariant = reader.ReadU8();
+        }
+        if (mask & FieldPosition)
+        {
+            inOutState.mX += reader.ReadSigned();
+            inOutState.mY += reader.ReadSigned();
+        }
+        if (mask & FieldRotation)
+        {
+            inOutState.mRotation = reader.ReadU16();
+        }
+        if (mask & FieldVelocity)
+        {
+            inOutState.mVelocityX = int16_t(reader.ReadSigned());
+            inOutState.mVelocityY = int16_t(reader.ReadSigned());
+        }
+        if (mask & FieldHealth)
+        {
+            inOutState.mHealth = int16_t(reader.ReadSigned());
+        }
+        if (mask & FieldLives)
+        {
+            inOutState.mLives = reader.ReadU8();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
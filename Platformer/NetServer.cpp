@@ -0,0 +1,446 @@
+#include "AstroidsPrivate.h"
+#include "NetServer.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace NetProtocol;
+
+namespace
+{
+    const int skMaxClients = 4;
+    const size_t skMaxQueuedInputs = 64;
+    const int skDefaultBytesPerSecond = 16 * 1024;
+    const size_t skMinPacketBudget = 128;
+
+    // Entities a little outside the view are sent too, so they are already there when they scroll in
+    const float skRelevancyMargin = 256.f;
+
+    const float skOwnPlayerWeight = 100.f;
+}
+
+NetServer::NetServer(NetTransport & transport)
+    : mTransport(transport)
+    , mBytesPerSecond(skDefaultBytesPerSecond)
+    , mNextClientId(1)
+    , mTick(0)
+    , mClients()
+    , mPacket()
+    , mReceived()
+    , mKnown()
+    , mCandidates()
+    , mRemoved()
+{
+    mPacket.reserve(skMaxPacketSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::SetBandwidthBudget(int bytesPerSecond)
+{
+    mBytesPerSecond = std::max(bytesPerSecond, 1024);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::Update(float deltaTime, std::vector<int> & outConnected, std::vector<int> & outDisconnected)
+{
+    for (auto & client : mClients)
+    {
+        client.mTimeSinceHeard += deltaTime;
+    }
+
+    NetAddress from;
+    while (mTransport.Receive(mReceived, from))
+    {
+        NetReader reader(mReceived.data(), mReceived.size());
+        EMessage message;
+        if (!ReadHeader(reader, message))
+        {
+            continue;
+        }
+
+        NetServerClient * pClient = FindClient(from);
+        switch (message)
+        {
+            case Hello:
+            {
+                float viewWidth = float(reader.ReadU16());
+                float viewHeight = float(reader.ReadU16());
+                if (!reader.IsOk())
+                {
+                    break;
+                }
+
+                if (!pClient)
+                {
+                    if (int(mClients.size()) >= skMaxClients)
+                    {
+                        break;
+                    }
+                    NetServerClient client;
+                    client.mId = mNextClientId++;
+                    client.mAddress = from;
+                    client.mHistory.resize(skSnapshotHistory);
+                    mClients.push_back(std::move(client));
+                    pClient = &mClients.back();
+                    outConnected.push_back(pClient->mId);
+                }
+
+                // Hello is repeated until the client hears back, so a lost Welcome is simply sent again
+                pClient->mViewWidth = viewWidth;
+                pClient->mViewHeight = viewHeight;
+                pClient->mTimeSinceHeard = 0.f;
+                SendWelcome(*pClient);
+                break;
+            }
+            case Input:
+            {
+                if (pClient)
+                {
+                    ReadInput(*pClient, reader);
+                }
+                break;
+            }
+            case Disconnect:
+            {
+                if (pClient)
+                {
+                    pClient->mTimeSinceHeard = skTimeoutSeconds + 1.f;
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    auto removeStart = std::remove_if(mClients.begin(), mClients.end(),
+        [&outDisconnected](const NetServerClient & client)
+        {
+            if (client.mTimeSinceHeard > skTimeoutSeconds)
+            {
+                outDisconnected.push_back(client.mId);
+                return true;
+            }
+            return false;
+        });
+    mClients.erase(removeStart, mClients.end());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::SetClientPlayer(int clientId, uint32_t playerId)
+{
+    if (NetServerClient * pClient = FindClient(clientId))
+    {
+        pClient->mPlayerId = playerId;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NetServer::PopInput(int clientId, InputCommand & outCommand)
+{
+    NetServerClient * pClient = FindClient(clientId);
+    if (!pClient || pClient->mInputs.empty())
+    {
+        return false;
+    }
+
+    outCommand = pClient->mInputs.front();
+    pClient->mInputs.pop_front();
+    pClient->mLastProcessedInput = outCommand.mSequence;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::SendSnapshots(uint32_t tick, const std::vector<EntityState> & entities, int32_t score)
+{
+    mTick = tick;
+    for (auto & client : mClients)
+    {
+        SendSnapshot(client, tick, entities, score);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::DisconnectAll()
+{
+    for (auto & client : mClients)
+    {
+        NetWriter writer(mPacket);
+        WriteHeader(writer, Disconnect);
+        mTransport.Send(client.mAddress, mPacket.data(), mPacket.size());
+    }
+    mClients.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NetServerClient * NetServer::FindClient(const NetAddress & address)
+{
+    for (auto & client : mClients)
+    {
+        if (client.mAddress == address)
+        {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NetServerClient * NetServer::FindClient(int clientId)
+{
+    for (auto & client : mClients)
+    {
+        if (client.mId == clientId)
+        {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::ReadInput(NetServerClient & client, NetReader & reader)
+{
+    uint32_t ackedTick = reader.ReadVarint();
+    uint32_t firstSequence = reader.ReadVarint();
+    int count = std::min(int(reader.ReadU8()), skMaxInputsPerPacket);
+
+    InputCommand commands[skMaxInputsPerPacket];
+    for (int i = 0; i < count; ++i)
+    {
+        ReadInputCommand(reader, commands[i]);
+        commands[i].mSequence = firstSequence + uint32_t(i);
+    }
+
+    if (!reader.IsOk())
+    {
+        return;
+    }
+
+    client.mTimeSinceHeard = 0.f;
+    if (ackedTick > client.mAckedTick && ackedTick <= mTick)
+    {
+        client.mAckedTick = ackedTick;
+    }
+
+    // Every packet repeats the unacked commands, only the ones not seen yet are queued
+    for (int i = 0; i < count; ++i)
+    {
+        if (commands[i].mSequence > client.mNewestInput)
+        {
+            client.mInputs.push_back(commands[i]);
+            client.mNewestInput = commands[i].mSequence;
+        }
+    }
+
+    // A client sending faster than it is stepped loses its oldest commands rather than falling further behind
+    while (client.mInputs.size() > skMaxQueuedInputs)
+    {
+        client.mLastProcessedInput = client.mInputs.front().mSequence;
+        client.mInputs.pop_front();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::SendSnapshot(NetServerClient & client, uint32_t tick, const std::vector<EntityState> & entities, int32_t score)
+{
+    static const std::vector<EntityState> skNoEntities;
+    static const EntityState skZeroState;
+
+    // Encode against the newest snapshot the client has acked, if it is still in the history
+    uint32_t baselineTick = 0;
+    const std::vector<EntityState> * pBaseline = &skNoEntities;
+    if (client.mAckedTick != 0 && tick - client.mAckedTick < uint32_t(skSnapshotHistory))
+    {
+        auto & known = client.mHistory[client.mAckedTick % skSnapshotHistory];
+        if (known.mTick == client.mAckedTick)
+        {
+            baselineTick = client.mAckedTick;
+            pBaseline = &known.mEntities;
+        }
+    }
+    const std::vector<EntityState> & baseline = *pBaseline;
+
+    // Follow the client's player, keeping the last position while it has none
+    auto ownIt = std::lower_bound(entities.begin(), entities.end(), client.mPlayerId,
+        [](const EntityState & state, uint32_t id) { return state.mId < id; });
+    if (client.mPlayerId != 0 && ownIt != entities.end() && ownIt->mId == client.mPlayerId)
+    {
+        client.mViewCenterX = DequantizePosition(ownIt->mX);
+        client.mViewCenterY = DequantizePosition(ownIt->mY);
+    }
+
+    float halfWidth = client.mViewWidth * 0.5f + skRelevancyMargin;
+    float halfHeight = client.mViewHeight * 0.5f + skRelevancyMargin;
+    float halfDiagonal = std::sqrt(halfWidth * halfWidth + halfHeight * halfHeight);
+
+    // Returns a negative weight for entities the client should not know about
+    auto getWeight = [&](const EntityState & state)
+    {
+        if (state.mId == client.mPlayerId)
+        {
+            return skOwnPlayerWeight;
+        }
+        float dx = DequantizePosition(state.mX) - client.mViewCenterX;
+        float dy = DequantizePosition(state.mY) - client.mViewCenterY;
+        if (std::abs(dx) > halfWidth || std::abs(dy) > halfHeight)
+        {
+            return -1.f;
+        }
+        float closeness = 1.f - std::min(std::sqrt(dx * dx + dy * dy) / halfDiagonal, 1.f);
+        return 1.f + 2.f * closeness;
+    };
+
+    // Walk both id sorted lists together: entities only in the baseline are removed, ones only in the world are new
+    mKnown.clear();
+    mRemoved.clear();
+    mCandidates.clear();
+    int relevantCount = 0;
+
+    size_t b = 0;
+    size_t e = 0;
+    while (b < baseline.size() || e < entities.size())
+    {
+        bool isRemovedOnly = e == entities.size() || (b < baseline.size() && baseline[b].mId < entities[e].mId);
+        if (isRemovedOnly)
+        {
+            mRemoved.push_back(uint32_t(b++));
+            continue;
+        }
+
+        const EntityState & state = entities[e++];
+        bool isInBaseline = b < baseline.size() && baseline[b].mId == state.mId;
+        float weight = getWeight(state);
+
+        if (weight < 0.f)
+        {
+            client.mPriorities.erase(state.mId);
+            if (isInBaseline)
+            {
+                mRemoved.push_back(uint32_t(b++));
+            }
+            continue;
+        }
+
+        ++relevantCount;
+        const EntityState * pKnown = nullptr;
+        int knownIndex = -1;
+        uint8_t mask = FieldAll;
+        if (isInBaseline)
+        {
+            pKnown = &baseline[b++];
+            knownIndex = int(mKnown.size());
+            mKnown.push_back(*pKnown);
+            mask = GetChangedFields(*pKnown, state);
+        }
+
+        if (mask == 0)
+        {
+            client.mPriorities.erase(state.mId);
+            continue;
+        }
+
+        float & priority = client.mPriorities[state.mId];
+        priority += weight;
+        mCandidates.push_back({ &state, pKnown, knownIndex, mask, priority });
+    }
+
+    // Header and removals always go out, the entities share what is left of the budget
+    size_t packetBudget = std::min(skMaxPacketSize, std::max(skMinPacketBudget, size_t(mBytesPerSecond / skTickRate)));
+
+    NetWriter writer(mPacket);
+    WriteHeader(writer, Snapshot);
+    writer.WriteVarint(tick);
+    writer.WriteVarint(baselineTick);
+    writer.WriteVarint(client.mLastProcessedInput);
+    writer.WriteVarint(client.mPlayerId);
+    writer.WriteSigned(score);
+
+    // Removals that would not fit in a datagram stay known and are removed on a later tick
+    size_t maxRemovals = (skMaxPacketSize / 2) / 5;
+    size_t removalCount = std::min(mRemoved.size(), maxRemovals);
+    writer.WriteVarint(uint32_t(removalCount));
+    for (size_t i = 0; i < mRemoved.size(); ++i)
+    {
+        const EntityState & removed = baseline[mRemoved[i]];
+        if (i < removalCount)
+        {
+            writer.WriteVarint(removed.mId);
+            client.mPriorities.erase(removed.mId);
+        }
+        else
+        {
+            mKnown.push_back(removed);
+        }
+    }
+
+    std::sort(mCandidates.begin(), mCandidates.end(),
+        [](const Candidate & a, const Candidate & b) { return a.mPriority > b.mPriority; });
+
+    int sentCount = 0;
+    int deferredCount = 0;
+    for (const Candidate & candidate : mCandidates)
+    {
+        size_t before = writer.GetSize();
+        WriteEntityDelta(writer, candidate.mpBaseline ? *candidate.mpBaseline : skZeroState, *candidate.mpState, candidate.mMask);
+
+        // One byte kept for the terminator
+        if (writer.GetSize() + 1 > packetBudget)
+        {
+            writer.Truncate(before);
+            ++deferredCount;
+            continue;
+        }
+
+        ++sentCount;
+        client.mPriorities[candidate.mpState->mId] = 0.f;
+        if (candidate.mKnownIndex >= 0)
+        {
+            mKnown[candidate.mKnownIndex] = *candidate.mpState;
+        }
+        else
+        {
+            mKnown.push_back(*candidate.mpState);
+        }
+    }
+    writer.WriteVarint(0);
+
+    std::sort(mKnown.begin(), mKnown.end(), [](const EntityState & a, const EntityState & b) { return a.mId < b.mId; });
+    auto & history = client.mHistory[tick % skSnapshotHistory];
+    history.mTick = tick;
+    history.mEntities.assign(mKnown.begin(), mKnown.end());
+
+    mTransport.Send(client.mAddress, mPacket.data(), mPacket.size());
+
+    client.mLastSnapshotBytes = mPacket.size();
+    client.mLastEntitiesSent = sentCount;
+    client.mLastEntitiesRelevant = relevantCount;
+    client.mLastEntitiesDeferred = deferredCount;
+    client.mBytesPerSecond += (float(mPacket.size() * skTickRate) - client.mBytesPerSecond) * 0.1f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetServer::SendWelcome(const NetServerClient & client)
+{
+    NetWriter writer(mPacket);
+    WriteHeader(writer, Welcome);
+    writer.WriteU8(uint8_t(client.mId));
+    writer.WriteVarint(mTick);
+    mTransport.Send(client.mAddress, mPacket.data(), mPacket.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
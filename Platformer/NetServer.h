@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "NetProtocol.h"
+#include "NetTransport.h"
+
+struct NetServerClient
+{
+    int mId = 0;
+    NetAddress mAddress;
+    float mTimeSinceHeard = 0.f;
+    float mViewWidth = 0.f;
+    float mViewHeight = 0.f;
+    float mViewCenterX = 0.f;                   // Last known position of the client's player
+    float mViewCenterY = 0.f;
+    uint32_t mPlayerId = 0;
+    uint32_t mNewestInput = 0;                  // Newest sequence queued
+    uint32_t mLastProcessedInput = 0;
+    uint32_t mAckedTick = 0;
+    std::deque<NetProtocol::InputCommand> mInputs;
+
+    // What the client knows after each snapshot sent, by tick % skSnapshotHistory, sorted by id
+    struct KnownState
+    {
+        uint32_t mTick = 0;
+        std::vector<NetProtocol::EntityState> mEntities;
+    };
+    std::vector<KnownState> mHistory;
+
+    // Grows every tick an entity has news the client has not been sent, so entities cut for bandwidth go first next time
+    std::unordered_map<uint32_t, float> mPriorities;
+
+    // Stats
+    size_t mLastSnapshotBytes = 0;
+    int mLastEntitiesSent = 0;
+    int mLastEntitiesRelevant = 0;
+    int mLastEntitiesDeferred = 0;
+    float mBytesPerSecond = 0.f;
+};
+
+// Authoritative side of the co-op protocol in NetProtocol.h. Knows nothing about GameObjects: each tick the
+// NetworkManager hands it the quantized world and it works out, per client, what that client has to be told. Snapshots
+// are encoded against the newest one the client acked, only entities within the client's view (plus a margin) are
+// sent, and entities whose changes do not fit the per client byte budget wait for a later tick with a higher priority.
+class NetServer
+{
+public:
+    NetServer(NetTransport & transport);
+
+    void SetBandwidthBudget(int bytesPerSecond);
+    int GetBandwidthBudget() const { return mBytesPerSecond; }
+
+    // Reads everything waiting, reporting clients that connected or were lost since the last call
+    void Update(float deltaTime, std::vector<int> & outConnected, std::vector<int> & outDisconnected);
+
+    void SetClientPlayer(int clientId, uint32_t playerId);
+
+    // The oldest command from the client that has not been stepped yet, marked processed once returned
+    bool PopInput(int clientId, NetProtocol::InputCommand & outCommand);
+
+    // entities must be sorted by id
+    void SendSnapshots(uint32_t tick, const std::vector<NetProtocol::EntityState> & entities, int32_t score);
+
+    void DisconnectAll();
+
+    const std::vector<NetServerClient> & GetClients() const { return mClients; }
+
+private:
+    NetServerClient * FindClient(const NetAddress & address);
+    NetServerClient * FindClient(int clientId);
+    void ReadInput(NetServerClient & client, NetProtocol::NetReader & reader);
+    void SendSnapshot(NetServerClient & client, uint32_t tick, const std::vector<NetProtocol::EntityState> & entities, int32_t score);
+    void SendWelcome(const NetServerClient & client);
+
+    struct Candidate
+    {
+        const NetProtocol::EntityState * mpState;
+        const NetProtocol::EntityState * mpBaseline;
+        int mKnownIndex;                        // Into mKnown, -1 for entities new to the client
+        uint8_t mMask;
+        float mPriority;
+    };
+
+    NetTransport & mTransport;
+    int mBytesPerSecond;
+    int mNextClientId;
+    uint32_t mTick;
+    std::vector<NetServerClient> mClients;
+
+    // Kept between calls so ticks do not allocate
+    std::vector<uint8_t> mPacket;
+    std::vector<uint8_t> mReceived;
+    std::vector<NetProtocol::EntityState> mKnown;
+    std::vector<Candidate> mCandidates;
+    std::vector<uint32_t> mRemoved;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
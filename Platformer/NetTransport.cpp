@@ -0,0 +1,232 @@
+#include "AstroidsPrivate.h"
+#include "NetTransport.h"
+#include "NetProtocol.h"
+#include <SFML/Network/IpAddress.hpp>
+
+std::string NetAddress::ToString() const
+{
+    return sf::IpAddress(mIp).toString() + ":" + std::to_string(mPort);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+UdpTransport::UdpTransport()
+    : mSocket()
+    , mReceiveBuffer(NetProtocol::skMaxPacketSize)
+{
+    mSocket.setBlocking(false);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool UdpTransport::Bind(uint16_t port)
+{
+    mSocket.unbind();
+    // Port 0 is sf::Socket::AnyPort, the system picks a free one
+    return mSocket.bind(port) == sf::Socket::Done;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint16_t UdpTransport::GetLocalPort() const
+{
+    return mSocket.getLocalPort();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool UdpTransport::Send(const NetAddress & to, const void * pData, size_t size)
+{
+    return mSocket.send(pData, size, sf::IpAddress(to.mIp), to.mPort) == sf::Socket::Done;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool UdpTransport::Receive(std::vector<uint8_t> & outData, NetAddress & outFrom)
+{
+    // Anything bigger than the buffer is not ours and comes back as an error, so skip past a few of those
+    for (int attempt = 0; attempt < 16; ++attempt)
+    {
+        std::size_t received = 0;
+        sf::IpAddress sender;
+        unsigned short port = 0;
+        sf::Socket::Status status = mSocket.receive(mReceiveBuffer.data(), mReceiveBuffer.size(), received, sender, port);
+        if (status == sf::Socket::Done)
+        {
+            outData.assign(mReceiveBuffer.begin(), mReceiveBuffer.begin() + received);
+            outFrom.mIp = sender.toInteger();
+            outFrom.mPort = port;
+            return true;
+        }
+        if (status != sf::Socket::Error)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NetAddress LoopbackNetwork::Open()
+{
+    NetAddress address;
+    address.mIp = sf::IpAddress::LocalHost.toInteger();
+    address.mPort = mNextPort++;
+    mQueues[address.mPort];
+    return address;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void LoopbackNetwork::Close(const NetAddress & address)
+{
+    mQueues.erase(address.mPort);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void LoopbackNetwork::Deliver(const NetAddress & from, const NetAddress & to, const void * pData, size_t size)
+{
+    auto it = mQueues.find(to.mPort);
+    if (it == mQueues.end())
+    {
+        return;
+    }
+
+    const uint8_t * pBytes = static_cast<const uint8_t *>(pData);
+    it->second.push_back({ from, std::vector<uint8_t>(pBytes, pBytes + size) });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool LoopbackNetwork::Take(const NetAddress & at, std::vector<uint8_t> & outData, NetAddress & outFrom)
+{
+    auto it = mQueues.find(at.mPort);
+    if (it == mQueues.end() || it->second.empty())
+    {
+        return false;
+    }
+
+    Datagram & datagram = it->second.front();
+    outFrom = datagram.mFrom;
+    outData.swap(datagram.mData);
+    it->second.pop_front();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+LoopbackTransport::LoopbackTransport(LoopbackNetwork & network)
+    : mNetwork(network)
+    , mAddress(network.Open())
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+LoopbackTransport::~LoopbackTransport()
+{
+    mNetwork.Close(mAddress);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool LoopbackTransport::Send(const NetAddress & to, const void * pData, size_t size)
+{
+    mNetwork.Deliver(mAddress, to, pData, size);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool LoopbackTransport::Receive(std::vector<uint8_t> & outData, NetAddress & outFrom)
+{
+    return mNetwork.Take(mAddress, outData, outFrom);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NetConditioner::NetConditioner(NetTransport & inner)
+    : mInner(inner)
+    , mConditions()
+    , mStats()
+    , mTime(0.f)
+    , mDelayed()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetConditioner::SetConditions(const NetConditions & conditions)
+{
+    mConditions = conditions;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NetConditioner::Send(const NetAddress & to, const void * pData, size_t size)
+{
+    ++mStats.mPacketsSent;
+    mStats.mBytesSent += uint32_t(size);
+
+    if (float(rand() % 10000) < mConditions.mLossPercent * 100.f)
+    {
+        ++mStats.mPacketsDropped;
+        return true;
+    }
+
+    float delayMilliseconds = mConditions.mLatencyMilliseconds;
+    if (mConditions.mJitterMilliseconds > 0.f)
+    {
+        delayMilliseconds += mConditions.mJitterMilliseconds * float(rand() % 1000) / 1000.f;
+    }
+
+    if (delayMilliseconds <= 0.f)
+    {
+        return mInner.Send(to, pData, size);
+    }
+
+    const uint8_t * pBytes = static_cast<const uint8_t *>(pData);
+    mDelayed.push_back({ mTime + delayMilliseconds / 1000.f, to, std::vector<uint8_t>(pBytes, pBytes + size) });
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NetConditioner::Receive(std::vector<uint8_t> & outData, NetAddress & outFrom)
+{
+    return mInner.Receive(outData, outFrom);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetConditioner::Update(float deltaTime)
+{
+    mTime += deltaTime;
+
+    // Few enough in flight that a scan beats keeping them sorted
+    size_t kept = 0;
+    for (size_t i = 0; i < mDelayed.size(); ++i)
+    {
+        if (mDelayed[i].mSendTime <= mTime)
+        {
+            mInner.Send(mDelayed[i].mTo, mDelayed[i].mData.data(), mDelayed[i].mData.size());
+        }
+        else
+        {
+            if (kept != i)
+            {
+                mDelayed[kept] = std::move(mDelayed[i]);
+            }
+            ++kept;
+        }
+    }
+    mDelayed.resize(kept);
+
+    mInner.Update(deltaTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SFML/Network/UdpSocket.hpp>
+
+struct NetAddress
+{
+    uint32_t mIp = 0;
+    uint16_t mPort = 0;
+
+    bool operator==(const NetAddress & other) const { return mIp == other.mIp && mPort == other.mPort; }
+    bool operator!=(const NetAddress & other) const { return !(*this == other); }
+    std::string ToString() const;
+};
+
+// Unreliable, unordered datagrams; NetServer and NetClient only ever see this interface
+class NetTransport
+{
+public:
+    virtual ~NetTransport() = default;
+
+    virtual bool Send(const NetAddress & to, const void * pData, size_t size) = 0;
+
+    // Returns false once nothing is waiting
+    virtual bool Receive(std::vector<uint8_t> & outData, NetAddress & outFrom) = 0;
+
+    virtual void Update(float deltaTime) {}
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+class UdpTransport : public NetTransport
+{
+public:
+    UdpTransport();
+
+    // Port 0 lets the OS pick one
+    bool Bind(uint16_t port);
+    uint16_t GetLocalPort() const;
+
+    virtual bool Send(const NetAddress & to, const void * pData, size_t size) override;
+    virtual bool Receive(std::vector<uint8_t> & outData, NetAddress & outFrom) override;
+
+private:
+    sf::UdpSocket mSocket;
+    std::vector<uint8_t> mReceiveBuffer;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+// Datagrams between transports in the same process, addressed by a made up port on 127.0.0.1
+class LoopbackNetwork
+{
+public:
+    NetAddress Open();
+    void Close(const NetAddress & address);
+
+    void Deliver(const NetAddress & from, const NetAddress & to, const void * pData, size_t size);
+    bool Take(const NetAddress & at, std::vector<uint8_t> & outData, NetAddress & outFrom);
+
+private:
+    struct Datagram
+    {
+        NetAddress mFrom;
+        std::vector<uint8_t> mData;
+    };
+
+    std::unordered_map<uint16_t, std::deque<Datagram>> mQueues;
+    uint16_t mNextPort = 50000;
+};
+
+class LoopbackTransport : public NetTransport
+{
+public:
+    LoopbackTransport(LoopbackNetwork & network);
+    ~LoopbackTransport();
+
+    const NetAddress & GetAddress() const { return mAddress; }
+
+    virtual bool Send(const NetAddress & to, const void * pData, size_t size) override;
+    virtual bool Receive(std::vector<uint8_t> & outData, NetAddress & outFrom) override;
+
+private:
+    LoopbackNetwork & mNetwork;
+    NetAddress mAddress;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+struct NetConditions
+{
+    float mLatencyMilliseconds = 0.f;   // One way
+    float mJitterMilliseconds = 0.f;    // Added at random on top, so packets can arrive out of order
+    float mLossPercent = 0.f;
+};
+
+struct NetTransportStats
+{
+    uint32_t mPacketsSent = 0;
+    uint32_t mPacketsDropped = 0;
+    uint32_t mBytesSent = 0;
+};
+
+// Wraps another transport and holds back or drops what is sent through it. Only outgoing packets are conditioned, so
+// both ends of a connection need one for the round trip to see the latency twice.
+class NetConditioner : public NetTransport
+{
+public:
+    NetConditioner(NetTransport & inner);
+
+    void SetConditions(const NetConditions & conditions);
+    const NetConditions & GetConditions() const { return mConditions; }
+    const NetTransportStats & GetStats() const { return mStats; }
+
+    virtual bool Send(const NetAddress & to, const void * pData, size_t size) override;
+    virtual bool Receive(std::vector<uint8_t> & outData, NetAddress & outFrom) override;
+
+    // Sends whatever has waited long enough
+    virtual void Update(float deltaTime) override;
+
+private:
+    struct DelayedPacket
+    {
+        float mSendTime;
+        NetAddress mTo;
+        std::vector<uint8_t> mData;
+    };
+
+    NetTransport & mInner;
+    NetConditions mConditions;
+    NetTransportStats mStats;
+    float mTime;
+    std::vector<DelayedPacket> mDelayed;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,856 @@
+#include "AstroidsPrivate.h"
+#include "NetworkManager.h"
+#include "PlayerManager.h"
+#include "EnemyAIManager.h"
+#include "ScoreManager.h"
+#include "CameraManager.h"
+#include "LevelManager.h"
+#include "ResourceManager.h"
+#include "SnapshotManager.h"
+#include "SpriteComponent.h"
+#include "HealthComponent.h"
+#include "ProjectileComponent.h"
+#include "NetInputComponent.h"
+#include "BDConfig.h"
+#include <SFML/Network/IpAddress.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <imgui.h>
+
+using namespace NetProtocol;
+
+namespace
+{
+    const uint16_t skDefaultPort = 45000;
+    const int skDefaultBandwidthBudget = 16 * 1024;
+
+    // A server that falls this far behind skips ticks rather than sending a burst of them
+    const int skMaxTicksPerFrame = 3;
+
+    // Commands stepped per remote player per frame, so a burst after a stall does not freeze the host
+    const int skMaxCommandsPerFrame = 8;
+
+    // Smaller corrections are quantization, not a misprediction, and are left alone so the player does not jitter
+    const float skReconcileTolerance = 1.f;
+
+    const float skBotDecisionInterval = 1.5f;
+
+    std::string GetProxyFile(uint8_t archetype, uint8_t variant, sf::Vector2f & outScale)
+    {
+        switch (archetype)
+        {
+            case SnapshotFormat::Player:
+            {
+                outScale = sf::Vector2f(0.25f, 0.25f);
+                return "Art/Player.png";
+            }
+            case SnapshotFormat::Drop:
+            {
+                outScale = sf::Vector2f(1.f, 1.f);
+                return EDropType(variant) == EDropType::NukePickup ? "Art/Nuke.png" : "Art/Life.png";
+            }
+            case SnapshotFormat::Projectile:
+            {
+                outScale = sf::Vector2f(1.05f, 1.05f);
+                return ProjectileComponent::GetProjectileFile(EProjectileType(variant));
+            }
+            default:
+            {
+                return std::string();
+            }
+        }
+    }
+
+    sf::Color GetOverlayColor(uint8_t archetype)
+    {
+        switch (archetype)
+        {
+            case SnapshotFormat::Player:     return sf::Color::Cyan;
+            case SnapshotFormat::Enemy:      return sf::Color::Red;
+            case SnapshotFormat::Drop:       return sf::Color::Yellow;
+            default:                         return sf::Color::White;
+        }
+    }
+}
+
+NetworkManager::NetworkManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mMode(ENetMode::Off)
+    , mConditions()
+    , mBandwidthBudget(skDefaultBandwidthBudget)
+    , mTickAccumulator(0.f)
+    , mTick(0)
+    , mNextNetId(1)
+    , mNetIds()
+    , mSeenNetIds()
+    , mClientPlayers()
+    , mEntities()
+    , mStack()
+    , mPredicted()
+    , mTuning()
+    , mInputSendAccumulator(0.f)
+    , mLastCorrection(0.f)
+    , mFrame(0)
+    , mProxies()
+    , mInterpolated()
+    , mBotTime(0.f)
+    , mBotInput()
+    , mPort(skDefaultPort)
+{
+    std::strcpy(mAddressText, "127.0.0.1");
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+NetworkManager::~NetworkManager()
+{
+    // Other managers may already be gone, so only tell the other end
+    if (mpServer)
+    {
+        mpServer->DisconnectAll();
+    }
+    if (mpClient)
+    {
+        mpClient->Disconnect();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::Update(float deltaTime)
+{
+    ++mFrame;
+
+    if (mpServer)
+    {
+        UpdateServer(deltaTime);
+    }
+    if (mpClient)
+    {
+        UpdateClient(deltaTime);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::Render(sf::RenderWindow & window)
+{
+    if (mMode != ENetMode::Loopback || !mpClient || !mpClient->IsConnected())
+    {
+        return;
+    }
+
+    // The headless client's view, outlines where it draws each entity and its predicted player
+    sf::CircleShape shape;
+    shape.setFillColor(sf::Color::Transparent);
+    shape.setOutlineThickness(2.f);
+    for (const NetInterpolatedEntity & entity : mInterpolated)
+    {
+        float radius = entity.mArchetype == SnapshotFormat::Projectile ? 6.f : 20.f;
+        shape.setRadius(radius);
+        shape.setOrigin(radius, radius);
+        shape.setPosition(entity.mPosition);
+        shape.setOutlineColor(GetOverlayColor(entity.mArchetype));
+        window.draw(shape);
+    }
+
+    shape.setRadius(24.f);
+    shape.setOrigin(24.f, 24.f);
+    shape.setPosition(mPredicted.mPosition);
+    shape.setOutlineColor(sf::Color::Green);
+    window.draw(shape);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::OnGameEnd()
+{
+    Stop();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NetworkManager::StartHost(uint16_t port)
+{
+    Stop();
+
+    mpUdpTransport = std::make_unique<UdpTransport>();
+    if (!mpUdpTransport->Bind(port))
+    {
+        mpUdpTransport.reset();
+        return false;
+    }
+
+    mpConditioner = std::make_unique<NetConditioner>(*mpUdpTransport);
+    mpConditioner->SetConditions(mConditions);
+    mpServer = std::make_unique<NetServer>(*mpConditioner);
+    mpServer->SetBandwidthBudget(mBandwidthBudget);
+    mTick = 0;
+    mTickAccumulator = 0.f;
+    mMode = ENetMode::Host;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool NetworkManager::StartClient(const std::string & address, uint16_t port)
+{
+    Stop();
+
+    sf::IpAddress serverIp(address);
+    GameObject * pPlayer = GetLocalPlayer();
+    if (serverIp == sf::IpAddress::None || !pPlayer)
+    {
+        return false;
+    }
+
+    mpUdpTransport = std::make_unique<UdpTransport>();
+    if (!mpUdpTransport->Bind(0))
+    {
+        mpUdpTransport.reset();
+        return false;
+    }
+
+    auto & gameManager = GetGameManager();
+    mpConditioner = std::make_unique<NetConditioner>(*mpUdpTransport);
+    mpConditioner->SetConditions(mConditions);
+    mpClient = std::make_unique<NetClient>(*mpConditioner);
+
+    // The server's enemies arrive as proxies
+    if (auto * pEnemyAIManager = gameManager.GetManager<EnemyAIManager>())
+    {
+        pEnemyAIManager->SetSpawningEnabled(false);
+        pEnemyAIManager->DestroyAllEnemies();
+    }
+
+    // From here the local player only moves through prediction, and never fires locally, the server's shots come back
+    pPlayer->AddComponent(std::make_shared<NetInputComponent>(pPlayer, gameManager));
+    mPredicted.mPosition = pPlayer->GetPosition();
+    mPredicted.mRotation = pPlayer->GetRotationDegrees();
+    if (auto pMovementComponent = pPlayer->GetComponent<ControlledMovementComponent>().lock())
+    {
+        mPredicted.mVelocity = pMovementComponent->GetVelocity();
+        mTuning = pMovementComponent->GetTuning();
+    }
+
+    NetAddress server;
+    server.mIp = serverIp.toInteger();
+    server.mPort = port;
+    sf::Vector2f viewSize = gameManager.GetManager<CameraManager>()->GetView().getSize();
+    mpClient->Connect(server, uint16_t(viewSize.x), uint16_t(viewSize.y));
+    mInputSendAccumulator = 0.f;
+    mMode = ENetMode::Client;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::StartLoopback()
+{
+    Stop();
+
+    mpLoopbackNetwork = std::make_unique<LoopbackNetwork>();
+    mpServerLoopback = std::make_unique<LoopbackTransport>(*mpLoopbackNetwork);
+    mpClientLoopback = std::make_unique<LoopbackTransport>(*mpLoopbackNetwork);
+    mpConditioner = std::make_unique<NetConditioner>(*mpServerLoopback);
+    mpClientConditioner = std::make_unique<NetConditioner>(*mpClientLoopback);
+    mpConditioner->SetConditions(mConditions);
+    mpClientConditioner->SetConditions(mConditions);
+
+    mpServer = std::make_unique<NetServer>(*mpConditioner);
+    mpServer->SetBandwidthBudget(mBandwidthBudget);
+    mpClient = std::make_unique<NetClient>(*mpClientConditioner);
+    mTick = 0;
+    mTickAccumulator = 0.f;
+    mInputSendAccumulator = 0.f;
+    mPredicted = MovementState();
+    mTuning = MovementTuning();
+    mBotTime = 0.f;
+
+    sf::Vector2f viewSize = GetGameManager().GetManager<CameraManager>()->GetView().getSize();
+    mpClient->Connect(mpServerLoopback->GetAddress(), uint16_t(viewSize.x), uint16_t(viewSize.y));
+    mMode = ENetMode::Loopback;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::Stop()
+{
+    auto & gameManager = GetGameManager();
+
+    if (mpServer)
+    {
+        mpServer->DisconnectAll();
+        for (auto & [clientId, playerHandle] : mClientPlayers)
+        {
+            if (GameObject * pPlayer = gameManager.GetGameObject(playerHandle))
+            {
+                pPlayer->Destroy();
+            }
+        }
+    }
+
+    if (mpClient)
+    {
+        mpClient->Disconnect();
+        DestroyProxies();
+
+        if (mMode == ENetMode::Client)
+        {
+            if (auto * pEnemyAIManager = gameManager.GetManager<EnemyAIManager>())
+            {
+                pEnemyAIManager->SetSpawningEnabled(true);
+            }
+            if (GameObject * pPlayer = GetLocalPlayer())
+            {
+                pPlayer->RemoveComponent<NetInputComponent>();
+            }
+        }
+    }
+
+    // Ends first, they hold references to the transports
+    mpServer.reset();
+    mpClient.reset();
+    mpConditioner.reset();
+    mpClientConditioner.reset();
+    mpServerLoopback.reset();
+    mpClientLoopback.reset();
+    mpLoopbackNetwork.reset();
+    mpUdpTransport.reset();
+
+    mClientPlayers.clear();
+    mNetIds.clear();
+    mSeenNetIds.clear();
+    mInterpolated.clear();
+    mMode = ENetMode::Off;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::SetConditions(const NetConditions & conditions)
+{
+    mConditions = conditions;
+    if (mpConditioner)
+    {
+        mpConditioner->SetConditions(conditions);
+    }
+    if (mpClientConditioner)
+    {
+        mpClientConditioner->SetConditions(conditions);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::UpdateServer(float deltaTime)
+{
+    mpConditioner->Update(deltaTime);
+
+    std::vector<int> connected;
+    std::vector<int> disconnected;
+    mpServer->Update(deltaTime, connected, disconnected);
+    for (int clientId : connected)
+    {
+        OnClientConnected(clientId);
+    }
+    for (int clientId : disconnected)
+    {
+        OnClientDisconnected(clientId);
+    }
+
+    StepClientInputs();
+
+    // The world still steps every frame, snapshots of it go out at the fixed tick rate
+    mTickAccumulator += deltaTime;
+    int tickCount = 0;
+    while (mTickAccumulator >= skTickSeconds && tickCount < skMaxTicksPerFrame)
+    {
+        mTickAccumulator -= skTickSeconds;
+        ++tickCount;
+        ++mTick;
+
+        GatherEntities();
+        auto * pScoreManager = GetGameManager().GetManager<ScoreManager>();
+        mpServer->SendSnapshots(mTick, mEntities, pScoreManager ? pScoreManager->GetScore() : 0);
+    }
+    mTickAccumulator = std::min(mTickAccumulator, skTickSeconds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::StepClientInputs()
+{
+    auto & gameManager = GetGameManager();
+
+    for (auto & [clientId, playerHandle] : mClientPlayers)
+    {
+        GameObject * pPlayer = gameManager.GetGameObject(playerHandle);
+        bool isAlive = pPlayer && !pPlayer->IsDestroyed() && pPlayer->IsActive();
+        auto pMovementComponent = isAlive ? pPlayer->GetComponent<ControlledMovementComponent>().lock() : nullptr;
+        auto pNetInput = isAlive ? pPlayer->GetComponent<NetInputComponent>().lock() : nullptr;
+
+        InputCommand command;
+        int steppedCount = 0;
+        while (steppedCount < skMaxCommandsPerFrame && mpServer->PopInput(clientId, command))
+        {
+            // Commands for a dead player are still taken, so the client stops resending them
+            if (!pMovementComponent || !pNetInput)
+            {
+                continue;
+            }
+
+            PlayerInput input = GetPlayerInput(command);
+            pMovementComponent->Step(input, GetDeltaTime(command));
+            pNetInput->SetInput(input);
+            ++steppedCount;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::GatherEntities()
+{
+    auto & gameManager = GetGameManager();
+    mEntities.clear();
+    mSeenNetIds.clear();
+
+    GameObject * pRoot = gameManager.GetRootGameObject();
+    if (!pRoot)
+    {
+        return;
+    }
+
+    mStack.assign(pRoot->GetChildrenHandles().begin(), pRoot->GetChildrenHandles().end());
+    while (!mStack.empty())
+    {
+        BD::Handle handle = mStack.back();
+        mStack.pop_back();
+
+        GameObject * pObject = gameManager.GetGameObject(handle);
+        if (!pObject || pObject->IsDestroyed())
+        {
+            continue;
+        }
+
+        auto & children = pObject->GetChildrenHandles();
+        mStack.insert(mStack.end(), children.begin(), children.end());
+
+        uint8_t archetype;
+        uint8_t variant;
+        if (!pObject->IsActive() || !SnapshotManager::GetArchetype(gameManager, *pObject, archetype, variant))
+        {
+            continue;
+        }
+
+        EntityState state;
+        state.mId = GetNetId(handle);
+        state.mArchetype = archetype;
+        state.mVariant = variant;
+
+        sf::Vector2f position = pObject->GetPosition();
+        state.mX = QuantizePosition(position.x);
+        state.mY = QuantizePosition(position.y);
+        state.mRotation = QuantizeRotation(pObject->GetRotationDegrees());
+
+        if (auto pMovementComponent = pObject->GetComponent<ControlledMovementComponent>().lock())
+        {
+            sf::Vector2f velocity = pMovementComponent->GetVelocity();
+            state.mVelocityX = QuantizeVelocity(velocity.x);
+            state.mVelocityY = QuantizeVelocity(velocity.y);
+        }
+        if (auto pHealthComponent = pObject->GetComponent<HealthComponent>().lock())
+        {
+            state.mHealth = int16_t(std::min(std::max(pHealthComponent->GetHealth(), -32768), 32767));
+            state.mLives = uint8_t(std::min(std::max(pHealthComponent->GetLives(), 0), 255));
+        }
+
+        mSeenNetIds[handle] = state.mId;
+        mEntities.push_back(state);
+    }
+
+    // Ids of objects that are gone are never used again
+    mNetIds.swap(mSeenNetIds);
+
+    std::sort(mEntities.begin(), mEntities.end(), [](const EntityState & a, const EntityState & b) { return a.mId < b.mId; });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint32_t NetworkManager::GetNetId(BD::Handle handle)
+{
+    auto it = mNetIds.find(handle);
+    if (it != mNetIds.end())
+    {
+        return it->second;
+    }
+
+    uint32_t netId = mNextNetId++;
+    mNetIds[handle] = netId;
+    return netId;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::OnClientConnected(int clientId)
+{
+    auto & gameManager = GetGameManager();
+    auto * pPlayerManager = gameManager.GetManager<PlayerManager>();
+    if (!pPlayerManager)
+    {
+        return;
+    }
+
+    BD::Handle playerHandle = pPlayerManager->InitPlayer();
+    GameObject * pPlayer = gameManager.GetGameObject(playerHandle);
+    if (!pPlayer)
+    {
+        return;
+    }
+
+    pPlayer->AddComponent(std::make_shared<NetInputComponent>(pPlayer, gameManager));
+    mClientPlayers[clientId] = playerHandle;
+    mpServer->SetClientPlayer(clientId, GetNetId(playerHandle));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::OnClientDisconnected(int clientId)
+{
+    auto it = mClientPlayers.find(clientId);
+    if (it == mClientPlayers.end())
+    {
+        return;
+    }
+
+    if (GameObject * pPlayer = GetGameManager().GetGameObject(it->second))
+    {
+        pPlayer->Destroy();
+    }
+    mClientPlayers.erase(it);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::UpdateClient(float deltaTime)
+{
+    NetConditioner & conditioner = mMode == ENetMode::Loopback ? *mpClientConditioner : *mpConditioner;
+    conditioner.Update(deltaTime);
+    mpClient->Update(deltaTime);
+
+    // Timed out or told to leave by the server
+    if (!mpClient->IsConnecting() && !mpClient->IsConnected())
+    {
+        Stop();
+        return;
+    }
+    if (!mpClient->IsConnected())
+    {
+        return;
+    }
+
+    PlayerInput input = mMode == ENetMode::Loopback ? GetBotInput(deltaTime) : SampleLocalPlayerInput(GetGameManager());
+    const InputCommand & command = mpClient->AddInput(input, deltaTime);
+    Reconcile(command);
+
+    mInputSendAccumulator += deltaTime;
+    if (mInputSendAccumulator >= skTickSeconds)
+    {
+        mInputSendAccumulator = std::min(mInputSendAccumulator - skTickSeconds, skTickSeconds);
+        mpClient->SendInputs();
+    }
+
+    mpClient->SampleEntities(mInterpolated);
+    if (mMode == ENetMode::Client)
+    {
+        UpdateProxies();
+        if (auto * pScoreManager = GetGameManager().GetManager<ScoreManager>())
+        {
+            pScoreManager->SetScore(mpClient->GetScore());
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+PlayerInput NetworkManager::GetBotInput(float deltaTime)
+{
+    // Wanders in a new direction every so often and fires in short bursts, enough to keep every path busy
+    float previousTime = mBotTime;
+    mBotTime += deltaTime;
+    if (std::floor(previousTime / skBotDecisionInterval) != std::floor(mBotTime / skBotDecisionInterval) || previousTime == 0.f)
+    {
+        mBotInput.mMove = sf::Vector2f(float(rand() % 3 - 1), float(rand() % 3 - 1));
+    }
+
+    sf::Vector2f heading = mBotInput.mMove;
+    if (heading.x == 0.f && heading.y == 0.f)
+    {
+        heading.y = -1.f;
+    }
+    mBotInput.mAim = mPredicted.mPosition + heading * 200.f;
+    mBotInput.mIsFiring = std::fmod(mBotTime, 3.f) < 0.4f;
+    return mBotInput;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::Reconcile(const InputCommand & newestCommand)
+{
+    LevelManager * pLevelManager = GetGameManager().GetManager<LevelManager>();
+
+    EntityState authoritative;
+    if (!mpClient->TakePlayerState(authoritative))
+    {
+        ControlledMovementComponent::Simulate(mPredicted, GetPlayerInput(newestCommand), GetDeltaTime(newestCommand), mTuning, pLevelManager);
+        ApplyToLocalPlayer(nullptr);
+        return;
+    }
+
+    // Start from where the server had the player and step every command it has not seen yet, this frame's included
+    MovementState corrected;
+    corrected.mPosition = sf::Vector2f(DequantizePosition(authoritative.mX), DequantizePosition(authoritative.mY));
+    corrected.mVelocity = sf::Vector2f(DequantizeVelocity(authoritative.mVelocityX), DequantizeVelocity(authoritative.mVelocityY));
+    corrected.mRotation = mPredicted.mRotation;
+    for (const InputCommand & command : mpClient->GetPendingInputs())
+    {
+        ControlledMovementComponent::Simulate(corrected, GetPlayerInput(command), GetDeltaTime(command), mTuning, pLevelManager);
+    }
+
+    ControlledMovementComponent::Simulate(mPredicted, GetPlayerInput(newestCommand), GetDeltaTime(newestCommand), mTuning, pLevelManager);
+    sf::Vector2f error = corrected.mPosition - mPredicted.mPosition;
+    mLastCorrection = std::sqrt(error.x * error.x + error.y * error.y);
+    if (mLastCorrection > skReconcileTolerance)
+    {
+        mPredicted = corrected;
+    }
+
+    ApplyToLocalPlayer(&authoritative);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::ApplyToLocalPlayer(const EntityState * pAuthoritative)
+{
+    GameObject * pPlayer = mMode == ENetMode::Client ? GetLocalPlayer() : nullptr;
+    if (!pPlayer)
+    {
+        return;
+    }
+
+    if (auto pSpriteComponent = pPlayer->GetComponent<SpriteComponent>().lock())
+    {
+        pSpriteComponent->SetPosition(mPredicted.mPosition);
+        pSpriteComponent->SetRotation(mPredicted.mRotation);
+    }
+    if (auto pMovementComponent = pPlayer->GetComponent<ControlledMovementComponent>().lock())
+    {
+        pMovementComponent->SetVelocity(mPredicted.mVelocity);
+    }
+
+    // Damage is only ever dealt on the server
+    auto pHealthComponent = pPlayer->GetComponent<HealthComponent>().lock();
+    if (pAuthoritative && pHealthComponent)
+    {
+        SnapshotFormat::HealthRecord record;
+        pHealthComponent->SaveState(record);
+        record.mHealth = pAuthoritative->mHealth;
+        record.mLifeCount = pAuthoritative->mLives;
+        pHealthComponent->LoadState(record);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::UpdateProxies()
+{
+    auto & gameManager = GetGameManager();
+
+    for (const NetInterpolatedEntity & entity : mInterpolated)
+    {
+        auto it = mProxies.find(entity.mId);
+        if (it == mProxies.end())
+        {
+            it = mProxies.emplace(entity.mId, Proxy{ CreateProxy(entity), 0 }).first;
+        }
+        it->second.mSeenFrame = mFrame;
+
+        GameObject * pProxy = gameManager.GetGameObject(it->second.mHandle);
+        auto pSpriteComponent = pProxy ? pProxy->GetComponent<SpriteComponent>().lock() : nullptr;
+        if (pSpriteComponent)
+        {
+            pSpriteComponent->SetPosition(entity.mPosition);
+            pSpriteComponent->SetRotation(entity.mRotation);
+        }
+    }
+
+    for (auto it = mProxies.begin(); it != mProxies.end();)
+    {
+        if (it->second.mSeenFrame == mFrame)
+        {
+            ++it;
+            continue;
+        }
+
+        if (GameObject * pProxy = gameManager.GetGameObject(it->second.mHandle))
+        {
+            pProxy->Destroy();
+        }
+        it = mProxies.erase(it);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle NetworkManager::CreateProxy(const NetInterpolatedEntity & entity)
+{
+    auto & gameManager = GetGameManager();
+    BD::Handle proxyHandle = gameManager.CreateNewGameObject(ETeam::Neutral, gameManager.GetRootGameObjectHandle());
+    GameObject * pProxy = gameManager.GetGameObject(proxyHandle);
+    auto pSpriteComponent = pProxy ? pProxy->GetComponent<SpriteComponent>().lock() : nullptr;
+    if (!pSpriteComponent)
+    {
+        return proxyHandle;
+    }
+
+    if (entity.mArchetype == SnapshotFormat::Enemy)
+    {
+        if (auto * pEnemyAIManager = gameManager.GetManager<EnemyAIManager>())
+        {
+            pEnemyAIManager->SetUpSprite(*pSpriteComponent, EEnemy(entity.mVariant));
+        }
+        return proxyHandle;
+    }
+
+    sf::Vector2f scale;
+    ResourceId resourceId(GetProxyFile(entity.mArchetype, entity.mVariant, scale));
+    auto pTexture = gameManager.GetManager<ResourceManager>()->GetTexture(resourceId);
+    if (pTexture)
+    {
+        pSpriteComponent->SetSprite(pTexture, scale);
+    }
+    return proxyHandle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::DestroyProxies()
+{
+    auto & gameManager = GetGameManager();
+    for (auto & [netId, proxy] : mProxies)
+    {
+        if (GameObject * pProxy = gameManager.GetGameObject(proxy.mHandle))
+        {
+            pProxy->Destroy();
+        }
+    }
+    mProxies.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+GameObject * NetworkManager::GetLocalPlayer()
+{
+    auto * pPlayerManager = GetGameManager().GetManager<PlayerManager>();
+    if (!pPlayerManager || pPlayerManager->GetPlayers().empty())
+    {
+        return nullptr;
+    }
+    return GetGameManager().GetGameObject(pPlayerManager->GetPlayers().front());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Network");
+
+    static const char * skModeNames[] = { "Off", "Host", "Client", "Loopback" };
+    ImGui::Text("Mode: %s", skModeNames[int(mMode)]);
+
+    if (mMode == ENetMode::Off)
+    {
+        ImGui::InputInt("Port", &mPort);
+        ImGui::InputText("Address", mAddressText, sizeof(mAddressText));
+        if (ImGui::Button("Host"))
+        {
+            StartHost(uint16_t(mPort));
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Connect"))
+        {
+            StartClient(mAddressText, uint16_t(mPort));
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Loopback"))
+        {
+            StartLoopback();
+        }
+    }
+    else if (ImGui::Button("Stop"))
+    {
+        Stop();
+    }
+
+    ImGui::Separator();
+    NetConditions conditions = mConditions;
+    bool isChanged = ImGui::SliderFloat("Latency (ms)", &conditions.mLatencyMilliseconds, 0.f, 500.f);
+    isChanged |= ImGui::SliderFloat("Jitter (ms)", &conditions.mJitterMilliseconds, 0.f, 200.f);
+    isChanged |= ImGui::SliderFloat("Loss (%)", &conditions.mLossPercent, 0.f, 50.f);
+    if (isChanged)
+    {
+        SetConditions(conditions);
+    }
+    if (ImGui::SliderInt("Budget (B/s)", &mBandwidthBudget, 1024, 64 * 1024) && mpServer)
+    {
+        mpServer->SetBandwidthBudget(mBandwidthBudget);
+    }
+
+    if (mpServer)
+    {
+        ImGui::Separator();
+        ImGui::Text("Server tick %u, %d entities", mTick, int(mEntities.size()));
+        for (const NetServerClient & client : mpServer->GetClients())
+        {
+            ImGui::Text("Client %d %s", client.mId, client.mAddress.ToString().c_str());
+            ImGui::Text("  %d of %d relevant sent, %d deferred, %d B, %.1f KB/s", client.mLastEntitiesSent,
+                client.mLastEntitiesRelevant, client.mLastEntitiesDeferred, int(client.mLastSnapshotBytes), client.mBytesPerSecond / 1024.f);
+            ImGui::Text("  Input %u processed, %d queued, acked tick %u", client.mLastProcessedInput, int(client.mInputs.size()), client.mAckedTick);
+        }
+    }
+
+    if (mpClient)
+    {
+        NetClientStats stats = mpClient->GetStats();
+        ImGui::Separator();
+        ImGui::Text("Client %s", mpClient->IsConnected() ? "connected" : (mpClient->IsConnecting() ? "connecting" : "disconnected"));
+        ImGui::Text("RTT %.0f ms, interpolating %.0f ms behind", stats.mRoundTripMilliseconds, stats.mInterpolationDelayMilliseconds);
+        ImGui::Text("Snapshots %u received, %u dropped, %d buffered", stats.mSnapshotsReceived, stats.mSnapshotsDropped, int(stats.mBufferedSnapshots));
+        ImGui::Text("Last snapshot %d B, %.1f KB/s", int(stats.mLastSnapshotBytes), stats.mBytesPerSecond / 1024.f);
+        ImGui::Text("Pending inputs %d, last correction %.2f px", int(stats.mPendingInputs), mLastCorrection);
+
+        float delayMilliseconds = stats.mInterpolationDelayMilliseconds;
+        if (ImGui::SliderFloat("Interpolation (ms)", &delayMilliseconds, 0.f, 300.f))
+        {
+            mpClient->SetInterpolationDelay(delayMilliseconds / 1000.f);
+        }
+    }
+
+    for (NetConditioner * pConditioner : { mpConditioner.get(), mpClientConditioner.get() })
+    {
+        if (pConditioner)
+        {
+            const NetTransportStats & stats = pConditioner->GetStats();
+            ImGui::Text("Sent %u packets, %.1f KB, %u dropped", stats.mPacketsSent, stats.mBytesSent / 1024.f, stats.mPacketsDropped);
+        }
+    }
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
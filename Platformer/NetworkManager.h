@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BaseManager.h"
+#include "ControlledMovementComponent.h"
+#include "NetClient.h"
+#include "NetServer.h"
+#include "NetTransport.h"
+
+enum class ENetMode
+{
+    Off,
+    Host,       // This game is the server, remote players join it
+    Client,     // The server's world is drawn from snapshots, only the local player is simulated here
+    Loopback    // Host plus a headless client in this process, over a simulated network
+};
+
+// Co-op over UDP. The host runs the game as always and, at a fixed NetProtocol::skTickRate, hands NetServer the world
+// quantized per GameObject; each remote player is a normal player from PlayerManager with a NetInputComponent, stepped
+// with ControlledMovementComponent::Step once per command as they arrive. A client stops spawning enemies, predicts its
+// own player with ControlledMovementComponent::Simulate and replays the unacked commands on top of every
+// authoritative state, and draws everything else as sprite-only proxies interpolated a little behind the server.
+// Loopback draws the headless client's view as outlines over the host's, to see latency and loss at work.
+class NetworkManager : public BaseManager
+{
+public:
+    NetworkManager(GameManager * pGameManager);
+    ~NetworkManager();
+
+    virtual void Update(float deltaTime) override;
+    virtual void Render(sf::RenderWindow & window) override;
+    virtual void OnGameEnd() override;
+
+    bool StartHost(uint16_t port);
+    bool StartClient(const std::string & address, uint16_t port);
+    void StartLoopback();
+    void Stop();
+
+    ENetMode GetMode() const { return mMode; }
+
+    // Applies to everything this process sends, so in Loopback to both directions
+    void SetConditions(const NetConditions & conditions);
+
+    void DebugImGuiInfo();
+
+private:
+    // Server
+    void UpdateServer(float deltaTime);
+    void StepClientInputs();
+    void GatherEntities();
+    uint32_t GetNetId(BD::Handle handle);
+    void OnClientConnected(int clientId);
+    void OnClientDisconnected(int clientId);
+
+    // Client
+    void UpdateClient(float deltaTime);
+    PlayerInput GetBotInput(float deltaTime);
+    void Reconcile(const NetProtocol::InputCommand & newestCommand);
+    void ApplyToLocalPlayer(const NetProtocol::EntityState * pAuthoritative);
+    void UpdateProxies();
+    BD::Handle CreateProxy(const NetInterpolatedEntity & entity);
+    void DestroyProxies();
+    GameObject * GetLocalPlayer();
+
+    ENetMode mMode;
+    std::unique_ptr<UdpTransport> mpUdpTransport;
+    std::unique_ptr<LoopbackNetwork> mpLoopbackNetwork;
+    std::unique_ptr<LoopbackTransport> mpServerLoopback;
+    std::unique_ptr<LoopbackTransport> mpClientLoopback;
+    std::unique_ptr<NetConditioner> mpConditioner;          // The host's or the client's outgoing packets
+    std::unique_ptr<NetConditioner> mpClientConditioner;    // Loopback only, the headless client's outgoing packets
+    std::unique_ptr<NetServer> mpServer;
+    std::unique_ptr<NetClient> mpClient;
+    NetConditions mConditions;
+    int mBandwidthBudget;
+
+    // Server
+    float mTickAccumulator;
+    uint32_t mTick;
+    uint32_t mNextNetId;
+    std::unordered_map<BD::Handle, uint32_t> mNetIds;
+    std::unordered_map<BD::Handle, uint32_t> mSeenNetIds;
+    std::unordered_map<int, BD::Handle> mClientPlayers;
+    std::vector<NetProtocol::EntityState> mEntities;
+    std::vector<BD::Handle> mStack;
+
+    // Client
+    struct Proxy
+    {
+        BD::Handle mHandle;
+        uint32_t mSeenFrame;
+    };
+
+    MovementState mPredicted;
+    MovementTuning mTuning;
+    float mInputSendAccumulator;
+    float mLastCorrection;      // Pixels the last authoritative state moved the predicted player
+    uint32_t mFrame;
+    std::unordered_map<uint32_t, Proxy> mProxies;
+    std::vector<NetInterpolatedEntity> mInterpolated;
+    float mBotTime;
+    PlayerInput mBotInput;
+
+    // ImGui
+    char mAddressText[64];
+    int mPort;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,551 @@
+#include "AstroidsPrivate.h"
+#include "ParticleManager.h"
+#include "CameraManager.h"
+#include "LevelManager.h"
+#include "JobSystem.h"
+#include <xmmintrin.h>
+#include <cmath>
+
+namespace
+{
+    // Padded to a multiple of four so the SIMD loop never needs a scalar tail
+    const int skMaxParticlesPerBatch = 128 * 1024;
+    const int skMinParticlesPerJob = 4096;
+    const float skTileRestitution = 0.4f;
+    const float skPi = 3.14159265f;
+
+    const ParticleEmitterDesc skParticleDescs[int(EParticleEffect::Count)] =
+    {
+        // Thruster
+        { 140.f, 0, 0.25f, 0.45f, 60.f, 120.f, sf::Vector2f(0.f, 1.f), 25.f,
+          sf::Color(255, 200, 80, 255), sf::Color(200, 40, 10, 0), 6.f, 1.f, 2.f, nullptr, false },
+        // ImpactSparks
+        { 0.f, 24, 0.15f, 0.35f, 150.f, 320.f, sf::Vector2f(0.f, -1.f), 120.f,
+          sf::Color(255, 240, 180, 255), sf::Color(255, 120, 0, 0), 3.f, 1.f, 4.f, nullptr, true },
+        // DeathBurst
+        { 0.f, 48, 0.5f, 1.1f, 40.f, 200.f, sf::Vector2f(0.f, -1.f), 360.f,
+          sf::Color(255, 255, 255, 220), sf::Color(80, 80, 80, 0), 24.f, 48.f, 3.f, "Art/Tanks/PNG/Effects/Smoke_A.png", true },
+    };
+
+    BD::Handle PackEmitterHandle(BD::uint32 slot, BD::uint32 version)
+    {
+        return (static_cast<BD::Handle>(version) << 32) | slot;
+    }
+
+    sf::Vector2f Rotate(const sf::Vector2f & vector, float radians)
+    {
+        float cosAngle = std::cos(radians);
+        float sinAngle = std::sin(radians);
+        return sf::Vector2f(vector.x * cosAngle - vector.y * sinAngle, vector.x * sinAngle + vector.y * cosAngle);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ParticleManager::ParticleManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mBatches()
+    , mEmitters()
+    , mFreeEmitters()
+    , mRandom(std::random_device{}())
+    , mUseWorkerThreads(pGameManager->GetJobSystem().GetWorkerCount() > 0)
+{
+    for (int effect = 0; effect < int(EParticleEffect::Count); ++effect)
+    {
+        mEffectBatches[effect] = GetBatchIndex(skParticleDescs[effect]);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ParticleManager::~ParticleManager()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::Update(float deltaTime)
+{
+    UpdateEmitters(deltaTime);
+
+    JobSystem & jobSystem = GetGameManager().GetJobSystem();
+    for (auto & batch : mBatches)
+    {
+        if (batch.mCount == 0)
+        {
+            continue;
+        }
+
+        // Jobs work on whole groups of four so every chunk stays SIMD aligned
+        int groupCount = (batch.mCount + 3) / 4;
+        auto simulateGroups = [this, &batch, deltaTime](int beginGroup, int endGroup)
+            {
+                int begin = beginGroup * 4;
+                int end = endGroup * 4;
+                Simulate(batch, begin, end, deltaTime);
+                if (batch.mCollideWithTiles)
+                {
+                    CollideWithTiles(batch, begin, std::min(end, batch.mCount), deltaTime);
+                }
+            };
+
+        if (mUseWorkerThreads)
+        {
+            jobSystem.ParallelFor(groupCount, skMinParticlesPerJob / 4, simulateGroups);
+        }
+        else
+        {
+            simulateGroups(0, groupCount);
+        }
+
+        RemoveDeadParticles(batch);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::Render(sf::RenderWindow & window)
+{
+    sf::FloatRect viewBounds;
+    auto * pCameraManager = GetGameManager().GetManager<CameraManager>();
+    if (pCameraManager)
+    {
+        viewBounds = pCameraManager->GetViewBounds();
+    }
+
+    for (auto & batch : mBatches)
+    {
+        if (batch.mCount == 0)
+        {
+            continue;
+        }
+
+        sf::Vector2f textureSize;
+        if (batch.mpTexture)
+        {
+            textureSize = sf::Vector2f(batch.mpTexture->getSize());
+        }
+
+        const float * pPosX = batch.mFields[PosX].data();
+        const float * pPosY = batch.mFields[PosY].data();
+        const float * pSize = batch.mFields[Size].data();
+        const float * pR = batch.mFields[ColorR].data();
+        const float * pG = batch.mFields[ColorG].data();
+        const float * pB = batch.mFields[ColorB].data();
+        const float * pA = batch.mFields[ColorA].data();
+
+        batch.mVertices.resize(size_t(batch.mCount) * 6);
+        size_t vertexCount = 0;
+        for (int ii = 0; ii < batch.mCount; ++ii)
+        {
+            float halfSize = pSize[ii] * 0.5f;
+            float left = pPosX[ii] - halfSize;
+            float top = pPosY[ii] - halfSize;
+            float right = pPosX[ii] + halfSize;
+            float bottom = pPosY[ii] + halfSize;
+
+            if (pCameraManager && (right < viewBounds.left || left > viewBounds.left + viewBounds.width ||
+                bottom < viewBounds.top || top > viewBounds.top + viewBounds.height))
+            {
+                continue;
+            }
+
+            sf::Color color(sf::Uint8(pR[ii]), sf::Uint8(pG[ii]), sf::Uint8(pB[ii]), sf::Uint8(pA[ii]));
+            sf::Vertex * pQuad = &batch.mVertices[vertexCount];
+            pQuad[0] = sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(0.f, 0.f));
+            pQuad[1] = sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(textureSize.x, 0.f));
+            pQuad[2] = sf::Vertex(sf::Vector2f(right, bottom), color, textureSize);
+            pQuad[3] = pQuad[0];
+            pQuad[4] = pQuad[2];
+            pQuad[5] = sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(0.f, textureSize.y));
+            vertexCount += 6;
+        }
+        batch.mVertices.resize(vertexCount);
+
+        if (vertexCount > 0)
+        {
+            sf::RenderStates states(batch.mpTexture.get());
+            window.draw(batch.mVertices, states);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::OnGameEnd()
+{
+    for (auto & batch : mBatches)
+    {
+        batch.mCount = 0;
+    }
+
+    for (BD::uint32 slot = 0; slot < mEmitters.size(); ++slot)
+    {
+        DestroyEmitter(PackEmitterHandle(slot, mEmitters[slot].mVersion));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle ParticleManager::CreateEmitter(EParticleEffect effect, BD::Handle ownerHandle, const sf::Vector2f & localOffset)
+{
+    if (!GetGameManager().GetGameObject(ownerHandle))
+    {
+        return BD::Handle(0);
+    }
+    return AddEmitter(effect, ownerHandle, localOffset);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle ParticleManager::CreateEmitter(EParticleEffect effect, const sf::Vector2f & position)
+{
+    return AddEmitter(effect, BD::Handle(0), position);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::DestroyEmitter(BD::Handle handle)
+{
+    Emitter * pEmitter = GetEmitter(handle);
+    if (pEmitter)
+    {
+        pEmitter->mAlive = false;
+        ++pEmitter->mVersion; // Invalidates outstanding handles
+        mFreeEmitters.push_back(static_cast<BD::uint32>(handle & 0xFFFFFFFF));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::SetEmitterEnabled(BD::Handle handle, bool enabled)
+{
+    Emitter * pEmitter = GetEmitter(handle);
+    if (pEmitter)
+    {
+        pEmitter->mEnabled = enabled;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::Burst(EParticleEffect effect, const sf::Vector2f & position, int count, const sf::Vector2f & direction)
+{
+    const ParticleEmitterDesc & desc = skParticleDescs[int(effect)];
+    Spawn(effect, position, direction == sf::Vector2f() ? desc.mDirection : direction, count < 0 ? desc.mBurstCount : count);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::SetUseWorkerThreads(bool useWorkerThreads)
+{
+    mUseWorkerThreads = useWorkerThreads;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int ParticleManager::GetParticleCount() const
+{
+    int count = 0;
+    for (const auto & batch : mBatches)
+    {
+        count += batch.mCount;
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int ParticleManager::GetBatchIndex(const ParticleEmitterDesc & desc)
+{
+    std::shared_ptr<sf::Texture> pTexture;
+    if (desc.mpTexturePath)
+    {
+        ResourceId resourceId(desc.mpTexturePath);
+        pTexture = GetGameManager().GetManager<ResourceManager>()->GetTexture(resourceId);
+    }
+
+    for (size_t batchIndex = 0; batchIndex < mBatches.size(); ++batchIndex)
+    {
+        if (mBatches[batchIndex].mpTexture == pTexture && mBatches[batchIndex].mCollideWithTiles == desc.mCollideWithTiles)
+        {
+            return int(batchIndex);
+        }
+    }
+
+    mBatches.emplace_back();
+    Batch & batch = mBatches.back();
+    batch.mpTexture = pTexture;
+    batch.mCollideWithTiles = desc.mCollideWithTiles;
+    batch.mCount = 0;
+    batch.mVertices.setPrimitiveType(sf::Triangles);
+    for (auto & field : batch.mFields)
+    {
+        field.assign(skMaxParticlesPerBatch, 0.f);
+    }
+    return int(mBatches.size() - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle ParticleManager::AddEmitter(EParticleEffect effect, BD::Handle ownerHandle, const sf::Vector2f & offset)
+{
+    BD::uint32 slot;
+    if (!mFreeEmitters.empty())
+    {
+        slot = mFreeEmitters.back();
+        mFreeEmitters.pop_back();
+    }
+    else
+    {
+        slot = BD::uint32(mEmitters.size());
+        mEmitters.push_back(Emitter{ effect, BD::Handle(0), sf::Vector2f(), 0.f, 0, false, false });
+    }
+
+    Emitter & emitter = mEmitters[slot];
+    emitter.mEffect = effect;
+    emitter.mOwnerHandle = ownerHandle;
+    emitter.mOffset = offset;
+    emitter.mAccumulator = 0.f;
+    emitter.mAlive = true;
+    emitter.mEnabled = true;
+    ++emitter.mVersion;
+
+    return PackEmitterHandle(slot, emitter.mVersion);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+ParticleManager::Emitter * ParticleManager::GetEmitter(BD::Handle handle)
+{
+    BD::uint32 slot = static_cast<BD::uint32>(handle & 0xFFFFFFFF);
+    BD::uint32 version = static_cast<BD::uint32>((handle >> 32) & 0xFFFFFFFF);
+    if (handle == BD::Handle(0) || slot >= mEmitters.size() || !mEmitters[slot].mAlive || mEmitters[slot].mVersion != version)
+    {
+        return nullptr;
+    }
+    return &mEmitters[slot];
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::UpdateEmitters(float deltaTime)
+{
+    auto & gameManager = GetGameManager();
+    for (BD::uint32 slot = 0; slot < mEmitters.size(); ++slot)
+    {
+        Emitter & emitter = mEmitters[slot];
+        if (!emitter.mAlive)
+        {
+            continue;
+        }
+
+        const ParticleEmitterDesc & desc = skParticleDescs[int(emitter.mEffect)];
+        sf::Vector2f position = emitter.mOffset;
+        sf::Vector2f direction = desc.mDirection;
+
+        if (emitter.mOwnerHandle != BD::Handle(0))
+        {
+            GameObject * pOwner = gameManager.GetGameObject(emitter.mOwnerHandle);
+            if (!pOwner || pOwner->IsDestroyed())
+            {
+                DestroyEmitter(PackEmitterHandle(slot, emitter.mVersion));
+                continue;
+            }
+            if (!pOwner->IsActive())
+            {
+                continue;
+            }
+
+            float rotation = pOwner->GetRotationRadians();
+            position = pOwner->GetPosition() + Rotate(emitter.mOffset, rotation);
+            direction = Rotate(direction, rotation);
+        }
+
+        if (!emitter.mEnabled)
+        {
+            emitter.mAccumulator = 0.f;
+            continue;
+        }
+
+        emitter.mAccumulator += desc.mRate * deltaTime;
+        int count = int(emitter.mAccumulator);
+        emitter.mAccumulator -= float(count);
+        if (count > 0)
+        {
+            Spawn(emitter.mEffect, position, direction, count);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::Spawn(EParticleEffect effect, const sf::Vector2f & position, const sf::Vector2f & direction, int count)
+{
+    const ParticleEmitterDesc & desc = skParticleDescs[int(effect)];
+    Batch & batch = mBatches[mEffectBatches[int(effect)]];
+
+    count = std::min(count, skMaxParticlesPerBatch - batch.mCount);
+    if (count <= 0)
+    {
+        return;
+    }
+
+    std::uniform_real_distribution<float> lifetimeDist(desc.mMinLifetime, desc.mMaxLifetime);
+    std::uniform_real_distribution<float> speedDist(desc.mMinSpeed, desc.mMaxSpeed);
+    std::uniform_real_distribution<float> spreadDist(-0.5f, 0.5f);
+
+    float baseAngle = std::atan2(direction.y, direction.x);
+    float spread = desc.mSpreadDegrees * skPi / 180.f;
+
+    for (int ii = 0; ii < count; ++ii)
+    {
+        int index = batch.mCount++;
+        float angle = baseAngle + spreadDist(mRandom) * spread;
+        float speed = speedDist(mRandom);
+
+        auto & fields = batch.mFields;
+        fields[PosX][index] = position.x;
+        fields[PosY][index] = position.y;
+        fields[VelX][index] = std::cos(angle) * speed;
+        fields[VelY][index] = std::sin(angle) * speed;
+        fields[Age][index] = 0.f;
+        fields[InvLifetime][index] = 1.f / std::max(lifetimeDist(mRandom), 0.001f);
+        fields[Drag][index] = desc.mDrag;
+        fields[SizeStart][index] = desc.mStartSize;
+        fields[SizeDelta][index] = desc.mEndSize - desc.mStartSize;
+        fields[Size][index] = desc.mStartSize;
+        fields[StartR][index] = desc.mStartColor.r;
+        fields[StartG][index] = desc.mStartColor.g;
+        fields[StartB][index] = desc.mStartColor.b;
+        fields[StartA][index] = desc.mStartColor.a;
+        fields[DeltaR][index] = float(desc.mEndColor.r) - desc.mStartColor.r;
+        fields[DeltaG][index] = float(desc.mEndColor.g) - desc.mStartColor.g;
+        fields[DeltaB][index] = float(desc.mEndColor.b) - desc.mStartColor.b;
+        fields[DeltaA][index] = float(desc.mEndColor.a) - desc.mStartColor.a;
+        fields[ColorR][index] = desc.mStartColor.r;
+        fields[ColorG][index] = desc.mStartColor.g;
+        fields[ColorB][index] = desc.mStartColor.b;
+        fields[ColorA][index] = desc.mStartColor.a;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::Simulate(Batch & batch, int begin, int end, float deltaTime)
+{
+    float * pPosX = batch.mFields[PosX].data();
+    float * pPosY = batch.mFields[PosY].data();
+    float * pVelX = batch.mFields[VelX].data();
+    float * pVelY = batch.mFields[VelY].data();
+    float * pAge = batch.mFields[Age].data();
+    const float * pInvLifetime = batch.mFields[InvLifetime].data();
+    const float * pDrag = batch.mFields[Drag].data();
+    const float * pSizeStart = batch.mFields[SizeStart].data();
+    const float * pSizeDelta = batch.mFields[SizeDelta].data();
+    float * pSize = batch.mFields[Size].data();
+
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int ii = begin; ii < end; ii += 4)
+    {
+        __m128 age = _mm_add_ps(_mm_loadu_ps(pAge + ii), dt);
+        _mm_storeu_ps(pAge + ii, age);
+
+        __m128 damping = _mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(pDrag + ii), dt)), zero);
+        __m128 velX = _mm_mul_ps(_mm_loadu_ps(pVelX + ii), damping);
+        __m128 velY = _mm_mul_ps(_mm_loadu_ps(pVelY + ii), damping);
+        _mm_storeu_ps(pVelX + ii, velX);
+        _mm_storeu_ps(pVelY + ii, velY);
+        _mm_storeu_ps(pPosX + ii, _mm_add_ps(_mm_loadu_ps(pPosX + ii), _mm_mul_ps(velX, dt)));
+        _mm_storeu_ps(pPosY + ii, _mm_add_ps(_mm_loadu_ps(pPosY + ii), _mm_mul_ps(velY, dt)));
+
+        // Normalized age drives every over-lifetime curve
+        __m128 t = _mm_min_ps(_mm_mul_ps(age, _mm_loadu_ps(pInvLifetime + ii)), one);
+        _mm_storeu_ps(pSize + ii, _mm_add_ps(_mm_loadu_ps(pSizeStart + ii), _mm_mul_ps(_mm_loadu_ps(pSizeDelta + ii), t)));
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            const float * pStart = batch.mFields[StartR + channel].data();
+            const float * pDelta = batch.mFields[DeltaR + channel].data();
+            float * pColor = batch.mFields[ColorR + channel].data();
+            _mm_storeu_ps(pColor + ii, _mm_add_ps(_mm_loadu_ps(pStart + ii), _mm_mul_ps(_mm_loadu_ps(pDelta + ii), t)));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::CollideWithTiles(Batch & batch, int begin, int end, float deltaTime)
+{
+    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
+    if (!pLevelManager)
+    {
+        return;
+    }
+
+    float * pPosX = batch.mFields[PosX].data();
+    float * pPosY = batch.mFields[PosY].data();
+    float * pVelX = batch.mFields[VelX].data();
+    float * pVelY = batch.mFields[VelY].data();
+    const float invCellSize = 1.f / BD::gsPixelCountCellSize;
+
+    for (int ii = begin; ii < end; ++ii)
+    {
+        int tileX = int(pPosX[ii] * invCellSize);
+        int tileY = int(pPosY[ii] * invCellSize);
+        if (pLevelManager->IsTileWalkablePlayer(tileX, tileY))
+        {
+            continue;
+        }
+
+        // Step back to last frame's position and bounce off whichever axis crossed into the wall
+        float oldX = pPosX[ii] - pVelX[ii] * deltaTime;
+        float oldY = pPosY[ii] - pVelY[ii] * deltaTime;
+        int oldTileX = int(oldX * invCellSize);
+        int oldTileY = int(oldY * invCellSize);
+
+        if (!pLevelManager->IsTileWalkablePlayer(tileX, oldTileY))
+        {
+            pVelX[ii] = -pVelX[ii] * skTileRestitution;
+        }
+        if (!pLevelManager->IsTileWalkablePlayer(oldTileX, tileY))
+        {
+            pVelY[ii] = -pVelY[ii] * skTileRestitution;
+        }
+        pPosX[ii] = oldX;
+        pPosY[ii] = oldY;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ParticleManager::RemoveDeadParticles(Batch & batch)
+{
+    const float * pAge = batch.mFields[Age].data();
+    const float * pInvLifetime = batch.mFields[InvLifetime].data();
+
+    // Walk backwards so the swap-remove never skips an element
+    for (int ii = batch.mCount - 1; ii >= 0; --ii)
+    {
+        if (pAge[ii] * pInvLifetime[ii] < 1.f)
+        {
+            continue;
+        }
+
+        int last = --batch.mCount;
+        if (ii != last)
+        {
+            for (auto & field : batch.mFields)
+            {
+                field[ii] = field[last];
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
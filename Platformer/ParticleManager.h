@@ -0,0 +1,112 @@
+#pragma once
+#include "BaseManager.h"
+#include <random>
+#include <vector>
+
+enum class EParticleEffect
+{
+    Thruster,
+    ImpactSparks,
+    DeathBurst,
+    Count
+};
+
+struct ParticleEmitterDesc
+{
+    float mRate;                // Particles per second for continuous emitters
+    int mBurstCount;            // Default count for Burst()
+    float mMinLifetime;
+    float mMaxLifetime;
+    float mMinSpeed;
+    float mMaxSpeed;
+    sf::Vector2f mDirection;    // Local space, rotated by the owner for attached emitters
+    float mSpreadDegrees;
+    sf::Color mStartColor;
+    sf::Color mEndColor;
+    float mStartSize;
+    float mEndSize;
+    float mDrag;
+    const char * mpTexturePath; // nullptr draws flat colored quads
+    bool mCollideWithTiles;
+};
+
+// CPU particles that never touch a GameObject. Particles sharing a texture and collision mode live in one batch of SoA
+// float arrays that are integrated four at a time with SSE, optionally split across the JobSystem, and every batch is
+// drawn with a single vertex array. Emitters are either free-standing or follow a GameObject handle and die with it.
+class ParticleManager : public BaseManager
+{
+public:
+    ParticleManager(GameManager * pGameManager);
+    ~ParticleManager();
+
+    virtual void Update(float deltaTime) override;
+    virtual void Render(sf::RenderWindow & window) override;
+    virtual void OnGameEnd() override;
+
+    BD::Handle CreateEmitter(EParticleEffect effect, BD::Handle ownerHandle, const sf::Vector2f & localOffset);
+    BD::Handle CreateEmitter(EParticleEffect effect, const sf::Vector2f & position);
+    void DestroyEmitter(BD::Handle handle);
+    void SetEmitterEnabled(BD::Handle handle, bool enabled);
+
+    // Direction of zero uses the effect's own direction
+    void Burst(EParticleEffect effect, const sf::Vector2f & position, int count = -1, const sf::Vector2f & direction = sf::Vector2f());
+
+    void SetUseWorkerThreads(bool useWorkerThreads);
+    int GetParticleCount() const;
+
+private:
+    enum EField
+    {
+        PosX, PosY,
+        VelX, VelY,
+        Age, InvLifetime, Drag,
+        SizeStart, SizeDelta, Size,
+        StartR, StartG, StartB, StartA,
+        DeltaR, DeltaG, DeltaB, DeltaA,
+        ColorR, ColorG, ColorB, ColorA,
+        FieldCount
+    };
+
+    struct Batch
+    {
+        std::shared_ptr<sf::Texture> mpTexture;
+        bool mCollideWithTiles;
+        int mCount;
+        std::vector<float> mFields[FieldCount];
+        sf::VertexArray mVertices;
+    };
+
+    struct Emitter
+    {
+        EParticleEffect mEffect;
+        BD::Handle mOwnerHandle;
+        sf::Vector2f mOffset;
+        float mAccumulator;
+        BD::uint32 mVersion;
+        bool mAlive;
+        bool mEnabled;
+    };
+
+    int GetBatchIndex(const ParticleEmitterDesc & desc);
+    BD::Handle AddEmitter(EParticleEffect effect, BD::Handle ownerHandle, const sf::Vector2f & offset);
+    Emitter * GetEmitter(BD::Handle handle);
+    void UpdateEmitters(float deltaTime);
+    void Spawn(EParticleEffect effect, const sf::Vector2f & position, const sf::Vector2f & direction, int count);
+
+    void Simulate(Batch & batch, int begin, int end, float deltaTime);
+    void CollideWithTiles(Batch & batch, int begin, int end, float deltaTime);
+    void RemoveDeadParticles(Batch & batch);
+
+    std::vector<Batch> mBatches;
+    int mEffectBatches[int(EParticleEffect::Count)];
+
+    std::vector<Emitter> mEmitters;
+    std::vector<BD::uint32> mFreeEmitters;
+
+    std::mt19937 mRandom;
+    bool mUseWorkerThreads;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
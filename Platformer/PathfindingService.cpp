@@ -0,0 +1,408 @@
+#include "AstroidsPrivate.h"
+#include "PathfindingService.h"
+#include "LevelManager.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    const int skDefaultExpansionBudget = 4000;
+    const size_t skCacheCapacity = 128;
+
+    // Requests spanning more tiles than this on either axis go through the hierarchy
+    const int skHierarchicalDistance = 64;
+
+    // Tiles a hierarchical request hands back at once, and what a query is charged against the slice budget
+    const size_t skPartialPathLength = 32;
+    const int skHierarchicalQueryCost = 1000;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+PathfindingService::PathfindingService(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mSearch()
+    , mActiveRequest()
+    , mSearchActive(false)
+    , mWalkable()
+    , mHierarchicalPathfinder()
+    , mHierarchyStale(true)
+    , mMutex()
+    , mSliceDone()
+    , mSliceRunning(false)
+    , mPendingRequests()
+    , mResults()
+    , mCancelledTickets()
+    , mChangedTiles()
+    , mActiveTicket(gsInvalidPathTicket)
+    , mCache()
+    , mCacheLookup()
+    , mNextTicket(gsInvalidPathTicket + 1)
+    , mExpansionBudget(skDefaultExpansionBudget)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+PathfindingService::~PathfindingService()
+{
+    WaitForSlice();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::Update(float deltaTime)
+{
+    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
+    if (!pLevelManager)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mSliceRunning)
+    {
+        return;
+    }
+
+    // A different level makes the search in progress and every cached path meaningless. No slice is running here,
+    // so the worker side state is safe to touch.
+    const BitGridView & walkable = pLevelManager->GetLayer(LevelFormat::WalkableAI);
+    if (walkable.GetRowWords(0) != mWalkable.GetRowWords(0) || walkable.GetWidth() != mWalkable.GetWidth() ||
+        walkable.GetHeight() != mWalkable.GetHeight())
+    {
+        mWalkable = walkable;
+        mHierarchyStale = true;
+        mChangedTiles.clear();
+        mCache.clear();
+        mCacheLookup.clear();
+        if (mSearchActive)
+        {
+            mPendingRequests.push_front(mActiveRequest);
+            mActiveTicket = gsInvalidPathTicket;
+            mSearchActive = false;
+        }
+    }
+
+    if (mWalkable.IsEmpty() || (mPendingRequests.empty() && !mSearchActive))
+    {
+        return;
+    }
+    mSliceRunning = true;
+    lock.unlock();
+
+    int expansionBudget = mExpansionBudget;
+    GetGameManager().GetJobSystem().Submit([this, expansionBudget]() { RunSlice(expansionBudget); });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::OnGameEnd()
+{
+    WaitForSlice();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPendingRequests.clear();
+    mResults.clear();
+    mCancelledTickets.clear();
+    mActiveTicket = gsInvalidPathTicket;
+    mSearchActive = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::OnLevelUnloading()
+{
+    WaitForSlice();
+
+    // An empty view never matches the next level, even one that lands at the same address with the same size
+    std::lock_guard<std::mutex> lock(mMutex);
+    mWalkable = BitGridView();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+PathTicket PathfindingService::RequestPath(const sf::Vector2i & start, const sf::Vector2i & goal)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    PathTicket ticket = mNextTicket++;
+    if (mNextTicket == gsInvalidPathTicket)
+    {
+        ++mNextTicket;
+    }
+
+    PathResult result;
+    if (FindCachedPath(MakeCacheKey(start, goal), result.mPath))
+    {
+        result.mStatus = EPathStatus::Ready;
+        mResults.emplace(ticket, std::move(result));
+        return ticket;
+    }
+
+    mPendingRequests.push_back({ ticket, start, goal });
+    return ticket;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+EPathStatus PathfindingService::PollPath(PathTicket ticket, std::vector<sf::Vector2i> & outPath)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mResults.find(ticket);
+    if (it != mResults.end())
+    {
+        EPathStatus status = it->second.mStatus;
+        outPath = std::move(it->second.mPath);
+        mResults.erase(it);
+        return status;
+    }
+
+    if (ticket == mActiveTicket)
+    {
+        return EPathStatus::Pending;
+    }
+
+    auto pending = std::find_if(mPendingRequests.begin(), mPendingRequests.end(),
+        [ticket](const PathRequest & request) { return request.mTicket == ticket; });
+    return pending != mPendingRequests.end() ? EPathStatus::Pending : EPathStatus::Unknown;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::CancelPath(PathTicket ticket)
+{
+    if (ticket == gsInvalidPathTicket)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mResults.erase(ticket) > 0)
+    {
+        return;
+    }
+
+    auto pending = std::find_if(mPendingRequests.begin(), mPendingRequests.end(),
+        [ticket](const PathRequest & request) { return request.mTicket == ticket; });
+    if (pending != mPendingRequests.end())
+    {
+        mPendingRequests.erase(pending);
+        return;
+    }
+
+    // Still being searched, drop the result when it lands
+    if (ticket == mActiveTicket)
+    {
+        mCancelledTickets.insert(ticket);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::MarkTilesChanged(const sf::IntRect & tiles)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mChangedTiles.push_back(tiles);
+    mCache.clear();
+    mCacheLookup.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::SetExpansionBudget(int expansionsPerFrame)
+{
+    mExpansionBudget = std::max(1, expansionsPerFrame);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int PathfindingService::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return int(mPendingRequests.size()) + (mActiveTicket != gsInvalidPathTicket ? 1 : 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::RunSlice(int expansionBudget)
+{
+    std::vector<sf::Vector2i> path;
+    while (expansionBudget > 0)
+    {
+        if (!mSearchActive)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (mPendingRequests.empty())
+            {
+                break;
+            }
+            mActiveRequest = mPendingRequests.front();
+            mPendingRequests.pop_front();
+
+            // An earlier request in the queue may have found this exact path already. The result goes in under the same
+            // lock the request came out under, so a CancelPath always finds the ticket in one place or the other.
+            uint64_t cacheKey = MakeCacheKey(mActiveRequest.mStart, mActiveRequest.mGoal);
+            if (FindCachedPath(cacheKey, path))
+            {
+                mResults[mActiveRequest.mTicket] = { EPathStatus::Ready, std::move(path) };
+                continue;
+            }
+            mActiveTicket = mActiveRequest.mTicket;
+
+            if (IsFarRequest(mActiveRequest))
+            {
+                std::vector<sf::IntRect> changedTiles;
+                changedTiles.swap(mChangedTiles);
+                lock.unlock();
+
+                for (const sf::IntRect & tiles : changedTiles)
+                {
+                    mHierarchicalPathfinder.MarkDirty(tiles);
+                }
+                EPathStatus status = FindPartialPath(mActiveRequest, path);
+                expansionBudget -= skHierarchicalQueryCost;
+                Publish(mActiveRequest.mTicket, cacheKey, status, path);
+                continue;
+            }
+            lock.unlock();
+
+            mSearch.Begin(mWalkable, mActiveRequest.mStart, mActiveRequest.mGoal);
+            mSearchActive = true;
+        }
+
+        int expansions = 0;
+        ESearchStatus status = mSearch.Step(expansionBudget, expansions);
+        expansionBudget -= expansions;
+        if (status == ESearchStatus::Running)
+        {
+            break;
+        }
+
+        mSearchActive = false;
+        mSearch.GetPath(path);
+        Publish(mActiveRequest.mTicket, MakeCacheKey(mActiveRequest.mStart, mActiveRequest.mGoal),
+            status == ESearchStatus::Found ? EPathStatus::Ready : EPathStatus::Failed, path);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mSliceRunning = false;
+    }
+    mSliceDone.notify_all();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool PathfindingService::IsFarRequest(const PathRequest & request) const
+{
+    return std::abs(request.mGoal.x - request.mStart.x) > skHierarchicalDistance ||
+        std::abs(request.mGoal.y - request.mStart.y) > skHierarchicalDistance;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+EPathStatus PathfindingService::FindPartialPath(const PathRequest & request, std::vector<sf::Vector2i> & outPath)
+{
+    if (mHierarchyStale)
+    {
+        mHierarchicalPathfinder.Build(mWalkable);
+        mHierarchyStale = false;
+    }
+
+    outPath.clear();
+    HierarchicalPath route;
+    if (!mHierarchicalPathfinder.FindPath(request.mStart, request.mGoal, route))
+    {
+        return EPathStatus::Failed;
+    }
+
+    // Same layout GridPathSearch::GetPath uses, starting on the start tile
+    outPath.push_back(request.mStart);
+    while (outPath.size() < skPartialPathLength && !route.IsComplete())
+    {
+        if (!mHierarchicalPathfinder.RefineNextSegment(route, outPath))
+        {
+            return EPathStatus::Failed;
+        }
+    }
+    return EPathStatus::Ready;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::WaitForSlice()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSliceDone.wait(lock, [this]() { return !mSliceRunning; });
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::Publish(PathTicket ticket, uint64_t cacheKey, EPathStatus status, std::vector<sf::Vector2i> & path)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (status == EPathStatus::Ready)
+    {
+        CachePath(cacheKey, path);
+    }
+
+    if (ticket == mActiveTicket)
+    {
+        mActiveTicket = gsInvalidPathTicket;
+    }
+
+    if (mCancelledTickets.erase(ticket) > 0)
+    {
+        return;
+    }
+    mResults[ticket] = { status, std::move(path) };
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint64_t PathfindingService::MakeCacheKey(const sf::Vector2i & start, const sf::Vector2i & goal) const
+{
+    auto cellIndex = [this](const sf::Vector2i & tile) { return uint32_t(tile.y * mWalkable.GetWidth() + tile.x); };
+    return (uint64_t(cellIndex(start)) << 32) | cellIndex(goal);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool PathfindingService::FindCachedPath(uint64_t cacheKey, std::vector<sf::Vector2i> & outPath)
+{
+    auto it = mCacheLookup.find(cacheKey);
+    if (it == mCacheLookup.end())
+    {
+        return false;
+    }
+
+    mCache.splice(mCache.begin(), mCache, it->second);
+    outPath = it->second->second;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PathfindingService::CachePath(uint64_t cacheKey, const std::vector<sf::Vector2i> & path)
+{
+    auto it = mCacheLookup.find(cacheKey);
+    if (it != mCacheLookup.end())
+    {
+        mCache.splice(mCache.begin(), mCache, it->second);
+        return;
+    }
+
+    mCache.emplace_front(cacheKey, path);
+    mCacheLookup[cacheKey] = mCache.begin();
+    if (mCache.size() > skCacheCapacity)
+    {
+        mCacheLookup.erase(mCache.back().first);
+        mCache.pop_back();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
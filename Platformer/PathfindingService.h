@@ -0,0 +1,110 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "BaseManager.h"
+#include "GridPathSearch.h"
+#include "HierarchicalPathfinder.h"
+
+enum class EPathStatus
+{
+    Pending,
+    Ready,
+    Failed,
+    Unknown     // Never requested, already collected or cancelled
+};
+
+using PathTicket = uint32_t;
+const PathTicket gsInvalidPathTicket = 0;
+
+// Point to point paths over the AI walkable layer, resolved off the main thread. Requests queue up and once a frame a
+// slice of at most mExpansionBudget jump point expansions runs on the JobSystem. A search that does not fit carries
+// over to the next slice. Found paths also go into a small LRU cache keyed by (start, goal), and repeated requests are
+// answered from it straight away. Far apart start and goal go through a HierarchicalPathfinder instead, and only the
+// first stretch of that route is turned into tiles. Callers ask again once they reach the end of it.
+class PathfindingService : public BaseManager
+{
+public:
+    PathfindingService(GameManager * pGameManager);
+    ~PathfindingService();
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    // Waits out the slice in flight and forgets the level, so the next Update starts over on whatever replaces it
+    virtual void OnLevelUnloading() override;
+
+    PathTicket RequestPath(const sf::Vector2i & start, const sf::Vector2i & goal);
+
+    // Ready and Failed hand over the result and retire the ticket
+    EPathStatus PollPath(PathTicket ticket, std::vector<sf::Vector2i> & outPath);
+    void CancelPath(PathTicket ticket);
+
+    // Walkability changed inside these tiles, the hierarchy rebuilds the clusters they touch before its next query
+    void MarkTilesChanged(const sf::IntRect & tiles);
+
+    void SetExpansionBudget(int expansionsPerFrame);
+    int GetPendingCount();
+
+    // Blocks until the slice in flight, if any, is done. Anything that writes the walkable layer in place calls this
+    // first.
+    void WaitForSlice();
+
+private:
+    struct PathRequest
+    {
+        PathTicket mTicket;
+        sf::Vector2i mStart;
+        sf::Vector2i mGoal;
+    };
+
+    struct PathResult
+    {
+        EPathStatus mStatus;
+        std::vector<sf::Vector2i> mPath;
+    };
+
+    using CacheEntry = std::pair<uint64_t, std::vector<sf::Vector2i>>;
+
+    void RunSlice(int expansionBudget);
+    bool IsFarRequest(const PathRequest & request) const;
+    EPathStatus FindPartialPath(const PathRequest & request, std::vector<sf::Vector2i> & outPath);
+    void Publish(PathTicket ticket, uint64_t cacheKey, EPathStatus status, std::vector<sf::Vector2i> & path);
+    uint64_t MakeCacheKey(const sf::Vector2i & start, const sf::Vector2i & goal) const;
+
+    // Callers hold mMutex
+    bool FindCachedPath(uint64_t cacheKey, std::vector<sf::Vector2i> & outPath);
+    void CachePath(uint64_t cacheKey, const std::vector<sf::Vector2i> & path);
+
+    // Only touched by the slice in flight, or by the main thread while no slice is running
+    GridPathSearch mSearch;
+    PathRequest mActiveRequest;
+    bool mSearchActive;
+    BitGridView mWalkable;
+    HierarchicalPathfinder mHierarchicalPathfinder;
+    bool mHierarchyStale;
+
+    std::mutex mMutex;
+    std::condition_variable mSliceDone;
+    bool mSliceRunning;
+    std::deque<PathRequest> mPendingRequests;
+    std::unordered_map<PathTicket, PathResult> mResults;
+    std::unordered_set<PathTicket> mCancelledTickets;
+    std::vector<sf::IntRect> mChangedTiles;
+    PathTicket mActiveTicket;
+
+    std::list<CacheEntry> mCache;
+    std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> mCacheLookup;
+
+    PathTicket mNextTicket;
+    int mExpansionBudget;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
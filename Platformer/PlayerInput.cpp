@@ -0,0 +1,31 @@
+#include "AstroidsPrivate.h"
+#include "PlayerInput.h"
+#include "CameraManager.h"
+#include "InputManager.h"
+
+PlayerInput SampleLocalPlayerInput(GameManager & gameManager)
+{
+    PlayerInput input;
+    auto * pInputManager = gameManager.GetManager<InputManager>();
+    if (!pInputManager)
+    {
+        return input;
+    }
+
+    const InputSnapshot & snapshot = pInputManager->GetSnapshot();
+    if (snapshot.IsDown(EAction::MoveUp)) input.mMove.y -= 1.f;
+    if (snapshot.IsDown(EAction::MoveDown)) input.mMove.y += 1.f;
+    if (snapshot.IsDown(EAction::MoveLeft)) input.mMove.x -= 1.f;
+    if (snapshot.IsDown(EAction::MoveRight)) input.mMove.x += 1.f;
+
+    if (auto * pCameraManager = gameManager.GetManager<CameraManager>())
+    {
+        input.mAim = pCameraManager->GetCrosshairPosition();
+    }
+    input.mIsFiring = snapshot.IsDown(EAction::Fire);
+    return input;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
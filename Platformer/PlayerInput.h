@@ -0,0 +1,20 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+
+class GameManager;
+
+// What a player asks for in one frame. Read from the local keyboard and mouse, or for players driven over the network
+// from their NetInputComponent.
+struct PlayerInput
+{
+    sf::Vector2f mMove;         // Each axis -1, 0 or 1
+    sf::Vector2f mAim;          // World position of the crosshair
+    bool mIsFiring = false;
+};
+
+// From this tick's InputManager snapshot
+PlayerInput SampleLocalPlayerInput(GameManager & gameManager);
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
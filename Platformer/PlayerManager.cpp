@@ -5,30 +5,23 @@
 #include "ProjectileComponent.h"
 #include "HealthComponent.h"
 #include "CollisionComponent.h"
-#include "ExplosionComponent.h"
+#include "EffectsManager.h"
 #include <cassert>
 #include "ResourceManager.h"
 #include "CameraManager.h"
+#include "AudioManager.h"
+#include "ParticleManager.h"
 
 static int sPlayerHealth = 100;
 
 PlayerManager::PlayerManager(GameManager * pGameManager)
     : BaseManager(pGameManager)
     , mPlayerHandles()
+    , mDeathEffect(0)
+    , mThrusterEmitter(0)
     , mSoundPlayed(false)
 {
     InitPlayer();
-
-    // Sound
-    {
-        mLoseLifeSoundBuffer.loadFromFile("Audio/LoseLifeSound.wav");
-        mLoseLifeSound.setBuffer(mLoseLifeSoundBuffer);
-        mLoseLifeSound.setVolume(100.f);
-        
-        mDeathSoundBuffer.loadFromFile("Audio/Death.flac");
-        mDeathSound.setBuffer(mDeathSoundBuffer);
-        mDeathSound.setVolume(50.f);
-    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -39,7 +32,7 @@ PlayerManager::~PlayerManager()
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void PlayerManager::InitPlayer()
+BD::Handle PlayerManager::InitPlayer()
 {
     auto & gameManager = GetGameManager();
     BD::Handle playerHandle = gameManager.CreateNewGameObject(ETeam::Player, gameManager.GetRootGameObjectHandle());
@@ -111,6 +104,8 @@ void PlayerManager::InitPlayer()
             ));
         }
     }
+
+    return playerHandle;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -130,14 +125,15 @@ void PlayerManager::Update(float deltaTime)
         {
             GameObject * pPlayer = gameManager.GetGameObject(playerHandle);
 
-            // Destroy the player after the explosion animation finishes
-            auto explosionComp = pPlayer->GetComponent<ExplosionComponent>().lock();
-            if (explosionComp && explosionComp->IsAnimationFinished())
+            // Destroy the player after the death explosion finishes
+            if (!pPlayer->IsActive() && !gameManager.GetManager<EffectsManager>()->IsPlaying(mDeathEffect))
             {
                 pPlayer->Destroy();
                 return;
             }
 
+            UpdateThruster(pPlayer);
+
             auto pHealthComp = pPlayer->GetComponent<HealthComponent>().lock();
 
             if (pHealthComp)
@@ -167,11 +163,6 @@ void PlayerManager::Update(float deltaTime)
                 }
             }
         }
-
-        if (mLoseLifeSound.getStatus() == sf::Sound::Stopped)
-        {
-            mSoundPlayed = false;
-        }
     }
 }
 
@@ -180,6 +171,43 @@ void PlayerManager::Update(float deltaTime)
 void PlayerManager::OnGameEnd()
 {
     mPlayerHandles.clear();
+    mDeathEffect = BD::Handle(0);
+    mThrusterEmitter = BD::Handle(0);
+    mSoundPlayed = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PlayerManager::OnGameStart()
+{
+    InitPlayer();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void PlayerManager::UpdateThruster(GameObject * pPlayer)
+{
+    auto * pParticleManager = GetGameManager().GetManager<ParticleManager>();
+    if (!pParticleManager)
+    {
+        return;
+    }
+
+    // ParticleManager is created after us, so the emitter is attached on the first update instead of in InitPlayer
+    if (mThrusterEmitter == BD::Handle(0))
+    {
+        sf::Vector2f exhaustOffset(0.f, pPlayer->GetSize().y * 0.5f);
+        mThrusterEmitter = pParticleManager->CreateEmitter(EParticleEffect::Thruster, pPlayer->GetHandle(), exhaustOffset);
+    }
+
+    bool isMoving = false;
+    auto pMovementComponent = pPlayer->GetComponent<ControlledMovementComponent>().lock();
+    if (pMovementComponent)
+    {
+        sf::Vector2f velocity = pMovementComponent->GetVelocity();
+        isMoving = (velocity.x * velocity.x + velocity.y * velocity.y) > 1.f;
+    }
+    pParticleManager->SetEmitterEnabled(mThrusterEmitter, isMoving);
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -188,7 +216,7 @@ void PlayerManager::OnPlayerLostLife(GameObject * pPlayer)
 {
     if (!mSoundPlayed)
     {
-        mLoseLifeSound.play();
+        GetGameManager().GetManager<AudioManager>()->PlaySound(ESound::LoseLife);
     }
 }
 
@@ -198,16 +226,23 @@ void PlayerManager::OnPlayerDeath(GameObject * pPlayer)
 {
     if (!mSoundPlayed)
     {
-        mDeathSound.play();
+        GetGameManager().GetManager<AudioManager>()->PlaySound(ESound::Death);
         mSoundPlayed = true;
     }
 
-    // Add the explosion animation here
-    if (!pPlayer->GetComponent<ExplosionComponent>().lock())
+    auto & gameManager = GetGameManager();
+    if (!gameManager.GetManager<EffectsManager>()->IsPlaying(mDeathEffect))
+    {
+        ResourceId clipId("Explosion");
+        mDeathEffect = gameManager.GetManager<EffectsManager>()->PlayEffect(clipId, pPlayer->GetPosition(), sf::Vector2f(2.f, 2.f));
+        gameManager.GetManager<AudioManager>()->PlaySound(ESound::Explosion, pPlayer->GetPosition());
+    }
+
+    // The player lingers (inactive) until the explosion ends but stops colliding now
+    auto pCollisionComp = pPlayer->GetComponent<CollisionComponent>().lock();
+    if (pCollisionComp)
     {
-        auto explosionComp = std::make_shared<ExplosionComponent>(
-            pPlayer, GetGameManager(), "Art/explosion.png", 32, 32, 7, 0.1f, sf::Vector2f(2.f, 2.f), pPlayer->GetPosition());
-        pPlayer->AddComponent(explosionComp);
+        pCollisionComp->DestroyBody();
     }
 }
 
@@ -7,10 +7,11 @@ public:
     PlayerManager(GameManager * pGameManager);
     ~PlayerManager();
 
-    void InitPlayer();
+    BD::Handle InitPlayer();
 
     virtual void Update(float deltaTime) override;
     virtual void OnGameEnd() override;
+    virtual void OnGameStart() override;
 
     void OnPlayerLostLife(GameObject * pPlayer);
 
@@ -19,12 +20,10 @@ public:
     const std::vector<BD::Handle> & GetPlayers() const;
 
 private:
-    std::vector<BD::Handle> mPlayerHandles;
+    void UpdateThruster(GameObject * pPlayer);
 
-    // Audio
-    sf::SoundBuffer mLoseLifeSoundBuffer;
-    sf::SoundBuffer mDeathSoundBuffer;
-    sf::Sound mLoseLifeSound;
-    sf::Sound mDeathSound;
+    std::vector<BD::Handle> mPlayerHandles;
+    BD::Handle mDeathEffect;
+    BD::Handle mThrusterEmitter;
     bool mSoundPlayed;
 };
@@ -11,6 +11,7 @@
 #include "PlayerManager.h"
 #include "ResourceManager.h"
 #include "CameraManager.h"
+#include "NetInputComponent.h"
 #include "imgui.h"
 
 ProjectileComponent::ProjectileComponent(GameObject * pOwner, GameManager & gameManager)
@@ -20,7 +21,6 @@ ProjectileComponent::ProjectileComponent(GameObject * pOwner, GameManager & game
 	, mCooldown(.2f)
 	, mTimeSinceLastShot(1.f)
 	, mLastUsedProjectile(EProjectileType::GreenLaser)
-	, mName("ProjectileComponent")
 {
 
 }
@@ -52,71 +52,157 @@ std::string ProjectileComponent::GetCorrectProjectileFile()
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void ProjectileComponent::Shoot()
+std::string ProjectileComponent::GetProjectileFile(EProjectileType type)
+{
+	return type == EProjectileType::RedLaser ? "Art/laserRed.png" : "Art/laserGreen.png";
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void ProjectileComponent::Shoot(const sf::Vector2f & aimPosition)
+{
+	GameObject * pOwnerGameObj = GetGameManager().GetGameObject(mOwnerHandle);
+	if (!pOwnerGameObj)
+	{
+		return;
+	}
+
+	// Alternates between the two lasers
+	GetCorrectProjectileFile();
+
+	// Get ship's position, size
+	sf::Vector2f playerPosition = pOwnerGameObj->GetPosition();
+	sf::Vector2f playerSize = pOwnerGameObj->GetSize();
+
+	// Calculate edge offset
+	sf::Vector2f offset;
+	if (mLastUsedProjectile == EProjectileType::RedLaser)
+	{
+		offset = sf::Vector2f(playerSize.y / 2.f, 0);
+	}
+	else
+	{
+		offset = sf::Vector2f(-playerSize.y / 2.f, 0);
+	}
+
+	sf::Vector2f spawnPosition = playerPosition + offset;
+
+	sf::Vector2f direction = aimPosition - spawnPosition;
+	float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length != 0)
+	{
+		direction /= length; // Normalize
+	}
+
+	BD::Handle projectileHandle = SpawnProjectile(mLastUsedProjectile, spawnPosition, direction);
+	if (projectileHandle != BD::Handle(0))
+	{
+		mProjectiles.push_back({ projectileHandle, 3.f, 15, direction, mLastUsedProjectile });
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle ProjectileComponent::SpawnProjectile(EProjectileType type, const sf::Vector2f & position, const sf::Vector2f & direction)
 {
 	GameManager & gameManager = GetGameManager();
 	BD::Handle projectileHandle = gameManager.CreateNewGameObject(ETeam::Friendly, mOwnerHandle);
 	GameObject * pProjectile = gameManager.GetGameObject(projectileHandle);
-	GameObject * pOwnerGameObj = gameManager.GetGameObject(mOwnerHandle);
-
-	if (!pProjectile || !pOwnerGameObj)
+	if (!pProjectile)
 	{
-		return;
+		return BD::Handle(0);
 	}
 
 	auto pProjectileSpriteComponent = pProjectile->GetComponent<SpriteComponent>().lock();
-	if (pProjectileSpriteComponent)
+	if (!pProjectileSpriteComponent)
 	{
-		auto file = GetCorrectProjectileFile();
-		ResourceId resourceId(file);
-		auto pTexture = GetGameManager().GetManager<ResourceManager>()->GetTexture(resourceId);
+		pProjectile->Destroy();
+		return BD::Handle(0);
+	}
 
-		pProjectileSpriteComponent->SetSprite(pTexture, sf::Vector2f(1.05f, 1.05f));
+	ResourceId resourceId(GetProjectileFile(type));
+	auto pTexture = gameManager.GetManager<ResourceManager>()->GetTexture(resourceId);
+	pProjectileSpriteComponent->SetSprite(pTexture, sf::Vector2f(1.05f, 1.05f));
+
+	// Calculate angle in degrees
+	float angleDegrees = std::atan2(direction.y, direction.x) * (180.f / 3.14159265f);
+
+	// Set projectile position and rotation
+	pProjectileSpriteComponent->SetPosition(position);
+	pProjectileSpriteComponent->SetRotation(angleDegrees + 90.f); // Adjust rotation for sprite alignment
+
+	// Add collision
+	pProjectile->CreatePhysicsBody(&gameManager.GetPhysicsWorld(), pProjectile->GetSize(), true);
+	auto pCollisionComponent = std::make_shared<CollisionComponent>(
+		pProjectile,
+		gameManager,
+		&gameManager.GetPhysicsWorld(),
+		pProjectile->GetPhysicsBody(),
+		pProjectile->GetSize(),
+		true
+	);
+	pProjectile->AddComponent(pCollisionComponent);
+
+	return projectileHandle;
+}
 
-		// Get ship's position, size
-		sf::Vector2f playerPosition = pOwnerGameObj->GetPosition();
-		sf::Vector2f playerSize = pOwnerGameObj->GetSize();
+//------------------------------------------------------------------------------------------------------------------------
 
-		// Calculate edge offset
-		sf::Vector2f offset;
-		if (mLastUsedProjectile == EProjectileType::RedLaser)
-		{
-			offset = sf::Vector2f(playerSize.y / 2.f, 0);
-		}
-		else
+bool ProjectileComponent::GetProjectileType(BD::Handle handle, EProjectileType & outType) const
+{
+	for (const auto & projectile : mProjectiles)
+	{
+		if (projectile.handle == handle)
 		{
-			offset = sf::Vector2f(-playerSize.y / 2.f, 0);
+			outType = projectile.type;
+			return true;
 		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
 
-		sf::Vector2f spawnPosition = playerPosition + offset;
+void ProjectileComponent::SaveState(SnapshotFormat::ProjectileRecord & outRecord, std::vector<SnapshotFormat::ProjectileEntry> & outEntries) const
+{
+	outRecord.mSpeed = mSpeed;
+	outRecord.mCooldown = mCooldown;
+	outRecord.mTimeSinceLastShot = mTimeSinceLastShot;
+	outRecord.mLastUsedProjectile = uint32_t(mLastUsedProjectile);
+	outRecord.mFirstEntry = uint32_t(outEntries.size());
+	outRecord.mEntryCount = uint32_t(mProjectiles.size());
+
+	for (const auto & projectile : mProjectiles)
+	{
+		SnapshotFormat::ProjectileEntry entry = {};
+		entry.mHandle = projectile.handle;
+		entry.mLifespan = projectile.lifespan;
+		entry.mDamage = projectile.damage;
+		entry.mDirectionX = projectile.direction.x;
+		entry.mDirectionY = projectile.direction.y;
+		entry.mType = uint32_t(projectile.type);
+		outEntries.push_back(entry);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------
 
-		auto crosshairPosition = GetGameObject().GetGameManager().GetManager<CameraManager>()->GetCrosshairPosition();
-		sf::Vector2f direction = crosshairPosition - spawnPosition;
-		float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-		if (length != 0)
+void ProjectileComponent::LoadState(const SnapshotFormat::ProjectileRecord & record, const SnapshotFormat::ProjectileEntry * pEntries)
+{
+	mSpeed = record.mSpeed;
+	mCooldown = record.mCooldown;
+	mTimeSinceLastShot = record.mTimeSinceLastShot;
+	mLastUsedProjectile = EProjectileType(record.mLastUsedProjectile);
+
+	mProjectiles.clear();
+	for (uint32_t index = 0; index < record.mEntryCount; ++index)
+	{
+		const SnapshotFormat::ProjectileEntry & entry = pEntries[index];
+		if (entry.mHandle != BD::Handle(0))
 		{
-			direction /= length; // Normalize
+			sf::Vector2f direction(entry.mDirectionX, entry.mDirectionY);
+			mProjectiles.push_back({ entry.mHandle, entry.mLifespan, entry.mDamage, direction, EProjectileType(entry.mType) });
 		}
-
-		// Calculate angle in degrees
-		float angleDegrees = std::atan2(direction.y, direction.x) * (180.f / 3.14159265f);
-
-		// Set projectile position and rotation
-		pProjectileSpriteComponent->SetPosition(spawnPosition);
-		pProjectileSpriteComponent->SetRotation(angleDegrees + 90.f); // Adjust rotation for sprite alignment
-
-		// Add collision
-		pProjectile->CreatePhysicsBody(&pOwnerGameObj->GetGameManager().GetPhysicsWorld(), pProjectile->GetSize(), true);
-		auto pCollisionComponent = std::make_shared<CollisionComponent>(
-			pProjectile,
-			gameManager,
-			&pOwnerGameObj->GetGameManager().GetPhysicsWorld(),
-			pProjectile->GetPhysicsBody(),
-            pProjectile->GetSize(), 
-            true
-        );
-		pProjectile->AddComponent(pCollisionComponent);
-		mProjectiles.push_back({ projectileHandle, 3.f, 15, direction });
 	}
 }
 
@@ -132,9 +218,13 @@ void ProjectileComponent::Update(float deltaTime)
 
 	mTimeSinceLastShot += deltaTime;
 
-	if (sf::Mouse::isButtonPressed(sf::Mouse::Left) && mTimeSinceLastShot >= mCooldown)
+	// Players driven over the network fire from their newest command instead of the local mouse
+	auto pNetInput = GetGameObject().GetComponent<NetInputComponent>().lock();
+	PlayerInput input = pNetInput ? pNetInput->GetInput() : SampleLocalPlayerInput(GetGameManager());
+
+	if (input.mIsFiring && mTimeSinceLastShot >= mCooldown)
 	{
-		Shoot();
+		Shoot(input.mAim);
 		mTimeSinceLastShot = 0.0f;
 	}
 
@@ -155,9 +245,13 @@ void ProjectileComponent::DebugImGuiComponentInfo()
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & ProjectileComponent::GetClassName()
+BD_REGISTER_COMPONENT(ProjectileComponent)
+
+void ProjectileComponent::DescribeType(ComponentTypeInfo & typeInfo)
 {
-	return mName;
+	typeInfo.AddField<&ProjectileComponent::mSpeed>("Speed");
+	typeInfo.AddField<&ProjectileComponent::mCooldown>("Cooldown");
+	typeInfo.AddField<&ProjectileComponent::mTimeSinceLastShot>("TimeSinceLastShot");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
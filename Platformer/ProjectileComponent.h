@@ -1,36 +1,49 @@
 #pragma once
 #include "GameComponent.h"
+#include "SnapshotFormat.h"
 #include <SFML/System/Vector2.hpp>
 #include <vector>
 #include <string>
 
+enum class EProjectileType
+{
+    RedLaser,
+    GreenLaser
+};
+
 struct Projectile
 {
     BD::Handle handle;
     float lifespan;
     int damage;
     sf::Vector2f direction;
-};
-
-enum class EProjectileType
-{
-    RedLaser,
-    GreenLaser
+    EProjectileType type = EProjectileType::RedLaser;
 };
 
 class ProjectileComponent : public GameComponent
 {
+    BD_COMPONENT(ProjectileComponent)
+
 public:
     ProjectileComponent(GameObject * pOwner, GameManager & gameManager);
     ~ProjectileComponent();
 
     std::string GetCorrectProjectileFile();
 
-    void Shoot();
+    void Shoot(const sf::Vector2f & aimPosition);
+
+    // Creates the projectile GameObject as a child of the owner without tracking it, returns 0 on failure
+    BD::Handle SpawnProjectile(EProjectileType type, const sf::Vector2f & position, const sf::Vector2f & direction);
+    bool GetProjectileType(BD::Handle handle, EProjectileType & outType) const;
+    static std::string GetProjectileFile(EProjectileType type);
+
+    // Appends the tracked projectiles to outEntries. On load the entries' handles must already point at live objects,
+    // entries with a handle of 0 are dropped.
+    void SaveState(SnapshotFormat::ProjectileRecord & outRecord, std::vector<SnapshotFormat::ProjectileEntry> & outEntries) const;
+    void LoadState(const SnapshotFormat::ProjectileRecord & record, const SnapshotFormat::ProjectileEntry * pEntries);
 
     virtual void Update(float deltaTime) override;
     virtual void DebugImGuiComponentInfo() override;
-    virtual std::string & GetClassName() override;
 
 private:
     void UpdateProjectiles(float deltaTime);
@@ -40,5 +53,4 @@ private:
     float mCooldown;
     float mTimeSinceLastShot;
     EProjectileType mLastUsedProjectile;
-    std::string mName;
 };
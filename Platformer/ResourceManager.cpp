@@ -1,5 +1,6 @@
 #include "AstroidsPrivate.h"
 #include "ResourceManager.h"
+#include <fstream>
 
 //------------------------------------------------------------------------------------------------------------------------
 
@@ -30,6 +31,8 @@ std::string & ResourceId::GetName()
 ResourceManager::ResourceManager(GameManager * pGameManager)
     : BaseManager(pGameManager)
     , mTextureResources()
+    , mSoundBufferResources()
+    , mAnimationClips()
 {
 }
 
@@ -57,6 +60,145 @@ std::shared_ptr<sf::Texture> ResourceManager::GetTexture(ResourceId & resourceId
 
 //------------------------------------------------------------------------------------------------------------------------
 
+std::shared_ptr<sf::SoundBuffer> ResourceManager::GetSoundBuffer(ResourceId & resourceId)
+{
+    auto it = mSoundBufferResources.find(resourceId);
+    if (it != mSoundBufferResources.end())
+    {
+        return it->second;
+    }
+
+    auto soundBuffer = std::make_shared<sf::SoundBuffer>();
+    if (soundBuffer->loadFromFile(resourceId.GetName()))
+    {
+        mSoundBufferResources[resourceId] = soundBuffer;
+        return soundBuffer;
+    }
+
+    std::cerr << "Failed to load sound: " << resourceId.GetName() << std::endl;
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const AnimationClip> ResourceManager::GetAnimationClip(ResourceId & resourceId)
+{
+    auto it = mAnimationClips.find(resourceId);
+    if (it != mAnimationClips.end())
+    {
+        return it->second;
+    }
+
+    std::cerr << "Unknown animation clip: " << resourceId.GetName() << std::endl;
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool ResourceManager::LoadAnimationClips(const std::string & filePath)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open animation definitions: " << filePath << std::endl;
+        return false;
+    }
+
+    nlohmann::json definitions;
+    file >> definitions;
+
+    if (!definitions.contains("clips") || !definitions["clips"].is_array())
+    {
+        std::cerr << "No clips found in " << filePath << std::endl;
+        return false;
+    }
+
+    for (const auto & clipData : definitions["clips"])
+    {
+        auto pClip = std::make_shared<AnimationClip>();
+        pClip->mName = clipData["name"].get<std::string>();
+        pClip->mLoop = clipData.value("loop", false);
+
+        if (clipData.contains("sheet"))
+        {
+            ResourceId sheetId(clipData["sheet"].get<std::string>());
+            pClip->mpSheet = GetTexture(sheetId);
+            if (!pClip->mpSheet)
+            {
+                continue;
+            }
+
+            int frameWidth = clipData["frameWidth"];
+            int frameHeight = clipData["frameHeight"];
+            int frameCount = clipData["frameCount"];
+            int columns = std::max(1, int(pClip->mpSheet->getSize().x) / frameWidth);
+            for (int frame = 0; frame < frameCount; ++frame)
+            {
+                pClip->mFrames.emplace_back((frame % columns) * frameWidth, (frame / columns) * frameHeight, frameWidth, frameHeight);
+            }
+        }
+        else if (clipData.contains("frames"))
+        {
+            // Pack the loose frame images side by side so the clip only ever binds one texture
+            std::vector<sf::Image> frameImages;
+            unsigned int sheetWidth = 0;
+            unsigned int sheetHeight = 0;
+            for (const auto & framePath : clipData["frames"])
+            {
+                sf::Image image;
+                if (!image.loadFromFile(framePath.get<std::string>()))
+                {
+                    std::cerr << "Failed to load animation frame: " << framePath << std::endl;
+                    continue;
+                }
+                sheetWidth += image.getSize().x;
+                sheetHeight = std::max(sheetHeight, image.getSize().y);
+                frameImages.push_back(std::move(image));
+            }
+
+            if (frameImages.empty())
+            {
+                continue;
+            }
+
+            sf::Image sheet;
+            sheet.create(sheetWidth, sheetHeight, sf::Color::Transparent);
+            int x = 0;
+            for (const auto & image : frameImages)
+            {
+                sheet.copy(image, x, 0);
+                pClip->mFrames.emplace_back(x, 0, int(image.getSize().x), int(image.getSize().y));
+                x += int(image.getSize().x);
+            }
+
+            pClip->mpSheet = std::make_shared<sf::Texture>();
+            pClip->mpSheet->loadFromImage(sheet);
+        }
+
+        // Either one shared frame time or explicit per frame timings
+        float elapsed = 0.f;
+        for (size_t frame = 0; frame < pClip->mFrames.size(); ++frame)
+        {
+            if (clipData.contains("timings") && frame < clipData["timings"].size())
+            {
+                elapsed += clipData["timings"][frame].get<float>();
+            }
+            else
+            {
+                elapsed += clipData.value("frameTime", 0.1f);
+            }
+            pClip->mFrameEndTimes.push_back(elapsed);
+        }
+
+        ResourceId clipId(pClip->mName);
+        mAnimationClips[clipId] = pClip;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void ResourceManager::PreloadResources(std::vector<std::string> const & resourcePaths)
 {
     for (auto const & path : resourcePaths)
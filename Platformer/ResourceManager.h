@@ -2,6 +2,7 @@
 #include "BaseManager.h"
 #include <string>
 #include <functional>
+#include "AnimationClip.h"
 
 //------------------------------------------------------------------------------------------------------------------------
 // ResourceId
@@ -56,6 +57,11 @@ public:
 	ResourceManager(GameManager * pGameManager);
 	
     std::shared_ptr<sf::Texture> GetTexture(ResourceId & resourceId);
+    std::shared_ptr<sf::SoundBuffer> GetSoundBuffer(ResourceId & resourceId);
+    std::shared_ptr<const AnimationClip> GetAnimationClip(ResourceId & resourceId);
+
+    // Reads every clip in a definitions file, frames given as separate images are packed into a single sheet
+    bool LoadAnimationClips(const std::string & filePath);
 
     void PreloadResources(std::vector<std::string> const & resourcePaths);
 
@@ -63,4 +69,6 @@ public:
     
 private:
     std::unordered_map<ResourceId, std::shared_ptr<sf::Texture>> mTextureResources;
+    std::unordered_map<ResourceId, std::shared_ptr<sf::SoundBuffer>> mSoundBufferResources;
+    std::unordered_map<ResourceId, std::shared_ptr<const AnimationClip>> mAnimationClips;
 };
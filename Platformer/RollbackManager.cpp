@@ -0,0 +1,464 @@
+#include "AstroidsPrivate.h"
+#include "RollbackManager.h"
+#include "SnapshotManager.h"
+#include "BDConfig.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <imgui.h>
+
+namespace
+{
+    const size_t skDefaultMemoryBudget = 32 * 1024 * 1024;
+    const int skDefaultKeyframeInterval = 120;
+
+    void WriteVarint(std::vector<uint8_t> & out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(uint8_t(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(uint8_t(value));
+    }
+
+    uint64_t ReadVarint(const uint8_t *& pData, const uint8_t * pEnd)
+    {
+        uint64_t value = 0;
+        for (int shift = 0; pData < pEnd && shift < 64; shift += 7)
+        {
+            uint8_t byte = *pData++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                break;
+            }
+        }
+        return value;
+    }
+
+    uint64_t LoadWord(const uint8_t * pBytes, size_t byteCount, size_t word)
+    {
+        uint64_t value = 0;
+        if ((word + 1) * 8 <= byteCount)
+        {
+            std::memcpy(&value, pBytes + word * 8, 8);
+        }
+        return value;
+    }
+
+    // Current XOR previous as alternating runs of zero words and literal words: varint zero count, varint literal
+    // count, then the literals. Snapshots are whole words long; previous may be shorter, longer or empty.
+    void EncodeDelta(const std::vector<uint8_t> & current, const std::vector<uint8_t> & previous, std::vector<uint8_t> & out)
+    {
+        out.clear();
+        const size_t wordCount = current.size() / 8;
+        size_t word = 0;
+        while (word < wordCount)
+        {
+            size_t zeroStart = word;
+            while (word < wordCount && LoadWord(current.data(), current.size(), word) == LoadWord(previous.data(), previous.size(), word))
+            {
+                ++word;
+            }
+
+            size_t literalStart = word;
+            while (word < wordCount && LoadWord(current.data(), current.size(), word) != LoadWord(previous.data(), previous.size(), word))
+            {
+                ++word;
+            }
+
+            WriteVarint(out, literalStart - zeroStart);
+            WriteVarint(out, word - literalStart);
+            for (size_t literal = literalStart; literal < word; ++literal)
+            {
+                uint64_t delta = LoadWord(current.data(), current.size(), literal) ^ LoadWord(previous.data(), previous.size(), literal);
+                uint8_t bytes[8];
+                std::memcpy(bytes, &delta, 8);
+                out.insert(out.end(), bytes, bytes + 8);
+            }
+        }
+    }
+
+    // Turns inOut from the previous snapshot into the encoded one
+    bool ApplyDelta(const uint8_t * pData, size_t size, size_t rawSize, std::vector<uint8_t> & inOut)
+    {
+        inOut.resize(rawSize, 0);
+
+        const uint8_t * pEnd = pData + size;
+        const size_t wordCount = rawSize / 8;
+        size_t word = 0;
+        while (pData < pEnd)
+        {
+            word += size_t(ReadVarint(pData, pEnd));
+            size_t literalCount = size_t(ReadVarint(pData, pEnd));
+            if (word + literalCount > wordCount || size_t(pEnd - pData) < literalCount * 8)
+            {
+                return false;
+            }
+
+            for (size_t literal = 0; literal < literalCount; ++literal, ++word, pData += 8)
+            {
+                uint64_t value;
+                uint64_t delta;
+                std::memcpy(&value, inOut.data() + word * 8, 8);
+                std::memcpy(&delta, pData, 8);
+                value ^= delta;
+                std::memcpy(inOut.data() + word * 8, &value, 8);
+            }
+        }
+        return true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+RollbackManager::RollbackManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mIsRecording(false)
+    , mIsHolding(false)
+    , mIsResimulating(false)
+    , mHeldIndex(0)
+    , mNextTick(0)
+    , mKeyframeInterval(skDefaultKeyframeInterval)
+    , mTicksSinceKeyframe(0)
+    , mRing()
+    , mHead(0)
+    , mFrames()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::Update(float deltaTime)
+{
+    if (mIsRecording && !mIsResimulating && !mIsHolding)
+    {
+        Record(deltaTime);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::OnGameEnd()
+{
+    mIsRecording = false;
+    Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::SetRecording(bool isRecording)
+{
+    if (isRecording && !mIsRecording)
+    {
+        Clear();
+        if (mRing.empty())
+        {
+            mRing.resize(skDefaultMemoryBudget);
+        }
+    }
+    mIsRecording = isRecording;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::SetMemoryBudget(size_t bytes)
+{
+    Clear();
+    mRing.assign(bytes, 0);
+    mRing.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint32_t RollbackManager::GetOldestTick() const
+{
+    return mFrames.empty() ? 0 : mFrames.front().mTick;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint32_t RollbackManager::GetNewestTick() const
+{
+    return mFrames.empty() ? 0 : mFrames.back().mTick;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float RollbackManager::GetRecordedSeconds() const
+{
+    float seconds = 0.f;
+    for (const Frame & frame : mFrames)
+    {
+        seconds += frame.mDeltaTime;
+    }
+    return seconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::Clear()
+{
+    mFrames.clear();
+    mHead = 0;
+    mIsHolding = false;
+    mTicksSinceKeyframe = 0;
+    mPrevious.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::Record(float deltaTime)
+{
+    auto * pSnapshotManager = GetGameManager().GetManager<SnapshotManager>();
+    if (!pSnapshotManager || !pSnapshotManager->SaveSnapshot(mCurrent))
+    {
+        return;
+    }
+
+    Frame frame = {};
+    frame.mTick = mNextTick++;
+    frame.mRawSize = uint32_t(mCurrent.size());
+    frame.mDeltaTime = deltaTime;
+    frame.mUpdateMilliseconds = GetGameManager().GetUpdateMilliseconds();
+    frame.mResimMilliseconds = -1.f;
+    frame.mIsKeyframe = mFrames.empty() || mTicksSinceKeyframe >= mKeyframeInterval;
+
+    static const std::vector<uint8_t> skEmpty;
+    EncodeDelta(mCurrent, frame.mIsKeyframe ? skEmpty : mPrevious, mEncoded);
+    if (!StoreFrame(frame, mEncoded))
+    {
+        // Making room dropped every frame this one was a delta of
+        frame.mIsKeyframe = true;
+        EncodeDelta(mCurrent, skEmpty, mEncoded);
+        if (!StoreFrame(frame, mEncoded))
+        {
+            // A single snapshot does not fit the budget
+            mIsRecording = false;
+            Clear();
+            return;
+        }
+    }
+
+    mTicksSinceKeyframe = frame.mIsKeyframe ? 1 : mTicksSinceKeyframe + 1;
+    mPrevious.swap(mCurrent);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool RollbackManager::StoreFrame(const Frame & frame, const std::vector<uint8_t> & encoded)
+{
+    uint32_t offset;
+    if (!Reserve(uint32_t(encoded.size()), offset) || (!frame.mIsKeyframe && mFrames.empty()))
+    {
+        return false;
+    }
+
+    std::memcpy(mRing.data() + offset, encoded.data(), encoded.size());
+    mFrames.push_back(frame);
+    mFrames.back().mOffset = offset;
+    mFrames.back().mSize = uint32_t(encoded.size());
+    mHead = offset + uint32_t(encoded.size());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool RollbackManager::Reserve(uint32_t size, uint32_t & outOffset)
+{
+    if (size > mRing.size())
+    {
+        return false;
+    }
+
+    uint32_t start = mHead;
+    if (size_t(start) + size > mRing.size())
+    {
+        // The frames between the head and the end of the ring are the oldest ones, wrapping skips past them
+        while (!mFrames.empty() && mFrames.front().mOffset >= start)
+        {
+            mFrames.pop_front();
+        }
+        start = 0;
+    }
+
+    while (!mFrames.empty() && mFrames.front().mOffset < start + size && start < mFrames.front().mOffset + mFrames.front().mSize)
+    {
+        mFrames.pop_front();
+    }
+
+    // The oldest frame kept has to decode on its own
+    while (!mFrames.empty() && !mFrames.front().mIsKeyframe)
+    {
+        mFrames.pop_front();
+    }
+
+    outOffset = start;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool RollbackManager::DecodeTo(size_t frameIndex)
+{
+    size_t keyframeIndex = frameIndex;
+    while (keyframeIndex > 0 && !mFrames[keyframeIndex].mIsKeyframe)
+    {
+        --keyframeIndex;
+    }
+
+    mDecoded.clear();
+    for (size_t index = keyframeIndex; index <= frameIndex; ++index)
+    {
+        const Frame & frame = mFrames[index];
+        if (!ApplyDelta(mRing.data() + frame.mOffset, frame.mSize, frame.mRawSize, mDecoded))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool RollbackManager::Rewind(uint32_t tick)
+{
+    auto * pSnapshotManager = GetGameManager().GetManager<SnapshotManager>();
+    if (!pSnapshotManager || mFrames.empty() || tick < GetOldestTick() || tick > GetNewestTick())
+    {
+        return false;
+    }
+
+    size_t frameIndex = tick - GetOldestTick();
+    if (!DecodeTo(frameIndex) || !pSnapshotManager->LoadSnapshot(mDecoded.data(), mDecoded.size()))
+    {
+        return false;
+    }
+
+    mIsHolding = true;
+    mHeldIndex = frameIndex;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::Resume()
+{
+    if (!mIsHolding)
+    {
+        return;
+    }
+
+    mFrames.erase(mFrames.begin() + mHeldIndex + 1, mFrames.end());
+    mHead = mFrames.back().mOffset + mFrames.back().mSize;
+    mNextTick = mFrames.back().mTick + 1;
+    mTicksSinceKeyframe = 0;
+    for (auto it = mFrames.rbegin(); it != mFrames.rend() && !it->mIsKeyframe; ++it)
+    {
+        ++mTicksSinceKeyframe;
+    }
+    ++mTicksSinceKeyframe;
+
+    // mDecoded still holds the held tick, the next frame is a delta against it
+    mPrevious = mDecoded;
+    mIsHolding = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::Resimulate()
+{
+    if (!mIsHolding)
+    {
+        return;
+    }
+
+    TIMEFUNCTION_EX("RollbackManager::Resimulate", 1000.f);
+
+    mIsHolding = false;
+    mIsResimulating = true;
+    auto & gameManager = GetGameManager();
+    for (size_t index = mHeldIndex + 1; index < mFrames.size() && !gameManager.IsGameOver(); ++index)
+    {
+        Frame & frame = mFrames[index];
+        StopWatch stopWatch;
+        {
+            // Prints the ticks that run over a frame at 60 Hz
+            TimeBlock const tickBlock("RollbackManager resimulated tick", 1000.f / 60.f);
+            gameManager.Update(frame.mDeltaTime);
+        }
+        frame.mResimMilliseconds = stopWatch.GetElapsedMilliseconds();
+    }
+    mIsResimulating = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void RollbackManager::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Rollback");
+
+    bool isRecording = mIsRecording;
+    if (ImGui::Checkbox("Record every tick", &isRecording))
+    {
+        SetRecording(isRecording);
+    }
+
+    if (!mFrames.empty())
+    {
+        size_t encodedBytes = 0;
+        size_t rawBytes = 0;
+        for (const Frame & frame : mFrames)
+        {
+            encodedBytes += frame.mSize;
+            rawBytes += frame.mRawSize;
+        }
+        ImGui::Text("%d ticks, %.1f s, %.1f / %.1f MB", int(mFrames.size()), GetRecordedSeconds(),
+            encodedBytes / (1024.f * 1024.f), mRing.size() / (1024.f * 1024.f));
+        ImGui::Text("Per tick: %.0f bytes stored, %.0f bytes raw", encodedBytes / float(mFrames.size()), rawBytes / float(mFrames.size()));
+
+        mPlotValues.clear();
+        for (const Frame & frame : mFrames)
+        {
+            mPlotValues.push_back(frame.mUpdateMilliseconds);
+        }
+        ImGui::PlotLines("Update (ms)", mPlotValues.data(), int(mPlotValues.size()), 0, nullptr, 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+
+        mPlotValues.clear();
+        for (const Frame & frame : mFrames)
+        {
+            mPlotValues.push_back(std::max(frame.mResimMilliseconds, 0.f));
+        }
+        ImGui::PlotLines("Resim (ms)", mPlotValues.data(), int(mPlotValues.size()), 0, nullptr, 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+
+        int tick = int(mIsHolding ? mFrames[mHeldIndex].mTick : GetNewestTick());
+        if (ImGui::SliderInt("Tick", &tick, int(GetOldestTick()), int(GetNewestTick())))
+        {
+            Rewind(uint32_t(tick));
+        }
+
+        if (mIsHolding)
+        {
+            const Frame & held = mFrames[mHeldIndex];
+            ImGui::Text("Held: dt %.2f ms, update %.3f ms", held.mDeltaTime * 1000.f, held.mUpdateMilliseconds);
+            if (ImGui::Button("Resume Here"))
+            {
+                Resume();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Re-simulate To Newest"))
+            {
+                Resimulate();
+            }
+        }
+    }
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "BaseManager.h"
+
+// Records the whole simulation every tick into a fixed size ring of memory so a spike or a bug can be rewound to and
+// stepped through again. Each tick is a SnapshotManager snapshot XORed against the previous tick's and stored as runs
+// of unchanged words and changed words, so a tick where little moved costs a few hundred bytes. Every so often a
+// keyframe is stored against nothing, and the oldest ticks are dropped back to a keyframe when the ring is full, so any
+// tick still held decodes from the keyframe before it. While a rewound tick is held GameManager::Update does nothing;
+// from there the game can resume, dropping the ticks after it, or re-simulate them with their recorded frame times and
+// compare the time each one takes against the original.
+class RollbackManager : public BaseManager
+{
+public:
+    RollbackManager(GameManager * pGameManager);
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    // Off by default. Turning it on starts a fresh recording.
+    void SetRecording(bool isRecording);
+    bool IsRecording() const { return mIsRecording; }
+    void SetMemoryBudget(size_t bytes);
+
+    uint32_t GetOldestTick() const;
+    uint32_t GetNewestTick() const;
+    float GetRecordedSeconds() const;
+
+    // Loads the state at the end of the given tick and holds it
+    bool Rewind(uint32_t tick);
+    bool IsHoldingTick() const { return mIsHolding; }
+
+    // Goes on live from the held tick, the ticks recorded after it are dropped
+    void Resume();
+
+    // Steps from the held tick through the newest one again, then goes on live
+    void Resimulate();
+
+    void DebugImGuiInfo();
+
+private:
+    struct Frame
+    {
+        uint32_t mTick;
+        uint32_t mOffset;               // Into mRing
+        uint32_t mSize;                 // Encoded bytes
+        uint32_t mRawSize;              // Snapshot bytes
+        float mDeltaTime;
+        float mUpdateMilliseconds;      // GameManager::Update when recorded
+        float mResimMilliseconds;       // GameManager::Update when last re-simulated, negative if never
+        bool mIsKeyframe;
+    };
+
+    void Clear();
+    void Record(float deltaTime);
+    bool StoreFrame(const Frame & frame, const std::vector<uint8_t> & encoded);
+    bool Reserve(uint32_t size, uint32_t & outOffset);
+    bool DecodeTo(size_t frameIndex);
+
+    bool mIsRecording;
+    bool mIsHolding;
+    bool mIsResimulating;
+    size_t mHeldIndex;
+    uint32_t mNextTick;
+    int mKeyframeInterval;
+    int mTicksSinceKeyframe;
+
+    std::vector<uint8_t> mRing;
+    uint32_t mHead;
+    std::deque<Frame> mFrames;
+
+    std::vector<uint8_t> mPrevious;     // Raw snapshot of the newest frame, what the next one is encoded against
+    std::vector<uint8_t> mCurrent;
+    std::vector<uint8_t> mEncoded;
+    std::vector<uint8_t> mDecoded;
+    std::vector<float> mPlotValues;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
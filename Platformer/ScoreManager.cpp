@@ -37,6 +37,13 @@ void ScoreManager::Render(sf::RenderWindow & window)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void ScoreManager::OnGameStart()
+{
+	SetScore(0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 void ScoreManager::AddScore(int points)
 {
 	mScore += points;
@@ -45,6 +52,14 @@ void ScoreManager::AddScore(int points)
 
 //------------------------------------------------------------------------------------------------------------------------
 
+void ScoreManager::SetScore(int score)
+{
+	mScore = score;
+	mScoreText.setString("Score: " + std::to_string(mScore));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 const sf::Text & ScoreManager::GetScoreText()
 {
 	return mScoreText;
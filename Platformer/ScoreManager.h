@@ -9,8 +9,10 @@ public:
 	ScoreManager(GameManager * pGameManager);
 
 	virtual void Render(sf::RenderWindow & window);
+	virtual void OnGameStart() override;
 
 	void AddScore(int points);
+	void SetScore(int score);
 	const sf::Text & GetScoreText();
 
 	std::vector<sf::Sprite> & GetSpriteLives();
@@ -0,0 +1,254 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//------------------------------------------------------------------------------------------------------------------------
+// Game snapshot format (.bdsave)
+//
+// Written and read by SnapshotManager. Every section is a packed array of one plain old data record type at an 8 byte
+// aligned offset, so a section is written with a single memcpy and read in place. Records refer to GameObjects by the
+// handle they had when the snapshot was taken; handles are remapped when objects have to be respawned on load. Bump
+// skVersion whenever a struct below changes; stale snapshots are rejected instead of being misread.
+//
+//   Header
+//   ObjectRecord[]             scene graph in parent before child order, the root itself is not stored
+//   BodyRecord[]               Box2D transforms and velocities
+//   HealthRecord[]
+//   MovementRecord[]           ControlledMovementComponent
+//   ProjectileRecord[]         ProjectileComponent, each owning a range of
+//   ProjectileEntry[]
+//   AIPathRecord[]             AIPathComponent, each owning a range of
+//   PathPoint[]
+//   AnimationRecord[]
+//   DropMovementRecord[]
+//   ManagerRecord[1]
+//------------------------------------------------------------------------------------------------------------------------
+
+namespace SnapshotFormat
+{
+    const uint32_t skMagic = 0x53534442; // "BDSS"
+    const uint32_t skVersion = 1;
+
+    enum ESection
+    {
+        Objects,
+        Bodies,
+        Health,
+        Movement,
+        Projectiles,
+        ProjectileEntries,
+        AIPaths,
+        PathPoints,
+        Animations,
+        DropMovements,
+        Managers,
+        SectionCount
+    };
+
+    // Which manager respawns an object missing on load
+    enum EArchetype : uint8_t
+    {
+        Player,
+        Enemy,          // mVariant is the EEnemy
+        Drop,           // mVariant is the EDropType
+        Projectile      // mVariant is the EProjectileType, the parent owns it through its ProjectileComponent
+    };
+
+    struct SectionDesc
+    {
+        uint32_t mOffset;
+        uint32_t mCount;
+    };
+
+    struct Header
+    {
+        uint32_t mMagic;
+        uint32_t mVersion;
+        uint32_t mFileSize;
+        uint32_t mFrame;
+        SectionDesc mSections[SectionCount];
+    };
+
+    struct ObjectRecord
+    {
+        uint64_t mHandle;
+        uint64_t mParentHandle;
+        float mPositionX;
+        float mPositionY;
+        float mRotation;    // Degrees
+        uint8_t mTeam;
+        uint8_t mArchetype;
+        uint8_t mVariant;
+        uint8_t mIsActive;
+    };
+
+    struct BodyRecord
+    {
+        uint64_t mObject;
+        float mPositionX;   // Meters
+        float mPositionY;
+        float mAngle;
+        float mLinearVelocityX;
+        float mLinearVelocityY;
+        float mAngularVelocity;
+    };
+
+    struct HealthRecord
+    {
+        uint64_t mObject;
+        int32_t mHealth;
+        int32_t mMaxHealth;
+        int32_t mLifeCount;
+        int32_t mMaxLives;
+        float mHitCooldown;
+        float mTimeSinceLastHit;
+    };
+
+    struct MovementRecord
+    {
+        uint64_t mObject;
+        float mVelocityX;
+        float mVelocityY;
+        float mInputVelocityX;
+        float mInputVelocityY;
+        uint32_t mTilt;
+        uint32_t mPadding;
+    };
+
+    struct ProjectileRecord
+    {
+        uint64_t mObject;
+        float mSpeed;
+        float mCooldown;
+        float mTimeSinceLastShot;
+        uint32_t mLastUsedProjectile;
+        uint32_t mFirstEntry;
+        uint32_t mEntryCount;
+    };
+
+    struct ProjectileEntry
+    {
+        uint64_t mHandle;
+        float mLifespan;
+        int32_t mDamage;
+        float mDirectionX;
+        float mDirectionY;
+        uint32_t mType;
+        uint32_t mPadding;
+    };
+
+    struct AIPathRecord
+    {
+        uint64_t mObject;
+        float mStopDistance;
+        float mMovementSpeed;
+        float mTimeSinceLastPlayerMovement;
+        float mPlayerPositionX;
+        float mPlayerPositionY;
+        float mDirectionX;
+        float mDirectionY;
+        uint32_t mPathIndex;
+        uint32_t mFirstPoint;
+        uint32_t mPointCount;
+        uint32_t mNeedsRepath;  // Also set when a path request was still in flight, tickets do not survive a load
+        uint32_t mPadding;
+    };
+
+    struct PathPoint
+    {
+        int32_t mX;
+        int32_t mY;
+    };
+
+    struct AnimationRecord
+    {
+        uint64_t mObject;
+        float mElapsedTime;
+        int32_t mCurrentFrame;
+    };
+
+    struct DropMovementRecord
+    {
+        uint64_t mObject;
+        float mDirectionX;
+        float mDirectionY;
+        float mVelocity;
+        float mStartPositionX;
+        float mStartPositionY;
+        uint32_t mPadding;
+    };
+
+    // Manager handle lists are rebuilt from the object archetypes, only state that lives nowhere else is kept here
+    struct ManagerRecord
+    {
+        int32_t mScore;
+        uint32_t mPadding;
+    };
+
+    inline uint32_t AlignOffset(uint32_t offset)
+    {
+        return (offset + 7u) & ~7u;
+    }
+
+    inline size_t GetRecordSize(ESection section)
+    {
+        switch (section)
+        {
+            case Objects:           return sizeof(ObjectRecord);
+            case Bodies:            return sizeof(BodyRecord);
+            case Health:            return sizeof(HealthRecord);
+            case Movement:          return sizeof(MovementRecord);
+            case Projectiles:       return sizeof(ProjectileRecord);
+            case ProjectileEntries: return sizeof(ProjectileEntry);
+            case AIPaths:           return sizeof(AIPathRecord);
+            case PathPoints:        return sizeof(PathPoint);
+            case Animations:        return sizeof(AnimationRecord);
+            case DropMovements:     return sizeof(DropMovementRecord);
+            case Managers:          return sizeof(ManagerRecord);
+            default:                return 0;
+        }
+    }
+
+    // Returns the header if pData holds a complete snapshot of the current version, nullptr otherwise
+    inline const Header * Validate(const void * pData, size_t size)
+    {
+        if (!pData || size < sizeof(Header))
+        {
+            return nullptr;
+        }
+
+        const Header * pHeader = static_cast<const Header *>(pData);
+        if (pHeader->mMagic != skMagic || pHeader->mVersion != skVersion || pHeader->mFileSize != size)
+        {
+            return nullptr;
+        }
+
+        for (int section = 0; section < SectionCount; ++section)
+        {
+            const SectionDesc & desc = pHeader->mSections[section];
+            size_t bytes = size_t(desc.mCount) * GetRecordSize(ESection(section));
+            if ((desc.mOffset % 8) != 0 || size_t(desc.mOffset) + bytes > size)
+            {
+                return nullptr;
+            }
+        }
+
+        if (pHeader->mSections[Managers].mCount != 1)
+        {
+            return nullptr;
+        }
+
+        return pHeader;
+    }
+
+    template <typename T>
+    const T * GetSection(const Header * pHeader, ESection section)
+    {
+        return reinterpret_cast<const T *>(reinterpret_cast<const char *>(pHeader) + pHeader->mSections[section].mOffset);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
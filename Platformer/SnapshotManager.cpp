@@ -0,0 +1,679 @@
+#include "AstroidsPrivate.h"
+#include "SnapshotManager.h"
+#include "PlayerManager.h"
+#include "EnemyAIManager.h"
+#include "DropManager.h"
+#include "ScoreManager.h"
+#include "HealthComponent.h"
+#include "ControlledMovementComponent.h"
+#include "ProjectileComponent.h"
+#include "AIPathComponent.h"
+#include "AnimationComponent.h"
+#include "DropMovementComponent.h"
+#include "CollisionComponent.h"
+#include "BDConfig.h"
+#include <fstream>
+#include <iostream>
+#include <imgui.h>
+
+namespace
+{
+    const float skDefaultAutoSnapshotInterval = 5.f;
+
+    template <typename TComponent, typename TRecord>
+    void SaveComponent(GameObject & object, std::vector<TRecord> & records)
+    {
+        auto pComponent = object.GetComponent<TComponent>().lock();
+        if (pComponent)
+        {
+            TRecord record = {};
+            record.mObject = object.GetHandle();
+            pComponent->SaveState(record);
+            records.push_back(record);
+        }
+    }
+
+    template <typename TRecord>
+    void CopySection(std::vector<uint8_t> & bytes, const SnapshotFormat::Header & header, SnapshotFormat::ESection section, const std::vector<TRecord> & records)
+    {
+        if (!records.empty())
+        {
+            std::memcpy(bytes.data() + header.mSections[section].mOffset, records.data(), records.size() * sizeof(TRecord));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+SnapshotManager::SnapshotManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mFrame(0)
+    , mAutoSnapshotInterval(skDefaultAutoSnapshotInterval)
+    , mTimeSinceAutoSnapshot(0.f)
+    , mIsAutoSnapshotEnabled(true)
+    , mAutoSnapshot()
+    , mFileBuffer()
+    , mStats()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SnapshotManager::Update(float deltaTime)
+{
+    ++mFrame;
+
+    mTimeSinceAutoSnapshot += deltaTime;
+    if (mIsAutoSnapshotEnabled && mTimeSinceAutoSnapshot >= mAutoSnapshotInterval)
+    {
+        SaveSnapshot(mAutoSnapshot);
+        mTimeSinceAutoSnapshot = 0.f;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SnapshotManager::OnGameEnd()
+{
+    mAutoSnapshot.clear();
+    mHandleRemap.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool SnapshotManager::SaveSnapshot(std::vector<uint8_t> & outBytes)
+{
+    if (!GetGameManager().GetRootGameObject())
+    {
+        return false;
+    }
+
+    StopWatch stopWatch;
+    GatherObjects();
+    WriteSnapshot(outBytes);
+
+    mStats.mSaveMilliseconds = stopWatch.GetElapsedMilliseconds();
+    mStats.mByteCount = outBytes.size();
+    mStats.mObjectCount = int(mObjects.size());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SnapshotManager::GatherObjects()
+{
+    using namespace SnapshotFormat;
+
+    mObjects.clear();
+    mBodies.clear();
+    mHealth.clear();
+    mMovement.clear();
+    mProjectiles.clear();
+    mProjectileEntries.clear();
+    mAIPaths.clear();
+    mPathPoints.clear();
+    mAnimations.clear();
+    mDropMovements.clear();
+
+    auto & gameManager = GetGameManager();
+    GameObject * pRoot = gameManager.GetRootGameObject();
+
+    // Depth first with children pushed when their parent is written, so parents always come first in the snapshot
+    mStack.assign(pRoot->GetChildrenHandles().rbegin(), pRoot->GetChildrenHandles().rend());
+    while (!mStack.empty())
+    {
+        BD::Handle handle = mStack.back();
+        mStack.pop_back();
+
+        GameObject * pObject = gameManager.GetGameObject(handle);
+        if (!pObject || pObject->IsDestroyed())
+        {
+            continue;
+        }
+
+        auto & children = pObject->GetChildrenHandles();
+        mStack.insert(mStack.end(), children.rbegin(), children.rend());
+
+        ObjectRecord object = {};
+        if (!GetArchetype(gameManager, *pObject, object.mArchetype, object.mVariant))
+        {
+            continue;
+        }
+
+        sf::Vector2f position = pObject->GetPosition();
+        object.mHandle = handle;
+        object.mParentHandle = pObject->GetParentHandle();
+        object.mPositionX = position.x;
+        object.mPositionY = position.y;
+        object.mRotation = pObject->GetRotationDegrees();
+        object.mTeam = uint8_t(pObject->GetTeam());
+        object.mIsActive = pObject->IsActive() ? 1 : 0;
+        mObjects.push_back(object);
+
+        if (b2Body * pBody = pObject->GetPhysicsBody())
+        {
+            BodyRecord body = {};
+            body.mObject = handle;
+            body.mPositionX = pBody->GetPosition().x;
+            body.mPositionY = pBody->GetPosition().y;
+            body.mAngle = pBody->GetAngle();
+            body.mLinearVelocityX = pBody->GetLinearVelocity().x;
+            body.mLinearVelocityY = pBody->GetLinearVelocity().y;
+            body.mAngularVelocity = pBody->GetAngularVelocity();
+            mBodies.push_back(body);
+        }
+
+        SaveComponent<HealthComponent>(*pObject, mHealth);
+        SaveComponent<ControlledMovementComponent>(*pObject, mMovement);
+        SaveComponent<AnimationComponent>(*pObject, mAnimations);
+        SaveComponent<DropMovementComponent>(*pObject, mDropMovements);
+
+        if (auto pProjectileComponent = pObject->GetComponent<ProjectileComponent>().lock())
+        {
+            ProjectileRecord record = {};
+            record.mObject = handle;
+            pProjectileComponent->SaveState(record, mProjectileEntries);
+            mProjectiles.push_back(record);
+        }
+
+        if (auto pAIPathComponent = pObject->GetComponent<AIPathComponent>().lock())
+        {
+            AIPathRecord record = {};
+            record.mObject = handle;
+            pAIPathComponent->SaveState(record, mPathPoints);
+            mAIPaths.push_back(record);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SnapshotManager::WriteSnapshot(std::vector<uint8_t> & outBytes) const
+{
+    using namespace SnapshotFormat;
+
+    ManagerRecord managers = {};
+    if (auto * pScoreManager = GetGameManager().GetManager<ScoreManager>())
+    {
+        managers.mScore = pScoreManager->GetScore();
+    }
+
+    Header header = {};
+    header.mMagic = skMagic;
+    header.mVersion = skVersion;
+    header.mFrame = mFrame;
+
+    const size_t counts[SectionCount] =
+    {
+        mObjects.size(),
+        mBodies.size(),
+        mHealth.size(),
+        mMovement.size(),
+        mProjectiles.size(),
+        mProjectileEntries.size(),
+        mAIPaths.size(),
+        mPathPoints.size(),
+        mAnimations.size(),
+        mDropMovements.size(),
+        1
+    };
+
+    uint32_t offset = AlignOffset(sizeof(Header));
+    for (int section = 0; section < SectionCount; ++section)
+    {
+        header.mSections[section].mOffset = offset;
+        header.mSections[section].mCount = uint32_t(counts[section]);
+        offset = AlignOffset(offset + uint32_t(counts[section] * GetRecordSize(ESection(section))));
+    }
+    header.mFileSize = offset;
+
+    // Zero filled so padding bytes are the same from one snapshot to the next
+    outBytes.assign(offset, 0);
+    std::memcpy(outBytes.data(), &header, sizeof(Header));
+    CopySection(outBytes, header, Objects, mObjects);
+    CopySection(outBytes, header, Bodies, mBodies);
+    CopySection(outBytes, header, Health, mHealth);
+    CopySection(outBytes, header, Movement, mMovement);
+    CopySection(outBytes, header, Projectiles, mProjectiles);
+    CopySection(outBytes, header, ProjectileEntries, mProjectileEntries);
+    CopySection(outBytes, header, AIPaths, mAIPaths);
+    CopySection(outBytes, header, PathPoints, mPathPoints);
+    CopySection(outBytes, header, Animations, mAnimations);
+    CopySection(outBytes, header, DropMovements, mDropMovements);
+    std::memcpy(outBytes.data() + header.mSections[Managers].mOffset, &managers, sizeof(ManagerRecord));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool SnapshotManager::LoadSnapshot(const void * pData, size_t size)
+{
+    using namespace SnapshotFormat;
+
+    auto & gameManager = GetGameManager();
+    const Header * pHeader = Validate(pData, size);
+    GameObject * pRoot = gameManager.GetRootGameObject();
+    if (!pHeader || !pRoot)
+    {
+        return false;
+    }
+
+    StopWatch stopWatch;
+    const ObjectRecord * pObjects = GetSection<ObjectRecord>(pHeader, Objects);
+    const uint32_t objectCount = pHeader->mSections[Objects].mCount;
+
+    // Keep live objects that still are what the snapshot says they were. Parents come first, so a projectile is only
+    // kept when its owner was.
+    mHandleRemap.clear();
+    for (uint32_t index = 0; index < objectCount; ++index)
+    {
+        const ObjectRecord & record = pObjects[index];
+        GameObject * pObject = gameManager.GetGameObject(record.mHandle);
+        uint8_t archetype;
+        uint8_t variant;
+        if (pObject && !pObject->IsDestroyed() &&
+            GetArchetype(gameManager, *pObject, archetype, variant) &&
+            archetype == record.mArchetype && variant == record.mVariant &&
+            GetRestoredHandle(record.mParentHandle) == pObject->GetParentHandle())
+        {
+            mHandleRemap[record.mHandle] = record.mHandle;
+        }
+    }
+
+    // Everything else that the snapshot could have held goes, as do enemy bullets, which it never holds and whose
+    // owners may now be somewhere else entirely
+    mStack.assign(pRoot->GetChildrenHandles().begin(), pRoot->GetChildrenHandles().end());
+    while (!mStack.empty())
+    {
+        BD::Handle handle = mStack.back();
+        mStack.pop_back();
+
+        GameObject * pObject = gameManager.GetGameObject(handle);
+        if (!pObject || pObject->IsDestroyed())
+        {
+            continue;
+        }
+
+        auto & children = pObject->GetChildrenHandles();
+        mStack.insert(mStack.end(), children.begin(), children.end());
+
+        uint8_t archetype;
+        uint8_t variant;
+        bool isEnemyBullet = pObject->GetTeam() == ETeam::Enemy && pObject->GetParentHandle() != gameManager.GetRootGameObjectHandle();
+        if (isEnemyBullet ||
+            (GetArchetype(gameManager, *pObject, archetype, variant) && mHandleRemap.find(handle) == mHandleRemap.end()))
+        {
+            if (auto pCollisionComp = pObject->GetComponent<CollisionComponent>().lock())
+            {
+                pCollisionComp->DestroyBody();
+            }
+            pObject->Destroy();
+        }
+    }
+    gameManager.RemoveDestroyedGameObjects();
+
+    // Spawn what is missing through its manager
+    mStats.mRespawnCount = 0;
+    for (uint32_t index = 0; index < objectCount; ++index)
+    {
+        const ObjectRecord & record = pObjects[index];
+        if (mHandleRemap.find(record.mHandle) != mHandleRemap.end())
+        {
+            continue;
+        }
+
+        BD::Handle handle = Respawn(record);
+        if (handle != BD::Handle(0))
+        {
+            mHandleRemap[record.mHandle] = handle;
+            ++mStats.mRespawnCount;
+        }
+    }
+
+    // Scene graph state
+    for (uint32_t index = 0; index < objectCount; ++index)
+    {
+        const ObjectRecord & record = pObjects[index];
+        GameObject * pObject = gameManager.GetGameObject(GetRestoredHandle(record.mHandle));
+        if (!pObject)
+        {
+            continue;
+        }
+
+        pObject->SetPosition(sf::Vector2f(record.mPositionX, record.mPositionY));
+        pObject->SetRotation(record.mRotation);
+        if (record.mIsActive && !pObject->IsActive())
+        {
+            pObject->Activate();
+        }
+        else if (!record.mIsActive && pObject->IsActive())
+        {
+            pObject->Deactivate();
+        }
+    }
+
+    ForEachRestored<BodyRecord>(pHeader, Bodies, [](GameObject & object, const BodyRecord & record)
+    {
+        if (b2Body * pBody = object.GetPhysicsBody())
+        {
+            pBody->SetTransform(b2Vec2(record.mPositionX, record.mPositionY), record.mAngle);
+            pBody->SetLinearVelocity(b2Vec2(record.mLinearVelocityX, record.mLinearVelocityY));
+            pBody->SetAngularVelocity(record.mAngularVelocity);
+            pBody->SetAwake(true);
+        }
+    });
+
+    ForEachRestored<HealthRecord>(pHeader, Health, [](GameObject & object, const HealthRecord & record)
+    {
+        if (auto pComponent = object.GetComponent<HealthComponent>().lock())
+        {
+            pComponent->LoadState(record);
+        }
+    });
+
+    ForEachRestored<MovementRecord>(pHeader, Movement, [](GameObject & object, const MovementRecord & record)
+    {
+        if (auto pComponent = object.GetComponent<ControlledMovementComponent>().lock())
+        {
+            pComponent->LoadState(record);
+        }
+    });
+
+    ForEachRestored<AnimationRecord>(pHeader, Animations, [](GameObject & object, const AnimationRecord & record)
+    {
+        if (auto pComponent = object.GetComponent<AnimationComponent>().lock())
+        {
+            pComponent->LoadState(record);
+        }
+    });
+
+    ForEachRestored<DropMovementRecord>(pHeader, DropMovements, [](GameObject & object, const DropMovementRecord & record)
+    {
+        if (auto pComponent = object.GetComponent<DropMovementComponent>().lock())
+        {
+            pComponent->LoadState(record);
+        }
+    });
+
+    const ProjectileEntry * pEntries = GetSection<ProjectileEntry>(pHeader, ProjectileEntries);
+    const uint32_t entryCount = pHeader->mSections[ProjectileEntries].mCount;
+    ForEachRestored<ProjectileRecord>(pHeader, Projectiles, [this, pEntries, entryCount](GameObject & object, const ProjectileRecord & record)
+    {
+        auto pComponent = object.GetComponent<ProjectileComponent>().lock();
+        if (!pComponent || record.mFirstEntry > entryCount || record.mEntryCount > entryCount - record.mFirstEntry)
+        {
+            return;
+        }
+
+        // Entries point at projectile objects, which may have been spawned again under new handles
+        mRemappedEntries.assign(pEntries + record.mFirstEntry, pEntries + record.mFirstEntry + record.mEntryCount);
+        for (ProjectileEntry & entry : mRemappedEntries)
+        {
+            entry.mHandle = GetRestoredHandle(entry.mHandle);
+        }
+        pComponent->LoadState(record, mRemappedEntries.data());
+    });
+
+    const PathPoint * pPoints = GetSection<PathPoint>(pHeader, PathPoints);
+    const uint32_t pointCount = pHeader->mSections[PathPoints].mCount;
+    ForEachRestored<AIPathRecord>(pHeader, AIPaths, [pPoints, pointCount](GameObject & object, const AIPathRecord & record)
+    {
+        auto pComponent = object.GetComponent<AIPathComponent>().lock();
+        if (pComponent && record.mFirstPoint <= pointCount && record.mPointCount <= pointCount - record.mFirstPoint)
+        {
+            pComponent->LoadState(record, pPoints + record.mFirstPoint);
+        }
+    });
+
+    // Managers, their handle lists follow the snapshot's object order
+    {
+        std::vector<BD::Handle> enemyHandles;
+        std::vector<BD::Handle> dropHandles;
+        for (uint32_t index = 0; index < objectCount; ++index)
+        {
+            BD::Handle handle = GetRestoredHandle(pObjects[index].mHandle);
+            if (handle == BD::Handle(0))
+            {
+                continue;
+            }
+            if (pObjects[index].mArchetype == Enemy)
+            {
+                enemyHandles.push_back(handle);
+            }
+            else if (pObjects[index].mArchetype == Drop)
+            {
+                dropHandles.push_back(handle);
+            }
+        }
+
+        if (auto * pEnemyAIManager = gameManager.GetManager<EnemyAIManager>())
+        {
+            pEnemyAIManager->RestoreEnemies(enemyHandles);
+        }
+        if (auto * pDropManager = gameManager.GetManager<DropManager>())
+        {
+            pDropManager->RestoreDrops(dropHandles);
+        }
+        if (auto * pScoreManager = gameManager.GetManager<ScoreManager>())
+        {
+            pScoreManager->SetScore(GetSection<ManagerRecord>(pHeader, Managers)->mScore);
+        }
+    }
+
+    mFrame = pHeader->mFrame;
+    mStats.mLoadMilliseconds = stopWatch.GetElapsedMilliseconds();
+    mStats.mByteCount = size;
+    mStats.mObjectCount = int(objectCount);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool SnapshotManager::SaveToFile(const std::string & path)
+{
+    std::vector<uint8_t> bytes;
+    if (!SaveSnapshot(bytes))
+    {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "SnapshotManager: cannot write " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(bytes.data()), std::streamsize(bytes.size()));
+    return bool(file);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool SnapshotManager::LoadFromFile(const std::string & path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        std::cerr << "SnapshotManager: cannot read " << path << std::endl;
+        return false;
+    }
+
+    mFileBuffer.resize(size_t(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(mFileBuffer.data()), std::streamsize(mFileBuffer.size()));
+    if (!file || !LoadSnapshot(mFileBuffer.data(), mFileBuffer.size()))
+    {
+        std::cerr << "SnapshotManager: " << path << " is not a valid snapshot" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool SnapshotManager::RestoreAutoSnapshot()
+{
+    if (mAutoSnapshot.empty())
+    {
+        return false;
+    }
+    mTimeSinceAutoSnapshot = 0.f;
+    return LoadSnapshot(mAutoSnapshot.data(), mAutoSnapshot.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle SnapshotManager::Respawn(const SnapshotFormat::ObjectRecord & record)
+{
+    auto & gameManager = GetGameManager();
+    sf::Vector2f position(record.mPositionX, record.mPositionY);
+
+    switch (record.mArchetype)
+    {
+        case SnapshotFormat::Player:
+        {
+            auto * pPlayerManager = gameManager.GetManager<PlayerManager>();
+            return pPlayerManager ? pPlayerManager->InitPlayer() : BD::Handle(0);
+        }
+        case SnapshotFormat::Enemy:
+        {
+            auto * pEnemyAIManager = gameManager.GetManager<EnemyAIManager>();
+            return pEnemyAIManager ? pEnemyAIManager->SpawnEnemy(EEnemy(record.mVariant), position) : BD::Handle(0);
+        }
+        case SnapshotFormat::Drop:
+        {
+            auto * pDropManager = gameManager.GetManager<DropManager>();
+            return pDropManager ? pDropManager->SpawnDrop(EDropType(record.mVariant), position) : BD::Handle(0);
+        }
+        case SnapshotFormat::Projectile:
+        {
+            GameObject * pOwner = gameManager.GetGameObject(GetRestoredHandle(record.mParentHandle));
+            auto pProjectileComponent = pOwner ? pOwner->GetComponent<ProjectileComponent>().lock() : nullptr;
+            if (!pProjectileComponent)
+            {
+                return BD::Handle(0);
+            }
+            // The heading comes back with the owner's projectile entries, the rotation with the object record
+            return pProjectileComponent->SpawnProjectile(EProjectileType(record.mVariant), position, sf::Vector2f(0.f, -1.f));
+        }
+        default:
+        {
+            return BD::Handle(0);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle SnapshotManager::GetRestoredHandle(uint64_t snapshotHandle) const
+{
+    if (snapshotHandle == GetGameManager().GetRootGameObjectHandle())
+    {
+        return snapshotHandle;
+    }
+    auto it = mHandleRemap.find(snapshotHandle);
+    return it != mHandleRemap.end() ? it->second : BD::Handle(0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+template <typename TRecord, typename TFunc>
+void SnapshotManager::ForEachRestored(const SnapshotFormat::Header * pHeader, SnapshotFormat::ESection section, TFunc func)
+{
+    const TRecord * pRecords = SnapshotFormat::GetSection<TRecord>(pHeader, section);
+    for (uint32_t index = 0; index < pHeader->mSections[section].mCount; ++index)
+    {
+        if (GameObject * pObject = GetGameManager().GetGameObject(GetRestoredHandle(pRecords[index].mObject)))
+        {
+            func(*pObject, pRecords[index]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SnapshotManager::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Snapshots");
+
+    if (ImGui::Button("Quick Save"))
+    {
+        SaveToFile("Quicksave.bdsave");
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Quick Load"))
+    {
+        LoadFromFile("Quicksave.bdsave");
+    }
+
+    ImGui::Checkbox("Auto Snapshot", &mIsAutoSnapshotEnabled);
+    ImGui::SliderFloat("Interval (s)", &mAutoSnapshotInterval, 0.5f, 30.f);
+    if (ImGui::Button("Restore Auto Snapshot"))
+    {
+        RestoreAutoSnapshot();
+    }
+
+    ImGui::Text("Frame: %u", mFrame);
+    ImGui::Text("Last snapshot: %d objects, %.1f KB", mStats.mObjectCount, mStats.mByteCount / 1024.f);
+    ImGui::Text("Save: %.3f ms  Load: %.3f ms", mStats.mSaveMilliseconds, mStats.mLoadMilliseconds);
+    ImGui::Text("Respawned on last load: %d", mStats.mRespawnCount);
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool SnapshotManager::GetArchetype(GameManager & gameManager, GameObject & object, uint8_t & outArchetype, uint8_t & outVariant)
+{
+    bool isTopLevel = object.GetParentHandle() == gameManager.GetRootGameObjectHandle();
+    outVariant = 0;
+
+    switch (object.GetTeam())
+    {
+        case ETeam::Player:
+        {
+            outArchetype = SnapshotFormat::Player;
+            return isTopLevel;
+        }
+        case ETeam::Enemy:
+        {
+            auto * pEnemyAIManager = gameManager.GetManager<EnemyAIManager>();
+            if (!isTopLevel || !pEnemyAIManager)
+            {
+                return false;
+            }
+            outArchetype = SnapshotFormat::Enemy;
+            outVariant = uint8_t(pEnemyAIManager->GetEnemyType(object.GetHandle()));
+            return true;
+        }
+        case ETeam::NukeDrop:
+        case ETeam::LifeDrop:
+        {
+            outArchetype = SnapshotFormat::Drop;
+            outVariant = uint8_t(object.GetTeam() == ETeam::NukeDrop ? EDropType::NukePickup : EDropType::LifePickup);
+            return isTopLevel;
+        }
+        case ETeam::Friendly:
+        {
+            GameObject * pParent = object.GetParent();
+            auto pProjectileComponent = pParent ? pParent->GetComponent<ProjectileComponent>().lock() : nullptr;
+            EProjectileType type;
+            if (!pProjectileComponent || !pProjectileComponent->GetProjectileType(object.GetHandle(), type))
+            {
+                return false;
+            }
+            outArchetype = SnapshotFormat::Projectile;
+            outVariant = uint8_t(type);
+            return true;
+        }
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BaseManager.h"
+#include "SnapshotFormat.h"
+
+struct SnapshotStats
+{
+    float mSaveMilliseconds = 0.f;
+    float mLoadMilliseconds = 0.f;
+    size_t mByteCount = 0;
+    int mObjectCount = 0;
+    int mRespawnCount = 0;      // Objects the last load had to spawn again, the rest kept their handles
+};
+
+// Saves the running game to a versioned binary snapshot (see SnapshotFormat.h) and restores it. Saving walks the
+// scene graph once and gathers each component type's state into its own array of POD records, which then go into the
+// snapshot with one memcpy per section. Loading keeps the live objects that still match a record, destroys the rest
+// and has the owning managers spawn whatever is missing, so sprites, clips and physics fixtures come from the same code
+// as in play; then it writes transforms, Box2D bodies and component state over the top. Registered after every
+// gameplay manager, so the automatic snapshot taken every few seconds sees a whole frame.
+class SnapshotManager : public BaseManager
+{
+public:
+    SnapshotManager(GameManager * pGameManager);
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    bool SaveSnapshot(std::vector<uint8_t> & outBytes);
+    bool LoadSnapshot(const void * pData, size_t size);
+
+    bool SaveToFile(const std::string & path);
+    bool LoadFromFile(const std::string & path);
+
+    // Goes back to the snapshot taken automatically every few seconds
+    bool RestoreAutoSnapshot();
+
+    const SnapshotStats & GetStats() const { return mStats; }
+
+    // Which manager spawns the object again on load. Objects without an archetype (effects, the root) are left alone
+    // by both saving and loading.
+    static bool GetArchetype(GameManager & gameManager, GameObject & object, uint8_t & outArchetype, uint8_t & outVariant);
+
+    void DebugImGuiInfo();
+
+private:
+    void GatherObjects();
+    void WriteSnapshot(std::vector<uint8_t> & outBytes) const;
+    BD::Handle Respawn(const SnapshotFormat::ObjectRecord & record);
+    BD::Handle GetRestoredHandle(uint64_t snapshotHandle) const;
+
+    template <typename TRecord, typename TFunc>
+    void ForEachRestored(const SnapshotFormat::Header * pHeader, SnapshotFormat::ESection section, TFunc func);
+
+    uint32_t mFrame;
+    float mAutoSnapshotInterval;
+    float mTimeSinceAutoSnapshot;
+    bool mIsAutoSnapshotEnabled;
+    std::vector<uint8_t> mAutoSnapshot;
+    std::vector<uint8_t> mFileBuffer;
+    SnapshotStats mStats;
+
+    // Gathered on save, kept so snapshots taken every few seconds do not reallocate
+    std::vector<SnapshotFormat::ObjectRecord> mObjects;
+    std::vector<SnapshotFormat::BodyRecord> mBodies;
+    std::vector<SnapshotFormat::HealthRecord> mHealth;
+    std::vector<SnapshotFormat::MovementRecord> mMovement;
+    std::vector<SnapshotFormat::ProjectileRecord> mProjectiles;
+    std::vector<SnapshotFormat::ProjectileEntry> mProjectileEntries;
+    std::vector<SnapshotFormat::AIPathRecord> mAIPaths;
+    std::vector<SnapshotFormat::PathPoint> mPathPoints;
+    std::vector<SnapshotFormat::AnimationRecord> mAnimations;
+    std::vector<SnapshotFormat::DropMovementRecord> mDropMovements;
+    std::vector<BD::Handle> mStack;
+
+    // Snapshot handle to live handle, filled on load
+    std::unordered_map<uint64_t, BD::Handle> mHandleRemap;
+    std::vector<SnapshotFormat::ProjectileEntry> mRemappedEntries;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
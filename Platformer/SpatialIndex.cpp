@@ -0,0 +1,268 @@
+#include "AstroidsPrivate.h"
+#include "SpatialIndex.h"
+#include <cmath>
+
+namespace
+{
+    // Four tiles per cell, about the reach of a typical neighbor query
+    const float skCellSize = 64.f;
+
+    // Power of two so the hash can be masked
+    const int skBucketCount = 4096;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+SpatialIndex::SpatialIndex(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mEntries()
+    , mBuckets(skBucketCount)
+    , mMovedHandles()
+    , mPairNeighbors()
+    , mObjectCount(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+SpatialIndex::~SpatialIndex()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SpatialIndex::Update(float deltaTime)
+{
+    FlushMoves();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SpatialIndex::OnGameEnd()
+{
+    mEntries.clear();
+    for (auto & bucket : mBuckets)
+    {
+        bucket.clear();
+    }
+    mMovedHandles.clear();
+    mObjectCount = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SpatialIndex::MarkMoved(BD::Handle handle)
+{
+    int slot = GetSlot(handle);
+    if (slot >= int(mEntries.size()))
+    {
+        mEntries.resize(slot + 1);
+    }
+
+    Entry & entry = mEntries[slot];
+    if (entry.mQueuedHandle == handle)
+    {
+        return;
+    }
+    entry.mQueuedHandle = handle;
+    mMovedHandles.push_back(handle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SpatialIndex::Remove(BD::Handle handle)
+{
+    int slot = GetSlot(handle);
+    if (slot < int(mEntries.size()) && mEntries[slot].mHandle == handle)
+    {
+        Unlink(slot);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int SpatialIndex::QueryRadius(const sf::Vector2f & center, float radius, TeamMask teams, std::vector<BD::Handle> & outHandles)
+{
+    FlushMoves();
+    outHandles.clear();
+
+    float radiusSquared = radius * radius;
+    ForEachInCells(GetCellCoord(center.x - radius), GetCellCoord(center.y - radius),
+        GetCellCoord(center.x + radius), GetCellCoord(center.y + radius), teams,
+        [&](int slot)
+        {
+            sf::Vector2f delta = mEntries[slot].mPosition - center;
+            if (delta.x * delta.x + delta.y * delta.y <= radiusSquared)
+            {
+                outHandles.push_back(mEntries[slot].mHandle);
+            }
+        });
+    return int(outHandles.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int SpatialIndex::QueryAABB(const sf::FloatRect & rect, TeamMask teams, std::vector<BD::Handle> & outHandles)
+{
+    FlushMoves();
+    outHandles.clear();
+
+    ForEachInCells(GetCellCoord(rect.left), GetCellCoord(rect.top),
+        GetCellCoord(rect.left + rect.width), GetCellCoord(rect.top + rect.height), teams,
+        [&](int slot)
+        {
+            if (rect.contains(mEntries[slot].mPosition))
+            {
+                outHandles.push_back(mEntries[slot].mHandle);
+            }
+        });
+    return int(outHandles.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+BD::Handle SpatialIndex::Nearest(const sf::Vector2f & position, ETeam team, float maxRadius, BD::Handle ignoreHandle)
+{
+    FlushMoves();
+
+    BD::Handle bestHandle = 0;
+    float bestDistanceSquared = maxRadius * maxRadius;
+    auto visit = [&](int slot)
+    {
+        const Entry & entry = mEntries[slot];
+        sf::Vector2f delta = entry.mPosition - position;
+        float distanceSquared = delta.x * delta.x + delta.y * delta.y;
+        if (distanceSquared <= bestDistanceSquared && entry.mHandle != ignoreHandle)
+        {
+            bestDistanceSquared = distanceSquared;
+            bestHandle = entry.mHandle;
+        }
+    };
+
+    // Grow square rings of cells around the start cell. Everything in ring r + 1 is at least r cells away, so once
+    // the best hit is closer than that the remaining rings cannot beat it.
+    int centerX = GetCellCoord(position.x);
+    int centerY = GetCellCoord(position.y);
+    int maxRing = int(std::ceil(maxRadius / skCellSize));
+    TeamMask teams = TeamBit(team);
+    for (int ring = 0; ring <= maxRing; ++ring)
+    {
+        if (ring == 0)
+        {
+            ForEachInCells(centerX, centerY, centerX, centerY, teams, visit);
+        }
+        else
+        {
+            ForEachInCells(centerX - ring, centerY - ring, centerX + ring, centerY - ring, teams, visit);
+            ForEachInCells(centerX - ring, centerY + ring, centerX + ring, centerY + ring, teams, visit);
+            ForEachInCells(centerX - ring, centerY - ring + 1, centerX - ring, centerY + ring - 1, teams, visit);
+            ForEachInCells(centerX + ring, centerY - ring + 1, centerX + ring, centerY + ring - 1, teams, visit);
+        }
+
+        float ringDistance = ring * skCellSize;
+        if (bestHandle != 0 && bestDistanceSquared <= ringDistance * ringDistance)
+        {
+            break;
+        }
+    }
+    return bestHandle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int SpatialIndex::GetCellCoord(float worldCoord) const
+{
+    return int(std::floor(worldCoord / skCellSize));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int SpatialIndex::GetBucket(int cellX, int cellY, ETeam team) const
+{
+    uint32_t hash = uint32_t(cellX) * 73856093u ^ uint32_t(cellY) * 19349663u ^ uint32_t(team) * 83492791u;
+    return int(hash & (skBucketCount - 1));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SpatialIndex::FlushMoves()
+{
+    GameManager & gameManager = GetGameManager();
+    for (BD::Handle handle : mMovedHandles)
+    {
+        int slot = GetSlot(handle);
+        Entry & entry = mEntries[slot];
+        if (entry.mQueuedHandle == handle)
+        {
+            entry.mQueuedHandle = 0;
+        }
+
+        // The slot may still hold an object the pool has since replaced
+        if (entry.mHandle != 0 && entry.mHandle != handle)
+        {
+            Unlink(slot);
+        }
+
+        GameObject * pGameObject = gameManager.GetGameObject(handle);
+        if (!pGameObject || pGameObject->IsDestroyed())
+        {
+            Remove(handle);
+            continue;
+        }
+        Insert(slot, *pGameObject);
+    }
+    mMovedHandles.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SpatialIndex::Insert(int slot, GameObject & gameObject)
+{
+    Entry & entry = mEntries[slot];
+    sf::Vector2f position = gameObject.GetPosition();
+    ETeam team = gameObject.GetTeam();
+    int cellX = GetCellCoord(position.x);
+    int cellY = GetCellCoord(position.y);
+
+    entry.mPosition = position;
+    if (entry.mHandle != 0 && entry.mCellX == cellX && entry.mCellY == cellY && entry.mTeam == team)
+    {
+        return;
+    }
+
+    if (entry.mHandle != 0)
+    {
+        Unlink(slot);
+    }
+
+    entry.mHandle = gameObject.GetHandle();
+    entry.mTeam = team;
+    entry.mCellX = cellX;
+    entry.mCellY = cellY;
+    entry.mBucket = GetBucket(cellX, cellY, team);
+    entry.mBucketSlot = int(mBuckets[entry.mBucket].size());
+    mBuckets[entry.mBucket].push_back(slot);
+    ++mObjectCount;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void SpatialIndex::Unlink(int slot)
+{
+    Entry & entry = mEntries[slot];
+    std::vector<int> & bucket = mBuckets[entry.mBucket];
+
+    int movedSlot = bucket.back();
+    bucket[entry.mBucketSlot] = movedSlot;
+    mEntries[movedSlot].mBucketSlot = entry.mBucketSlot;
+    bucket.pop_back();
+
+    entry.mHandle = 0;
+    entry.mBucket = -1;
+    entry.mBucketSlot = -1;
+    --mObjectCount;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
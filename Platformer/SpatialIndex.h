@@ -0,0 +1,144 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BaseManager.h"
+#include "GameObject.h"
+
+using TeamMask = uint32_t;
+const TeamMask gsAllTeams = ~TeamMask(0);
+
+inline TeamMask TeamBit(ETeam team)
+{
+    return TeamMask(1) << int(team);
+}
+
+// Uniform grid over world positions, answering "what is near me" without walking the GameObject hierarchy.
+// SpriteComponent reports every move and the object is rehashed on the next query or Update, so only objects that
+// moved this frame cost anything. Each (cell, team) pair hashes to its own bucket, which lets a team filtered query
+// skip the other teams' objects entirely. Queries write into caller owned buffers and are main thread only.
+class SpatialIndex : public BaseManager
+{
+public:
+    SpatialIndex(GameManager * pGameManager);
+    ~SpatialIndex();
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    // Position, team or destroyed state changed, picked up before the next query
+    void MarkMoved(BD::Handle handle);
+    void Remove(BD::Handle handle);
+
+    // Clear outHandles and fill it with every object of the given teams inside the circle or rect
+    int QueryRadius(const sf::Vector2f & center, float radius, TeamMask teams, std::vector<BD::Handle> & outHandles);
+    int QueryAABB(const sf::FloatRect & rect, TeamMask teams, std::vector<BD::Handle> & outHandles);
+
+    // Closest object of the team within maxRadius, 0 when there is none
+    BD::Handle Nearest(const sf::Vector2f & position, ETeam team, float maxRadius, BD::Handle ignoreHandle = 0);
+
+    // Calls fn(a, b) once for every pair of objects of the given teams closer than radius
+    template <typename Fn>
+    void ForEachPair(float radius, TeamMask teams, Fn && fn);
+
+    int GetObjectCount() const { return mObjectCount; }
+
+private:
+    struct Entry
+    {
+        BD::Handle mHandle = 0;     // 0 while the slot is not in the index
+        sf::Vector2f mPosition;
+        ETeam mTeam = ETeam::Neutral;
+        int mCellX = 0;
+        int mCellY = 0;
+        int mBucket = -1;
+        int mBucketSlot = -1;
+        BD::Handle mQueuedHandle = 0;   // Set while a move for this handle waits in mMovedHandles
+    };
+
+    static int GetSlot(BD::Handle handle) { return int(handle & 0xFFFFFFFF); }
+
+    int GetCellCoord(float worldCoord) const;
+    int GetBucket(int cellX, int cellY, ETeam team) const;
+    void FlushMoves();
+    void Insert(int slot, GameObject & gameObject);
+    void Unlink(int slot);
+
+    // Calls fn(slot) for each object of the teams whose cell lies in the inclusive cell range
+    template <typename Fn>
+    void ForEachInCells(int minX, int minY, int maxX, int maxY, TeamMask teams, Fn && fn) const;
+
+    std::vector<Entry> mEntries;                // Indexed by pool slot
+    std::vector<std::vector<int>> mBuckets;     // Slots per hashed (cell, team)
+    std::vector<BD::Handle> mMovedHandles;
+    std::vector<int> mPairNeighbors;
+    int mObjectCount;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+template <typename Fn>
+void SpatialIndex::ForEachInCells(int minX, int minY, int maxX, int maxY, TeamMask teams, Fn && fn) const
+{
+    for (int team = 0; team < int(sizeof(TeamMask) * 8) && (teams >> team) != 0; ++team)
+    {
+        if (!(teams & (TeamMask(1) << team)))
+        {
+            continue;
+        }
+
+        for (int cellY = minY; cellY <= maxY; ++cellY)
+        {
+            for (int cellX = minX; cellX <= maxX; ++cellX)
+            {
+                // Buckets are shared on hash collisions, the cell check keeps every object to the one cell it is in
+                for (int slot : mBuckets[GetBucket(cellX, cellY, ETeam(team))])
+                {
+                    const Entry & entry = mEntries[slot];
+                    if (entry.mCellX == cellX && entry.mCellY == cellY && int(entry.mTeam) == team)
+                    {
+                        fn(slot);
+                    }
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+template <typename Fn>
+void SpatialIndex::ForEachPair(float radius, TeamMask teams, Fn && fn)
+{
+    FlushMoves();
+
+    float radiusSquared = radius * radius;
+    for (int slot = 0; slot < int(mEntries.size()); ++slot)
+    {
+        BD::Handle handle = mEntries[slot].mHandle;
+        sf::Vector2f position = mEntries[slot].mPosition;
+        if (handle == 0 || !(teams & TeamBit(mEntries[slot].mTeam)))
+        {
+            continue;
+        }
+
+        mPairNeighbors.clear();
+        ForEachInCells(GetCellCoord(position.x - radius), GetCellCoord(position.y - radius),
+            GetCellCoord(position.x + radius), GetCellCoord(position.y + radius), teams,
+            [this, slot](int other) { if (other > slot) mPairNeighbors.push_back(other); });
+
+        // Collected first so fn is free to move or remove objects, moves are only queued until the next flush
+        for (int other : mPairNeighbors)
+        {
+            const Entry & otherEntry = mEntries[other];
+            sf::Vector2f delta = otherEntry.mPosition - position;
+            if (otherEntry.mHandle != 0 && delta.x * delta.x + delta.y * delta.y < radiusSquared)
+            {
+                fn(handle, otherEntry.mHandle);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
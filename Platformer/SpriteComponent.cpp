@@ -2,12 +2,12 @@
 #include "SpriteComponent.h"
 #include "cassert"
 #include "imgui.h"
+#include "SpatialIndex.h"
 
 SpriteComponent::SpriteComponent(GameObject * pOwner, GameManager & gameManager)
     : GameComponent(pOwner, gameManager)
     , mRotationSpeed(3.f)
     , mCurrentRotation(0.f)
-    , mName("SpriteComponent")
 {
     SetOriginToCenter();
 }
@@ -42,6 +42,7 @@ sf::Vector2f SpriteComponent::GetPosition() const
 void SpriteComponent::SetPosition(const sf::Vector2f & position)
 {
     mSprite.setPosition(position);
+    NotifyMoved();
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -63,6 +64,7 @@ float SpriteComponent::GetHeight() const
 void SpriteComponent::Move(const sf::Vector2f & offset)
 {
     mSprite.move(offset);
+    NotifyMoved();
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -70,6 +72,7 @@ void SpriteComponent::Move(const sf::Vector2f & offset)
 void SpriteComponent::Move(float x, float y)
 {
     mSprite.move(sf::Vector2f(x, y));
+    NotifyMoved();
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -152,23 +155,29 @@ void SpriteComponent::draw(sf::RenderTarget & target, sf::RenderStates states)
 
 //------------------------------------------------------------------------------------------------------------------------
 
-void SpriteComponent::DebugImGuiComponentInfo()
+BD_REGISTER_COMPONENT(SpriteComponent)
+
+void SpriteComponent::DescribeType(ComponentTypeInfo & typeInfo)
 {
-    
+    typeInfo.AddField<&SpriteComponent::mRotationSpeed>("RotationSpeed");
+    typeInfo.AddField<&SpriteComponent::mCurrentRotation>("CurrentRotation");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & SpriteComponent::GetClassName()
+sf::Sprite & SpriteComponent::GetSprite()
 {
-    return mName;
+    return mSprite;
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 
-sf::Sprite & SpriteComponent::GetSprite()
+void SpriteComponent::NotifyMoved()
 {
-    return mSprite;
+    if (auto * pSpatialIndex = mGameManager.GetManager<SpatialIndex>())
+    {
+        pSpatialIndex->MarkMoved(mOwnerHandle);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -4,6 +4,8 @@
 
 class SpriteComponent : public GameComponent
 {
+	BD_COMPONENT(SpriteComponent)
+
 public:
 	SpriteComponent(GameObject * pOwner, GameManager & gameManager);
 	~SpriteComponent();
@@ -32,15 +34,14 @@ public:
 
 	virtual void Update(float deltaTime) override;
 	virtual void draw(sf::RenderTarget & target, sf::RenderStates states) override;
-	virtual void DebugImGuiComponentInfo() override;
-	virtual std::string & GetClassName() override;
 
 private:
+	void NotifyMoved();
+
 	sf::Texture mTexture;
 	sf::Sprite mSprite;
 	float mRotationSpeed;
 	float mCurrentRotation;
-	std::string mName;
 };
 
 //------------------------------------------------------------------------------------------------------------------------
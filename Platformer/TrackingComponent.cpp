@@ -1,10 +1,10 @@
 #include "AstroidsPrivate.h"
 #include "TrackingComponent.h"
+#include "VisibilityService.h"
 
 TrackingComponent::TrackingComponent(GameObject * pOwner, GameManager & gameManager, BD::Handle trackedHandle)
 	: GameComponent(pOwner, gameManager)
 	, mTracker(trackedHandle)
-    , mName("TrackingComponent")
 {
 
 }
@@ -33,6 +33,13 @@ void TrackingComponent::Update(float deltaTime)
     sf::Vector2f ownerPosition = pGameObject->GetPosition();
     sf::Vector2f trackedPosition = pTrackedGameObject->GetPosition();
 
+    // Keep the last heading while the target is behind a wall
+    auto * pVisibilityService = gameManager.GetManager<VisibilityService>();
+    if (pVisibilityService && !pVisibilityService->HasLineOfSight(ownerPosition, trackedPosition))
+    {
+        return;
+    }
+
     sf::Vector2f direction = trackedPosition - ownerPosition;
     float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
     if (length != 0)
@@ -47,9 +54,11 @@ void TrackingComponent::Update(float deltaTime)
 
 //------------------------------------------------------------------------------------------------------------------------
 
-std::string & TrackingComponent::GetClassName()
+BD_REGISTER_COMPONENT(TrackingComponent)
+
+void TrackingComponent::DescribeType(ComponentTypeInfo & typeInfo)
 {
-    return mName;
+    typeInfo.AddField<&TrackingComponent::mTracker>("Tracker");
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -2,15 +2,15 @@
 #include "GameComponent.h"
 class TrackingComponent : public GameComponent
 {
+	BD_COMPONENT(TrackingComponent)
+
 public:
 	TrackingComponent(GameObject * pOwner, GameManager & gameManager, BD::Handle trackedHandle);
 	~TrackingComponent();
 
 	virtual void Update(float deltaTime) override;
-	virtual std::string & GetClassName() override;
 
 private:
 	BD::Handle mTracker;
-	std::string mName;
 };
 
@@ -0,0 +1,342 @@
+#include "AstroidsPrivate.h"
+#include "VisibilityService.h"
+#include "LevelManager.h"
+#include "PlayerManager.h"
+#include "NavigationManager.h"
+#include <climits>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Tiles from the player the field of view reaches, a little beyond the edge of the screen
+    const int skFieldOfViewRadius = 40;
+
+    const int skMinQueriesPerJob = 64;
+
+    // Slopes stay exact as fractions, shadowcasting is only symmetric without rounding error
+    struct Slope
+    {
+        int mNumerator;
+        int mDenominator;   // Always positive
+    };
+
+    struct ScanRow
+    {
+        int mDepth;
+        Slope mStart;
+        Slope mEnd;
+    };
+
+    int FloorDiv(int numerator, int denominator)
+    {
+        int quotient = numerator / denominator;
+        return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+    }
+
+    int CeilDiv(int numerator, int denominator)
+    {
+        return -FloorDiv(-numerator, denominator);
+    }
+
+    // Slope through the edge of the tile at col that faces the start of the row
+    Slope GetTileSlope(int depth, int col)
+    {
+        return { 2 * col - 1, 2 * depth };
+    }
+
+    sf::Vector2i TransformToQuadrant(const sf::Vector2i & origin, int quadrant, int depth, int col)
+    {
+        switch (quadrant)
+        {
+            case 0: return sf::Vector2i(origin.x + col, origin.y - depth);     // North
+            case 1: return sf::Vector2i(origin.x + depth, origin.y + col);     // East
+            case 2: return sf::Vector2i(origin.x + col, origin.y + depth);     // South
+            default: return sf::Vector2i(origin.x - depth, origin.y + col);    // West
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+VisibilityService::VisibilityService(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mOpaque()
+    , mFieldOfView(2 * skFieldOfViewRadius + 1, 2 * skFieldOfViewRadius + 1)
+    , mFovOrigin(INT_MIN, INT_MIN)
+    , mHasFieldOfView(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+VisibilityService::~VisibilityService()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void VisibilityService::Update(float deltaTime)
+{
+    auto & gameManager = GetGameManager();
+    auto * pLevelManager = gameManager.GetManager<LevelManager>();
+    if (!pLevelManager)
+    {
+        return;
+    }
+
+    const BitGridView & opaque = pLevelManager->GetLayer(LevelFormat::Opaque);
+    if (opaque.GetRowWords(0) != mOpaque.GetRowWords(0) || opaque.GetWidth() != mOpaque.GetWidth() ||
+        opaque.GetHeight() != mOpaque.GetHeight())
+    {
+        mOpaque = opaque;
+        mHasFieldOfView = false;
+    }
+
+    auto * pPlayerManager = gameManager.GetManager<PlayerManager>();
+    if (mOpaque.IsEmpty() || !pPlayerManager || pPlayerManager->GetPlayers().empty())
+    {
+        return;
+    }
+
+    GameObject * pPlayer = gameManager.GetGameObject(pPlayerManager->GetPlayers()[0]);
+    if (!pPlayer)
+    {
+        return;
+    }
+
+    sf::Vector2i playerTile = NavigationManager::WorldToTile(pPlayer->GetPosition());
+    if (!mHasFieldOfView || playerTile != mFovOrigin)
+    {
+        RebuildFieldOfView(playerTile);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void VisibilityService::OnGameEnd()
+{
+    mHasFieldOfView = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool VisibilityService::CastRay(const sf::Vector2f & from, const sf::Vector2f & to, RaycastHit * pOutHit) const
+{
+    if (mOpaque.IsEmpty())
+    {
+        return false;
+    }
+
+    // Work in tile units, t runs from 0 at from to 1 at to
+    const float invCellSize = 1.f / BD::gsPixelCountCellSize;
+    float startX = from.x * invCellSize;
+    float startY = from.y * invCellSize;
+    float deltaX = to.x * invCellSize - startX;
+    float deltaY = to.y * invCellSize - startY;
+
+    int tileX = int(std::floor(startX));
+    int tileY = int(std::floor(startY));
+    int endTileX = int(std::floor(to.x * invCellSize));
+    int endTileY = int(std::floor(to.y * invCellSize));
+    int stepX = deltaX > 0.f ? 1 : (deltaX < 0.f ? -1 : 0);
+    int stepY = deltaY > 0.f ? 1 : (deltaY < 0.f ? -1 : 0);
+
+    // Distance in t to the next vertical and horizontal grid line, and between two of them
+    const float infinity = std::numeric_limits<float>::infinity();
+    float tDeltaX = stepX != 0 ? std::abs(1.f / deltaX) : infinity;
+    float tDeltaY = stepY != 0 ? std::abs(1.f / deltaY) : infinity;
+    float tMaxX = stepX > 0 ? (tileX + 1 - startX) * tDeltaX : (stepX < 0 ? (startX - tileX) * tDeltaX : infinity);
+    float tMaxY = stepY > 0 ? (tileY + 1 - startY) * tDeltaY : (stepY < 0 ? (startY - tileY) * tDeltaY : infinity);
+
+    // Every step crosses exactly one grid line, which bounds the walk even if rounding drifts past the end tile
+    int stepsLeft = std::abs(endTileX - tileX) + std::abs(endTileY - tileY);
+    for (; stepsLeft > 0; --stepsLeft)
+    {
+        float t;
+        if (tMaxX < tMaxY)
+        {
+            tileX += stepX;
+            t = tMaxX;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            tileY += stepY;
+            t = tMaxY;
+            tMaxY += tDeltaY;
+        }
+
+        if (IsOpaque(tileX, tileY))
+        {
+            if (pOutHit)
+            {
+                sf::Vector2f ray = to - from;
+                pOutHit->mTile = sf::Vector2i(tileX, tileY);
+                pOutHit->mPoint = from + ray * t;
+                pOutHit->mDistance = t * std::sqrt(ray.x * ray.x + ray.y * ray.y);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool VisibilityService::HasLineOfSight(const sf::Vector2f & from, const sf::Vector2f & to) const
+{
+    return !CastRay(from, to);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void VisibilityService::QueryLineOfSight(const std::vector<LineOfSightQuery> & queries, std::vector<uint8_t> & outVisible,
+    bool useWorkerThreads) const
+{
+    outVisible.resize(queries.size());
+    auto castRange = [this, &queries, &outVisible](int begin, int end)
+        {
+            for (int query = begin; query < end; ++query)
+            {
+                outVisible[query] = uint8_t(HasLineOfSight(queries[query].mFrom, queries[query].mTo));
+            }
+        };
+
+    if (useWorkerThreads)
+    {
+        GetGameManager().GetJobSystem().ParallelFor(int(queries.size()), skMinQueriesPerJob, castRange);
+    }
+    else
+    {
+        castRange(0, int(queries.size()));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool VisibilityService::IsTileVisibleFromPlayer(int x, int y) const
+{
+    return mHasFieldOfView &&
+        mFieldOfView.Test(x - mFovOrigin.x + skFieldOfViewRadius, y - mFovOrigin.y + skFieldOfViewRadius);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool VisibilityService::IsVisibleFromPlayer(const sf::Vector2f & position) const
+{
+    sf::Vector2i tile = NavigationManager::WorldToTile(position);
+    return IsTileVisibleFromPlayer(tile.x, tile.y);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int VisibilityService::GetFieldOfViewRadius() const
+{
+    return skFieldOfViewRadius;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void VisibilityService::MarkTilesChanged(const sf::IntRect & tiles)
+{
+    sf::IntRect fovBounds(mFovOrigin.x - skFieldOfViewRadius, mFovOrigin.y - skFieldOfViewRadius,
+        2 * skFieldOfViewRadius + 1, 2 * skFieldOfViewRadius + 1);
+    if (mHasFieldOfView && fovBounds.intersects(tiles))
+    {
+        mHasFieldOfView = false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool VisibilityService::IsOpaque(int x, int y) const
+{
+    // Off the map counts as a wall
+    return !mOpaque.IsInBounds(x, y) || mOpaque.TestUnchecked(x, y);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void VisibilityService::RebuildFieldOfView(const sf::Vector2i & origin)
+{
+    mFieldOfView.SetAll(false);
+    mFovOrigin = origin;
+    mHasFieldOfView = true;
+
+    Reveal(origin.x, origin.y);
+    for (int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        ScanQuadrant(origin, quadrant);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void VisibilityService::ScanQuadrant(const sf::Vector2i & origin, int quadrant)
+{
+    // Symmetric shadowcasting, rows move away from the origin and each one is scanned between two slopes. A floor to
+    // wall transition closes a row segment and queues the next row for it, a wall to floor one opens a new segment.
+    std::vector<ScanRow> rows;
+    rows.push_back({ 1, { -1, 1 }, { 1, 1 } });
+    while (!rows.empty())
+    {
+        ScanRow row = rows.back();
+        rows.pop_back();
+        if (row.mDepth > skFieldOfViewRadius)
+        {
+            continue;
+        }
+
+        // Columns whose centers fall between the slopes, rounding ties outward
+        int depth = row.mDepth;
+        int minCol = FloorDiv(2 * depth * row.mStart.mNumerator + row.mStart.mDenominator, 2 * row.mStart.mDenominator);
+        int maxCol = CeilDiv(2 * depth * row.mEnd.mNumerator - row.mEnd.mDenominator, 2 * row.mEnd.mDenominator);
+
+        int previous = -1;  // -1 before the first tile, then 1 for a wall and 0 for floor
+        for (int col = minCol; col <= maxCol; ++col)
+        {
+            sf::Vector2i tile = TransformToQuadrant(origin, quadrant, depth, col);
+            bool isWall = IsOpaque(tile.x, tile.y);
+
+            // Floor is only revealed when its center is inside the row, which is what keeps the result symmetric
+            bool isCenterInside = col * row.mStart.mDenominator >= depth * row.mStart.mNumerator &&
+                col * row.mEnd.mDenominator <= depth * row.mEnd.mNumerator;
+            if (isWall || isCenterInside)
+            {
+                Reveal(tile.x, tile.y);
+            }
+
+            if (previous == 1 && !isWall)
+            {
+                row.mStart = GetTileSlope(depth, col);
+            }
+            if (previous == 0 && isWall)
+            {
+                rows.push_back({ depth + 1, row.mStart, GetTileSlope(depth, col) });
+            }
+            previous = isWall ? 1 : 0;
+        }
+
+        if (previous == 0)
+        {
+            rows.push_back({ depth + 1, row.mStart, row.mEnd });
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void VisibilityService::Reveal(int x, int y)
+{
+    int localX = x - mFovOrigin.x + skFieldOfViewRadius;
+    int localY = y - mFovOrigin.y + skFieldOfViewRadius;
+    if (mFieldOfView.IsInBounds(localX, localY))
+    {
+        mFieldOfView.Set(localX, localY, true);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BaseManager.h"
+#include "BitGrid.h"
+
+struct RaycastHit
+{
+    sf::Vector2i mTile;     // First opaque tile the ray entered
+    sf::Vector2f mPoint;    // Where it entered, in world pixels
+    float mDistance;        // Pixels from the ray's start
+};
+
+struct LineOfSightQuery
+{
+    sf::Vector2f mFrom;
+    sf::Vector2f mTo;
+};
+
+// Visibility over the cooked opaque layer, with no Box2D involved. Rays walk the tile grid with Amanatides-Woo DDA,
+// visiting each tile they cross exactly once. Around the player a symmetric shadowcasting field of view is kept, only
+// recomputed when the player changes tile, so "can the player see this tile" and the reverse are a single bit test.
+// Queries are const and safe to run from worker threads between Updates.
+class VisibilityService : public BaseManager
+{
+public:
+    VisibilityService(GameManager * pGameManager);
+    ~VisibilityService();
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    // True when an opaque tile lies between from and to. The tile from starts in never blocks.
+    bool CastRay(const sf::Vector2f & from, const sf::Vector2f & to, RaycastHit * pOutHit = nullptr) const;
+    bool HasLineOfSight(const sf::Vector2f & from, const sf::Vector2f & to) const;
+
+    // outVisible[i] is 1 when query i has line of sight. Large batches are split across the JobSystem.
+    void QueryLineOfSight(const std::vector<LineOfSightQuery> & queries, std::vector<uint8_t> & outVisible,
+        bool useWorkerThreads = true) const;
+
+    // Field of view around the player's tile. Symmetric, so it also answers whether a tile can see the player.
+    bool IsTileVisibleFromPlayer(int x, int y) const;
+    bool IsVisibleFromPlayer(const sf::Vector2f & position) const;
+    int GetFieldOfViewRadius() const;
+
+    // Opacity changed inside these tiles, the field of view is rebuilt next Update if it covers them
+    void MarkTilesChanged(const sf::IntRect & tiles);
+
+private:
+    bool IsOpaque(int x, int y) const;
+    void RebuildFieldOfView(const sf::Vector2i & origin);
+    void ScanQuadrant(const sf::Vector2i & origin, int quadrant);
+    void Reveal(int x, int y);
+
+    BitGridView mOpaque;
+
+    // Visible tiles in a square window centered on mFovOrigin
+    BitGrid mFieldOfView;
+    sf::Vector2i mFovOrigin;
+    bool mHasFieldOfView;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
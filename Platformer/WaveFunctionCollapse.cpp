@@ -0,0 +1,449 @@
+#include "AstroidsPrivate.h"
+#include "WaveFunctionCollapse.h"
+#include "LevelCook.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    const int skDirectionCount = 4;
+    const int skDirectionOffsetX[skDirectionCount] = { 0, 1, 0, -1 };
+    const int skDirectionOffsetY[skDirectionCount] = { -1, 0, 1, 0 };
+
+    // Support tables are looked up one byte of the domain at a time
+    const int skSupportByteValues = 256;
+    const int skSupportTableSize = (WfcRules::skMaxTileCount / 8) * skSupportByteValues;
+
+    // Small enough never to reorder cells whose entropies really differ
+    const float skNoiseScale = 1e-4f;
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    int PopCount(uint64_t word)
+    {
+#ifdef _MSC_VER
+        return int(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    int CountTrailingZeros(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return int(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    // xorshift32, deterministic on every compiler unlike the std distributions
+    uint32_t NextRandom(uint32_t & state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float RandomUnit(uint32_t & state)
+    {
+        return float(NextRandom(state) >> 8) * (1.f / 16777216.f);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    uint64_t GetTileBit(int tile)
+    {
+        return uint64_t(1) << tile;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// WfcRules
+//------------------------------------------------------------------------------------------------------------------------
+
+int WfcRules::AddTile(uint32_t tileId, float weight)
+{
+    if (GetTileCount() >= skMaxTileCount)
+    {
+        return -1;
+    }
+
+    mTileIds.push_back(tileId);
+    mWeights.push_back(std::max(weight, 1e-6f));
+    for (auto & allowed : mAllowed)
+    {
+        allowed.push_back(0);
+    }
+    return GetTileCount() - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WfcRules::Allow(int tile, EWfcDirection direction, int neighbor)
+{
+    int side = int(direction);
+    mAllowed[side][tile] |= GetTileBit(neighbor);
+    mAllowed[(side + 2) % skDirectionCount][neighbor] |= GetTileBit(tile);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WfcRules::LoadFromTileset(const std::string & tsxPath, std::string & outError)
+{
+    TileAdjacency adjacency;
+    if (!ReadTileAdjacency(tsxPath, adjacency, outError))
+    {
+        return false;
+    }
+    if (adjacency.mTileIds.size() > size_t(skMaxTileCount))
+    {
+        outError = "Tileset " + tsxPath + " has more than 64 tiles with adjacency rules";
+        return false;
+    }
+
+    *this = WfcRules();
+    for (size_t tile = 0; tile < adjacency.mTileIds.size(); ++tile)
+    {
+        AddTile(adjacency.mTileIds[tile], adjacency.mWeights[tile]);
+    }
+    for (const TileAdjacency::Rule & rule : adjacency.mRules)
+    {
+        Allow(int(rule.mTile), EWfcDirection(rule.mDirection), int(rule.mNeighbor));
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// WfcSolver
+//------------------------------------------------------------------------------------------------------------------------
+
+WfcSolver::WfcSolver(const WfcRules & rules)
+    : mTileCount(rules.GetTileCount())
+    , mSupportByteCount((rules.GetTileCount() + 7) / 8)
+    , mSupportTables(size_t(skDirectionCount) * skSupportTableSize, 0)
+    , mWeights(rules.GetTileCount())
+    , mWeightLogWeights(rules.GetTileCount())
+    , mWidth(0)
+    , mHeight(0)
+    , mMaxBacktracks(0)
+    , mRandomState(1)
+    , mResult()
+    , mStats()
+{
+    for (int tile = 0; tile < mTileCount; ++tile)
+    {
+        mWeights[tile] = rules.GetWeight(tile);
+        mWeightLogWeights[tile] = mWeights[tile] * std::log(mWeights[tile]);
+    }
+
+    // Entry [direction][byte][value] is every tile allowed on that side of the tiles set in that byte of a domain
+    for (int direction = 0; direction < skDirectionCount; ++direction)
+    {
+        uint64_t * pTable = &mSupportTables[size_t(direction) * skSupportTableSize];
+        for (int byte = 0; byte < mSupportByteCount; ++byte)
+        {
+            for (int value = 1; value < skSupportByteValues; ++value)
+            {
+                uint64_t support = 0;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    int tile = byte * 8 + bit;
+                    if ((value & (1 << bit)) && tile < mTileCount)
+                    {
+                        support |= rules.GetAllowed(tile, EWfcDirection(direction));
+                    }
+                }
+                pTable[byte * skSupportByteValues + value] = support;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WfcSolver::Solve(const WfcSettings & settings)
+{
+    StopWatch stopWatch;
+    mStats = WfcStats();
+    mWidth = settings.mWidth;
+    mHeight = settings.mHeight;
+    mMaxBacktracks = settings.mMaxBacktracks;
+    mRandomState = settings.mSeed * 2654435761u + 1u;
+    if (mRandomState == 0)
+    {
+        mRandomState = 1;
+    }
+
+    int cellCount = mWidth * mHeight;
+    if (mTileCount == 0 || cellCount <= 0)
+    {
+        return false;
+    }
+
+    uint64_t allTiles = mTileCount == WfcRules::skMaxTileCount ? ~uint64_t(0) : GetTileBit(mTileCount) - 1;
+    mDomains.assign(cellCount, allTiles);
+    mNoise.resize(cellCount);
+    for (float & noise : mNoise)
+    {
+        noise = RandomUnit(mRandomState) * skNoiseScale;
+    }
+
+    mEntropies.resize(cellCount);
+    mHeap.clear();
+    if (mTileCount > 1)
+    {
+        mHeap.reserve(size_t(cellCount) * 2);
+        for (int cell = 0; cell < cellCount; ++cell)
+        {
+            mEntropies[cell] = GetEntropy(cell);
+            mHeap.push_back({ mEntropies[cell], cell });
+        }
+        std::make_heap(mHeap.begin(), mHeap.end(), std::greater<HeapEntry>());
+    }
+
+    mTrail.clear();
+    mDecisions.clear();
+    mQueue.clear();
+    mIsQueued.assign(cellCount, 0);
+
+    // Tiles that can never have a neighbor on some side go before the first decision, and an unsolvable rule set
+    // fails here without searching
+    for (int cell = 0; cell < cellCount; ++cell)
+    {
+        mQueue.push_back(cell);
+        mIsQueued[cell] = 1;
+    }
+    bool isConsistent = Propagate();
+
+    while (isConsistent)
+    {
+        int cell = PopLowestEntropyCell();
+        if (cell < 0)
+        {
+            break;
+        }
+
+        int tile = PickTile(mDomains[cell]);
+        mDecisions.push_back({ mTrail.size(), cell, tile });
+        ++mStats.mDecisionCount;
+        if (!Narrow(cell, GetTileBit(tile)) || !Propagate())
+        {
+            isConsistent = Backtrack();
+        }
+    }
+
+    if (isConsistent)
+    {
+        mResult.Resize(mWidth, mHeight);
+        uint8_t * pResult = mResult.GetData();
+        for (int cell = 0; cell < cellCount; ++cell)
+        {
+            pResult[cell] = uint8_t(CountTrailingZeros(mDomains[cell]));
+        }
+    }
+
+    mStats.mIsSolved = isConsistent;
+    mStats.mMilliseconds = stopWatch.GetElapsedMilliseconds();
+    return isConsistent;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+uint64_t WfcSolver::GetSupport(uint64_t domain, int direction) const
+{
+    const uint64_t * pTable = &mSupportTables[size_t(direction) * skSupportTableSize];
+    uint64_t support = 0;
+    for (int byte = 0; byte < mSupportByteCount; ++byte)
+    {
+        support |= pTable[byte * skSupportByteValues + int((domain >> (byte * 8)) & 0xFF)];
+    }
+    return support;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+float WfcSolver::GetEntropy(int cell) const
+{
+    // Shannon entropy of the weights left in the domain
+    float weightSum = 0.f;
+    float weightLogWeightSum = 0.f;
+    for (uint64_t domain = mDomains[cell]; domain; domain &= domain - 1)
+    {
+        int tile = CountTrailingZeros(domain);
+        weightSum += mWeights[tile];
+        weightLogWeightSum += mWeightLogWeights[tile];
+    }
+    return std::log(weightSum) - weightLogWeightSum / weightSum + mNoise[cell];
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WfcSolver::PushCell(int cell)
+{
+    mEntropies[cell] = GetEntropy(cell);
+    mHeap.push_back({ mEntropies[cell], cell });
+    std::push_heap(mHeap.begin(), mHeap.end(), std::greater<HeapEntry>());
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int WfcSolver::PopLowestEntropyCell()
+{
+    while (!mHeap.empty())
+    {
+        std::pop_heap(mHeap.begin(), mHeap.end(), std::greater<HeapEntry>());
+        HeapEntry entry = mHeap.back();
+        mHeap.pop_back();
+
+        // Entries are pushed on every change and never removed, only the newest one for an open cell counts
+        if (PopCount(mDomains[entry.mCell]) > 1 && entry.mEntropy == mEntropies[entry.mCell])
+        {
+            return entry.mCell;
+        }
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int WfcSolver::PickTile(uint64_t domain)
+{
+    float weightSum = 0.f;
+    for (uint64_t bits = domain; bits; bits &= bits - 1)
+    {
+        weightSum += mWeights[CountTrailingZeros(bits)];
+    }
+
+    float pick = RandomUnit(mRandomState) * weightSum;
+    int tile = CountTrailingZeros(domain);
+    for (uint64_t bits = domain; bits; bits &= bits - 1)
+    {
+        tile = CountTrailingZeros(bits);
+        pick -= mWeights[tile];
+        if (pick < 0.f)
+        {
+            break;
+        }
+    }
+    return tile;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WfcSolver::Narrow(int cell, uint64_t domain)
+{
+    uint64_t previous = mDomains[cell];
+    if (domain == previous)
+    {
+        return true;
+    }
+    if (domain == 0)
+    {
+        return false;
+    }
+
+    mTrail.push_back({ cell, previous });
+    mDomains[cell] = domain;
+    ++mStats.mNarrowCount;
+
+    if (PopCount(domain) > 1)
+    {
+        PushCell(cell);
+    }
+    if (!mIsQueued[cell])
+    {
+        mIsQueued[cell] = 1;
+        mQueue.push_back(cell);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WfcSolver::Propagate()
+{
+    while (!mQueue.empty())
+    {
+        int cell = mQueue.back();
+        mQueue.pop_back();
+        mIsQueued[cell] = 0;
+
+        int x = cell % mWidth;
+        int y = cell / mWidth;
+        uint64_t domain = mDomains[cell];
+        for (int direction = 0; direction < skDirectionCount; ++direction)
+        {
+            int neighborX = x + skDirectionOffsetX[direction];
+            int neighborY = y + skDirectionOffsetY[direction];
+            if (unsigned(neighborX) >= unsigned(mWidth) || unsigned(neighborY) >= unsigned(mHeight))
+            {
+                continue;
+            }
+
+            int neighbor = neighborY * mWidth + neighborX;
+            if (!Narrow(neighbor, mDomains[neighbor] & GetSupport(domain, direction)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WfcSolver::Backtrack()
+{
+    while (true)
+    {
+        for (int cell : mQueue)
+        {
+            mIsQueued[cell] = 0;
+        }
+        mQueue.clear();
+
+        if (mDecisions.empty() || mStats.mBacktrackCount >= mMaxBacktracks)
+        {
+            return false;
+        }
+        ++mStats.mBacktrackCount;
+
+        Decision decision = mDecisions.back();
+        mDecisions.pop_back();
+
+        // Unwound newest first, so a cell's last restore is its domain from before the decision
+        while (mTrail.size() > decision.mTrailSize)
+        {
+            const TrailEntry & entry = mTrail.back();
+            mDomains[entry.mCell] = entry.mDomain;
+            if (PopCount(entry.mDomain) > 1)
+            {
+                PushCell(entry.mCell);
+            }
+            mTrail.pop_back();
+        }
+
+        // Ruling the tile out is a consequence of the earlier decisions, so it stays on their part of the trail
+        uint64_t remaining = mDomains[decision.mCell] & ~GetTileBit(decision.mTile);
+        if (Narrow(decision.mCell, remaining) && Propagate())
+        {
+            return true;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
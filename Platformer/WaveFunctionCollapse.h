@@ -0,0 +1,145 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Grid2D.h"
+
+enum class EWfcDirection : uint8_t
+{
+    Up,
+    Right,
+    Down,
+    Left
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// WfcRules
+//
+// The tiles a WfcSolver may place and which of them may sit next to which. There are at most 64 tiles so a cell's
+// domain is one word, and the rules are kept as one mask per tile and direction of the tiles allowed on that side.
+//------------------------------------------------------------------------------------------------------------------------
+
+class WfcRules
+{
+public:
+    static const int skMaxTileCount = 64;
+
+    // The new tile's index, or -1 once there are skMaxTileCount tiles
+    int AddTile(uint32_t tileId, float weight);
+
+    // Lets neighbor sit on the given side of tile, and so tile on the opposite side of neighbor
+    void Allow(int tile, EWfcDirection direction, int neighbor);
+
+    // Replaces the rules with a tileset's Wang sets and "wfcNeighbors" properties, see ReadTileAdjacency
+    bool LoadFromTileset(const std::string & tsxPath, std::string & outError);
+
+    int GetTileCount() const { return int(mTileIds.size()); }
+    uint32_t GetTileId(int tile) const { return mTileIds[tile]; }
+    float GetWeight(int tile) const { return mWeights[tile]; }
+    uint64_t GetAllowed(int tile, EWfcDirection direction) const { return mAllowed[int(direction)][tile]; }
+
+private:
+    std::vector<uint32_t> mTileIds;
+    std::vector<float> mWeights;
+    std::vector<uint64_t> mAllowed[4];
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+
+struct WfcSettings
+{
+    uint32_t mSeed = 1;
+    int mWidth = 64;
+    int mHeight = 64;
+    int mMaxBacktracks = 4096;  // Contradictions undone before the solver gives up
+};
+
+struct WfcStats
+{
+    float mMilliseconds = 0.f;
+    int mDecisionCount = 0;
+    int mBacktrackCount = 0;
+    int64_t mNarrowCount = 0;   // Domains shrunk by propagation
+    bool mIsSolved = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// WfcSolver
+//
+// Wave function collapse over a grid of bitmask domains, the same rules and seed always give the same result. The
+// cell with the lowest weighted entropy comes off a heap and is collapsed to a weighted random tile, then AC-3 style
+// propagation narrows each queued cell's neighbors to the tiles its domain still supports. The support of a whole
+// domain is looked up a byte at a time from per direction tables, so narrowing a neighbor is a few ORs and an AND.
+// Every narrowing goes on a trail; on a contradiction the trail is unwound to the last decision and the tile that was
+// picked there is ruled out instead.
+//------------------------------------------------------------------------------------------------------------------------
+
+class WfcSolver
+{
+public:
+    explicit WfcSolver(const WfcRules & rules);
+
+    bool Solve(const WfcSettings & settings);
+
+    // Rule tile index per cell, valid after Solve returned true
+    const Grid2D<uint8_t> & GetResult() const { return mResult; }
+    const WfcStats & GetStats() const { return mStats; }
+
+private:
+    struct HeapEntry
+    {
+        float mEntropy;
+        int mCell;
+
+        bool operator>(const HeapEntry & other) const { return mEntropy > other.mEntropy; }
+    };
+
+    struct TrailEntry
+    {
+        int mCell;
+        uint64_t mDomain;   // Before the change
+    };
+
+    struct Decision
+    {
+        size_t mTrailSize;
+        int mCell;
+        int mTile;
+    };
+
+    uint64_t GetSupport(uint64_t domain, int direction) const;
+    float GetEntropy(int cell) const;
+    void PushCell(int cell);
+    int PopLowestEntropyCell();
+    int PickTile(uint64_t domain);
+    bool Narrow(int cell, uint64_t domain);
+    bool Propagate();
+    bool Backtrack();
+
+    int mTileCount;
+    int mSupportByteCount;
+    std::vector<uint64_t> mSupportTables;   // [direction][byte][value]
+    std::vector<float> mWeights;
+    std::vector<float> mWeightLogWeights;
+
+    int mWidth;
+    int mHeight;
+    int mMaxBacktracks;
+    uint32_t mRandomState;
+
+    std::vector<uint64_t> mDomains;
+    std::vector<float> mEntropies;          // What the cell's newest heap entry holds, older entries are skipped
+    std::vector<float> mNoise;              // Seeded tie breaks between cells of equal entropy
+    std::vector<HeapEntry> mHeap;
+    std::vector<int> mQueue;
+    std::vector<uint8_t> mIsQueued;
+    std::vector<TrailEntry> mTrail;
+    std::vector<Decision> mDecisions;
+
+    Grid2D<uint8_t> mResult;
+    WfcStats mStats;
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
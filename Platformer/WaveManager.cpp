@@ -0,0 +1,568 @@
+#include "AstroidsPrivate.h"
+#include "WaveManager.h"
+#include "LevelManager.h"
+#include "PlayerManager.h"
+#include "BDConfig.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <imgui.h>
+
+namespace
+{
+    const int skDefaultBudgetCount = 4;
+    const float skDefaultBudgetMicroseconds = 500.f;
+
+    // Random tiles tried per spawn before it waits for the next frame
+    const int skPickAttempts = 8;
+
+    int CountTrailingZeros(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return int(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    bool GetEnemyFromName(const std::string & name, EEnemy & outType)
+    {
+        if (name == "Ogre")
+        {
+            outType = EEnemy::Ogre;
+            return true;
+        }
+        if (name == "LizardF")
+        {
+            outType = EEnemy::LizardF;
+            return true;
+        }
+        return false;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------
+
+    const char * GetEnemyName(EEnemy type)
+    {
+        return type == EEnemy::LizardF ? "LizardF" : "Ogre";
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+WaveManager::WaveManager(GameManager * pGameManager)
+    : BaseManager(pGameManager)
+    , mSpawnSets()
+    , mWaves()
+    , mIsLooping(true)
+    , mLoopCountScale(1.f)
+    , mMaxAlive(1)
+    , mPrewarmCounts()
+    , mWaveIndex(-1)
+    , mLoopCount(0)
+    , mWaveDelay(0.f)
+    , mIsWaveRunning(false)
+    , mGroupProgress()
+    , mQueue()
+    , mBudgetCount(skDefaultBudgetCount)
+    , mBudgetMicroseconds(skDefaultBudgetMicroseconds)
+    , mSpawnedLastFrame(0)
+    , mPrewarmedLastFrame(0)
+    , mMicrosecondsLastFrame(0.f)
+    , mFailedPicks(0)
+{
+    if (!LoadWaves("Art/Waves.json"))
+    {
+        LoadDefaultWaves();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+WaveManager::~WaveManager()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::Update(float deltaTime)
+{
+    mSpawnedLastFrame = 0;
+    mPrewarmedLastFrame = 0;
+    mMicrosecondsLastFrame = 0.f;
+
+    // A network client draws the server's enemies, it neither spawns nor needs a pool
+    auto * pEnemyAIManager = GetGameManager().GetManager<EnemyAIManager>();
+    if (!pEnemyAIManager || !pEnemyAIManager->IsSpawningEnabled())
+    {
+        return;
+    }
+
+    if (mIsWaveRunning)
+    {
+        QueueGroups(deltaTime);
+        if (IsWaveCleared())
+        {
+            mIsWaveRunning = false;
+            size_t nextIndex = size_t(mWaveIndex + 1);
+            if (nextIndex >= mWaves.size() && mIsLooping)
+            {
+                nextIndex = 0;
+            }
+            mWaveDelay = nextIndex < mWaves.size() ? mWaves[nextIndex].mDelay : FLT_MAX;
+        }
+    }
+    else if (!mWaves.empty())
+    {
+        mWaveDelay -= deltaTime;
+        if (mWaveDelay <= 0.f)
+        {
+            StartWave(mWaveIndex + 1);
+        }
+    }
+
+    DrainQueue();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::OnGameEnd()
+{
+    mWaveIndex = -1;
+    mLoopCount = 0;
+    mWaveDelay = mWaves.empty() ? 0.f : mWaves[0].mDelay;
+    mIsWaveRunning = false;
+    mGroupProgress.clear();
+    mQueue.clear();
+    for (auto & spawnSet : mSpawnSets)
+    {
+        spawnSet.mPoints.clear();
+        spawnSet.mBuiltLevelGeneration = 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WaveManager::LoadWaves(const std::string & filePath)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open wave definitions: " << filePath << std::endl;
+        return false;
+    }
+
+    nlohmann::json definitions;
+    file >> definitions;
+
+    if (!definitions.contains("waves") || !definitions["waves"].is_array() ||
+        !definitions.contains("spawnSets") || !definitions["spawnSets"].is_array())
+    {
+        std::cerr << "No waves or spawn sets found in " << filePath << std::endl;
+        return false;
+    }
+
+    std::vector<SpawnSet> spawnSets;
+    for (const auto & setData : definitions["spawnSets"])
+    {
+        SpawnSet spawnSet;
+        spawnSet.mName = setData["name"].get<std::string>();
+        spawnSet.mSpacing = std::max(1, setData.value("spacing", 2));
+        spawnSet.mMinPlayerDistance = setData.value("minPlayerDistance", 0.f);
+        if (setData.contains("tiles") && setData["tiles"].size() == 4)
+        {
+            const auto & tiles = setData["tiles"];
+            spawnSet.mTiles = sf::IntRect(tiles[0], tiles[1], tiles[2], tiles[3]);
+        }
+        spawnSets.push_back(std::move(spawnSet));
+    }
+
+    std::vector<Wave> waves;
+    for (const auto & waveData : definitions["waves"])
+    {
+        Wave wave;
+        std::string setName = waveData.value("spawnSet", std::string());
+        auto setIt = std::find_if(spawnSets.begin(), spawnSets.end(), [&setName](const SpawnSet & spawnSet)
+        {
+            return spawnSet.mName == setName;
+        });
+        if (setIt == spawnSets.end())
+        {
+            std::cerr << "Wave uses unknown spawn set " << setName << " in " << filePath << std::endl;
+            continue;
+        }
+        wave.mSpawnSet = int(setIt - spawnSets.begin());
+        wave.mDelay = waveData.value("delay", 0.f);
+        wave.mClearBelow = std::max(1, waveData.value("clearBelow", 1));
+
+        for (const auto & groupData : waveData["groups"])
+        {
+            SpawnGroup group;
+            if (!GetEnemyFromName(groupData["enemy"].get<std::string>(), group.mType))
+            {
+                std::cerr << "Unknown enemy " << groupData["enemy"] << " in " << filePath << std::endl;
+                continue;
+            }
+            group.mCount = std::max(0, groupData.value("count", 1));
+            group.mInterval = std::max(0.f, groupData.value("interval", 0.f));
+            wave.mGroups.push_back(group);
+        }
+        waves.push_back(std::move(wave));
+    }
+
+    if (waves.empty())
+    {
+        std::cerr << "No usable waves in " << filePath << std::endl;
+        return false;
+    }
+
+    mPrewarmCounts.clear();
+    if (definitions.contains("prewarm"))
+    {
+        for (const auto & item : definitions["prewarm"].items())
+        {
+            EEnemy type;
+            if (GetEnemyFromName(item.key(), type))
+            {
+                mPrewarmCounts[type] = std::max(0, item.value().get<int>());
+            }
+        }
+    }
+
+    if (definitions.contains("spawnBudget"))
+    {
+        const auto & budget = definitions["spawnBudget"];
+        SetSpawnBudget(budget.value("count", skDefaultBudgetCount), budget.value("microseconds", skDefaultBudgetMicroseconds));
+    }
+
+    mSpawnSets.swap(spawnSets);
+    mWaves.swap(waves);
+    mIsLooping = definitions.value("loop", true);
+    mLoopCountScale = std::max(0.f, definitions.value("loopCountScale", 1.f));
+    mMaxAlive = std::max(1, definitions.value("maxAlive", 32));
+    OnGameEnd();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::LoadDefaultWaves()
+{
+    // One Ogre at a time anywhere on the level, as before waves were data
+    SpawnSet spawnSet;
+    spawnSet.mName = "Anywhere";
+    mSpawnSets.assign(1, spawnSet);
+
+    Wave wave;
+    SpawnGroup group;
+    group.mType = EEnemy::Ogre;
+    wave.mGroups.push_back(group);
+    mWaves.assign(1, wave);
+
+    mIsLooping = true;
+    mLoopCountScale = 1.f;
+    mMaxAlive = 1;
+    mPrewarmCounts.clear();
+    mPrewarmCounts[EEnemy::Ogre] = 1;
+    OnGameEnd();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::SetSpawnBudget(int count, float microseconds)
+{
+    mBudgetCount = std::max(1, count);
+    mBudgetMicroseconds = std::max(0.f, microseconds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::StartWave(int waveIndex)
+{
+    if (waveIndex >= int(mWaves.size()))
+    {
+        if (!mIsLooping)
+        {
+            return;
+        }
+        waveIndex = 0;
+        ++mLoopCount;
+    }
+
+    mWaveIndex = waveIndex;
+    mGroupProgress.assign(mWaves[waveIndex].mGroups.size(), GroupProgress());
+    mIsWaveRunning = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::QueueGroups(float deltaTime)
+{
+    const Wave & wave = mWaves[mWaveIndex];
+    for (size_t groupIndex = 0; groupIndex < wave.mGroups.size(); ++groupIndex)
+    {
+        const SpawnGroup & group = wave.mGroups[groupIndex];
+        GroupProgress & progress = mGroupProgress[groupIndex];
+        int count = GetScaledCount(group);
+
+        progress.mTimer -= deltaTime;
+        while (progress.mQueued < count && progress.mTimer <= 0.f)
+        {
+            mQueue.push_back({ group.mType, wave.mSpawnSet });
+            ++progress.mQueued;
+            progress.mTimer += group.mInterval;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WaveManager::IsWaveCleared() const
+{
+    if (!mQueue.empty())
+    {
+        return false;
+    }
+
+    const Wave & wave = mWaves[mWaveIndex];
+    for (size_t groupIndex = 0; groupIndex < wave.mGroups.size(); ++groupIndex)
+    {
+        if (mGroupProgress[groupIndex].mQueued < GetScaledCount(wave.mGroups[groupIndex]))
+        {
+            return false;
+        }
+    }
+
+    auto * pEnemyAIManager = GetGameManager().GetManager<EnemyAIManager>();
+    return !pEnemyAIManager || int(pEnemyAIManager->GetEnemies().size()) < wave.mClearBelow;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::DrainQueue()
+{
+    auto * pEnemyAIManager = GetGameManager().GetManager<EnemyAIManager>();
+    StopWatch stopWatch;
+    while (true)
+    {
+        int workDone = mSpawnedLastFrame + mPrewarmedLastFrame;
+        if (workDone >= mBudgetCount || (workDone > 0 && stopWatch.GetElapsedMicroSeconds() >= mBudgetMicroseconds))
+        {
+            break;
+        }
+
+        if (!mQueue.empty() && int(pEnemyAIManager->GetEnemies().size()) < mMaxAlive)
+        {
+            // A spawn with nowhere to go stays at the front and tries again next frame
+            sf::Vector2f position;
+            if (!PickSpawnPoint(mSpawnSets[mQueue.front().mSpawnSet], position))
+            {
+                ++mFailedPicks;
+                break;
+            }
+            pEnemyAIManager->SpawnEnemy(mQueue.front().mType, position);
+            mQueue.pop_front();
+            ++mSpawnedLastFrame;
+            continue;
+        }
+
+        EEnemy type;
+        if (GetPrewarmType(type))
+        {
+            pEnemyAIManager->PrewarmEnemy(type);
+            ++mPrewarmedLastFrame;
+            continue;
+        }
+        break;
+    }
+    mMicrosecondsLastFrame = stopWatch.GetElapsedMicroSeconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WaveManager::PickSpawnPoint(SpawnSet & spawnSet, sf::Vector2f & outPosition)
+{
+    auto & gameManager = GetGameManager();
+    auto * pLevelManager = gameManager.GetManager<LevelManager>();
+    if (!pLevelManager)
+    {
+        return false;
+    }
+
+    if (spawnSet.mBuiltLevelGeneration != pLevelManager->GetLevelGeneration())
+    {
+        BuildSpawnSet(spawnSet);
+    }
+    if (spawnSet.mPoints.empty())
+    {
+        return false;
+    }
+
+    const float cellSize = BD::gsPixelCountCellSize;
+    const float minDistanceSquared = spawnSet.mMinPlayerDistance * spawnSet.mMinPlayerDistance;
+    auto * pPlayerManager = gameManager.GetManager<PlayerManager>();
+    for (int attempt = 0; attempt < skPickAttempts; ++attempt)
+    {
+        // Streamed levels change under a set that was built earlier, so the tile is checked again
+        const sf::Vector2i & tile = spawnSet.mPoints[rand() % spawnSet.mPoints.size()];
+        if (!pLevelManager->IsTileWalkableAI(tile.x, tile.y))
+        {
+            continue;
+        }
+
+        sf::Vector2f position((tile.x + 0.5f) * cellSize, (tile.y + 0.5f) * cellSize);
+        bool isClearOfPlayers = true;
+        if (pPlayerManager && minDistanceSquared > 0.f)
+        {
+            for (BD::Handle playerHandle : pPlayerManager->GetPlayers())
+            {
+                GameObject * pPlayer = gameManager.GetGameObject(playerHandle);
+                if (!pPlayer)
+                {
+                    continue;
+                }
+                sf::Vector2f offset = pPlayer->GetPosition() - position;
+                if (offset.x * offset.x + offset.y * offset.y < minDistanceSquared)
+                {
+                    isClearOfPlayers = false;
+                    break;
+                }
+            }
+        }
+
+        if (isClearOfPlayers)
+        {
+            outPosition = position;
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::BuildSpawnSet(SpawnSet & spawnSet)
+{
+    spawnSet.mPoints.clear();
+    auto * pLevelManager = GetGameManager().GetManager<LevelManager>();
+    const BitGridView & walkable = pLevelManager->GetLayer(LevelFormat::WalkableAI);
+    spawnSet.mBuiltLevelGeneration = pLevelManager->GetLevelGeneration();
+    if (walkable.IsEmpty())
+    {
+        return;
+    }
+
+    sf::IntRect levelTiles(0, 0, walkable.GetWidth(), walkable.GetHeight());
+    sf::IntRect tiles = levelTiles;
+    if (spawnSet.mTiles.width > 0 && spawnSet.mTiles.height > 0 && !spawnSet.mTiles.intersects(levelTiles, tiles))
+    {
+        return;
+    }
+
+    // A word of the row at a time, only set bits cost anything
+    const int right = tiles.left + tiles.width;
+    for (int y = tiles.top; y < tiles.top + tiles.height; y += spawnSet.mSpacing)
+    {
+        const uint64_t * pRow = walkable.GetRowWords(y);
+        for (int wordIndex = tiles.left >> 6; wordIndex <= (right - 1) >> 6; ++wordIndex)
+        {
+            uint64_t bits = pRow[wordIndex];
+            while (bits)
+            {
+                int x = (wordIndex << 6) + CountTrailingZeros(bits);
+                bits &= bits - 1;
+                if (x < tiles.left || x >= right || (x - tiles.left) % spawnSet.mSpacing != 0)
+                {
+                    continue;
+                }
+
+                // Room for an enemy's body, not a tile squeezed against a wall
+                if (walkable.Test(x - 1, y) && walkable.Test(x + 1, y) && walkable.Test(x, y - 1) && walkable.Test(x, y + 1))
+                {
+                    spawnSet.mPoints.emplace_back(x, y);
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+bool WaveManager::GetPrewarmType(EEnemy & outType) const
+{
+    auto * pEnemyAIManager = GetGameManager().GetManager<EnemyAIManager>();
+    for (const auto & prewarm : mPrewarmCounts)
+    {
+        if (pEnemyAIManager->GetParkedCount(prewarm.first) < prewarm.second)
+        {
+            outType = prewarm.first;
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+int WaveManager::GetScaledCount(const SpawnGroup & group) const
+{
+    return int(std::round(group.mCount * std::pow(mLoopCountScale, float(mLoopCount))));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WaveManager::DebugImGuiInfo()
+{
+#if IMGUI_ENABLED()
+    ImGui::Begin("Waves");
+
+    auto * pEnemyAIManager = GetGameManager().GetManager<EnemyAIManager>();
+    ImGui::Text("Wave: %d of %d, loop %d", mWaveIndex + 1, int(mWaves.size()), mLoopCount);
+    if (mIsWaveRunning)
+    {
+        ImGui::Text("Running");
+    }
+    else
+    {
+        ImGui::Text("Next wave in %.1f s", mWaveDelay);
+    }
+    if (ImGui::Button("Start Next Wave"))
+    {
+        StartWave(mWaveIndex + 1);
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Alive: %d of %d", pEnemyAIManager ? int(pEnemyAIManager->GetEnemies().size()) : 0, mMaxAlive);
+    ImGui::Text("Queued: %d", GetQueuedCount());
+    for (const auto & prewarm : mPrewarmCounts)
+    {
+        int parkedCount = pEnemyAIManager ? pEnemyAIManager->GetParkedCount(prewarm.first) : 0;
+        ImGui::Text("Parked %s: %d, prewarm to %d", GetEnemyName(prewarm.first), parkedCount, prewarm.second);
+    }
+
+    ImGui::Separator();
+    ImGui::SliderInt("Budget (spawns)", &mBudgetCount, 1, 32);
+    ImGui::SliderFloat("Budget (us)", &mBudgetMicroseconds, 0.f, 4000.f);
+    ImGui::Text("Spawned last frame: %d", mSpawnedLastFrame);
+    ImGui::Text("Prewarmed last frame: %d", mPrewarmedLastFrame);
+    ImGui::Text("Last frame: %.1f us", mMicrosecondsLastFrame);
+    ImGui::Text("Failed spawn picks: %d", mFailedPicks);
+
+    for (const auto & spawnSet : mSpawnSets)
+    {
+        ImGui::Text("Spawn set %s: %d points", spawnSet.mName.c_str(), int(spawnSet.mPoints.size()));
+    }
+
+    ImGui::End();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BaseManager.h"
+#include "EnemyAIManager.h"
+
+// Runs the enemy waves described in Art/Waves.json. Each wave names a spawn set, the AI walkable tiles inside a rect of
+// the level found by one scan of the walkable layer, and groups of enemies that are queued at their own interval. The
+// queue is drained a few spawns per frame, capped by count and by microseconds, so a big wave costs a little over many
+// frames rather than all at once. The EnemyAIManager's pool is prewarmed from the same budget in the frames with
+// nothing queued, so spawns mostly just place a parked enemy.
+class WaveManager : public BaseManager
+{
+public:
+    WaveManager(GameManager * pGameManager);
+    ~WaveManager();
+
+    virtual void Update(float deltaTime) override;
+    virtual void OnGameEnd() override;
+
+    bool LoadWaves(const std::string & filePath);
+
+    // At least one spawn or prewarm happens each frame that has work, so a budget that is too small still makes progress
+    void SetSpawnBudget(int count, float microseconds);
+
+    int GetWaveIndex() const { return mWaveIndex; }
+    int GetQueuedCount() const { return int(mQueue.size()); }
+
+    void DebugImGuiInfo();
+
+private:
+    struct SpawnSet
+    {
+        std::string mName;
+        sf::IntRect mTiles;                 // Empty for the whole level
+        int mSpacing = 2;                   // Only every mSpacing'th tile in x and y is a candidate
+        float mMinPlayerDistance = 0.f;     // Pixels, keeps spawns off the player's screen
+        std::vector<sf::Vector2i> mPoints;  // Filled on first use and again whenever the level is replaced
+        uint32_t mBuiltLevelGeneration = 0; // LevelManager::GetLevelGeneration when mPoints was filled, 0 for never
+    };
+
+    struct SpawnGroup
+    {
+        EEnemy mType = EEnemy::Ogre;
+        int mCount = 1;
+        float mInterval = 0.f;              // Seconds between queueing each enemy of the group
+    };
+
+    struct Wave
+    {
+        int mSpawnSet = 0;
+        float mDelay = 0.f;                 // Seconds after the previous wave cleared
+        int mClearBelow = 1;                // Over once all of it has spawned and fewer enemies than this are left
+        std::vector<SpawnGroup> mGroups;
+    };
+
+    struct QueuedSpawn
+    {
+        EEnemy mType;
+        int mSpawnSet;
+    };
+
+    struct GroupProgress
+    {
+        int mQueued = 0;
+        float mTimer = 0.f;
+    };
+
+    void LoadDefaultWaves();
+    void StartWave(int waveIndex);
+    void QueueGroups(float deltaTime);
+    bool IsWaveCleared() const;
+    void DrainQueue();
+    bool PickSpawnPoint(SpawnSet & spawnSet, sf::Vector2f & outPosition);
+    void BuildSpawnSet(SpawnSet & spawnSet);
+    bool GetPrewarmType(EEnemy & outType) const;
+    int GetScaledCount(const SpawnGroup & group) const;
+
+    std::vector<SpawnSet> mSpawnSets;
+    std::vector<Wave> mWaves;
+    bool mIsLooping;
+    float mLoopCountScale;              // Group counts grow by this much each time the waves loop
+    int mMaxAlive;
+    std::unordered_map<EEnemy, int> mPrewarmCounts;     // Parked enemies to keep ready, by type
+
+    int mWaveIndex;                     // -1 before the first wave
+    int mLoopCount;
+    float mWaveDelay;                   // Counting down to the next wave
+    bool mIsWaveRunning;
+    std::vector<GroupProgress> mGroupProgress;
+    std::deque<QueuedSpawn> mQueue;
+
+    // Budget
+    int mBudgetCount;
+    float mBudgetMicroseconds;
+    int mSpawnedLastFrame;
+    int mPrewarmedLastFrame;
+    float mMicrosecondsLastFrame;
+    int mFailedPicks;                   // Queued spawns put back because no spawn point passed
+};
+
+//------------------------------------------------------------------------------------------------------------------------
+// EOF
+//------------------------------------------------------------------------------------------------------------------------
@@ -6,9 +6,12 @@
 
 WindowManager::WindowManager()
 	: mEvent()
+	, mFramePacer()
+	, mHasFocus(true)
+	, mEvents()
 {
     mpWindow = new sf::RenderWindow(sf::VideoMode(1920, 1088), "Astroids", sf::Style::Default);
-    mpWindow->setFramerateLimit(300);
+    mFramePacer.SetMode(EFrameSync::Paced, *mpWindow);
 
     mpWindow->setMouseCursorVisible(false);
 
@@ -30,20 +33,58 @@ WindowManager::~WindowManager()
 
 void WindowManager::PollEvents()
 {
-    ImGui::SFML::ProcessEvent(mEvent);
+    mEvents.clear();
     while (mpWindow->pollEvent(mEvent))
     {
-        switch (mEvent.type)
+        HandleEvent();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WindowManager::WaitEvents()
+{
+    mEvents.clear();
+    if (!mpWindow->waitEvent(mEvent))
+    {
+        return;
+    }
+    HandleEvent();
+    while (mpWindow->pollEvent(mEvent))
+    {
+        HandleEvent();
+    }
+
+    // Time spent blocked is not a frame
+    mFramePacer.ResetClock();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
+void WindowManager::HandleEvent()
+{
+    ImGui::SFML::ProcessEvent(mEvent);
+    mEvents.push_back(mEvent);
+    switch (mEvent.type)
+    {
+        case sf::Event::Closed:
+        {
+            mpWindow->close();
+            break;
+        }
+        case sf::Event::LostFocus:
+        {
+            mHasFocus = false;
+            break;
+        }
+        case sf::Event::GainedFocus:
+        {
+            mHasFocus = true;
+            break;
+        }
+        default:
         {
-            case sf::Event::Closed:
-            {
-                mpWindow->close();
-                break;
-            }
-            case sf::Event::KeyPressed:
-            {
-                break;
-            }
+            break;
         }
     }
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <vector>
+#include "FramePacer.h"
 
 namespace BD
 {
@@ -13,10 +15,23 @@ public:
 
 	void PollEvents();
 
+	// Blocks until at least one event arrives, then handles everything waiting. Uses no CPU while nothing happens.
+	void WaitEvents();
+
+	// Everything the last PollEvents or WaitEvents handled, for the InputManager to sample
+	const std::vector<sf::Event> & GetEvents() const { return mEvents; }
+	bool HasFocus() const { return mHasFocus; }
+
 	sf::RenderWindow * GetWindow();
 	sf::Event GetEvent() const;
+	FramePacer & GetFramePacer() { return mFramePacer; }
 
 private:
+	void HandleEvent();
+
 	sf::RenderWindow * mpWindow;
 	sf::Event mEvent;
+	FramePacer mFramePacer;
+	bool mHasFocus;
+	std::vector<sf::Event> mEvents;
 };
\ No newline at end of file
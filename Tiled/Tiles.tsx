@@ -1,4 +1,23 @@
 <?xml version="1.0" encoding="UTF-8"?>
 <tileset version="1.10" tiledversion="1.11.0" name="Tiles" tilewidth="16" tileheight="16" tilecount="1024" columns="32">
+ <properties>
+  <property name="gameImage" value="Art/TileSet.png"/>
+ </properties>
  <image source="C:/Users/leasi/Downloads/0x72_DungeonTilesetII_v1.7/0x72_DungeonTilesetII_v1.7/0x72_DungeonTilesetII_v1.7.png" width="512" height="512"/>
+ <tile id="34">
+  <properties>
+   <property name="walkable" type="bool" value="false"/>
+   <property name="wfcNeighbors" value="34,129,130"/>
+  </properties>
+ </tile>
+ <tile id="129" probability="0.35">
+  <properties>
+   <property name="wfcNeighbors" value="129"/>
+  </properties>
+ </tile>
+ <tile id="130" probability="0.6">
+  <properties>
+   <property name="wfcNeighbors" value="130"/>
+  </properties>
+ </tile>
 </tileset>